@@ -92,18 +92,30 @@ VERSTR = '\\"$${VER}\\"'          # place quotes around the version string
 DEFINES += VERSION=\"$${VERSTR}\" # create a VERSION macro containing the version string
 
 SOURCES += \
+    src/applications/gqrx/band_scanner.cpp \
     src/applications/gqrx/main.cpp \
+    src/applications/gqrx/kiss_server.cpp \
     src/applications/gqrx/mainwindow.cpp \
+    src/applications/gqrx/packet_decoder.cpp \
     src/applications/gqrx/receiver.cpp \
     src/applications/gqrx/file_resources.cpp \
     src/applications/gqrx/remote_control.cpp \
     src/applications/gqrx/remote_control_settings.cpp \
+    src/applications/gqrx/spectrum_server.cpp \
     src/dsp/afsk1200/cafsk12.cpp \
     src/dsp/afsk1200/costabf.c \
     src/dsp/agc_impl.cpp \
+    src/dsp/audio_ring.cpp \
     src/dsp/correct_iq_cc.cpp \
+    src/dsp/drift_resampler.cpp \
+    src/dsp/fft_plan.cpp \
+    src/dsp/gap_logger_c.cpp \
+    src/dsp/hbf_decim.cpp \
+    src/dsp/level_history.cpp \
+    src/dsp/filter/decimator.cpp \
     src/dsp/filter/fir_decim.cpp \
     src/dsp/lpf.cpp \
+    src/dsp/packet_chan.cpp \
     src/dsp/rds/decoder_impl.cc \
     src/dsp/rds/parser_impl.cc \
     src/dsp/resampler_xx.cpp \
@@ -116,8 +128,13 @@ SOURCES += \
     src/dsp/rx_meter.cpp \
     src/dsp/rx_noise_blanker_cc.cpp \
     src/dsp/rx_rds.cpp \
+    src/dsp/rx_time.cpp \
+    src/dsp/rx_time_tagger_cc.cpp \
     src/dsp/sniffer_f.cpp \
+    src/dsp/spectrum_persistence.cpp \
+    src/dsp/sql_recorder_ff.cpp \
     src/dsp/stereo_demod.cpp \
+    src/interfaces/udp_framer_f.cpp \
     src/interfaces/udp_sink_f.cpp \
     src/qtgui/afsk1200win.cpp \
     src/qtgui/agc_options.cpp \
@@ -127,8 +144,10 @@ SOURCES += \
     src/qtgui/bookmarkstaglist.cpp \
     src/qtgui/ctk/ctkRangeSlider.cpp \
     src/qtgui/demod_options.cpp \
+    src/qtgui/device_discovery.cpp \
     src/qtgui/dockaudio.cpp \
     src/qtgui/dockbookmarks.cpp \
+    src/qtgui/dockdspload.cpp \
     src/qtgui/dockinputctl.cpp \
     src/qtgui/dockrds.cpp \
     src/qtgui/dockrxopt.cpp \
@@ -140,24 +159,42 @@ SOURCES += \
     src/qtgui/nb_options.cpp \
     src/qtgui/plotter.cpp \
     src/qtgui/qtcolorpicker.cpp \
+    src/qtgui/waterfall_history.cpp \
     src/receivers/nbrx.cpp \
     src/receivers/receiver_base.cpp \
     src/receivers/wfmrx.cpp
 
 HEADERS += \
+    src/applications/gqrx/band_scanner.h \
+    src/applications/gqrx/block_stats.h \
+    src/applications/gqrx/gain_stage.h \
     src/applications/gqrx/gqrx.h \
+    src/applications/gqrx/kiss_server.h \
     src/applications/gqrx/mainwindow.h \
+    src/applications/gqrx/packet_decoder.h \
     src/applications/gqrx/receiver.h \
     src/applications/gqrx/remote_control.h \
     src/applications/gqrx/remote_control_settings.h \
+    src/applications/gqrx/spectrum_server.h \
     src/dsp/afsk1200/cafsk12.h \
     src/dsp/afsk1200/filter.h \
     src/dsp/afsk1200/filter-i386.h \
     src/dsp/agc_impl.h \
+    src/dsp/audio_ring.h \
     src/dsp/correct_iq_cc.h \
+    src/dsp/drift_resampler.h \
+    src/dsp/fft_plan.h \
+    src/dsp/gap_logger_c.h \
+    src/dsp/hbf_decim.h \
+    src/dsp/level_history.h \
+    src/dsp/filter/decimator.h \
+    src/dsp/filter/filtercoef_hbf_70.h \
+    src/dsp/filter/filtercoef_hbf_100.h \
+    src/dsp/filter/filtercoef_hbf_140.h \
     src/dsp/filter/fir_decim.h \
     src/dsp/filter/fir_decim_coef.h \
     src/dsp/lpf.h \
+    src/dsp/packet_chan.h \
     src/dsp/rds/api.h \
     src/dsp/rds/parser.h \
     src/dsp/rds/decoder.h \
@@ -175,8 +212,13 @@ HEADERS += \
     src/dsp/rx_meter.h \
     src/dsp/rx_noise_blanker_cc.h \
     src/dsp/rx_rds.h \
+    src/dsp/rx_time.h \
+    src/dsp/rx_time_tagger_cc.h \
     src/dsp/sniffer_f.h \
+    src/dsp/spectrum_persistence.h \
+    src/dsp/sql_recorder_ff.h \
     src/dsp/stereo_demod.h \
+    src/interfaces/udp_framer_f.h \
     src/interfaces/udp_sink_f.h \
     src/qtgui/afsk1200win.h \
     src/qtgui/agc_options.h \
@@ -187,8 +229,10 @@ HEADERS += \
     src/qtgui/ctk/ctkPimpl.h \
     src/qtgui/ctk/ctkRangeSlider.h \
     src/qtgui/demod_options.h \
+    src/qtgui/device_discovery.h \
     src/qtgui/dockaudio.h \
     src/qtgui/dockbookmarks.h \
+    src/qtgui/dockdspload.h \
     src/qtgui/dockfft.h \
     src/qtgui/dockinputctl.h \
     src/qtgui/dockrds.h \
@@ -200,6 +244,7 @@ HEADERS += \
     src/qtgui/nb_options.h \
     src/qtgui/plotter.h \
     src/qtgui/qtcolorpicker.h \
+    src/qtgui/waterfall_history.h \
     src/receivers/nbrx.h \
     src/receivers/receiver_base.h \
     src/receivers/wfmrx.h
@@ -213,6 +258,7 @@ FORMS += \
     src/qtgui/demod_options.ui \
     src/qtgui/dockaudio.ui \
     src/qtgui/dockbookmarks.ui \
+    src/qtgui/dockdspload.ui \
     src/qtgui/dockfft.ui \
     src/qtgui/dockinputctl.ui \
     src/qtgui/dockrds.ui \
@@ -262,8 +308,10 @@ PKGCONFIG += gnuradio-analog \
              gnuradio-digital \
              gnuradio-filter \
              gnuradio-fft \
+             fftw3f \
              gnuradio-runtime \
-             gnuradio-osmosdr
+             gnuradio-osmosdr \
+             volk
 
 # Detect GNU Radio version and link against log4cpp for 3.8
 GNURADIO_VERSION = $$system(pkg-config --modversion gnuradio-runtime)
@@ -284,6 +332,12 @@ GNURADIO_HEX_VERSION = $$system(            \
 )
 DEFINES += GNURADIO_VERSION=$$GNURADIO_HEX_VERSION
 
+# Opus compressed audio streaming is optional
+packagesExist(opus) {
+    PKGCONFIG += opus
+    DEFINES += WITH_OPUS
+}
+
 greaterThan(GNURADIO_VERSION_MINOR, 7) {
     PKGCONFIG += log4cpp
 }
@@ -291,12 +345,12 @@ greaterThan(GNURADIO_VERSION_MINOR, 7) {
 INCPATH += src/
 
 unix:!macx {
-    LIBS += -lboost_system$$BOOST_SUFFIX -lboost_program_options$$BOOST_SUFFIX
+    LIBS += -lboost_system$$BOOST_SUFFIX -lboost_thread$$BOOST_SUFFIX -lboost_program_options$$BOOST_SUFFIX
     LIBS += -lrt  # need to include on some distros
 }
 
 macx {
-    LIBS += -lboost_system-mt -lboost_program_options-mt
+    LIBS += -lboost_system-mt -lboost_thread-mt -lboost_program_options-mt
 }
 
 OTHER_FILES += \
@@ -0,0 +1,654 @@
+/* -*- c++ -*- */
+/*
+ * Gqrx SDR: Software defined radio receiver powered by GNU Radio and Qt
+ *           http://gqrx.dk/
+ *
+ * Copyright 2020 Vadym Ostanin.
+ *
+ * Gqrx is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * Gqrx is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Gqrx; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <QDebug>
+#include <volk/volk.h>
+
+#include "band_scanner.h"
+
+#define SCAN_INTERVAL           25      /* milliseconds */
+
+#define DEFAULT_STEP            12500   /* Hz */
+#define DEFAULT_THRESHOLD       10.0    /* dB above noise floor */
+#define DEFAULT_DWELL           2000    /* milliseconds */
+#define DEFAULT_HANG            3000    /* milliseconds */
+#define DEFAULT_SETTLE          50      /* milliseconds */
+#define DEFAULT_PRIORITY_INTERVAL 10    /* capture windows */
+#define DEFAULT_PRIORITY_TAG    "Priority"
+
+/* Fraction of the I/Q bandwidth used for scanning; the rest is lost in the
+ * roll-off of the input filters. */
+#define USABLE_BANDWIDTH        0.8
+
+
+BandScanner::BandScanner(receiver *rx, QObject *parent) :
+    QObject(parent),
+    rx(rx),
+    range_start(0),
+    range_stop(0),
+    step(DEFAULT_STEP),
+    threshold(DEFAULT_THRESHOLD),
+    dwell_ms(DEFAULT_DWELL),
+    hang_ms(DEFAULT_HANG),
+    settle_ms(DEFAULT_SETTLE),
+    priority_interval(DEFAULT_PRIORITY_INTERVAL),
+    use_bookmarks(false),
+    priority_tag(DEFAULT_PRIORITY_TAG),
+    state(SCAN_SEARCH),
+    center_freq(0),
+    last_channel(0),
+    park_time(0),
+    active_time(0),
+    settle_time(0),
+    parked_priority(false),
+    priority_pass(false),
+    priority_next(0),
+    window_count(0),
+    resume_freq(0),
+    fft_size(0),
+    fft_center(0.0),
+    fft_rate(0.0),
+    fft_count(0),
+    noise_floor(0.f)
+{
+    fft_data.resize(MAX_FFT_SIZE);
+
+    scan_timer.setInterval(SCAN_INTERVAL);
+    connect(&scan_timer, SIGNAL(timeout()), this, SLOT(scanTimeout()));
+}
+
+BandScanner::~BandScanner()
+{
+    scan_timer.stop();
+}
+
+/*! \brief Read settings. */
+void BandScanner::readSettings(QSettings *settings)
+{
+    bool conv_ok;
+    int int_val;
+    double dbl_val;
+
+    if (!settings)
+        return;
+
+    settings->beginGroup("band_scanner");
+
+    range_start = settings->value("start", 0).toLongLong(&conv_ok);
+    range_stop = settings->value("stop", 0).toLongLong(&conv_ok);
+
+    int_val = settings->value("step", DEFAULT_STEP).toInt(&conv_ok);
+    if (conv_ok)
+        setStep(int_val);
+
+    dbl_val = settings->value("threshold", DEFAULT_THRESHOLD).toDouble(&conv_ok);
+    if (conv_ok)
+        setThreshold(dbl_val);
+
+    int_val = settings->value("dwell", DEFAULT_DWELL).toInt(&conv_ok);
+    if (conv_ok)
+        setDwell(int_val);
+
+    int_val = settings->value("hang", DEFAULT_HANG).toInt(&conv_ok);
+    if (conv_ok)
+        setHang(int_val);
+
+    int_val = settings->value("settle", DEFAULT_SETTLE).toInt(&conv_ok);
+    if (conv_ok && int_val >= 0)
+        settle_ms = int_val;
+
+    int_val = settings->value("priority_interval", DEFAULT_PRIORITY_INTERVAL).toInt(&conv_ok);
+    if (conv_ok)
+        setPriorityInterval(int_val);
+
+    use_bookmarks = settings->value("bookmarks", false).toBool();
+    priority_tag = settings->value("priority_tag", DEFAULT_PRIORITY_TAG).toString();
+
+    settings->endGroup();
+}
+
+/*! \brief Save settings. */
+void BandScanner::saveSettings(QSettings *settings) const
+{
+    if (!settings)
+        return;
+
+    settings->beginGroup("band_scanner");
+
+    if (range_start != 0)
+        settings->setValue("start", range_start);
+    else
+        settings->remove("start");
+
+    if (range_stop != 0)
+        settings->setValue("stop", range_stop);
+    else
+        settings->remove("stop");
+
+    if (step != DEFAULT_STEP)
+        settings->setValue("step", step);
+    else
+        settings->remove("step");
+
+    if (threshold != DEFAULT_THRESHOLD)
+        settings->setValue("threshold", threshold);
+    else
+        settings->remove("threshold");
+
+    if (dwell_ms != DEFAULT_DWELL)
+        settings->setValue("dwell", dwell_ms);
+    else
+        settings->remove("dwell");
+
+    if (hang_ms != DEFAULT_HANG)
+        settings->setValue("hang", hang_ms);
+    else
+        settings->remove("hang");
+
+    if (settle_ms != DEFAULT_SETTLE)
+        settings->setValue("settle", settle_ms);
+    else
+        settings->remove("settle");
+
+    if (priority_interval != DEFAULT_PRIORITY_INTERVAL)
+        settings->setValue("priority_interval", priority_interval);
+    else
+        settings->remove("priority_interval");
+
+    if (use_bookmarks)
+        settings->setValue("bookmarks", true);
+    else
+        settings->remove("bookmarks");
+
+    if (priority_tag != DEFAULT_PRIORITY_TAG)
+        settings->setValue("priority_tag", priority_tag);
+    else
+        settings->remove("priority_tag");
+
+    settings->endGroup();
+}
+
+/*! \brief Set scan range.
+ *
+ * If start and stop are equal, only the current capture window is scanned
+ * and the hardware is never retuned.
+ */
+void BandScanner::setRange(qint64 start_hz, qint64 stop_hz)
+{
+    range_start = std::min(start_hz, stop_hz);
+    range_stop = std::max(start_hz, stop_hz);
+}
+
+void BandScanner::setStep(int step_hz)
+{
+    if (step_hz > 0)
+        step = step_hz;
+}
+
+void BandScanner::setThreshold(double threshold_db)
+{
+    threshold = threshold_db;
+}
+
+void BandScanner::setDwell(int dwell_ms)
+{
+    this->dwell_ms = std::max(dwell_ms, 0);
+}
+
+void BandScanner::setHang(int hang_ms)
+{
+    this->hang_ms = std::max(hang_ms, 0);
+}
+
+/*! \brief Set number of capture windows between visits to priority channels.
+ *
+ * 0 disables the priority pass; priority channels are then only checked
+ * while they are within the current capture window.
+ */
+void BandScanner::setPriorityInterval(int windows)
+{
+    priority_interval = std::max(windows, 0);
+}
+
+/*! \brief Set the channels to scan.
+ *  \param channels Sorted channel frequencies or empty to scan a grid.
+ *  \param priority Sorted priority channel frequencies.
+ */
+void BandScanner::setChannelList(const QVector<qint64> &channels,
+                                 const QVector<qint64> &priority)
+{
+    this->channels = channels;
+    this->priority = priority;
+    priority_next = std::min(priority_next, priority.size());
+}
+
+/*! \brief Start scanning. */
+void BandScanner::start(void)
+{
+    if (isRunning())
+        return;
+
+    clock.start();
+    last_channel = 0;
+    window_count = 0;
+    parked_priority = false;
+    priority_pass = false;
+
+    if (channels.isEmpty() && range_start < range_stop)
+    {
+        // start at the lower edge of the range
+        nextWindow();
+    }
+    else
+    {
+        settle_time = clock.elapsed();
+        state = SCAN_SETTLE;
+    }
+
+    scan_timer.start();
+    emit scannerStatusChanged(true);
+}
+
+/*! \brief Stop scanning and stay on the current channel. */
+void BandScanner::stop(void)
+{
+    if (!isRunning())
+        return;
+
+    scan_timer.stop();
+    emit scannerStatusChanged(false);
+}
+
+/*! \brief Center frequency of the I/Q band has changed. */
+void BandScanner::setCenterFrequency(qint64 freq)
+{
+    if (freq == center_freq)
+        return;
+
+    // retuned by us or by the user; either way the spectrum is stale
+    center_freq = freq;
+    settle_time = clock.isValid() ? clock.elapsed() : 0;
+    if (isRunning())
+        state = SCAN_SETTLE;
+}
+
+void BandScanner::scanTimeout(void)
+{
+    qint64  now = clock.elapsed();
+    qint64  channel;
+
+    switch (state)
+    {
+    case SCAN_SETTLE:
+        // wait for the new samples to fill the FFT buffer
+        if (now - settle_time < settle_ms ||
+            (fft_rate > 0.0 && now - settle_time < 2000.0 * fft_size / fft_rate))
+            break;
+        // discard spectrum of samples received while retuning
+        updateSpectrum();
+        last_channel = 0;
+        state = SCAN_SEARCH;
+        break;
+
+    case SCAN_SEARCH:
+        if (!updateSpectrum())
+            break;
+
+        if (priority_pass)
+        {
+            if (findPriority(channel))
+            {
+                parkChannel(channel, true);
+            }
+            else if (!nextPriorityWindow())
+            {
+                // continue with the window after the one we left
+                priority_pass = false;
+                center_freq = resume_freq;
+                nextWindow();
+            }
+        }
+        else if (findPriority(channel))
+        {
+            parkChannel(channel, true);
+        }
+        else if (findChannel(last_channel, channel) ||
+                 (last_channel != 0 && singleWindow() && findChannel(0, channel)))
+        {
+            parkChannel(channel, false);
+        }
+        else if (singleWindow())
+        {
+            // start over from the lower edge
+            last_channel = 0;
+        }
+        else if (!priority.isEmpty() && priority_interval > 0 &&
+                 ++window_count >= priority_interval)
+        {
+            window_count = 0;
+            priority_next = 0;
+            resume_freq = center_freq;
+            priority_pass = nextPriorityWindow();
+            if (!priority_pass)
+                nextWindow();
+        }
+        else
+        {
+            nextWindow();
+        }
+        break;
+
+    case SCAN_PARKED:
+        if (!updateSpectrum())
+            break;
+
+        // priority channels take over from normal channels
+        if (!parked_priority && findPriority(channel))
+        {
+            parkChannel(channel, true);
+            break;
+        }
+
+        if (channelActive(last_channel))
+            active_time = now;
+        else if (now - park_time >= dwell_ms && now - active_time >= hang_ms)
+            state = SCAN_SEARCH;
+        break;
+    }
+}
+
+/*! \brief Fetch new FFT data from the receiver.
+ *  \return False if there was no new spectrum covering the capture window.
+ *
+ * The FFT may be zoomed in on the pandapter span, or repeat the last
+ * spectrum while the zoom changes, so the range is taken from the
+ * receiver and only new spectra of the whole window are used.
+ */
+bool BandScanner::updateSpectrum(void)
+{
+    unsigned int    fftsize = 0;
+    unsigned int    i;
+    unsigned int    half;
+    unsigned long   count;
+    double          center;
+    double          rate;
+
+    rx->get_iq_fft_data(fft_data.data(), fftsize);
+    if (fftsize == 0)
+        return false;
+
+    count = rx->get_iq_fft_count();
+    if (count == fft_count)
+        return false;
+    fft_count = count;
+
+    rx->get_iq_fft_range(center, rate);
+    if (rate <= 0.0 || std::abs(center) + windowSpan() / 2 > rate / 2)
+        return false;
+
+    fft_center = center;
+    fft_rate = rate;
+
+    fft_size = fftsize;
+    fft_pwr.resize(fftsize);
+    volk_32fc_magnitude_squared_32f(fft_pwr.data(), fft_data.data(), fftsize);
+
+    // move DC to the middle
+    half = fftsize / 2;
+    std::rotate(fft_pwr.begin(), fft_pwr.begin() + half, fft_pwr.end());
+
+    // noise floor is the median of the usable part of the spectrum
+    i = (unsigned int)(half * (1.0 - USABLE_BANDWIDTH));
+    fft_sorted.assign(fft_pwr.begin() + i, fft_pwr.end() - i);
+    std::nth_element(fft_sorted.begin(),
+                     fft_sorted.begin() + fft_sorted.size() / 2,
+                     fft_sorted.end());
+    noise_floor = fft_sorted[fft_sorted.size() / 2];
+
+    return true;
+}
+
+/*! \brief Average bin power of a channel relative to the noise floor in dB. */
+float BandScanner::channelLevel(qint64 freq) const
+{
+    double  bin_hz = fft_rate / fft_size;
+    double  offset = freq - center_freq - fft_center;
+    int     first = (int)std::floor((offset - step / 2) / bin_hz) + fft_size / 2;
+    int     last = (int)std::ceil((offset + step / 2) / bin_hz) + fft_size / 2;
+    float   sum = 0.f;
+    int     i;
+
+    first = std::max(first, 0);
+    last = std::min(last, (int)fft_size - 1);
+    if (last < first || noise_floor <= 0.f)
+        return 0.f;
+
+    for (i = first; i <= last; i++)
+        sum += fft_pwr[i];
+
+    return 10.f * std::log10(sum / (last - first + 1) / noise_floor);
+}
+
+bool BandScanner::channelActive(qint64 freq) const
+{
+    return channelLevel(freq) >= threshold;
+}
+
+/*! \brief Width of the usable part of the capture window. */
+qint64 BandScanner::windowSpan(void) const
+{
+    double rate = rx->get_input_rate() / (double)std::max(rx->get_input_decim(), 1u);
+
+    return (qint64)(rate * USABLE_BANDWIDTH);
+}
+
+/*! \brief Whether the scan is limited to the current capture window. */
+bool BandScanner::singleWindow(void) const
+{
+    return channels.isEmpty() && range_start >= range_stop;
+}
+
+/*! \brief Lower and upper edge of the usable part of the capture window. */
+void BandScanner::windowLimits(qint64 &lo, qint64 &hi) const
+{
+    qint64  span = windowSpan();
+
+    lo = center_freq - span / 2;
+    hi = center_freq + span / 2;
+}
+
+/*! \brief Find the first active channel of a sorted list within [lo, hi]. */
+bool BandScanner::findListed(const QVector<qint64> &list, qint64 lo, qint64 hi,
+                             qint64 &channel) const
+{
+    QVector<qint64>::const_iterator it;
+
+    for (it = std::lower_bound(list.begin(), list.end(), lo);
+         it != list.end() && *it <= hi; ++it)
+    {
+        if (channelActive(*it))
+        {
+            channel = *it;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/*! \brief Find the first active channel above a frequency in the window.
+ *  \param after Frequency of the previous channel or 0 to start from the edge.
+ *  \param channel The frequency of the active channel.
+ *  \return True if an active channel was found.
+ */
+bool BandScanner::findChannel(qint64 after, qint64 &channel) const
+{
+    qint64  lo, hi;
+    qint64  base;
+    qint64  freq;
+
+    windowLimits(lo, hi);
+    base = range_start < range_stop ? range_start : lo;
+
+    if (range_start < range_stop)
+    {
+        lo = std::max(lo, range_start);
+        hi = std::min(hi, range_stop);
+    }
+    lo = std::max(lo, after + 1);
+
+    if (!channels.isEmpty())
+        return findListed(channels, lo, hi, channel);
+
+    // first channel on the grid at or above lo
+    freq = base + ((lo - base + step - 1) / step) * step;
+    if (lo < base)
+        freq = base;
+
+    for (; freq <= hi; freq += step)
+    {
+        if (channelActive(freq))
+        {
+            channel = freq;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/*! \brief Find an active priority channel in the window.
+ *
+ * Priority channels are checked regardless of the scan range.
+ */
+bool BandScanner::findPriority(qint64 &channel) const
+{
+    qint64  lo, hi;
+
+    if (priority.isEmpty())
+        return false;
+
+    windowLimits(lo, hi);
+
+    return findListed(priority, lo, hi, channel);
+}
+
+/*! \brief Receive an active channel within the current window. */
+void BandScanner::parkChannel(qint64 channel, bool is_priority)
+{
+    qint64  now = clock.elapsed();
+
+    last_channel = channel;
+    park_time = now;
+    active_time = now;
+    parked_priority = is_priority;
+    state = SCAN_PARKED;
+
+    emit newChannel(channel, channel - center_freq);
+}
+
+/*! \brief Retune the hardware to a new capture window. */
+void BandScanner::retune(qint64 freq)
+{
+    emit newCenterFrequency(freq);
+
+    // in case nobody retuned us
+    center_freq = freq;
+    settle_time = clock.elapsed();
+    last_channel = 0;
+    state = SCAN_SETTLE;
+}
+
+/*! \brief Center frequency of a window starting at a listed channel. */
+qint64 BandScanner::windowFrom(qint64 freq) const
+{
+    return freq + std::max<qint64>(windowSpan() / 2 - step, 0);
+}
+
+/*! \brief Retune to the next capture window within the range. */
+void BandScanner::nextWindow(void)
+{
+    qint64  span = windowSpan();
+    qint64  next;
+
+    if (span <= 0)
+        return;
+
+    if (!channels.isEmpty())
+    {
+        // skip to the next window containing listed channels
+        qint64  lo = std::numeric_limits<qint64>::min();
+        qint64  hi = std::numeric_limits<qint64>::max();
+        QVector<qint64>::const_iterator it;
+
+        if (range_start < range_stop)
+        {
+            lo = range_start;
+            hi = range_stop;
+        }
+
+        it = std::upper_bound(channels.begin(), channels.end(), center_freq + span / 2);
+        if (it != channels.end() && *it < lo)
+            it = std::lower_bound(channels.begin(), channels.end(), lo);
+        if (it == channels.end() || *it > hi)
+            it = std::lower_bound(channels.begin(), channels.end(), lo);
+        if (it == channels.end() || *it > hi)
+            return;
+
+        next = windowFrom(*it);
+    }
+    else if (center_freq - span / 2 < range_start || center_freq + span / 2 >= range_stop)
+    {
+        next = range_start + span / 2;
+    }
+    else
+    {
+        next = center_freq + span;
+    }
+
+    retune(next);
+}
+
+/*! \brief Retune to the next window containing priority channels.
+ *  \return False if all priority channels have been visited.
+ */
+bool BandScanner::nextPriorityWindow(void)
+{
+    qint64  span = windowSpan();
+    qint64  next;
+
+    if (span <= 0 || priority_next >= priority.size())
+        return false;
+
+    next = windowFrom(priority[priority_next]);
+
+    // all priority channels within this window are checked from one FFT
+    priority_next = std::upper_bound(priority.begin() + priority_next,
+                                     priority.end(), next + span / 2) - priority.begin();
+
+    retune(next);
+
+    return true;
+}
@@ -0,0 +1,186 @@
+/* -*- c++ -*- */
+/*
+ * Gqrx SDR: Software defined radio receiver powered by GNU Radio and Qt
+ *           http://gqrx.dk/
+ *
+ * Copyright 2020 Vadym Ostanin.
+ *
+ * Gqrx is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * Gqrx is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Gqrx; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifndef BAND_SCANNER_H
+#define BAND_SCANNER_H
+
+#include <complex>
+#include <vector>
+#include <QElapsedTimer>
+#include <QObject>
+#include <QSettings>
+#include <QTimer>
+#include <QVector>
+
+#include "applications/gqrx/receiver.h"
+
+/*! \brief Band scanner using the I/Q FFT to find active channels.
+ *
+ * Instead of tuning to every channel and waiting for the signal meter, the
+ * scanner measures the power of all channels within the current I/Q bandwidth
+ * from a single FFT of the I/Q stream. The hardware is only retuned when all
+ * channels in the current capture window are quiet and the scanner moves to
+ * the next window. Active channels are received by moving the channel filter
+ * offset, which does not require retuning.
+ *
+ * The scanner stays on an active channel for at least the dwell time and
+ * until the channel has been quiet for the hang time.
+ *
+ * By default the scanner checks channels on a regular grid. Alternatively a
+ * sorted channel list, e.g. the active bookmarks, can be scanned. In that
+ * case only capture windows containing listed channels are visited and all
+ * listed channels within a window are checked using the same FFT. Priority
+ * channels are revisited every few capture windows and take over from
+ * normal channels active in the same window.
+ *
+ * All frequencies include the LNB LO, i.e. they are the frequencies shown to
+ * the user. The scanner does not tune the receiver itself; it emits
+ * newCenterFrequency() and newChannel() which are handled by the application.
+ */
+class BandScanner : public QObject
+{
+    Q_OBJECT
+public:
+    explicit BandScanner(receiver *rx, QObject *parent = 0);
+    ~BandScanner();
+
+    void readSettings(QSettings *settings);
+    void saveSettings(QSettings *settings) const;
+
+    bool isRunning(void) const
+    {
+        return scan_timer.isActive();
+    }
+
+    void setRange(qint64 start_hz, qint64 stop_hz);
+    qint64 getStart(void) const
+    {
+        return range_start;
+    }
+    qint64 getStop(void) const
+    {
+        return range_stop;
+    }
+
+    void setStep(int step_hz);
+    void setThreshold(double threshold_db);
+    void setDwell(int dwell_ms);
+    void setHang(int hang_ms);
+    void setPriorityInterval(int windows);
+
+    void setChannelList(const QVector<qint64> &channels,
+                        const QVector<qint64> &priority);
+    void setUseBookmarks(bool enabled)
+    {
+        use_bookmarks = enabled;
+    }
+    bool getUseBookmarks(void) const
+    {
+        return use_bookmarks;
+    }
+    QString getPriorityTag(void) const
+    {
+        return priority_tag;
+    }
+
+public slots:
+    void start(void);
+    void stop(void);
+    void setCenterFrequency(qint64 freq);
+
+signals:
+    /*! \brief Tune the hardware to a new capture window. */
+    void newCenterFrequency(qint64 freq);
+
+    /*! \brief Park the demodulator on a channel within the capture window. */
+    void newChannel(qint64 freq, qint64 offset);
+
+    /*! \brief The scanner was started or stopped. */
+    void scannerStatusChanged(bool running);
+
+private slots:
+    void scanTimeout(void);
+
+private:
+    enum scan_state {
+        SCAN_SETTLE,    /*!< Waiting for the new capture window. */
+        SCAN_SEARCH,    /*!< Looking for active channels. */
+        SCAN_PARKED     /*!< Receiving an active channel. */
+    };
+
+    receiver       *rx;
+    QTimer          scan_timer;
+    QElapsedTimer   clock;
+
+    qint64          range_start;    /*!< Lower edge of the scan range. */
+    qint64          range_stop;     /*!< Upper edge of the scan range. */
+    int             step;           /*!< Channel spacing. */
+    double          threshold;      /*!< Activity threshold above noise floor in dB. */
+    int             dwell_ms;       /*!< Minimum time on an active channel. */
+    int             hang_ms;        /*!< Time on a quiet channel before moving on. */
+    int             settle_ms;      /*!< Time to wait after retuning. */
+    int             priority_interval; /*!< Capture windows between priority passes. */
+
+    bool            use_bookmarks;  /*!< Scan bookmarks instead of a grid. */
+    QString         priority_tag;   /*!< Bookmark tag of priority channels. */
+    QVector<qint64> channels;       /*!< Sorted channel list or empty for grid. */
+    QVector<qint64> priority;       /*!< Sorted priority channels. */
+
+    scan_state      state;
+    qint64          center_freq;    /*!< Center of the current capture window. */
+    qint64          last_channel;   /*!< Last channel visited in this window. */
+    qint64          park_time;      /*!< Time when the current channel was parked. */
+    qint64          active_time;    /*!< Last time the parked channel was active. */
+    qint64          settle_time;    /*!< Time when the last retune happened. */
+    bool            parked_priority; /*!< Parked on a priority channel. */
+    bool            priority_pass;  /*!< Visiting priority channels. */
+    int             priority_next;  /*!< Next priority channel to visit. */
+    int             window_count;   /*!< Windows since the last priority pass. */
+    qint64          resume_freq;    /*!< Center frequency to resume from. */
+
+    std::vector<std::complex<float> > fft_data;
+    std::vector<float> fft_pwr;     /*!< Power spectrum, DC in the middle. */
+    std::vector<float> fft_sorted;  /*!< Scratch buffer for the noise floor. */
+    unsigned int    fft_size;
+    double          fft_center;     /*!< Center of the spectrum relative to center_freq. */
+    double          fft_rate;       /*!< Bandwidth of the spectrum. */
+    unsigned long   fft_count;      /*!< Count of the last spectrum used. */
+    float           noise_floor;    /*!< Median bin power in the current window. */
+
+    bool    updateSpectrum(void);
+    float   channelLevel(qint64 freq) const;
+    bool    channelActive(qint64 freq) const;
+    qint64  windowSpan(void) const;
+    bool    singleWindow(void) const;
+    void    windowLimits(qint64 &lo, qint64 &hi) const;
+    bool    findListed(const QVector<qint64> &list, qint64 lo, qint64 hi,
+                       qint64 &channel) const;
+    bool    findChannel(qint64 after, qint64 &channel) const;
+    bool    findPriority(qint64 &channel) const;
+    void    parkChannel(qint64 channel, bool is_priority);
+    void    retune(qint64 freq);
+    qint64  windowFrom(qint64 freq) const;
+    void    nextWindow(void);
+    bool    nextPriorityWindow(void);
+};
+
+#endif // BAND_SCANNER_H
@@ -0,0 +1,45 @@
+/* -*- c++ -*- */
+/*
+ * Gqrx SDR: Software defined radio receiver powered by GNU Radio and Qt
+ *           http://gqrx.dk/
+ *
+ * Copyright 2020 Vadym Ostanin.
+ *
+ * Gqrx is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * Gqrx is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Gqrx; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifndef BLOCK_STATS_H
+#define BLOCK_STATS_H
+
+#include <string>
+#include <vector>
+
+/*! \brief Runtime statistics of a single GNU Radio block. */
+typedef struct
+{
+    std::string name;        /*!< Block alias, e.g. fir_filter_ccc3. */
+    double      load;        /*!< Share of one CPU core spent in work(), -1 if unknown. */
+    double      rate;        /*!< Items produced per second (consumed for sinks). */
+    float       buffer_full; /*!< Fullest input buffer in the range 0..1. */
+} block_stats_t;
+
+/*! \brief A vector with block statistics.
+ *
+ * This data structure is used for transfering the performance
+ * counters of the flow graph to the user interface.
+ */
+typedef std::vector<block_stats_t> block_stats_list_t;
+
+#endif // BLOCK_STATS_H
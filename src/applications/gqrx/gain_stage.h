@@ -0,0 +1,46 @@
+/* -*- c++ -*- */
+/*
+ * Gqrx SDR: Software defined radio receiver powered by GNU Radio and Qt
+ *           http://gqrx.dk/
+ *
+ * Copyright 2020 Vadym Ostanin.
+ *
+ * Gqrx is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * Gqrx is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Gqrx; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifndef GAIN_STAGE_H
+#define GAIN_STAGE_H
+
+#include <string>
+#include <vector>
+
+/*! \brief Structure describing a gain parameter with its range. */
+typedef struct
+{
+    std::string name;   /*!< The name of this gain stage. */
+    double      value;  /*!< Initial value. */
+    double      start;  /*!< The lower limit. */
+    double      stop;   /*!< The uppewr limit. */
+    double      step;   /*!< The resolution/step. */
+} gain_t;
+
+/*! \brief A vector with gain parameters.
+ *
+ * This data structure is used for transfering
+ * information about available gain stages.
+ */
+typedef std::vector<gain_t> gain_list_t;
+
+#endif // GAIN_STAGE_H
@@ -0,0 +1,716 @@
+/* -*- c++ -*- */
+/*
+ * Gqrx SDR: Software defined radio receiver powered by GNU Radio and Qt
+ *           http://gqrx.dk/
+ *
+ * Copyright 2020 Vadym Ostanin.
+ *
+ * Gqrx is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * Gqrx is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Gqrx; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#include <iostream>
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QFileInfo>
+#include <QMap>
+#include <QVariant>
+
+#include "applications/gqrx/headless.h"
+
+/* Mode indices used in the configuration file and by the remote control,
+ * see DockRxOpt::rxopt_mode_idx. */
+enum {
+    MODE_OFF        = 0,
+    MODE_RAW        = 1,
+    MODE_AM         = 2,
+    MODE_NFM        = 3,
+    MODE_WFM_MONO   = 4,
+    MODE_WFM_STEREO = 5,
+    MODE_LSB        = 6,
+    MODE_USB        = 7,
+    MODE_CWL        = 8,
+    MODE_CWU        = 9,
+    MODE_WFM_STEREO_OIRT = 10,
+    MODE_LAST       = 11
+};
+
+/* Mode names used in the names of squelch triggered recordings. */
+static const char *mode_name_table[MODE_LAST] =
+{
+    "DemodOff", "RawIQ", "AM", "NarrowFM", "WFMmono", "WFMstereo",
+    "LSB", "USB", "CWL", "CWU", "WFMoirt"
+};
+
+/* The "normal" filter presets of DockRxOpt. */
+static const int filter_preset_table[MODE_LAST][2] =
+{
+    {      0,      0},  // MODE_OFF
+    {  -5000,   5000},  // MODE_RAW
+    {  -5000,   5000},  // MODE_AM
+    {  -5000,   5000},  // MODE_NFM
+    { -80000,  80000},  // MODE_WFM_MONO
+    { -80000,  80000},  // MODE_WFM_STEREO
+    {  -2800,   -100},  // MODE_LSB
+    {    100,   2800},  // MODE_USB
+    {   -250,    250},  // MODE_CWL
+    {   -250,    250},  // MODE_CWU
+    { -80000,  80000}   // MODE_WFM_STEREO_OIRT
+};
+
+HeadlessReceiver::HeadlessReceiver(QObject *parent) :
+    QObject(parent),
+    m_settings(0),
+    d_lnb_lo(0),
+    d_hw_freq(0),
+    d_rx_freq(144500000),
+    d_mode(MODE_OFF),
+    d_filter_lo(0),
+    d_filter_hi(0),
+    d_cw_offset(700),
+    d_fm_maxdev(2500.0),
+    d_fm_deemph(75.0e-6),
+    d_sql_level(-150.0),
+    d_rec_dir(QDir::homePath()),
+    d_rec_sql(false),
+    d_rec_preroll(500),
+    d_rec_hang(2000),
+    d_offline_rate(0.0),
+    d_offline_freq(0)
+{
+    rx = new receiver("", "", 1);
+    rx->set_rf_freq(144500000.0f);
+
+    remote = new RemoteControl();
+    remote->setLevelHistory(rx->get_level_history());
+    packet_decoder = new PacketDecoder(rx);
+    scanner = new BandScanner(rx);
+
+    meter_timer = new QTimer(this);
+    connect(meter_timer, SIGNAL(timeout()), this, SLOT(meterTimeout()));
+
+    dsp_load_timer = new QTimer(this);
+    connect(dsp_load_timer, SIGNAL(timeout()), this, SLOT(dspLoadTimeout()));
+
+    connect(remote, SIGNAL(newFrequency(qint64)), this, SLOT(setNewFrequency(qint64)));
+    connect(remote, SIGNAL(newFilterOffset(qint64)), this, SLOT(setFilterOffset(qint64)));
+    connect(remote, SIGNAL(newLnbLo(double)), this, SLOT(setLnbLo(double)));
+    connect(remote, SIGNAL(newMode(int)), this, SLOT(selectDemod(int)));
+    connect(remote, SIGNAL(newPassband(int)), this, SLOT(setPassband(int)));
+    connect(remote, SIGNAL(newSquelchLevel(double)), this, SLOT(setSqlLevel(double)));
+    connect(remote, SIGNAL(gainChanged(QString, double)), this, SLOT(setGain(QString, double)));
+    connect(remote, SIGNAL(startAudioRecorderEvent()), this, SLOT(startAudioRec()));
+    connect(remote, SIGNAL(stopAudioRecorderEvent()), this, SLOT(stopAudioRec()));
+    connect(remote, SIGNAL(startScannerEvent()), scanner, SLOT(start()));
+    connect(remote, SIGNAL(stopScannerEvent()), scanner, SLOT(stop()));
+    connect(scanner, SIGNAL(scannerStatusChanged(bool)), remote, SLOT(setScannerStatus(bool)));
+    connect(scanner, SIGNAL(newCenterFrequency(qint64)), this, SLOT(setScannerCenterFreq(qint64)));
+    connect(scanner, SIGNAL(newChannel(qint64, qint64)), this, SLOT(setScannerChannel(qint64, qint64)));
+}
+
+HeadlessReceiver::~HeadlessReceiver()
+{
+    meter_timer->stop();
+    dsp_load_timer->stop();
+    remote->stop_server();
+    rx->stop();
+
+    delete packet_decoder;
+    delete scanner;
+    delete remote;
+    delete rx;
+    delete m_settings;
+}
+
+/**
+ * @brief Load configuration file.
+ * @param cfgfile Path to the configuration file.
+ * @return True if the input device could be opened.
+ *
+ * Uses the same keys as MainWindow::loadConfig() and the dock widgets. All
+ * flowgraph changes are applied in one reconfiguration.
+ */
+bool HeadlessReceiver::loadConfig(const QString &cfgfile)
+{
+    double      actual_rate;
+    qint64      int64_val;
+    int         int_val;
+    double      dbl_val;
+    bool        conv_ok;
+    bool        conf_ok = false;
+
+    qDebug() << "Loading configuration from:" << cfgfile;
+
+    delete m_settings;
+    m_settings = new QSettings(cfgfile, QSettings::IniFormat);
+
+    rx->begin_reconf();
+
+    QString indev = m_settings->value("input/device", "").toString();
+    if (!d_offline_file.isEmpty())
+        indev = QString("file='%1',rate=%2,throttle=false,repeat=false")
+                .arg(d_offline_file).arg((qint64) d_offline_rate);
+    if (!indev.isEmpty())
+    {
+        try
+        {
+            rx->set_input_device(indev.toStdString());
+            conf_ok = true;
+        }
+        catch (std::runtime_error &x)
+        {
+            std::cerr << "Failed to set input device: " << x.what() << std::endl;
+        }
+
+        if (indev.contains("rtl", Qt::CaseInsensitive)
+                && !m_settings->contains("input/gains"))
+            updateGainStages(false);
+        else
+            updateGainStages(true);
+    }
+
+    QString outdev = m_settings->value("output/device", "").toString();
+    rx->set_output_device(outdev.toStdString());
+
+    int_val = m_settings->value("input/sample_rate", 0).toInt(&conv_ok);
+    if (!d_offline_file.isEmpty())
+    {
+        int_val = (int) d_offline_rate;
+        conv_ok = true;
+    }
+    if (conv_ok && (int_val > 0))
+    {
+        actual_rate = rx->set_input_rate(int_val);
+        if (actual_rate == 0)
+        {
+            std::cerr << "There was an error configuring the input device."
+                      << std::endl;
+            actual_rate = int_val;
+        }
+    }
+    else
+        actual_rate = rx->get_input_rate();
+
+    int_val = m_settings->value("input/decim_engine", 0).toInt(&conv_ok);
+    if (conv_ok && int_val == receiver::DECIM_ENGINE_HBF)
+        rx->set_input_decim_engine(receiver::DECIM_ENGINE_HBF);
+    else
+        rx->set_input_decim_engine(receiver::DECIM_ENGINE_FIR);
+
+    int_val = m_settings->value("input/decimation", 1).toInt(&conv_ok);
+    if (conv_ok && int_val >= 2)
+    {
+        if (rx->set_input_decim(int_val) != (unsigned int)int_val)
+            std::cerr << "Failed to set decimation " << int_val << std::endl;
+    }
+    else
+        rx->set_input_decim(1);
+
+    remote->setBandwidth((qint64)(actual_rate / rx->get_input_decim()));
+
+    int64_val = m_settings->value("input/bandwidth", 0).toInt(&conv_ok);
+    if (conv_ok)
+        rx->set_analog_bandwidth((double) int64_val);
+
+    // input settings, see DockInputCtl::readSettings()
+    int64_val = m_settings->value("input/corr_freq", 0).toLongLong(&conv_ok);
+    rx->set_freq_corr(((double)int64_val) / 1.0e6);
+    rx->set_iq_swap(m_settings->value("input/swap_iq", false).toBool());
+    rx->set_dc_cancel(m_settings->value("input/dc_cancel", false).toBool());
+    rx->set_iq_balance(m_settings->value("input/iq_balance", false).toBool());
+    rx->set_antenna(m_settings->value("input/antenna", "").toString().toStdString());
+
+    int64_val = m_settings->value("input/lnb_lo", 0).toLongLong(&conv_ok);
+    if (conv_ok)
+        d_lnb_lo = int64_val;
+    remote->setLnbLo(d_lnb_lo / 1.0e6);
+
+    if (m_settings->contains("input/gains"))
+    {
+        // stored as integer dB*10
+        QMap<QString, QVariant> allgains = m_settings->value("input/gains").toMap();
+        QMapIterator<QString, QVariant> gain_iter(allgains);
+
+        while (gain_iter.hasNext())
+        {
+            gain_iter.next();
+            rx->set_gain(gain_iter.key().toStdString(),
+                         0.1 * (double)(gain_iter.value().toInt()));
+        }
+        updateGainStages(true);
+    }
+    rx->set_auto_gain(m_settings->value("input/hwagc", false).toBool());
+
+    // receiver settings, see DockRxOpt::readSettings()
+    int_val = m_settings->value("receiver/cwoffset", 700).toInt(&conv_ok);
+    if (conv_ok)
+        d_cw_offset = int_val;
+
+    int_val = m_settings->value("receiver/fm_maxdev", 2500).toInt(&conv_ok);
+    if (conv_ok)
+        d_fm_maxdev = int_val;
+
+    dbl_val = m_settings->value("receiver/fm_deemph", 75).toDouble(&conv_ok);
+    if (conv_ok && dbl_val >= 0)
+        d_fm_deemph = 1.0e-6 * dbl_val;
+
+    int64_val = m_settings->value("receiver/offset", 0).toInt(&conv_ok);
+    rx->set_filter_offset((double) int64_val);
+    remote->setFilterOffset(int64_val);
+
+    dbl_val = m_settings->value("receiver/sql_level", 1.0).toDouble(&conv_ok);
+    if (conv_ok && dbl_val < 1.0)
+        d_sql_level = dbl_val;
+
+    rx->set_agc_on(!m_settings->value("receiver/agc_off", false).toBool());
+    rx->set_agc_hang(m_settings->value("receiver/agc_usehang", false).toBool());
+    rx->set_agc_threshold(m_settings->value("receiver/agc_threshold", -100).toInt());
+    rx->set_agc_decay(m_settings->value("receiver/agc_decay", 500).toInt());
+    rx->set_agc_slope(m_settings->value("receiver/agc_slope", 0).toInt());
+    rx->set_agc_manual_gain(m_settings->value("receiver/agc_gain", 0).toInt());
+
+    selectDemod(m_settings->value("receiver/demod", MODE_AM).toInt());
+
+    // audio settings, see DockAudio::readSettings()
+    int_val = m_settings->value("audio/gain", -60).toInt(&conv_ok);
+    if (conv_ok)
+        rx->set_af_gain(0.1f * int_val);
+    d_rec_dir = m_settings->value("audio/rec_dir", QDir::homePath()).toString();
+    d_rec_sql = m_settings->value("audio/rec_squelch", false).toBool();
+    int_val = m_settings->value("audio/rec_preroll", 500).toInt(&conv_ok);
+    if (conv_ok && int_val >= 0)
+        d_rec_preroll = int_val;
+    int_val = m_settings->value("audio/rec_hang", 2000).toInt(&conv_ok);
+    if (conv_ok && int_val >= 0)
+        d_rec_hang = int_val;
+
+    int64_val = m_settings->value("input/frequency", 14236000).toLongLong(&conv_ok);
+    if (d_offline_freq > 0)
+        int64_val = d_offline_freq + d_lnb_lo + (qint64) rx->get_filter_offset();
+    setNewFrequency(int64_val);
+
+    {
+        int flo = m_settings->value("receiver/filter_low_cut", 0).toInt(&conv_ok);
+        int fhi = m_settings->value("receiver/filter_high_cut", 0).toInt(&conv_ok);
+
+        if (conv_ok && flo != fhi)
+        {
+            d_filter_lo = flo;
+            d_filter_hi = fhi;
+            rx->set_filter((double)flo, (double)fhi, receiver::FILTER_SHAPE_NORMAL);
+            remote->setPassband(flo, fhi);
+        }
+    }
+
+    int_val = m_settings->value("receiver/level_history_ms", 100).toInt(&conv_ok);
+    if (conv_ok && int_val > 0)
+        rx->set_level_history_interval(1.0e-3 * int_val);
+
+    rx->commit_reconf();
+
+    remote->readSettings(m_settings);
+    if (m_settings->value("remote_control/enabled", false).toBool() &&
+        d_offline_file.isEmpty())
+        remote->start_server();
+
+    packet_decoder->readSettings(m_settings);
+    scanner->readSettings(m_settings);
+
+    return conf_ok;
+}
+
+/** Start the receiver. */
+void HeadlessReceiver::start(void)
+{
+    rx->start();
+    remote->setReceiverStatus(true);
+    meter_timer->start(100);
+    dsp_load_timer->start(1000);
+}
+
+/** Stop the receiver. */
+void HeadlessReceiver::stop(void)
+{
+    meter_timer->stop();
+    dsp_load_timer->stop();
+    scanner->stop();
+    remote->setReceiverStatus(false);
+    rx->stop();
+}
+
+/**
+ * @brief Use an I/Q file instead of the configured input device.
+ * @param filename The I/Q file, complex float samples.
+ * @param sample_rate The sample rate of the file.
+ * @param center_freq The center frequency of the file or 0 to use the
+ *                    frequency from the configuration.
+ * @param start_time The capture time of the file in seconds since the epoch
+ *                   or 0 if not known; used for the time stamps of the output.
+ *
+ * Must be called before loadConfig(). The audio output is disconnected from
+ * the sound card and the file is read without throttling, so the receiver
+ * runs as fast as the CPU allows. The receiver settings, including the
+ * filter offset within the file, are taken from the configuration.
+ */
+void HeadlessReceiver::setOfflineInput(const QString &filename,
+                                       double sample_rate, qint64 center_freq,
+                                       double start_time)
+{
+    d_offline_file = filename;
+    d_offline_rate = sample_rate;
+    d_offline_freq = center_freq;
+    rx->set_offline(true, start_time);
+}
+
+/**
+ * @brief Start offline processing.
+ * @param outdir The directory where the audio is saved.
+ * @return True if processing has started.
+ *
+ * The demodulated audio is saved to <outdir>/<file name>.wav, or as one file
+ * per transmission if squelch triggered recording is enabled in the
+ * configuration. The recorders are connected before the flow graph starts,
+ * so the output does not depend on timing.
+ */
+bool HeadlessReceiver::startOffline(const QString &outdir)
+{
+    if (d_mode != MODE_OFF)
+    {
+        receiver::status err;
+
+        if (d_rec_sql)
+        {
+            err = rx->start_sql_recording(outdir.toStdString(), d_rec_preroll,
+                                          d_rec_hang);
+        }
+        else
+        {
+            QString path = QString("%1/%2.wav").arg(outdir)
+                    .arg(QFileInfo(d_offline_file).completeBaseName());
+
+            err = rx->start_audio_recording(path.toStdString());
+        }
+
+        if (err != receiver::STATUS_OK)
+            return false;
+    }
+
+    d_offline_timer.start();
+    rx->start_offline();
+
+    return true;
+}
+
+/** Stop offline processing and print the processing speed. */
+void HeadlessReceiver::stopOffline(void)
+{
+    double  elapsed = 1.e-3 * d_offline_timer.elapsed();
+    qint64  samples = QFileInfo(d_offline_file).size() / (2 * sizeof(float));
+    bool    finished = rx->is_finished();
+
+    rx->stop();
+    rx->stop_audio_recording();
+
+    if (!finished)
+    {
+        std::cout << "Processing interrupted after " << elapsed << " s"
+                  << std::endl;
+        return;
+    }
+
+    if (elapsed > 0.0)
+        std::cout << "Processed " << samples << " samples in " << elapsed
+                  << " s: " << 1.e-6 * samples / elapsed << " Msps, "
+                  << samples / d_offline_rate / elapsed << " x realtime"
+                  << std::endl;
+}
+
+/**
+ * @brief Set new receive frequency.
+ * @param rx_freq The frequency in Hz including LNB LO and filter offset.
+ */
+void HeadlessReceiver::setNewFrequency(qint64 rx_freq)
+{
+    double hw_freq = (double)(rx_freq - d_lnb_lo) - rx->get_filter_offset();
+    qint64 center_freq = rx_freq - (qint64)rx->get_filter_offset();
+
+    d_rx_freq = rx_freq;
+    d_hw_freq = (qint64)hw_freq;
+    rx->set_rf_freq(hw_freq);
+
+    remote->setNewFrequency(rx_freq);
+    packet_decoder->setCenterFrequency(center_freq);
+    scanner->setCenterFrequency(center_freq);
+    updateAudioRecLabel();
+}
+
+/** Set new channel filter offset. */
+void HeadlessReceiver::setFilterOffset(qint64 freq_hz)
+{
+    rx->set_filter_offset((double) freq_hz);
+
+    d_rx_freq = d_hw_freq + d_lnb_lo + freq_hz;
+    remote->setNewFrequency(d_rx_freq);
+    updateAudioRecLabel();
+
+    if (rx->is_rds_decoder_active())
+        rx->reset_rds_parser();
+}
+
+/** Set new LNB LO frequency. */
+void HeadlessReceiver::setLnbLo(double freq_mhz)
+{
+    qint64 rf_freq = d_rx_freq - d_lnb_lo;
+
+    d_lnb_lo = qint64(freq_mhz*1e6);
+    d_rx_freq = d_lnb_lo + rf_freq;
+
+    remote->setNewFrequency(d_rx_freq);
+    updateAudioRecLabel();
+    packet_decoder->setCenterFrequency(d_lnb_lo + d_hw_freq);
+    scanner->setCenterFrequency(d_lnb_lo + d_hw_freq);
+}
+
+/**
+ * @brief Select new demodulator.
+ * @param mode_idx The mode index as used by DockRxOpt and the remote control.
+ *
+ * Same mapping as MainWindow::selectDemod() using the normal filter preset.
+ */
+void HeadlessReceiver::selectDemod(int mode_idx)
+{
+    double  cwofs = 0.0;
+
+    if (mode_idx < MODE_OFF || mode_idx >= MODE_LAST)
+    {
+        qDebug() << "Invalid mode index:" << mode_idx;
+        mode_idx = MODE_OFF;
+    }
+
+    switch (mode_idx)
+    {
+    case MODE_OFF:
+        if (rx->is_recording_audio())
+            stopAudioRec();
+        rx->set_demod(receiver::RX_DEMOD_OFF);
+        break;
+
+    case MODE_RAW:
+        rx->set_demod(receiver::RX_DEMOD_NONE);
+        break;
+
+    case MODE_AM:
+        rx->set_demod(receiver::RX_DEMOD_AM);
+        break;
+
+    case MODE_NFM:
+        rx->set_demod(receiver::RX_DEMOD_NFM);
+        rx->set_fm_maxdev(d_fm_maxdev);
+        rx->set_fm_deemph(d_fm_deemph);
+        break;
+
+    case MODE_WFM_MONO:
+        rx->set_demod(receiver::RX_DEMOD_WFM_M);
+        break;
+
+    case MODE_WFM_STEREO:
+        rx->set_demod(receiver::RX_DEMOD_WFM_S);
+        break;
+
+    case MODE_WFM_STEREO_OIRT:
+        rx->set_demod(receiver::RX_DEMOD_WFM_S_OIRT);
+        break;
+
+    case MODE_LSB:
+    case MODE_USB:
+        rx->set_demod(receiver::RX_DEMOD_SSB);
+        break;
+
+    case MODE_CWL:
+        rx->set_demod(receiver::RX_DEMOD_SSB);
+        cwofs = -d_cw_offset;
+        break;
+
+    case MODE_CWU:
+        rx->set_demod(receiver::RX_DEMOD_SSB);
+        cwofs = d_cw_offset;
+        break;
+    }
+
+    d_mode = mode_idx;
+    d_filter_lo = filter_preset_table[mode_idx][0];
+    d_filter_hi = filter_preset_table[mode_idx][1];
+
+    rx->set_filter((double)d_filter_lo, (double)d_filter_hi,
+                   receiver::FILTER_SHAPE_NORMAL);
+    rx->set_cw_offset(cwofs);
+    rx->set_sql_level(d_sql_level);
+
+    remote->setMode(mode_idx);
+    remote->setPassband(d_filter_lo, d_filter_hi);
+    updateAudioRecLabel();
+}
+
+/** Set new filter width keeping the filter symmetry of the current mode. */
+void HeadlessReceiver::setPassband(int bandwidth)
+{
+    int lo = filter_preset_table[d_mode][0];
+    int hi = filter_preset_table[d_mode][1];
+
+    if (lo + hi == 0)
+    {
+        lo = -bandwidth / 2;
+        hi =  bandwidth / 2;
+    }
+    else if (lo >= 0 && hi >= 0)
+    {
+        hi = lo + bandwidth;
+    }
+    else if (lo <= 0 && hi <= 0)
+    {
+        lo = hi - bandwidth;
+    }
+
+    d_filter_lo = lo;
+    d_filter_hi = hi;
+    rx->set_filter((double)lo, (double)hi, receiver::FILTER_SHAPE_NORMAL);
+    remote->setPassband(lo, hi);
+}
+
+/** Set new squelch level. */
+void HeadlessReceiver::setSqlLevel(double level_db)
+{
+    d_sql_level = level_db;
+    rx->set_sql_level(level_db);
+    remote->setSquelchLevel(level_db);
+}
+
+/** Set new gain of a gain stage. */
+void HeadlessReceiver::setGain(QString name, double gain)
+{
+    rx->set_gain(name.toStdString(), gain);
+}
+
+/** Start audio recorder using the same file names as DockAudio. */
+void HeadlessReceiver::startAudioRec(void)
+{
+    if (d_mode == MODE_OFF)
+    {
+        std::cerr << "Recording audio requires a demodulator." << std::endl;
+        return;
+    }
+
+    if (d_rec_sql)
+    {
+        if (rx->start_sql_recording(d_rec_dir.toStdString(), d_rec_preroll, d_rec_hang))
+            remote->stopAudioRecorder();
+        else
+            remote->startAudioRecorder(d_rec_dir);
+        return;
+    }
+
+    QString file_name = QDateTime::currentDateTime().toUTC().toString("gqrx_yyyyMMdd_hhmmss");
+    QString path = QString("%1/%2_%3.wav").arg(d_rec_dir).arg(file_name).arg(d_rx_freq);
+
+    if (rx->start_audio_recording(path.toStdString()))
+        remote->stopAudioRecorder();
+    else
+        remote->startAudioRecorder(path);
+}
+
+/** Stop audio recorder. */
+void HeadlessReceiver::stopAudioRec(void)
+{
+    rx->stop_audio_recording();
+    remote->stopAudioRecorder();
+}
+
+/**
+ * Update frequency and mode used in the names of squelch triggered recordings
+ * and the frequency sent in the header of framed UDP audio packets.
+ */
+void HeadlessReceiver::updateAudioRecLabel(void)
+{
+    rx->set_audio_rec_label(QString("%1_%2").arg(d_rx_freq)
+                                            .arg(mode_name_table[d_mode])
+                                            .toStdString());
+    rx->set_udp_stream_freq(d_rx_freq);
+}
+
+/** Signal strength meter timeout. */
+void HeadlessReceiver::meterTimeout(void)
+{
+    remote->setSignalLevel(rx->get_signal_pwr(true));
+}
+
+/** Update the flow graph statistics reported by the remote control. */
+void HeadlessReceiver::dspLoadTimeout(void)
+{
+    block_stats_list_t stats;
+    uint64_t        samples, lost;
+    unsigned long   gaps;
+    double          last_gap;
+    unsigned long   reconf_count;
+    double          reconf_ms;
+
+    rx->get_block_stats(stats);
+    rx->get_input_stats(samples, lost, gaps, last_gap);
+    rx->get_reconf_stats(reconf_count, reconf_ms);
+    remote->setBlockStats(stats);
+    remote->setInputStats(samples, lost, gaps, last_gap);
+    remote->setReconfStats(reconf_count, reconf_ms);
+}
+
+/** Band scanner moved to a new capture window. */
+void HeadlessReceiver::setScannerCenterFreq(qint64 center_freq)
+{
+    setNewFrequency(center_freq + (qint64)rx->get_filter_offset());
+}
+
+/** Band scanner found an active channel within the capture window. */
+void HeadlessReceiver::setScannerChannel(qint64 freq, qint64 offset)
+{
+    Q_UNUSED(freq);
+
+    setFilterOffset(offset);
+    remote->setFilterOffset(offset);
+}
+
+/** Read gain stages from the device and pass them to the remote control. */
+void HeadlessReceiver::updateGainStages(bool read_from_device)
+{
+    gain_list_t gain_list;
+    std::vector<std::string> gain_names = rx->get_gain_names();
+    gain_t gain;
+
+    std::vector<std::string>::iterator it;
+    for (it = gain_names.begin(); it != gain_names.end(); ++it)
+    {
+        gain.name = *it;
+        rx->get_gain_range(gain.name, &gain.start, &gain.stop, &gain.step);
+        if (read_from_device)
+        {
+            gain.value = rx->get_gain(gain.name);
+        }
+        else
+        {
+            gain.value = (gain.start + gain.stop) / 2;
+            rx->set_gain(gain.name, gain.value);
+        }
+        gain_list.push_back(gain);
+    }
+
+    remote->setGainStages(gain_list);
+}
@@ -0,0 +1,120 @@
+/* -*- c++ -*- */
+/*
+ * Gqrx SDR: Software defined radio receiver powered by GNU Radio and Qt
+ *           http://gqrx.dk/
+ *
+ * Copyright 2020 Vadym Ostanin.
+ *
+ * Gqrx is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * Gqrx is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Gqrx; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifndef HEADLESS_H
+#define HEADLESS_H
+
+#include <QElapsedTimer>
+#include <QObject>
+#include <QSettings>
+#include <QString>
+#include <QTimer>
+
+#include "applications/gqrx/band_scanner.h"
+#include "applications/gqrx/packet_decoder.h"
+#include "applications/gqrx/receiver.h"
+#include "applications/gqrx/remote_control.h"
+
+/*! \brief Receiver controller without GUI.
+ *
+ * HeadlessReceiver loads the same configuration files as the GUI and drives
+ * the receiver from the remote control interface. It provides the same
+ * flowgraph, remote control and packet decoder as the GUI application but
+ * has no FFT, waterfall or meter timers, i.e. no rendering cost.
+ *
+ * The configuration is only read; changes made through the remote control
+ * interface are not saved.
+ *
+ * In offline mode the receiver processes an I/Q file as fast as possible
+ * instead of using the configured input device, see setOfflineInput().
+ */
+class HeadlessReceiver : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit HeadlessReceiver(QObject *parent = 0);
+    ~HeadlessReceiver();
+
+    bool loadConfig(const QString &cfgfile);
+
+    void start(void);
+    void stop(void);
+
+    void setOfflineInput(const QString &filename, double sample_rate,
+                         qint64 center_freq, double start_time);
+    bool startOffline(const QString &outdir);
+    bool isFinished(void) const { return rx->is_finished(); }
+    void stopOffline(void);
+
+public slots:
+    void setNewFrequency(qint64 rx_freq);
+    void setFilterOffset(qint64 freq_hz);
+    void setLnbLo(double freq_mhz);
+    void selectDemod(int mode_idx);
+    void setPassband(int bandwidth);
+    void setSqlLevel(double level_db);
+    void setGain(QString name, double gain);
+    void startAudioRec(void);
+    void stopAudioRec(void);
+
+private slots:
+    void meterTimeout(void);
+    void dspLoadTimeout(void);
+    void setScannerCenterFreq(qint64 center_freq);
+    void setScannerChannel(qint64 freq, qint64 offset);
+
+private:
+    void updateGainStages(bool read_from_device);
+    void updateAudioRecLabel(void);
+
+private:
+    receiver           *rx;
+    RemoteControl      *remote;
+    PacketDecoder      *packet_decoder;
+    BandScanner        *scanner;
+    QSettings          *m_settings;
+    QTimer             *meter_timer;
+    QTimer             *dsp_load_timer;
+
+    qint64      d_lnb_lo;       /*!< LNB LO in Hz. */
+    qint64      d_hw_freq;      /*!< Hardware frequency in Hz. */
+    qint64      d_rx_freq;      /*!< Receive frequency in Hz incl. LNB LO. */
+    int         d_mode;         /*!< Current mode index, see DockRxOpt. */
+    int         d_filter_lo;    /*!< Current filter low cut. */
+    int         d_filter_hi;    /*!< Current filter high cut. */
+    int         d_cw_offset;    /*!< CW offset in Hz. */
+    double      d_fm_maxdev;    /*!< FM maximum deviation in Hz. */
+    double      d_fm_deemph;    /*!< FM de-emphasis time constant in s. */
+    double      d_sql_level;    /*!< Squelch level in dBFS. */
+    QString     d_rec_dir;      /*!< Audio recording directory. */
+    bool        d_rec_sql;      /*!< Squelch triggered recording. */
+    int         d_rec_preroll;  /*!< Squelch triggered recording pre-roll in ms. */
+    int         d_rec_hang;     /*!< Squelch triggered recording hang time in ms. */
+
+    QString     d_offline_file; /*!< I/Q file processed in offline mode. */
+    double      d_offline_rate; /*!< Sample rate of the I/Q file. */
+    qint64      d_offline_freq; /*!< Center frequency of the I/Q file or 0. */
+    QElapsedTimer d_offline_timer; /*!< Offline processing time. */
+};
+
+#endif // HEADLESS_H
@@ -0,0 +1,249 @@
+/* -*- c++ -*- */
+/*
+ * Gqrx SDR: Software defined radio receiver powered by GNU Radio and Qt
+ *           http://gqrx.dk/
+ *
+ * Copyright 2020 Vadym Ostanin.
+ *
+ * Gqrx is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * Gqrx is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Gqrx; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#include <csignal>
+#include <iostream>
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QRegExp>
+#include <QString>
+#include <QTimer>
+#include <QtGlobal>
+
+#ifdef WITH_PORTAUDIO
+#include <portaudio.h>
+#endif
+
+#include "applications/gqrx/headless.h"
+#include "dsp/fft_plan.h"
+#include "gqrx.h"
+
+#include <boost/program_options.hpp>
+namespace po = boost::program_options;
+
+static volatile std::sig_atomic_t quit_requested = 0;
+
+static void signal_handler(int signum)
+{
+    (void) signum;
+
+    quit_requested = 1;
+}
+
+/*! \brief Receiver daemon without GUI.
+ *
+ * Loads a configuration file created by the gqrx GUI application, starts the
+ * receiver and serves the remote control interface until SIGINT or SIGTERM.
+ *
+ * With --input the receiver instead processes an I/Q file as fast as
+ * possible, saves the audio and exits when the end of the file is reached.
+ */
+int main(int argc, char *argv[])
+{
+    QString         cfg_file;
+    std::string     conf;
+    std::string     input;
+    std::string     output;
+    double          rate = 0.0;
+    qint64          freq = 0;
+    double          start_time = 0.0;
+    bool            clierr = false;
+    int             return_code = 0;
+
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setOrganizationName(GQRX_ORG_NAME);
+    QCoreApplication::setOrganizationDomain(GQRX_ORG_DOMAIN);
+    QCoreApplication::setApplicationName(GQRX_APP_NAME);
+    QCoreApplication::setApplicationVersion(VERSION);
+
+    if (qputenv("GR_CONF_CONTROLPORT_ON", "False"))
+        qDebug() << "Controlport disabled";
+    else
+        qDebug() << "Failed to disable controlport";
+
+    po::options_description desc("Command line options");
+    desc.add_options()
+            ("help,h", "This help message")
+            ("conf,c", po::value<std::string>(&conf), "Start with this config file")
+            ("input,i", po::value<std::string>(&input), "Process this I/Q file offline and exit")
+            ("rate,r", po::value<double>(&rate), "Sample rate of the I/Q file (default: from file name)")
+            ("output,o", po::value<std::string>(&output), "Directory for offline audio (default: current directory)")
+    ;
+
+    po::variables_map vm;
+    try
+    {
+        po::store(po::parse_command_line(argc, argv, desc), vm);
+    }
+    catch(const boost::program_options::error& ex)
+    {
+        std::cerr << ex.what() << std::endl;
+        clierr = true;
+    }
+
+    po::notify(vm);
+
+    if (vm.count("help") || clierr)
+    {
+        std::cout << "Gqrx headless receiver " << VERSION << std::endl;
+        std::cout << desc << std::endl;
+        return 1;
+    }
+
+    cfg_file = conf.empty() ? QString("default.conf") : QString::fromStdString(conf);
+    if (!QDir::isAbsolutePath(cfg_file) && !QFile::exists(cfg_file))
+    {
+        QByteArray xdg_dir = qgetenv("XDG_CONFIG_HOME");
+
+        if (xdg_dir.isEmpty())
+            cfg_file = QString("%1/.config/gqrx/%2").arg(QDir::homePath()).arg(cfg_file);
+        else
+            cfg_file = QString("%1/gqrx/%2").arg(xdg_dir.data()).arg(cfg_file);
+    }
+
+    if (!QFile::exists(cfg_file))
+    {
+        std::cerr << "Configuration file " << cfg_file.toStdString()
+                  << " does not exist." << std::endl
+                  << "Create it using the gqrx GUI." << std::endl;
+        return 1;
+    }
+
+    // share the FFTW wisdom with the GUI
+    fft_plan_c::set_wisdom_file(QFileInfo(cfg_file).absoluteDir()
+                                .filePath("fftw_wisdom").toStdString());
+
+    if (!input.empty())
+    {
+        // gqrx I/Q recordings are named gqrx_yyyyMMdd_hhmmss_freq_rate_fc.raw
+        QRegExp name_rx("gqrx_(\\d{8}_\\d{6})_(\\d+)_(\\d+)_fc");
+
+        if (name_rx.indexIn(QFileInfo(QString::fromStdString(input)).fileName()) != -1)
+        {
+            QDateTime capture = QDateTime::fromString(name_rx.cap(1),
+                                                      "yyyyMMdd_hhmmss");
+
+            // the capture time is in UTC
+            if (capture.isValid())
+            {
+                capture.setTimeSpec(Qt::UTC);
+                start_time = 1.0e-3 * capture.toMSecsSinceEpoch();
+            }
+            freq = name_rx.cap(2).toLongLong();
+            if (rate <= 0.0)
+                rate = name_rx.cap(3).toDouble();
+        }
+
+        if (rate <= 0.0)
+        {
+            std::cerr << "Sample rate of " << input << " unknown, use --rate."
+                      << std::endl;
+            return 1;
+        }
+
+        if (!QFile::exists(QString::fromStdString(input)))
+        {
+            std::cerr << "I/Q file " << input << " does not exist." << std::endl;
+            return 1;
+        }
+    }
+
+#ifdef WITH_PORTAUDIO
+    PaError     err = Pa_Initialize();
+    if (err != paNoError)
+    {
+        std::cerr << "Portaudio error: " << Pa_GetErrorText(err) << std::endl;
+        return 1;
+    }
+#endif
+
+    std::signal(SIGINT, signal_handler);
+    std::signal(SIGTERM, signal_handler);
+
+    try
+    {
+        HeadlessReceiver rx;
+
+        if (!input.empty())
+            rx.setOfflineInput(QString::fromStdString(input), rate, freq,
+                               start_time);
+
+        if (!rx.loadConfig(cfg_file))
+        {
+            return_code = 1;
+        }
+        else if (!input.empty())
+        {
+            QTimer quit_timer;
+
+            QObject::connect(&quit_timer, &QTimer::timeout, [&app, &rx]() {
+                if (quit_requested || rx.isFinished())
+                    app.quit();
+            });
+
+            if (rx.startOffline(output.empty() ? QDir::currentPath() :
+                                QString::fromStdString(output)))
+            {
+                quit_timer.start(100);
+                std::cout << "Processing " << input << " using "
+                          << cfg_file.toStdString() << std::endl;
+                app.exec();
+                rx.stopOffline();
+            }
+            else
+            {
+                return_code = 1;
+            }
+        }
+        else
+        {
+            QTimer quit_timer;
+
+            QObject::connect(&quit_timer, &QTimer::timeout, [&app]() {
+                if (quit_requested)
+                    app.quit();
+            });
+            quit_timer.start(200);
+
+            rx.start();
+            std::cout << "Receiver started using " << cfg_file.toStdString()
+                      << std::endl;
+            return_code = app.exec();
+            rx.stop();
+        }
+    }
+    catch (std::exception &x)
+    {
+        std::cerr << "gqrx exited with an exception: " << x.what() << std::endl;
+        return_code = 1;
+    }
+
+#ifdef WITH_PORTAUDIO
+    Pa_Terminate();
+#endif
+
+    return return_code;
+}
@@ -0,0 +1,188 @@
+/* -*- c++ -*- */
+/*
+ * Gqrx SDR: Software defined radio receiver powered by GNU Radio and Qt
+ *           http://gqrx.dk/
+ *
+ * Copyright 2020 Vadym Ostanin.
+ *
+ * Gqrx is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * Gqrx is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Gqrx; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#include <QtGlobal>
+#include <QDebug>
+#include <QNetworkProxy>
+#include "kiss_server.h"
+
+#define DEFAULT_KISS_PORT       8001
+#define DEFAULT_ALLOWED_HOSTS   "::ffff:127.0.0.1"
+
+/* KISS special characters */
+#define KISS_FEND   0xC0
+#define KISS_FESC   0xDB
+#define KISS_TFEND  0xDC
+#define KISS_TFESC  0xDD
+
+KissServer::KissServer(QObject *parent) :
+    QObject(parent),
+    kiss_port(DEFAULT_KISS_PORT)
+{
+#if QT_VERSION < 0x050900
+    // Workaround for https://bugreports.qt.io/browse/QTBUG-58374
+    kiss_server.setProxy(QNetworkProxy::NoProxy);
+#endif
+
+    kiss_allowed_hosts.append(DEFAULT_ALLOWED_HOSTS);
+
+    connect(&kiss_server, SIGNAL(newConnection()), this, SLOT(acceptConnection()));
+}
+
+KissServer::~KissServer()
+{
+    stop_server();
+}
+
+/*! \brief Start the server. */
+void KissServer::start_server()
+{
+    if (!kiss_server.isListening())
+        kiss_server.listen(QHostAddress::Any, kiss_port);
+}
+
+/*! \brief Stop the server and disconnect all clients. */
+void KissServer::stop_server()
+{
+    foreach (QTcpSocket *client, kiss_clients)
+    {
+        client->disconnect(this);
+        client->close();
+        client->deleteLater();
+    }
+    kiss_clients.clear();
+
+    if (kiss_server.isListening())
+        kiss_server.close();
+}
+
+/*! \brief Set new network port.
+ *  \param port The new network port.
+ *
+ * If the server is running it will be restarted.
+ */
+void KissServer::setPort(int port)
+{
+    if (port == kiss_port)
+        return;
+
+    kiss_port = port;
+    if (kiss_server.isListening())
+    {
+        kiss_server.close();
+        kiss_server.listen(QHostAddress::Any, kiss_port);
+    }
+}
+
+/*! \brief Set new list of allowed host addresses.
+ *
+ * Clients that are already connected are not affected.
+ */
+void KissServer::setHosts(QStringList hosts)
+{
+    kiss_allowed_hosts = hosts;
+}
+
+/*! \brief Send a frame to all connected clients.
+ *  \param frame The AX.25 frame without FCS.
+ *  \param port The KISS port number (0-15).
+ */
+void KissServer::sendFrame(const QByteArray &frame, int port)
+{
+    QByteArray  kiss;
+    int         i;
+
+    if (kiss_clients.isEmpty())
+        return;
+
+    kiss.reserve(2 * frame.size() + 3);
+    kiss.append((char)KISS_FEND);
+    kiss.append((char)((port & 0x0F) << 4)); // data frame
+    for (i = 0; i < frame.size(); i++)
+    {
+        unsigned char c = (unsigned char)frame.at(i);
+
+        if (c == KISS_FEND)
+        {
+            kiss.append((char)KISS_FESC);
+            kiss.append((char)KISS_TFEND);
+        }
+        else if (c == KISS_FESC)
+        {
+            kiss.append((char)KISS_FESC);
+            kiss.append((char)KISS_TFESC);
+        }
+        else
+        {
+            kiss.append((char)c);
+        }
+    }
+    kiss.append((char)KISS_FEND);
+
+    foreach (QTcpSocket *client, kiss_clients)
+        client->write(kiss);
+}
+
+/*! \brief Accept a new client connection. */
+void KissServer::acceptConnection()
+{
+    QTcpSocket *client;
+
+    while ((client = kiss_server.nextPendingConnection()) != 0)
+    {
+        QString address = client->peerAddress().toString();
+
+        if (kiss_allowed_hosts.indexOf(address) == -1)
+        {
+            qDebug() << "KISS server: connection attempt from" << address
+                     << "(not in allowed list)";
+            client->close();
+            client->deleteLater();
+            continue;
+        }
+
+        connect(client, SIGNAL(readyRead()), this, SLOT(discardRead()));
+        connect(client, SIGNAL(disconnected()), this, SLOT(clientDisconnected()));
+        kiss_clients.append(client);
+    }
+}
+
+/*! \brief Discard data sent by a client (we do not transmit). */
+void KissServer::discardRead()
+{
+    QTcpSocket *client = qobject_cast<QTcpSocket *>(sender());
+
+    if (client)
+        client->readAll();
+}
+
+/*! \brief Remove a client that has disconnected. */
+void KissServer::clientDisconnected()
+{
+    QTcpSocket *client = qobject_cast<QTcpSocket *>(sender());
+
+    if (client)
+    {
+        kiss_clients.removeAll(client);
+        client->deleteLater();
+    }
+}
@@ -0,0 +1,86 @@
+/* -*- c++ -*- */
+/*
+ * Gqrx SDR: Software defined radio receiver powered by GNU Radio and Qt
+ *           http://gqrx.dk/
+ *
+ * Copyright 2020 Vadym Ostanin.
+ *
+ * Gqrx is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * Gqrx is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Gqrx; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifndef KISS_SERVER_H
+#define KISS_SERVER_H
+
+#include <QByteArray>
+#include <QList>
+#include <QObject>
+#include <QStringList>
+#include <QTcpServer>
+#include <QTcpSocket>
+
+/*! \brief TCP server distributing received packets in KISS format.
+ *
+ * Every connected client receives a copy of each frame as a KISS data frame.
+ * The KISS port number identifies the channel on which the frame was heard.
+ * This is the same interface as provided by e.g. Direwolf and soundmodem, so
+ * APRS iGate and packet radio applications can be connected directly.
+ *
+ * Transmitting is not supported; data received from the clients is discarded.
+ *
+ * Like the remote control and spectrum servers, connections are only accepted
+ * from the hosts in the allowed list, which by default contains localhost.
+ */
+class KissServer : public QObject
+{
+    Q_OBJECT
+public:
+    explicit KissServer(QObject *parent = 0);
+    ~KissServer();
+
+    void start_server(void);
+    void stop_server(void);
+    bool is_running(void) const
+    {
+        return kiss_server.isListening();
+    }
+
+    void setPort(int port);
+    int  getPort(void) const
+    {
+        return kiss_port;
+    }
+
+    void setHosts(QStringList hosts);
+    QStringList getHosts(void) const
+    {
+        return kiss_allowed_hosts;
+    }
+
+public slots:
+    void sendFrame(const QByteArray &frame, int port);
+
+private slots:
+    void acceptConnection();
+    void discardRead();
+    void clientDisconnected();
+
+private:
+    QTcpServer          kiss_server;    /*!< The active server object. */
+    QList<QTcpSocket *> kiss_clients;   /*!< Connected clients. */
+    int                 kiss_port;      /*!< The port we are listening on. */
+    QStringList         kiss_allowed_hosts; /*!< Hosts where we accept connections from. */
+};
+
+#endif // KISS_SERVER_H
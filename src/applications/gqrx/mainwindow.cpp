@@ -27,11 +27,16 @@
 #include <QSettings>
 #include <QByteArray>
 #include <QDateTime>
+#include <QDateTimeEdit>
 #include <QDesktopServices>
+#include <QDialog>
 #include <QDebug>
 #include <QDialogButtonBox>
+#include <QElapsedTimer>
 #include <QFile>
+#include <QFormLayout>
 #include <QGroupBox>
+#include <QInputDialog>
 #include <QKeySequence>
 #include <QLineEdit>
 #include <QMessageBox>
@@ -45,6 +50,7 @@
 #include <QTimer>
 #include <QVBoxLayout>
 #include <QSvgWidget>
+#include "dsp/fft_plan.h"
 #include "qtgui/ioconfig.h"
 #include "mainwindow.h"
 
@@ -65,8 +71,13 @@ MainWindow::MainWindow(const QString cfgfile, bool edit_conf, QWidget *parent) :
     d_hw_freq(0),
     d_fftAvg(0.25),
     d_have_audio(true),
+    d_zoom_fft(false),
     dec_afsk1200(0)
 {
+    QElapsedTimer startup_timer;
+
+    startup_timer.start();
+
     ui->setupUi(this);
     Bookmarks::create();
 
@@ -90,17 +101,37 @@ MainWindow::MainWindow(const QString cfgfile, bool edit_conf, QWidget *parent) :
 
     d_filter_shape = receiver::FILTER_SHAPE_NORMAL;
 
+    /* FFTW wisdom makes large FFT plans instantaneous after the first time */
+    fft_plan_c::set_wisdom_file(QString("%1/fftw_wisdom").arg(m_cfg_dir).toStdString());
+
     /* create receiver object */
     rx = new receiver("", "", 1);
     rx->set_rf_freq(144500000.0f);
+    qDebug() << "Startup: receiver created after" << startup_timer.elapsed() << "ms";
 
     // remote controller
     remote = new RemoteControl();
+    remote->setLevelHistory(rx->get_level_history());
+
+    // spectrum server for remote displays
+    spectrum_server = new SpectrumServer();
+
+    // packet decoder service
+    packet_decoder = new PacketDecoder(rx);
+    connect(packet_decoder, SIGNAL(newMessage(QString)),
+            this, SLOT(packetDecoderMessage(QString)));
+
+    // band scanner
+    scanner = new BandScanner(rx);
 
     /* meter timer */
     meter_timer = new QTimer(this);
     connect(meter_timer, SIGNAL(timeout()), this, SLOT(meterTimeout()));
 
+    /* flow graph statistics timer */
+    dsp_load_timer = new QTimer(this);
+    connect(dsp_load_timer, SIGNAL(timeout()), this, SLOT(dspLoadTimeout()));
+
     /* FFT timer & data */
     iq_fft_timer = new QTimer(this);
     connect(iq_fft_timer, SIGNAL(timeout()), this, SLOT(iqFftTimeout()));
@@ -124,6 +155,7 @@ MainWindow::MainWindow(const QString cfgfile, bool edit_conf, QWidget *parent) :
     /* create dock widgets */
     uiDockRxOpt = new DockRxOpt();
     uiDockRDS = new DockRDS();
+    uiDockDspLoad = new DockDspLoad();
     uiDockAudio = new DockAudio();
     uiDockInputCtl = new DockInputCtl();
     uiDockFft = new DockFft();
@@ -161,10 +193,13 @@ MainWindow::MainWindow(const QString cfgfile, bool edit_conf, QWidget *parent) :
     uiDockAudio->raise();
 
     addDockWidget(Qt::BottomDockWidgetArea, uiDockBookmarks);
+    addDockWidget(Qt::RightDockWidgetArea, uiDockDspLoad);
+    tabifyDockWidget(uiDockRDS, uiDockDspLoad);
 
     /* hide docks that we don't want to show initially */
     uiDockBookmarks->hide();
     uiDockRDS->hide();
+    uiDockDspLoad->hide();
 
     /* Add dock widget actions to View menu. By doing it this way all signal/slot
        connections will be established automagially.
@@ -175,6 +210,7 @@ MainWindow::MainWindow(const QString cfgfile, bool edit_conf, QWidget *parent) :
     ui->menu_View->addAction(uiDockAudio->toggleViewAction());
     ui->menu_View->addAction(uiDockFft->toggleViewAction());
     ui->menu_View->addAction(uiDockBookmarks->toggleViewAction());
+    ui->menu_View->addAction(uiDockDspLoad->toggleViewAction());
     ui->menu_View->addSeparator();
     ui->menu_View->addAction(ui->mainToolBar->toggleViewAction());
     ui->menu_View->addSeparator();
@@ -216,10 +252,12 @@ MainWindow::MainWindow(const QString cfgfile, bool edit_conf, QWidget *parent) :
     connect(uiDockRxOpt, SIGNAL(sqlLevelChanged(double)), this, SLOT(setSqlLevel(double)));
     connect(uiDockRxOpt, SIGNAL(sqlAutoClicked()), this, SLOT(setSqlLevelAuto()));
     connect(uiDockAudio, SIGNAL(audioGainChanged(float)), this, SLOT(setAudioGain(float)));
-    connect(uiDockAudio, SIGNAL(audioStreamingStarted(QString,int,bool)), this, SLOT(startAudioStream(QString,int,bool)));
+    connect(uiDockAudio, SIGNAL(audioStreamingStarted(QString,int,bool,int)), this, SLOT(startAudioStream(QString,int,bool,int)));
     connect(uiDockAudio, SIGNAL(audioStreamingStopped()), this, SLOT(stopAudioStreaming()));
     connect(uiDockAudio, SIGNAL(audioRecStarted(QString)), this, SLOT(startAudioRec(QString)));
     connect(uiDockAudio, SIGNAL(audioRecStarted(QString)), remote, SLOT(startAudioRecorder(QString)));
+    connect(uiDockAudio, SIGNAL(audioSqlRecStarted(QString,int,int)), this, SLOT(startAudioSqlRec(QString,int,int)));
+    connect(uiDockAudio, SIGNAL(audioSqlRecStarted(QString,int,int)), remote, SLOT(startAudioRecorder(QString)));
     connect(uiDockAudio, SIGNAL(audioRecStopped()), this, SLOT(stopAudioRec()));
     connect(uiDockAudio, SIGNAL(audioRecStopped()), remote, SLOT(stopAudioRecorder()));
     connect(uiDockAudio, SIGNAL(audioPlayStarted(QString)), this, SLOT(startAudioPlayback(QString)));
@@ -252,6 +290,8 @@ MainWindow::MainWindow(const QString cfgfile, bool edit_conf, QWidget *parent) :
     connect(uiDockFft, SIGNAL(fftFillToggled(bool)), this, SLOT(setFftFill(bool)));
     connect(uiDockFft, SIGNAL(fftPeakHoldToggled(bool)), this, SLOT(setFftPeakHold(bool)));
     connect(uiDockFft, SIGNAL(peakDetectionToggled(bool)), this, SLOT(setPeakDetection(bool)));
+    connect(uiDockFft, SIGNAL(zoomFftToggled(bool)), this, SLOT(setZoomFft(bool)));
+    connect(uiDockFft, SIGNAL(persistenceToggled(bool)), ui->plotter, SLOT(setPersistence(bool)));
     connect(uiDockRDS, SIGNAL(rdsDecoderToggled(bool)), this, SLOT(setRdsDecoder(bool)));
 
     // Bookmarks
@@ -282,6 +322,13 @@ MainWindow::MainWindow(const QString cfgfile, bool edit_conf, QWidget *parent) :
     connect(ui->plotter, SIGNAL(newFilterFreq(int, int)), remote, SLOT(setPassband(int, int)));
     connect(remote, SIGNAL(newPassband(int)), this, SLOT(setPassband(int)));
     connect(remote, SIGNAL(gainChanged(QString, double)), uiDockInputCtl, SLOT(setGain(QString,double)));
+    connect(remote, SIGNAL(startScannerEvent()), scanner, SLOT(start()));
+    connect(remote, SIGNAL(stopScannerEvent()), scanner, SLOT(stop()));
+    connect(scanner, SIGNAL(newCenterFrequency(qint64)), this, SLOT(setScannerCenterFreq(qint64)));
+    connect(scanner, SIGNAL(newChannel(qint64, qint64)), this, SLOT(setScannerChannel(qint64, qint64)));
+    connect(scanner, SIGNAL(scannerStatusChanged(bool)), ui->actionBandScan, SLOT(setChecked(bool)));
+    connect(scanner, SIGNAL(scannerStatusChanged(bool)), remote, SLOT(setScannerStatus(bool)));
+    connect(&Bookmarks::Get(), SIGNAL(BookmarksChanged()), this, SLOT(updateScanList()));
 
     rds_timer = new QTimer(this);
     connect(rds_timer, SIGNAL(timeout()), this, SLOT(rdsTimeout()));
@@ -293,12 +340,28 @@ MainWindow::MainWindow(const QString cfgfile, bool edit_conf, QWidget *parent) :
     ui->plotter->setTooltipsEnabled(true);
 #endif
 
-    // Create list of input devices. This must be done before the configuration is
-    // restored because device probing might change the device configuration
-    CIoConfig::getDeviceList(devList);
+    // Start with the devices found last time. Probing all drivers takes several
+    // seconds, so the discovery runs in the background once the configured
+    // device has been opened. Probing while the device is being opened could
+    // change the device configuration.
+    CDeviceDiscovery::loadCache(QString("%1/devices.cache").arg(m_cfg_dir), devList);
+    discovery = new CDeviceDiscovery(this);
+    connect(discovery, SIGNAL(devicesFound(QVariantMap,bool)),
+            this, SLOT(updateDeviceList(QVariantMap,bool)));
+    qDebug() << "Startup: device cache loaded after" << startup_timer.elapsed() << "ms";
 
     // restore last session
-    if (!loadConfig(cfgfile, true, true))
+    bool cfg_loaded = loadConfig(cfgfile, true, true);
+    qDebug() << "Startup: configuration loaded after" << startup_timer.elapsed() << "ms";
+    discovery->start();
+
+    // waterfall history size in MB, 0 disables the history
+    int wf_history_mb = m_settings->value("fft/waterfall_history_mb", 256).toInt();
+    if (wf_history_mb > 0)
+        ui->plotter->openWaterfallHistory(QString("%1/waterfall_history").arg(m_cfg_dir),
+                                          (qint64)wf_history_mb * 1024 * 1024);
+
+    if (!cfg_loaded)
     {
 
       // first time config
@@ -328,6 +391,8 @@ MainWindow::MainWindow(const QString cfgfile, bool edit_conf, QWidget *parent) :
     }
 
     qsvg_dummy = new QSvgWidget();
+
+    qDebug() << "Startup: main window ready after" << startup_timer.elapsed() << "ms";
 }
 
 MainWindow::~MainWindow()
@@ -341,6 +406,12 @@ MainWindow::~MainWindow()
     meter_timer->stop();
     delete meter_timer;
 
+    dsp_load_timer->stop();
+    delete dsp_load_timer;
+
+    // waits for a running discovery
+    delete discovery;
+
     iq_fft_timer->stop();
     delete iq_fft_timer;
 
@@ -376,8 +447,12 @@ MainWindow::~MainWindow()
     delete uiDockFft;
     delete uiDockInputCtl;
     delete uiDockRDS;
+    delete uiDockDspLoad;
+    delete packet_decoder;
+    delete scanner;
     delete rx;
     delete remote;
+    delete spectrum_server;
     delete [] d_fftData;
     delete [] d_realFftData;
     delete [] d_iirFftData;
@@ -468,6 +543,9 @@ bool MainWindow::loadConfig(const QString cfgfile, bool check_crash,
         restoreState(m_settings->value("gui/state", saveState()).toByteArray());
     }
 
+    // apply all flow graph changes in one go
+    rx->begin_reconf();
+
     QString indev = m_settings->value("input/device", "").toString();
     if (!indev.isEmpty())
     {
@@ -547,6 +625,12 @@ bool MainWindow::loadConfig(const QString cfgfile, bool check_crash,
 
     if (actual_rate > 0.)
     {
+        int_val = m_settings->value("input/decim_engine", 0).toInt(&conv_ok);
+        if (conv_ok && int_val == receiver::DECIM_ENGINE_HBF)
+            rx->set_input_decim_engine(receiver::DECIM_ENGINE_HBF);
+        else
+            rx->set_input_decim_engine(receiver::DECIM_ENGINE_FIR);
+
         int_val = m_settings->value("input/decimation", 1).toInt(&conv_ok);
         if (conv_ok && int_val >= 2)
         {
@@ -616,6 +700,13 @@ bool MainWindow::loadConfig(const QString cfgfile, bool check_crash,
         }
     }
 
+    // signal level history resolution
+    int_val = m_settings->value("receiver/level_history_ms", 100).toInt(&conv_ok);
+    if (conv_ok && int_val > 0)
+        rx->set_level_history_interval(1.0e-3 * int_val);
+
+    rx->commit_reconf();
+
     iq_tool->readSettings(m_settings);
 
     /*
@@ -630,6 +721,13 @@ bool MainWindow::loadConfig(const QString cfgfile, bool check_crash,
        ui->actionRemoteControl->setChecked(true);
     }
 
+    packet_decoder->readSettings(m_settings);
+    scanner->readSettings(m_settings);
+    spectrum_server->readSettings(m_settings);
+    ui->actionSpectrumServer->setChecked(spectrum_server->is_running());
+    ui->actionScanBookmarks->setChecked(scanner->getUseBookmarks());
+    updateScanList();
+
     return conf_ok;
 }
 
@@ -708,6 +806,9 @@ void MainWindow::storeSession()
         uiDockAudio->saveSettings(m_settings);
 
         remote->saveSettings(m_settings);
+        packet_decoder->saveSettings(m_settings);
+        scanner->saveSettings(m_settings);
+        spectrum_server->saveSettings(m_settings);
         iq_tool->saveSettings(m_settings);
 
         {
@@ -830,6 +931,9 @@ void MainWindow::setNewFrequency(qint64 rx_freq)
     uiDockRxOpt->setHwFreq(d_hw_freq);
     ui->freqCtrl->setFrequency(rx_freq);
     uiDockBookmarks->setNewFrequency(rx_freq);
+    packet_decoder->setCenterFrequency(center_freq);
+    scanner->setCenterFrequency(center_freq);
+    updateAudioRecLabel();
 }
 
 /**
@@ -848,6 +952,9 @@ void MainWindow::setLnbLo(double freq_mhz)
     updateFrequencyRange();
     ui->freqCtrl->setFrequency(d_lnb_lo + rf_freq);
     ui->plotter->setCenterFreq(d_lnb_lo + d_hw_freq);
+    packet_decoder->setCenterFrequency(d_lnb_lo + d_hw_freq);
+    scanner->setCenterFrequency(d_lnb_lo + d_hw_freq);
+    updateAudioRecLabel();
 
     // update LNB LO in settings
     if (freq_mhz == 0.f)
@@ -876,6 +983,7 @@ void MainWindow::setFilterOffset(qint64 freq_hz)
 
     qint64 rx_freq = d_hw_freq + d_lnb_lo + freq_hz;
     ui->freqCtrl->setFrequency(rx_freq);
+    updateAudioRecLabel();
 
     if (rx->is_rds_decoder_active()) {
         rx->reset_rds_parser();
@@ -1123,6 +1231,7 @@ void MainWindow::selectDemod(int mode_idx)
     d_have_audio = (mode_idx != DockRxOpt::MODE_OFF);
 
     uiDockRxOpt->setCurrentDemod(mode_idx);
+    updateAudioRecLabel();
 }
 
 
@@ -1260,6 +1369,33 @@ void MainWindow::meterTimeout()
     remote->setSignalLevel(level);
 }
 
+/** Flow graph statistics timeout. */
+void MainWindow::dspLoadTimeout()
+{
+    block_stats_list_t stats;
+    uint64_t        samples, lost;
+    unsigned long   gaps;
+    double          last_gap;
+    unsigned long   reconf_count;
+    double          reconf_ms;
+
+    rx->get_block_stats(stats);
+    rx->get_input_stats(samples, lost, gaps, last_gap);
+    rx->get_reconf_stats(reconf_count, reconf_ms);
+    remote->setBlockStats(stats);
+    remote->setInputStats(samples, lost, gaps, last_gap);
+    remote->setReconfStats(reconf_count, reconf_ms);
+    if (uiDockDspLoad->isVisible())
+    {
+        uiDockDspLoad->setBlockStats(stats);
+        uiDockDspLoad->setAudioStats(rx->get_audio_latency(),
+                                     rx->get_audio_underruns(),
+                                     rx->get_audio_drift());
+        uiDockDspLoad->setInputStats(samples, lost, gaps, last_gap);
+        uiDockDspLoad->setReconfStats(reconf_count, reconf_ms);
+    }
+}
+
 /** Baseband FFT plot timeout. */
 void MainWindow::iqFftTimeout()
 {
@@ -1268,6 +1404,16 @@ void MainWindow::iqFftTimeout()
     float           pwr;
     float           pwr_scale;
     std::complex<float> pt;     /* a single FFT point used in calculations */
+    double          fft_center;
+    double          fft_rate;
+
+    // when zoomed in only the displayed span is computed; the band scanner
+    // needs the spectrum of the whole capture window
+    if (d_zoom_fft && !scanner->isRunning())
+        rx->set_iq_fft_zoom(ui->plotter->getFftCenterFreq(),
+                            ui->plotter->getSpanFreq());
+    else if (d_zoom_fft)
+        rx->set_iq_fft_zoom(0.0, 0.0);
 
     // FIXME: fftsize is a reference
     rx->get_iq_fft_data(d_fftData, fftsize);
@@ -1304,7 +1450,15 @@ void MainWindow::iqFftTimeout()
         d_iirFftData[i] += d_fftAvg * (d_realFftData[i] - d_iirFftData[i]);
     }
 
+    rx->get_iq_fft_range(fft_center, fft_rate);
+    ui->plotter->setFftDataRange((qint64)fft_center, (float)fft_rate);
     ui->plotter->setNewFftData(d_iirFftData, d_realFftData, fftsize);
+
+    // same frame as on the pandapter
+    if (spectrum_server->is_running())
+        spectrum_server->sendFftData(d_iirFftData, fftsize,
+                                     d_lnb_lo + d_hw_freq + (qint64)fft_center,
+                                     (qint64)fft_rate);
 }
 
 /** Audio FFT plot timeout. */
@@ -1394,6 +1548,51 @@ void MainWindow::startAudioRec(const QString filename)
     }
 }
 
+/**
+ * @brief Start squelch triggered audio recorder.
+ * @param dir The directory where the recordings are stored.
+ * @param preroll_ms Audio recorded before the squelch opens.
+ * @param hang_ms Time after the squelch closes before a file is closed.
+ */
+void MainWindow::startAudioSqlRec(const QString dir, int preroll_ms, int hang_ms)
+{
+    if (!d_have_audio)
+    {
+        QMessageBox msg_box;
+        msg_box.setIcon(QMessageBox::Critical);
+        msg_box.setText(tr("Recording audio requires a demodulator.\n"
+                           "Currently, demodulation is switched off "
+                           "(Mode->Demod off)."));
+        msg_box.exec();
+        uiDockAudio->setAudioRecButtonState(false);
+    }
+    else if (rx->start_sql_recording(dir.toStdString(), preroll_ms, hang_ms))
+    {
+        ui->statusBar->showMessage(tr("Error starting audio recorder"));
+
+        /* reset state of record button */
+        uiDockAudio->setAudioRecButtonState(false);
+    }
+    else
+    {
+        ui->statusBar->showMessage(tr("Recording transmissions to %1").arg(dir));
+    }
+}
+
+/**
+ * Update frequency and mode used in the names of squelch triggered recordings
+ * and the frequency sent with framed UDP audio.
+ */
+void MainWindow::updateAudioRecLabel()
+{
+    QString mode = DockRxOpt::GetStringForModulationIndex(uiDockRxOpt->currentDemod());
+
+    mode.remove(QRegExp("[^A-Za-z0-9]"));
+    rx->set_audio_rec_label(QString("%1_%2").arg(ui->freqCtrl->getFrequency())
+                                            .arg(mode).toStdString());
+    rx->set_udp_stream_freq(ui->freqCtrl->getFrequency());
+}
+
 /** Stop audio recorder. */
 void MainWindow::stopAudioRec()
 {
@@ -1444,9 +1643,19 @@ void MainWindow::stopAudioPlayback()
 }
 
 /** Start streaming audio over UDP. */
-void MainWindow::startAudioStream(const QString udp_host, int udp_port, bool stereo)
+void MainWindow::startAudioStream(const QString udp_host, int udp_port, bool stereo,
+                                  int format)
 {
-    rx->start_udp_streaming(udp_host.toStdString(), udp_port, stereo);
+    if (rx->start_udp_streaming(udp_host.toStdString(), udp_port, stereo,
+                                format) != receiver::STATUS_OK)
+    {
+        ui->statusBar->showMessage(tr("Error starting audio stream to %1:%2")
+                                   .arg(udp_host).arg(udp_port));
+        uiDockAudio->setAudioStreamButtonState(false);
+        return;
+    }
+
+    rx->set_udp_stream_freq(ui->freqCtrl->getFrequency());
 }
 
 /** Stop streaming audio over UDP. */
@@ -1696,6 +1905,14 @@ void MainWindow::setPeakDetection(bool enabled)
     ui->plotter->setPeakDetection(enabled ,2);
 }
 
+/** Enable or disable the zoom FFT. */
+void MainWindow::setZoomFft(bool enabled)
+{
+    d_zoom_fft = enabled;
+    if (!enabled)
+        rx->set_iq_fft_zoom(0.0, 0.0);
+}
+
 /**
  * @brief Force receiver reconfiguration.
  *
@@ -1733,6 +1950,7 @@ void MainWindow::on_actionDSP_triggered(bool checked)
 
         /* start GUI timers */
         meter_timer->start(100);
+        dsp_load_timer->start(1000);
 
         if (uiDockFft->fftRate())
         {
@@ -1758,9 +1976,12 @@ void MainWindow::on_actionDSP_triggered(bool checked)
     {
         /* stop GUI timers */
         meter_timer->stop();
+        dsp_load_timer->stop();
+        uiDockDspLoad->clearStats();
         iq_fft_timer->stop();
         audio_fft_timer->stop();
         rds_timer->stop();
+        scanner->stop();
 
         /* stop receiver */
         rx->stop();
@@ -1786,6 +2007,8 @@ int MainWindow::on_actionIoConfig_triggered()
     qDebug() << "Configure I/O devices.";
 
     CIoConfig *ioconf = new CIoConfig(m_settings, devList);
+    connect(discovery, SIGNAL(devicesFound(QVariantMap,bool)),
+            ioconf, SLOT(updateDeviceList(QVariantMap)));
     int confres = ioconf->exec();
 
     if (confres == QDialog::Accepted)
@@ -1810,12 +2033,48 @@ int MainWindow::on_actionIoConfig_triggered()
 }
 
 
+/**
+ * @brief New results from the background device discovery.
+ * @param devices All devices found so far, label -> device string.
+ * @param finished True when the discovery has finished.
+ *
+ * When the discovery has finished the results are saved in the device cache.
+ * The device in use is kept in the list because some drivers can not probe
+ * a device that is already open.
+ */
+void MainWindow::updateDeviceList(const QVariantMap &devices, bool finished)
+{
+    std::map<QString, QVariant> found = devices.toStdMap();
+
+    if (finished && m_settings)
+    {
+        QString indev = m_settings->value("input/device", "").toString();
+        bool    have_indev = false;
+
+        for (auto &dev : found)
+            if (dev.second.toString() == indev)
+                have_indev = true;
+
+        if (!have_indev)
+            for (auto &dev : devList)
+                if (dev.second.toString() == indev)
+                    found.insert(dev);
+    }
+
+    devList = found;
+
+    if (finished)
+        CDeviceDiscovery::saveCache(QString("%1/devices.cache").arg(m_cfg_dir), devList);
+}
+
 /** Run first time configurator. */
 int MainWindow::firstTimeConfig()
 {
     qDebug() << __func__;
 
     CIoConfig *ioconf = new CIoConfig(m_settings, devList);
+    connect(discovery, SIGNAL(devicesFound(QVariantMap,bool)),
+            ioconf, SLOT(updateDeviceList(QVariantMap)));
     int confres = ioconf->exec();
 
     if (confres == QDialog::Accepted)
@@ -1905,6 +2164,114 @@ void MainWindow::on_actionSaveWaterfall_triggered()
     m_settings->setValue("wf_save_dir", fi.absolutePath());
 }
 
+/** Export a time range of the waterfall history to a graphics file. */
+void MainWindow::on_actionExportWaterfallHistory_triggered()
+{
+    QDateTime   now(QDateTime::currentDateTime());
+    qint64      start_ms = ui->plotter->waterfallHistoryStart();
+    QString     wffile;
+    QString     save_path;
+
+    if (start_ms <= 0)
+    {
+        QMessageBox::information(this, tr("Export waterfall history"),
+                                 tr("The waterfall history is empty."));
+        return;
+    }
+
+    QDialog         dialog(this);
+    QFormLayout    *layout = new QFormLayout(&dialog);
+    QDateTimeEdit  *from_edit = new QDateTimeEdit(now.addSecs(-600), &dialog);
+    QDateTimeEdit  *to_edit = new QDateTimeEdit(now, &dialog);
+    QDialogButtonBox *buttons = new QDialogButtonBox(QDialogButtonBox::Ok |
+                                                     QDialogButtonBox::Cancel,
+                                                     &dialog);
+
+    from_edit->setMinimumDateTime(QDateTime::fromMSecsSinceEpoch(start_ms));
+    from_edit->setMaximumDateTime(now);
+    from_edit->setDisplayFormat("yyyy.MM.dd hh:mm:ss");
+    to_edit->setMinimumDateTime(QDateTime::fromMSecsSinceEpoch(start_ms));
+    to_edit->setMaximumDateTime(now);
+    to_edit->setDisplayFormat("yyyy.MM.dd hh:mm:ss");
+    layout->addRow(tr("From"), from_edit);
+    layout->addRow(tr("To"), to_edit);
+    layout->addRow(buttons);
+    connect(buttons, SIGNAL(accepted()), &dialog, SLOT(accept()));
+    connect(buttons, SIGNAL(rejected()), &dialog, SLOT(reject()));
+    dialog.setWindowTitle(tr("Export waterfall history"));
+
+    if (dialog.exec() != QDialog::Accepted)
+        return;
+
+    // previously used location
+    save_path = m_settings->value("wf_save_dir", "").toString();
+    if (!save_path.isEmpty())
+        save_path += "/";
+    save_path += from_edit->dateTime().toUTC().toString("gqrx_wfh_yyyyMMdd_hhmmss.png");
+
+    wffile = QFileDialog::getSaveFileName(this, tr("Export waterfall history"),
+                                          save_path, 0);
+    if (wffile.isEmpty())
+        return;
+
+    if (!ui->plotter->saveWaterfallHistory(wffile,
+                                           from_edit->dateTime().toMSecsSinceEpoch(),
+                                           to_edit->dateTime().toMSecsSinceEpoch()))
+    {
+        QMessageBox::critical(this,
+                              tr("Error"),
+                              tr("There was an error exporting the waterfall history"));
+    }
+
+    // store the location used for the waterfall file
+    QFileInfo fi(wffile);
+    m_settings->setValue("wf_save_dir", fi.absolutePath());
+}
+
+/** Export one resolution of the signal level history to a CSV file. */
+void MainWindow::on_actionExportLevelHistory_triggered()
+{
+    level_history_sptr  hist = rx->get_level_history();
+    QStringList         items;
+    QString             item;
+    QString             csvfile;
+    QString             save_path;
+    unsigned int        level;
+    bool                ok;
+
+    for (level = 0; level < hist->levels(); level++)
+        items << tr("%1 s (%2 entries)")
+                 .arg(hist->interval(level))
+                 .arg(hist->count(level));
+
+    item = QInputDialog::getItem(this, tr("Export signal level history"),
+                                 tr("Resolution"), items, 0, false, &ok);
+    if (!ok)
+        return;
+    level = items.indexOf(item);
+
+    save_path = m_settings->value("level_save_dir", "").toString();
+    if (!save_path.isEmpty())
+        save_path += "/";
+    save_path += QDateTime::currentDateTimeUtc().toString("gqrx_levels_yyyyMMdd_hhmmss.csv");
+
+    csvfile = QFileDialog::getSaveFileName(this, tr("Export signal level history"),
+                                           save_path, tr("CSV files (*.csv)"));
+    if (csvfile.isEmpty())
+        return;
+
+    if (!hist->write_csv(csvfile.toStdString(), level))
+    {
+        QMessageBox::critical(this,
+                              tr("Error"),
+                              tr("There was an error exporting the signal level history"));
+    }
+
+    // store the location used for the CSV file
+    QFileInfo fi(csvfile);
+    m_settings->setValue("level_save_dir", fi.absolutePath());
+}
+
 /** Show I/Q player. */
 void MainWindow::on_actionIqTool_triggered()
 {
@@ -1921,6 +2288,7 @@ void MainWindow::on_plotter_newDemodFreq(qint64 freq, qint64 delta)
     // update RF freq label and channel filter offset
     uiDockRxOpt->setFilterOffset(delta);
     ui->freqCtrl->setFrequency(freq);
+    updateAudioRecLabel();
 
     if (rx->is_rds_decoder_active())
         rx->reset_rds_parser();
@@ -1946,6 +2314,7 @@ void MainWindow::on_plotter_newCenterFreq(qint64 f)
 {
     rx->set_rf_freq(f);
     ui->freqCtrl->setFrequency(f);
+    updateAudioRecLabel();
 }
 
 /** Full screen button or menu item toggled. */
@@ -1972,6 +2341,15 @@ void MainWindow::on_actionRemoteControl_triggered(bool checked)
         remote->stop_server();
 }
 
+/** Spectrum server menu item toggled. */
+void MainWindow::on_actionSpectrumServer_triggered(bool checked)
+{
+    if (checked)
+        spectrum_server->start_server();
+    else
+        spectrum_server->stop_server();
+}
+
 /** Remote control configuration button (or menu item) clicked. */
 void MainWindow::on_actionRemoteConfig_triggered()
 {
@@ -1989,6 +2367,24 @@ void MainWindow::on_actionRemoteConfig_triggered()
     delete rcs;
 }
 
+/** Spectrum server configuration menu item clicked. */
+void MainWindow::on_actionSpectrumConfig_triggered()
+{
+    RemoteControlSettings *rcs = new RemoteControlSettings();
+
+    rcs->setWindowTitle(tr("Gqrx spectrum server settings"));
+    rcs->setPort(spectrum_server->getPort());
+    rcs->setHosts(spectrum_server->getHosts());
+
+    if (rcs->exec() == QDialog::Accepted)
+    {
+        spectrum_server->setPort(rcs->getPort());
+        spectrum_server->setHosts(rcs->getHosts());
+    }
+
+    delete rcs;
+}
+
 
 #define DATA_BUFFER_SIZE 48000
 
@@ -2029,6 +2425,34 @@ void MainWindow::on_actionAFSK1200_triggered()
 }
 
 
+/**
+ * Band scan action triggered.
+ *
+ * Start or stop scanning the configured frequency range for active
+ * channels. The scanner requires the receiver to be running.
+ */
+void MainWindow::on_actionBandScan_triggered(bool checked)
+{
+    if (checked && !ui->actionDSP->isChecked())
+    {
+        ui->actionBandScan->setChecked(false);
+        ui->statusBar->showMessage(tr("Start DSP before scanning"), 5000);
+        return;
+    }
+
+    if (checked)
+        scanner->start();
+    else
+        scanner->stop();
+}
+
+/** Scan the active bookmarks instead of a channel grid. */
+void MainWindow::on_actionScanBookmarks_triggered(bool checked)
+{
+    scanner->setUseBookmarks(checked);
+    updateScanList();
+}
+
 /**
  * Destroy AFSK1200 decoder window got closed.
  *
@@ -2047,6 +2471,19 @@ void MainWindow::afsk1200win_closed()
     dec_afsk1200 = 0;
 }
 
+/**
+ * Show a packet received by the multi-channel packet decoder.
+ *
+ * The packet is shown in the status bar and, if it is open, in the AFSK1200
+ * decoder window.
+ */
+void MainWindow::packetDecoderMessage(const QString &message)
+{
+    ui->statusBar->showMessage(message, 5000);
+    if (dec_afsk1200)
+        dec_afsk1200->add_message(message);
+}
+
 
 /**
  * Cyclic processing for acquiring samples from receiver and processing them
@@ -2056,10 +2493,11 @@ void MainWindow::decoderTimeout()
 {
     float buffer[DATA_BUFFER_SIZE];
     unsigned int num;
+    double time;
 
-    rx->get_sniffer_data(&buffer[0], num);
+    rx->get_sniffer_data(&buffer[0], num, time);
     if (dec_afsk1200)
-        dec_afsk1200->process_samples(&buffer[0], num);
+        dec_afsk1200->process_samples(&buffer[0], num, time);
 }
 
 void MainWindow::setRdsDecoder(bool checked)
@@ -2083,6 +2521,7 @@ void MainWindow::setRdsDecoder(bool checked)
 
 void MainWindow::onBookmarkActivated(qint64 freq, QString demod, int bandwidth)
 {
+    rx->begin_reconf();
     setNewFrequency(freq);
     selectDemod(demod);
 
@@ -2108,6 +2547,45 @@ void MainWindow::onBookmarkActivated(qint64 freq, QString demod, int bandwidth)
     }
 
     on_plotter_newFilterFreq(lo, hi);
+    rx->commit_reconf();
+}
+
+/** Band scanner moved to a new capture window. */
+void MainWindow::setScannerCenterFreq(qint64 center_freq)
+{
+    setNewFrequency(center_freq + (qint64)rx->get_filter_offset());
+}
+
+/** Band scanner found an active channel within the capture window. */
+void MainWindow::setScannerChannel(qint64 freq, qint64 offset)
+{
+    ui->plotter->setFilterOffset(offset);
+    on_plotter_newDemodFreq(freq, offset);
+
+    if (!scanner->getUseBookmarks())
+        return;
+
+    // use demodulator and bandwidth of the bookmark
+    QList<BookmarkInfo> bookmarks = Bookmarks::Get().getBookmarksInRange(freq, freq);
+    if (bookmarks.isEmpty())
+        return;
+
+    rx->begin_reconf();
+    if (DockRxOpt::GetEnumForModulationString(bookmarks[0].modulation) != uiDockRxOpt->currentDemod())
+        selectDemod(bookmarks[0].modulation);
+    if (bookmarks[0].bandwidth > 0)
+        setPassband(bookmarks[0].bandwidth);
+    rx->commit_reconf();
+}
+
+/** Update the channel list of the band scanner from the bookmarks. */
+void MainWindow::updateScanList()
+{
+    if (scanner->getUseBookmarks())
+        scanner->setChannelList(Bookmarks::Get().getActiveFrequencies(),
+                                Bookmarks::Get().getTaggedFrequencies(scanner->getPriorityTag()));
+    else
+        scanner->setChannelList(QVector<qint64>(), QVector<qint64>());
 }
 
 void MainWindow::setPassband(int bandwidth)
@@ -39,10 +39,15 @@
 #include "qtgui/dockfft.h"
 #include "qtgui/dockbookmarks.h"
 #include "qtgui/dockrds.h"
+#include "qtgui/dockdspload.h"
+#include "qtgui/device_discovery.h"
 #include "qtgui/afsk1200win.h"
 #include "qtgui/iq_tool.h"
 
 #include "applications/gqrx/remote_control.h"
+#include "applications/gqrx/packet_decoder.h"
+#include "applications/gqrx/band_scanner.h"
+#include "applications/gqrx/spectrum_server.h"
 
 // see https://bugreports.qt-project.org/browse/QTBUG-22829
 #ifndef Q_MOC_RUN
@@ -89,6 +94,7 @@ private:
     float           d_fftAvg;      /*!< FFT averaging parameter set by user (not the true gain). */
 
     bool d_have_audio;  /*!< Whether we have audio (i.e. not with demod_off. */
+    bool d_zoom_fft;    /*!< Compute the FFT only over the displayed span. */
 
     /* dock widgets */
     DockRxOpt      *uiDockRxOpt;
@@ -97,6 +103,7 @@ private:
     DockFft        *uiDockFft;
     DockBookmarks  *uiDockBookmarks;
     DockRDS        *uiDockRDS;
+    DockDspLoad    *uiDockDspLoad;
 
     CIqTool        *iq_tool;
 
@@ -110,12 +117,21 @@ private:
     QTimer   *iq_fft_timer;
     QTimer   *audio_fft_timer;
     QTimer   *rds_timer;
+    QTimer   *dsp_load_timer;
 
     receiver *rx;
 
     RemoteControl *remote;
 
+    // spectrum streaming to remote displays
+    SpectrumServer *spectrum_server;
+
+    // multi-channel packet decoder
+    PacketDecoder *packet_decoder;
+    BandScanner   *scanner;
+
     std::map<QString, QVariant> devList;
+    CDeviceDiscovery           *discovery;  /*!< Background device discovery. */
 
     // dummy widget to enforce linking to QtSvg
     QSvgWidget      *qsvg_dummy;
@@ -124,10 +140,12 @@ private:
     void updateHWFrequencyRange(bool ignore_limits);
     void updateFrequencyRange();
     void updateGainStages(bool read_from_device);
+    void updateAudioRecLabel();
     void showSimpleTextFile(const QString &resource_path,
                             const QString &window_title);
 
 private slots:
+    void updateDeviceList(const QVariantMap &devices, bool finished);
     /* rf */
     void setLnbLo(double freq_mhz);
     void setAntenna(const QString antenna);
@@ -162,11 +180,12 @@ private slots:
 
     /* audio recording and playback */
     void startAudioRec(const QString filename);
+    void startAudioSqlRec(const QString dir, int preroll_ms, int hang_ms);
     void stopAudioRec();
     void startAudioPlayback(const QString filename);
     void stopAudioPlayback();
 
-    void startAudioStream(const QString udp_host, int udp_port, bool stereo);
+    void startAudioStream(const QString udp_host, int udp_port, bool stereo, int format);
     void stopAudioStreaming();
 
     /* I/Q playback and recording*/
@@ -186,6 +205,7 @@ private slots:
     void setFftColor(const QColor color);
     void setFftFill(bool enable);
     void setPeakDetection(bool enabled);
+    void setZoomFft(bool enabled);
     void setFftPeakHold(bool enable);
     void setWfTimeSpan(quint64 span_ms);
     void setWfSize();
@@ -201,17 +221,28 @@ private slots:
     /* Bookmarks */
     void onBookmarkActivated(qint64 freq, QString demod, int bandwidth);
 
+    /* Band scanner */
+    void setScannerCenterFreq(qint64 center_freq);
+    void setScannerChannel(qint64 freq, qint64 offset);
+    void updateScanList();
+
     /* menu and toolbar actions */
     void on_actionDSP_triggered(bool checked);
     int  on_actionIoConfig_triggered();
     void on_actionLoadSettings_triggered();
     void on_actionSaveSettings_triggered();
     void on_actionSaveWaterfall_triggered();
+    void on_actionExportWaterfallHistory_triggered();
+    void on_actionExportLevelHistory_triggered();
     void on_actionIqTool_triggered();
     void on_actionFullScreen_triggered(bool checked);
     void on_actionRemoteControl_triggered(bool checked);
+    void on_actionSpectrumServer_triggered(bool checked);
     void on_actionRemoteConfig_triggered();
+    void on_actionSpectrumConfig_triggered();
     void on_actionAFSK1200_triggered();
+    void on_actionBandScan_triggered(bool checked);
+    void on_actionScanBookmarks_triggered(bool checked);
     void on_actionUserGroup_triggered();
     void on_actionNews_triggered();
     void on_actionRemoteProtocol_triggered();
@@ -222,11 +253,13 @@ private slots:
 
     /* window close signals */
     void afsk1200win_closed();
+    void packetDecoderMessage(const QString &message);
     int  firstTimeConfig();
 
     /* cyclic processing */
     void decoderTimeout();
     void meterTimeout();
+    void dspLoadTimeout();
     void iqFftTimeout();
     void audioFftTimeout();
     void rdsTimeout();
@@ -0,0 +1,434 @@
+/* -*- c++ -*- */
+/*
+ * Gqrx SDR: Software defined radio receiver powered by GNU Radio and Qt
+ *           http://gqrx.dk/
+ *
+ * Copyright 2020 Vadym Ostanin.
+ *
+ * Gqrx is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * Gqrx is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Gqrx; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#include <cmath>
+#include <QDateTime>
+#include <QDebug>
+#include <QMutexLocker>
+#include <QRunnable>
+#include <QStringList>
+#include <QThread>
+#include <QTime>
+#include "packet_decoder.h"
+
+#define DEFAULT_DEDUP_WINDOW    30      /* seconds */
+#define NUM_KISS_PORTS          16
+#define POLL_INTERVAL           100     /* milliseconds */
+
+/* Keep channels this far from the band edges */
+#define BAND_EDGE_MARGIN        10000.0
+
+/* Size of the sample buffer; same as the sniffer buffer in the receiver */
+#define CHANNEL_BUFFER_SIZE     48000
+
+
+/*! \brief Demodulator task running on the worker pool.
+ *
+ * The task processes all the samples pending on a channel and finishes when
+ * there are no more samples. New samples arriving while the task is running
+ * are picked up by the same task, which keeps the samples in order without
+ * tying up more than one worker per channel.
+ */
+class PacketDemodTask : public QRunnable
+{
+public:
+    explicit PacketDemodTask(PacketChannel *chan) : chan(chan) {}
+
+    void run()
+    {
+        QVector<float>  samples;
+        double          time;
+        int             num;
+
+        forever
+        {
+            {
+                QMutexLocker locker(&chan->mutex);
+                if (chan->pending.isEmpty())
+                {
+                    chan->scheduled = false;
+                    return;
+                }
+                num = chan->pending.size();
+                time = chan->pending_time;
+                samples = chan->tail;
+                samples += chan->pending;
+                chan->pending.clear();
+            }
+
+            /* the correlator looks CORRLEN samples ahead so we process
+             * the tail of the previous block plus all but the last CORRLEN
+             * samples of this block */
+            if (time > 0.0)
+                time -= (double) chan->tail.size() / FREQ_SAMP;
+            chan->demod->demod(samples.data(), num, time);
+            chan->tail = samples.mid(num);
+        }
+    }
+
+private:
+    PacketChannel *chan;
+};
+
+
+PacketDecoder::PacketDecoder(receiver *rx, QObject *parent) :
+    QObject(parent),
+    rx(rx),
+    dedup_window_ms(DEFAULT_DEDUP_WINDOW * 1000),
+    center_freq(0),
+    quad_rate(0.0)
+{
+    pool.setMaxThreadCount(QThread::idealThreadCount());
+    buffer.resize(CHANNEL_BUFFER_SIZE);
+
+    poll_timer.setInterval(POLL_INTERVAL);
+    connect(&poll_timer, SIGNAL(timeout()), this, SLOT(pollChannels()));
+}
+
+PacketDecoder::~PacketDecoder()
+{
+    stop();
+    clearChannels();
+}
+
+/*! \brief Read settings.
+ *
+ * Channels are stored as "frequency:port". Entries without a port, as written
+ * by earlier versions, use their position in the list as KISS port.
+ */
+void PacketDecoder::readSettings(QSettings *settings)
+{
+    QStringList freqs;
+    QMap<int, qint64> map;
+    bool conv_ok;
+    int int_val;
+    int i;
+
+    if (!settings)
+        return;
+
+    settings->beginGroup("packet_decoder");
+
+    freqs = settings->value("channels").toStringList();
+    for (i = 0; i < freqs.size(); i++)
+    {
+        QStringList fields = freqs[i].split(':');
+        qint64 f = fields[0].toLongLong(&conv_ok);
+        if (!conv_ok)
+            continue;
+
+        int_val = i;
+        if (fields.size() > 1)
+            int_val = fields[1].toInt(&conv_ok);
+        if (!conv_ok || int_val < 0 || int_val >= NUM_KISS_PORTS ||
+            map.contains(int_val))
+        {
+            qWarning() << "Packet decoder: Invalid channel" << freqs[i];
+            continue;
+        }
+        map.insert(int_val, f);
+    }
+    setChannels(map);
+
+    int_val = settings->value("kiss_port", 0).toInt(&conv_ok);
+    if (conv_ok && int_val > 0)
+        kiss.setPort(int_val);
+
+    if (settings->contains("kiss_allowed_hosts"))
+        kiss.setHosts(settings->value("kiss_allowed_hosts").toStringList());
+
+    int_val = settings->value("dedup_window", DEFAULT_DEDUP_WINDOW).toInt(&conv_ok);
+    if (conv_ok)
+        setDedupWindow(int_val);
+
+    if (settings->value("enabled", false).toBool())
+        start();
+
+    settings->endGroup();
+}
+
+void PacketDecoder::saveSettings(QSettings *settings) const
+{
+    QStringList freqs;
+
+    if (!settings)
+        return;
+
+    settings->beginGroup("packet_decoder");
+
+    if (isRunning())
+        settings->setValue("enabled", true);
+    else
+        settings->remove("enabled");
+
+    foreach (PacketChannel *chan, channels)
+        freqs.append(QString("%1:%2").arg(chan->freq).arg(chan->port));
+
+    if (freqs.isEmpty())
+        settings->remove("channels");
+    else
+        settings->setValue("channels", freqs);
+
+    if (kiss.getPort() != 8001)
+        settings->setValue("kiss_port", kiss.getPort());
+    else
+        settings->remove("kiss_port");
+
+    if (kiss.getHosts().count() > 0)
+        settings->setValue("kiss_allowed_hosts", kiss.getHosts());
+    else
+        settings->remove("kiss_allowed_hosts");
+
+    if (dedup_window_ms != DEFAULT_DEDUP_WINDOW * 1000)
+        settings->setValue("dedup_window", getDedupWindow());
+    else
+        settings->remove("dedup_window");
+
+    settings->endGroup();
+}
+
+/*! \brief Start decoding and the KISS server. */
+void PacketDecoder::start()
+{
+    if (isRunning())
+        return;
+
+    kiss.start_server();
+    poll_timer.start();
+    updateChannels();
+}
+
+/*! \brief Stop decoding and the KISS server. */
+void PacketDecoder::stop()
+{
+    poll_timer.stop();
+    pool.waitForDone();
+    kiss.stop_server();
+
+    foreach (PacketChannel *chan, channels)
+    {
+        if (chan->rx_id >= 0)
+        {
+            rx->remove_packet_channel(chan->rx_id);
+            chan->rx_id = -1;
+        }
+    }
+}
+
+/*! \brief Set the channels.
+ *  \param freqs The channel frequencies in Hz (including LNB LO) keyed by
+ *               their KISS port number (0-15).
+ */
+void PacketDecoder::setChannels(const QMap<int, qint64> &freqs)
+{
+    bool running = isRunning();
+
+    if (running)
+        stop();
+
+    clearChannels();
+    QMap<int, qint64>::const_iterator it;
+    for (it = freqs.constBegin(); it != freqs.constEnd(); ++it)
+    {
+        if (it.key() < 0 || it.key() >= NUM_KISS_PORTS)
+        {
+            qWarning() << "Packet decoder: Invalid KISS port" << it.key()
+                       << "for" << it.value();
+            continue;
+        }
+
+        PacketChannel *chan = new PacketChannel;
+        chan->freq = it.value();
+        chan->port = it.key();
+        chan->rx_id = -1;
+        chan->scheduled = false;
+        chan->pending_time = 0.0;
+        chan->tail.fill(0.0f, CORRLEN);
+        chan->demod = new CAfsk12();
+        chan->demod->setRawFrames(true);
+
+        /* CAfsk12 emits from the worker threads */
+        connect(chan->demod, SIGNAL(newFrame(QByteArray,double)),
+                this, SLOT(processFrame(QByteArray,double)), Qt::QueuedConnection);
+        channels.append(chan);
+    }
+
+    if (running)
+        start();
+}
+
+QMap<int, qint64> PacketDecoder::getChannels(void) const
+{
+    QMap<int, qint64> freqs;
+
+    foreach (PacketChannel *chan, channels)
+        freqs.insert(chan->port, chan->freq);
+
+    return freqs;
+}
+
+/*! \brief Set the deduplication window.
+ *  \param seconds Identical frames received within this time are dropped.
+ */
+void PacketDecoder::setDedupWindow(int seconds)
+{
+    dedup_window_ms = (qint64)seconds * 1000;
+}
+
+/*! \brief Set new center frequency of the I/Q band.
+ *  \param freq The center frequency in Hz (including LNB LO).
+ */
+void PacketDecoder::setCenterFrequency(qint64 freq)
+{
+    center_freq = freq;
+    updateChannels();
+}
+
+/*! \brief Connect, retune or disconnect receiver channels. */
+void PacketDecoder::updateChannels()
+{
+    double  offset;
+    double  max_offset;
+
+    quad_rate = rx->get_quad_rate();
+
+    if (!isRunning())
+        return;
+
+    max_offset = quad_rate / 2.0 - BAND_EDGE_MARGIN;
+    foreach (PacketChannel *chan, channels)
+    {
+        offset = (double)(chan->freq - center_freq);
+        if (std::abs(offset) < max_offset)
+        {
+            if (chan->rx_id < 0)
+                chan->rx_id = rx->add_packet_channel(offset);
+            else
+                rx->set_packet_channel_offset(chan->rx_id, offset);
+        }
+        else if (chan->rx_id >= 0)
+        {
+            qDebug() << "Packet decoder:" << chan->freq << "Hz is out of band";
+            rx->remove_packet_channel(chan->rx_id);
+            chan->rx_id = -1;
+        }
+    }
+}
+
+/*! \brief Delete all channels. */
+void PacketDecoder::clearChannels()
+{
+    pool.waitForDone();
+    foreach (PacketChannel *chan, channels)
+    {
+        if (chan->rx_id >= 0)
+            rx->remove_packet_channel(chan->rx_id);
+        delete chan->demod;
+        delete chan;
+    }
+    channels.clear();
+}
+
+/*! \brief Fetch new samples from the receiver and schedule demodulation. */
+void PacketDecoder::pollChannels()
+{
+    unsigned int num;
+    double       time;
+
+    if (std::abs(rx->get_quad_rate() - quad_rate) > 0.5)
+        updateChannels();
+
+    foreach (PacketChannel *chan, channels)
+    {
+        if (chan->rx_id < 0)
+            continue;
+
+        rx->get_packet_channel_data(chan->rx_id, buffer.data(), num, time);
+        if (num == 0)
+            continue;
+
+        QMutexLocker locker(&chan->mutex);
+        if (chan->pending.isEmpty())
+            chan->pending_time = time;
+        chan->pending += buffer.mid(0, num);
+        if (!chan->scheduled)
+        {
+            chan->scheduled = true;
+            pool.start(new PacketDemodTask(chan));
+        }
+    }
+}
+
+/*! \brief Common CRC check and deduplication stage.
+ *  \param frame The raw HDLC frame including FCS.
+ *  \param time The sampling time of the frame or 0 if not known.
+ */
+void PacketDecoder::processFrame(const QByteArray &frame, double time)
+{
+    QObject    *demod = sender();
+    PacketChannel *chan = 0;
+    QByteArray  payload;
+    QString     message;
+    qint64      now;
+
+    if (frame.size() < 10)
+        return;
+
+    if (!CAfsk12::checkCrc((const unsigned char *)frame.constData(), frame.size()))
+        return;
+
+    foreach (PacketChannel *c, channels)
+    {
+        if (c->demod == demod)
+        {
+            chan = c;
+            break;
+        }
+    }
+    if (!chan)
+        return;     // channel has been removed
+
+    /* drop frames already received on this or another channel */
+    now = QDateTime::currentMSecsSinceEpoch();
+    QHash<QByteArray, qint64>::iterator it = recent_frames.begin();
+    while (it != recent_frames.end())
+    {
+        if (now - it.value() > dedup_window_ms)
+            it = recent_frames.erase(it);
+        else
+            ++it;
+    }
+
+    payload = frame.left(frame.size() - 2);
+    if (recent_frames.contains(payload))
+        return;
+    recent_frames.insert(payload, now);
+
+    kiss.sendFrame(payload, chan->port);
+
+    message = CAfsk12::formatPacket((const unsigned char *)frame.constData(),
+                                    frame.size(), CAfsk12::packetTime(time));
+    if (message.size() > 0)
+        emit newMessage(QString("%1 kHz: %2")
+                        .arg(chan->freq / 1000)
+                        .arg(message));
+}
@@ -0,0 +1,131 @@
+/* -*- c++ -*- */
+/*
+ * Gqrx SDR: Software defined radio receiver powered by GNU Radio and Qt
+ *           http://gqrx.dk/
+ *
+ * Copyright 2020 Vadym Ostanin.
+ *
+ * Gqrx is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * Gqrx is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Gqrx; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifndef PACKET_DECODER_H
+#define PACKET_DECODER_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QList>
+#include <QMap>
+#include <QMutex>
+#include <QObject>
+#include <QSettings>
+#include <QThreadPool>
+#include <QTimer>
+#include <QVector>
+
+#include "applications/gqrx/receiver.h"
+#include "applications/gqrx/kiss_server.h"
+#include "dsp/afsk1200/cafsk12.h"
+
+/*! \brief A packet radio channel handled by the PacketDecoder. */
+struct PacketChannel
+{
+    qint64          freq;       /*!< Channel frequency in Hz. */
+    int             port;       /*!< KISS port number (0-15). */
+    int             rx_id;      /*!< Receiver channel ID or -1 if out of band. */
+    CAfsk12        *demod;      /*!< AFSK1200 demodulator and HDLC deframer. */
+    QVector<float>  pending;    /*!< Samples waiting for the demodulator. */
+    double          pending_time; /*!< Sampling time of pending[0] or 0. */
+    QVector<float>  tail;       /*!< Correlator overlap from previous block. */
+    bool            scheduled;  /*!< A demodulator task is queued or running. */
+    QMutex          mutex;      /*!< Protects pending and scheduled. */
+};
+
+/*! \brief Multi-channel AFSK1200 / AX.25 decoder service.
+ *
+ * The packet decoder attaches narrow band FM channels to the wideband I/Q
+ * stream of the receiver, one for each configured frequency. The demodulated
+ * audio is fetched periodically and processed by AFSK1200 demodulators running
+ * on a thread pool, at most one worker per channel at a time.
+ *
+ * Every demodulator delivers raw HDLC frames to a common stage running in the
+ * GUI thread, which does the CRC check and drops frames that have already been
+ * received on another channel within the deduplication window. The remaining
+ * frames are sent to the KISS server and emitted as text messages. Each channel
+ * has a fixed KISS port number, so adding or removing a channel does not move
+ * the frames of the other channels to a different port.
+ *
+ * Channels outside the current I/Q bandwidth are disconnected until they get
+ * back in band.
+ */
+class PacketDecoder : public QObject
+{
+    Q_OBJECT
+public:
+    explicit PacketDecoder(receiver *rx, QObject *parent = 0);
+    ~PacketDecoder();
+
+    void readSettings(QSettings *settings);
+    void saveSettings(QSettings *settings) const;
+
+    void start(void);
+    void stop(void);
+    bool isRunning(void) const
+    {
+        return poll_timer.isActive();
+    }
+
+    void setChannels(const QMap<int, qint64> &freqs);
+    QMap<int, qint64> getChannels(void) const;
+
+    void setDedupWindow(int seconds);
+    int  getDedupWindow(void) const
+    {
+        return dedup_window_ms / 1000;
+    }
+
+    KissServer *kissServer(void)
+    {
+        return &kiss;
+    }
+
+public slots:
+    void setCenterFrequency(qint64 freq);
+
+signals:
+    void newMessage(const QString &message);
+
+private slots:
+    void pollChannels();
+    void processFrame(const QByteArray &frame, double time);
+
+private:
+    receiver       *rx;
+    KissServer      kiss;
+    QThreadPool     pool;           /*!< Worker pool running the demodulators. */
+    QTimer          poll_timer;     /*!< Timer for fetching samples. */
+    QList<PacketChannel *> channels;
+    QVector<float>  buffer;         /*!< Buffer used for fetching samples. */
+
+    QHash<QByteArray, qint64> recent_frames; /*!< Recent frames and reception time. */
+    qint64          dedup_window_ms;
+
+    qint64          center_freq;    /*!< Center of the I/Q band. */
+    double          quad_rate;      /*!< I/Q bandwidth used to check channels. */
+
+    void updateChannels(void);
+    void clearChannels(void);
+};
+
+#endif // PACKET_DECODER_H
@@ -20,6 +20,7 @@
  * the Free Software Foundation, Inc., 51 Franklin Street,
  * Boston, MA 02110-1301, USA.
  */
+#include <algorithm>
 #include <cmath>
 #include <iostream>
 #ifndef _MSC_VER
@@ -28,6 +29,9 @@
 
 #include <iostream>
 
+#include <gnuradio/block_detail.h>
+#include <gnuradio/buffer.h>
+#include <gnuradio/high_res_timer.h>
 #include <gnuradio/prefs.h>
 #include <gnuradio/top_block.h>
 #include <osmosdr/source.h>
@@ -65,17 +69,34 @@ receiver::receiver(const std::string input_device,
       d_input_rate(96000.0),
       d_audio_rate(48000),
       d_decim(decimation),
+      d_decim_engine(DECIM_ENGINE_FIR),
       d_rf_freq(144800000.0),
       d_filter_offset(0.0),
       d_cw_offset(0.0),
       d_recording_iq(false),
       d_recording_wav(false),
+      d_recording_sql(false),
       d_sniffer_active(false),
       d_iq_rev(false),
       d_dc_cancel(false),
       d_iq_balance(false),
-      d_demod(RX_DEMOD_OFF)
-{
+      d_demod(RX_DEMOD_OFF),
+      d_reconf_depth(0),
+      d_reconf_stopped(false),
+      d_reconf_ms(0.0),
+      d_reconf_count(0),
+      d_packet_chan_id(0),
+      d_offline(false),
+      d_finished(false),
+      d_file_input(false)
+{
+    /* The block executors only update the performance counters when they
+     * are enabled at the time the flow graph is started. Respect the
+     * setting if the user has configured it in the GNU Radio config.
+     */
+    gr::prefs *prefs = gr::prefs::singleton();
+    if (!prefs->has_option("PerfCounters", "on"))
+        prefs->set_bool("PerfCounters", "on", true);
 
     tb = gr::make_top_block("gqrx");
 
@@ -90,29 +111,18 @@ receiver::receiver(const std::string input_device,
 //        src = make_rtlsdrsource(0);
     }
 
-    // input decimator
-    if (d_decim >= 2)
-    {
-        try
-        {
-            input_decim = make_fir_decim_cc(d_decim);
-        }
-        catch (std::range_error &e)
-        {
-            std::cout << "Error creating input decimator " << d_decim
-                      << ": " << e.what() << std::endl
-                      << "Using decimation 1." << std::endl;
-            d_decim = 1;
-        }
+    // sample time stamps
+    src_time = make_rx_time_tagger_cc(d_input_rate);
+    d_file_input = input_device.empty() ||
+                   input_device.find("file=") != std::string::npos;
+    update_gap_detection();
 
-        d_quad_rate = d_input_rate / (double)d_decim;
-    }
-    else
-    {
-        d_quad_rate = d_input_rate;
-    }
+    // input decimator
+    create_input_decim();
 
     rx  = make_nbrx(d_quad_rate, d_audio_rate);
+    level_hist = level_history_sptr(new level_history());
+    rx->set_level_history(level_hist);
     rot = gr::blocks::rotator_cc::make(0.0);
 
     iq_swap = make_iq_swap_cc(false);
@@ -124,7 +134,7 @@ receiver::receiver(const std::string input_device,
     audio_gain1 = gr::blocks::multiply_const_ff::make(0);
     set_af_gain(DEFAULT_AUDIO_GAIN);
 
-    audio_udp_sink = make_udp_sink_f();
+    audio_udp_sink = make_udp_sink_f((int) d_audio_rate);
 
 #ifdef WITH_PULSEAUDIO
     audio_snk = make_pa_sink(audio_device, d_audio_rate, "GQRX", "Audio output");
@@ -155,6 +165,8 @@ receiver::receiver(const std::string input_device,
 receiver::~receiver()
 {
     tb->stop();
+    if (d_wait_thread.joinable())
+        d_wait_thread.join();
 }
 
 
@@ -163,7 +175,9 @@ void receiver::start()
 {
     if (!d_running)
     {
-        tb->start();
+        // a pending reconf starts the flow graph in commit_reconf()
+        if (!d_reconf_stopped)
+            tb->start();
         d_running = true;
     }
 }
@@ -173,12 +187,189 @@ void receiver::stop()
 {
     if (d_running)
     {
-        tb->stop();
-        tb->wait(); // If the graph is needed to run again, wait() must be called after stop
+        if (d_wait_thread.joinable())
+        {
+            // the wait thread returns once the flow graph has stopped
+            tb->stop();
+            d_wait_thread.join();
+        }
+        else if (!d_reconf_stopped)
+        {
+            tb->stop();
+            tb->wait(); // If the graph is needed to run again, wait() must be called after stop
+        }
         d_running = false;
     }
 }
 
+/**
+ * @brief Enable or disable offline processing.
+ *
+ * In offline mode the audio output is not connected to the sound card, so
+ * the flow graph is not paced by the audio clock. Together with an input
+ * file without throttling, e.g. "file=x.raw,rate=1e6,throttle=false,repeat=false",
+ * the receiver processes the file as fast as the CPU allows. Audio can be
+ * saved using the audio recorders, which may be started before the flow
+ * graph in this mode.
+ *
+ * The sample time stamps start at start_time, the capture time of the first
+ * sample in the file in seconds since the epoch, instead of the system
+ * clock. Use 0 if the capture time is not known.
+ */
+void receiver::set_offline(bool offline, double start_time)
+{
+    src_time->set_start_time(offline ? start_time : -1.0);
+
+    if (offline == d_offline)
+        return;
+
+    d_offline = offline;
+    update_gap_detection();
+
+    // reconnect the audio path
+    set_demod(d_demod);
+}
+
+/**
+ * @brief Start offline processing.
+ *
+ * Starts the flow graph and a thread waiting for it to finish, i.e. for the
+ * end of the input file. Use is_finished() to check for completion and
+ * stop() to clean up, which also aborts processing.
+ */
+void receiver::start_offline(void)
+{
+    if (d_running)
+        return;
+
+    d_finished = false;
+    tb->start();
+    d_running = true;
+
+    d_wait_thread = std::thread([this]() {
+        tb->wait();
+        d_finished = true;
+    });
+}
+
+/**
+ * @brief Begin a batched flow graph reconfiguration.
+ *
+ * Every setter that changes the flow graph topology stops or locks the flow
+ * graph, which means tearing down the scheduler threads and reallocating all
+ * buffers when the graph is started again. Between begin_reconf() and
+ * commit_reconf() the first such setter stops the flow graph and the following
+ * ones edit the stopped graph directly. commit_reconf() starts the flow graph
+ * again, so that a sequence of changes costs only one reconfiguration.
+ *
+ * Calls may be nested; only the outermost commit_reconf() restarts the graph.
+ */
+void receiver::begin_reconf(void)
+{
+    d_reconf_depth++;
+}
+
+/**
+ * @brief Apply the changes collected since begin_reconf().
+ * @sa begin_reconf()
+ */
+void receiver::commit_reconf(void)
+{
+    if (d_reconf_depth == 0)
+        return;
+
+    if (--d_reconf_depth > 0 || !d_reconf_stopped)
+        return;
+
+    d_reconf_stopped = false;
+    if (d_running)
+    {
+        tb->start();
+        reconf_done();
+    }
+}
+
+/**
+ * @brief Stop the flow graph before changing its topology.
+ *
+ * During a batched reconfiguration the flow graph is stopped only once and
+ * stays stopped until commit_reconf().
+ */
+void receiver::graph_stop(void)
+{
+    if (d_reconf_depth > 0)
+    {
+        if (d_reconf_stopped)
+            return;
+
+        d_reconf_stopped = true;
+    }
+
+    d_reconf_start = std::chrono::steady_clock::now();
+    if (d_running)
+    {
+        tb->stop();
+        tb->wait();
+    }
+}
+
+/** Restart the flow graph after graph_stop() unless a reconf is pending. */
+void receiver::graph_start(void)
+{
+    if (d_reconf_depth == 0 && d_running)
+    {
+        tb->start();
+        reconf_done();
+    }
+}
+
+/**
+ * @brief Record how long the flow graph was stopped for a reconfiguration.
+ *
+ * The time covers stopping the flow graph, the topology changes and starting
+ * it again, i.e. the audio dropout seen by the user. See get_reconf_stats().
+ */
+void receiver::reconf_done(void)
+{
+    std::chrono::duration<double, std::milli> elapsed =
+            std::chrono::steady_clock::now() - d_reconf_start;
+
+    d_reconf_ms = elapsed.count();
+    d_reconf_count++;
+}
+
+/**
+ * @brief Lock the flow graph for a topology change.
+ *
+ * During a batched reconfiguration the flow graph is stopped instead, see
+ * graph_stop().
+ */
+void receiver::graph_lock(void)
+{
+    if (d_reconf_depth > 0)
+        graph_stop();
+    else
+        tb->lock();
+}
+
+/** Unlock the flow graph after graph_lock(). */
+void receiver::graph_unlock(void)
+{
+    if (d_reconf_depth == 0)
+        tb->unlock();
+}
+
+/**
+ * @brief Detect lost input samples only for real time input devices.
+ *
+ * Files are read at the speed of the CPU in offline mode, and even when
+ * throttled they do not lose samples.
+ */
+void receiver::update_gap_detection(void)
+{
+    src_time->set_gap_detection(!d_offline && !d_file_input);
+}
+
 /**
  * @brief Select new input device.
  *
@@ -206,21 +397,18 @@ void receiver::set_input_device(const std::string device)
     input_devstr = device;
 
     // tb->lock() can hang occasionally
-    if (d_running)
-    {
-        tb->stop();
-        tb->wait();
-    }
+    graph_stop();
 
     if (d_decim >= 2)
     {
-        tb->disconnect(src, 0, input_decim, 0);
+        tb->disconnect(src_time, 0, input_decim, 0);
         tb->disconnect(input_decim, 0, iq_swap, 0);
     }
     else
     {
-        tb->disconnect(src, 0, iq_swap, 0);
+        tb->disconnect(src_time, 0, iq_swap, 0);
     }
+    tb->disconnect(src, 0, src_time, 0);
 
     src.reset();
 
@@ -237,18 +425,21 @@ void receiver::set_input_device(const std::string device)
     if(src->get_sample_rate() != 0)
         set_input_rate(src->get_sample_rate());
 
+    d_file_input = !error.empty() || device.find("file=") != std::string::npos;
+    update_gap_detection();
+
+    tb->connect(src, 0, src_time, 0);
     if (d_decim >= 2)
     {
-        tb->connect(src, 0, input_decim, 0);
+        tb->connect(src_time, 0, input_decim, 0);
         tb->connect(input_decim, 0, iq_swap, 0);
     }
     else
     {
-        tb->connect(src, 0, iq_swap, 0);
+        tb->connect(src_time, 0, iq_swap, 0);
     }
 
-    if (d_running)
-        tb->start();
+    graph_start();
 
     if (error != "")
     {
@@ -278,9 +469,9 @@ void receiver::set_output_device(const std::string device)
 
     output_devstr = device;
 
-    tb->lock();
+    graph_lock();
 
-    if (d_demod != RX_DEMOD_OFF)
+    if (d_demod != RX_DEMOD_OFF && !d_offline)
     {
         tb->disconnect(audio_gain0, 0, audio_snk, 0);
         tb->disconnect(audio_gain1, 0, audio_snk, 1);
@@ -295,13 +486,13 @@ void receiver::set_output_device(const std::string device)
     audio_snk = gr::audio::sink::make(d_audio_rate, device, true);
 #endif
 
-    if (d_demod != RX_DEMOD_OFF)
+    if (d_demod != RX_DEMOD_OFF && !d_offline)
     {
         tb->connect(audio_gain0, 0, audio_snk, 0);
         tb->connect(audio_gain1, 0, audio_snk, 1);
     }
 
-    tb->unlock();
+    graph_unlock();
 }
 
 /** Get a list of available antenna connectors. */
@@ -335,7 +526,7 @@ double receiver::set_input_rate(double rate)
             std::abs(rate - current_rate) < std::abs(std::min(rate, current_rate))
             * std::numeric_limits<double>::epsilon());
 
-    tb->lock();
+    graph_lock();
     d_input_rate = src->set_sample_rate(rate);
 
     if (d_input_rate == 0)
@@ -353,12 +544,15 @@ double receiver::set_input_rate(double rate)
         d_input_rate = rate;
     }
 
+    src_time->set_sample_rate(d_input_rate);
     d_quad_rate = d_input_rate / (double)d_decim;
     dc_corr->set_sample_rate(d_quad_rate);
     rx->set_quad_rate(d_quad_rate);
     iq_fft->set_quad_rate(d_quad_rate);
+    for (auto &chan : packet_chans)
+        chan.second->set_quad_rate(d_quad_rate);
     update_ddc();
-    tb->unlock();
+    graph_unlock();
 
     return d_input_rate;
 }
@@ -369,59 +563,37 @@ unsigned int receiver::set_input_decim(unsigned int decim)
     if (decim == d_decim)
         return d_decim;
 
-    if (d_running)
-    {
-        tb->stop();
-        tb->wait();
-    }
+    graph_stop();
 
     if (d_decim >= 2)
     {
-        tb->disconnect(src, 0, input_decim, 0);
+        tb->disconnect(src_time, 0, input_decim, 0);
         tb->disconnect(input_decim, 0, iq_swap, 0);
     }
     else
     {
-        tb->disconnect(src, 0, iq_swap, 0);
+        tb->disconnect(src_time, 0, iq_swap, 0);
     }
 
-    input_decim.reset();
     d_decim = decim;
-    if (d_decim >= 2)
-    {
-        try
-        {
-            input_decim = make_fir_decim_cc(d_decim);
-        }
-        catch (std::range_error &e)
-        {
-            std::cout << "Error opening creating input decimator " << d_decim
-                      << ": " << e.what() << std::endl
-                      << "Using decimation 1." << std::endl;
-            d_decim = 1;
-        }
-
-        d_quad_rate = d_input_rate / (double)d_decim;
-    }
-    else
-    {
-        d_quad_rate = d_input_rate;
-    }
+    create_input_decim();
 
     // update quadrature rate
     dc_corr->set_sample_rate(d_quad_rate);
     rx->set_quad_rate(d_quad_rate);
     iq_fft->set_quad_rate(d_quad_rate);
+    for (auto &chan : packet_chans)
+        chan.second->set_quad_rate(d_quad_rate);
     update_ddc();
 
     if (d_decim >= 2)
     {
-        tb->connect(src, 0, input_decim, 0);
+        tb->connect(src_time, 0, input_decim, 0);
         tb->connect(input_decim, 0, iq_swap, 0);
     }
     else
     {
-        tb->connect(src, 0, iq_swap, 0);
+        tb->connect(src_time, 0, iq_swap, 0);
     }
 
 #ifdef CUSTOM_AIRSPY_KERNELS
@@ -429,12 +601,92 @@ unsigned int receiver::set_input_decim(unsigned int decim)
         src->set_bandwidth(d_quad_rate);
 #endif
 
-    if (d_running)
-        tb->start();
+    graph_start();
 
     return d_decim;
 }
 
+/**
+ * @brief Select input decimation filter implementation.
+ * @param engine The new decimation engine.
+ *
+ * The input decimator is the first block running at the full input rate, so
+ * its efficiency sets the upper limit for usable sample rates.
+ */
+void receiver::set_input_decim_engine(decim_engine engine)
+{
+    unsigned int decim = d_decim;
+
+    if (engine == d_decim_engine)
+        return;
+
+    d_decim_engine = engine;
+    if (decim < 2)
+        return;
+
+    graph_stop();
+
+    tb->disconnect(src_time, 0, input_decim, 0);
+    tb->disconnect(input_decim, 0, iq_swap, 0);
+
+    create_input_decim();
+    if (d_decim >= 2)
+    {
+        tb->connect(src_time, 0, input_decim, 0);
+        tb->connect(input_decim, 0, iq_swap, 0);
+    }
+    else
+    {
+        tb->connect(src_time, 0, iq_swap, 0);
+    }
+
+    if (d_decim != decim)
+    {
+        // new engine did not support the decimation
+        dc_corr->set_sample_rate(d_quad_rate);
+        rx->set_quad_rate(d_quad_rate);
+        iq_fft->set_quad_rate(d_quad_rate);
+        for (auto &chan : packet_chans)
+            chan.second->set_quad_rate(d_quad_rate);
+        update_ddc();
+    }
+
+    graph_start();
+}
+
+/**
+ * @brief Create input decimator for the current decimation.
+ *
+ * Falls back to decimation 1 if the decimation is not supported by the
+ * selected engine. Updates the quadrature rate.
+ */
+void receiver::create_input_decim()
+{
+    input_decim.reset();
+    if (d_decim >= 2)
+    {
+        try
+        {
+            if (d_decim_engine == DECIM_ENGINE_HBF)
+                input_decim = make_hbf_decim(d_decim);
+            else
+                input_decim = make_fir_decim_cc(d_decim);
+        }
+        catch (std::range_error &e)
+        {
+            std::cout << "Error creating input decimator " << d_decim
+                      << ": " << e.what() << std::endl
+                      << "Using decimation 1." << std::endl;
+            d_decim = 1;
+        }
+    }
+
+    if (d_decim >= 2)
+        d_quad_rate = d_input_rate / (double)d_decim;
+    else
+        d_quad_rate = d_input_rate;
+}
+
 /**
  * @brief Set new analog bandwidth.
  * @param bw The new bandwidth.
@@ -531,6 +783,11 @@ bool receiver::get_iq_balance(void) const
  */
 receiver::status receiver::set_rf_freq(double freq_hz)
 {
+    // Moving the channel filter also sets the RF frequency; skip the retune
+    // and PLL settling if the device is already tuned there.
+    if (freq_hz == d_rf_freq && freq_hz == src->get_center_freq())
+        return STATUS_OK;
+
     d_rf_freq = freq_hz;
 
     src->set_center_freq(d_rf_freq);
@@ -729,6 +986,17 @@ float receiver::get_signal_pwr(bool dbfs) const
     return rx->get_signal_level(dbfs);
 }
 
+/**
+ * @brief Set the resolution of the signal level history.
+ * @param interval The length of the finest buckets in seconds.
+ *
+ * The history is cleared when the interval changes.
+ */
+void receiver::set_level_history_interval(double interval)
+{
+    level_hist->set_interval(interval);
+}
+
 /** Set new FFT size. */
 void receiver::set_iq_fft_size(int newsize)
 {
@@ -746,6 +1014,36 @@ void receiver::get_iq_fft_data(std::complex<float>* fftPoints, unsigned int &fft
     iq_fft->get_fft_data(fftPoints, fftsize);
 }
 
+/**
+ * @brief Compute the baseband FFT only over the displayed span.
+ * @param center The center of the span relative to the RF frequency in Hz.
+ * @param span The span in Hz, 0 to compute the FFT over the full bandwidth.
+ */
+void receiver::set_iq_fft_zoom(double center, double span)
+{
+    iq_fft->set_zoom(center, span);
+}
+
+/**
+ * @brief Get the part of the spectrum covered by the baseband FFT data.
+ * @param center The center relative to the RF frequency in Hz (output).
+ * @param rate The bandwidth in Hz (output).
+ */
+void receiver::get_iq_fft_range(double &center, double &rate)
+{
+    iq_fft->get_zoom(center, rate);
+}
+
+/**
+ * @brief Get the number of baseband spectra computed so far.
+ *
+ * Unchanged if get_iq_fft_data() returned a repeated spectrum.
+ */
+unsigned long receiver::get_iq_fft_count(void)
+{
+    return iq_fft->get_fft_count();
+}
+
 /** Get latest audio FFT data. */
 void receiver::get_audio_fft_data(std::complex<float>* fftPoints, unsigned int &fftsize)
 {
@@ -858,11 +1156,7 @@ receiver::status receiver::set_demod(rx_demod demod)
     //    return ret;
 
     // tb->lock() seems to hang occasioanlly
-    if (d_running)
-    {
-        tb->stop();
-        tb->wait();
-    }
+    graph_stop();
 
     tb->disconnect_all();
 
@@ -914,8 +1208,7 @@ receiver::status receiver::set_demod(rx_demod demod)
 
     d_demod = demod;
 
-    if (d_running)
-        tb->start();
+    graph_start();
 
     return ret;
 }
@@ -961,6 +1254,182 @@ receiver::status receiver::set_af_gain(float gain_db)
     return STATUS_OK;
 }
 
+/**
+ * @brief Get the latency of the audio output.
+ * @return The latency in seconds or 0 if the audio backend does not
+ *         report it.
+ */
+double receiver::get_audio_latency(void)
+{
+#if defined(WITH_PULSEAUDIO) || defined(WITH_PORTAUDIO)
+    return audio_snk->get_latency();
+#else
+    return 0.0;
+#endif
+}
+
+/** @brief Get the number of audio output underruns. */
+unsigned long receiver::get_audio_underruns(void)
+{
+#if defined(WITH_PULSEAUDIO) || defined(WITH_PORTAUDIO)
+    return audio_snk->get_underruns();
+#else
+    return 0;
+#endif
+}
+
+/**
+ * @brief Get the clock drift between the input device and the sound card.
+ * @return The drift in ppm compensated by the audio output, or 0 if the
+ *         audio backend does not compensate drift.
+ */
+double receiver::get_audio_drift(void)
+{
+#if defined(WITH_PULSEAUDIO) || defined(WITH_PORTAUDIO)
+    return audio_snk->get_drift_ppm();
+#else
+    return 0.0;
+#endif
+}
+
+/**
+ * @brief Get runtime statistics of the blocks in the flow graph.
+ * @param stats Vector where the statistics are returned.
+ *
+ * The blocks are found by following the stream buffers from the FFT taps,
+ * so this also covers the blocks inside the hierarchical blocks. Load and
+ * throughput are averaged since the previous call. The load is taken from
+ * the GNU Radio performance counters and is reported as -1 when GNU Radio
+ * was built without them. The blocks are sorted with the heaviest first.
+ */
+void receiver::get_block_stats(block_stats_list_t &stats)
+{
+    std::vector<gr::block_sptr>         pending;
+    std::map<long, gr::block_sptr>      blocks;
+    std::map<long, block_sample>        samples;
+    std::chrono::steady_clock::time_point now;
+    double      dt, tps;
+    bool        have_pc = false;
+
+    stats.clear();
+    if (!d_running)
+    {
+        d_stats_prev.clear();
+        return;
+    }
+
+    pending.push_back(iq_fft);
+    pending.push_back(audio_fft);
+    while (!pending.empty())
+    {
+        gr::block_sptr blk = pending.back();
+        pending.pop_back();
+
+        if (!blk || !blk->detail() || blocks.count(blk->unique_id()))
+            continue;
+
+        blocks[blk->unique_id()] = blk;
+
+        gr::block_detail_sptr detail = blk->detail();
+        for (int i = 0; i < detail->ninputs(); i++)
+            pending.push_back(detail->input(i)->buffer()->link());
+        for (int i = 0; i < detail->noutputs(); i++)
+        {
+            gr::buffer_sptr buf = detail->output(i);
+            for (size_t j = 0; j < buf->nreaders(); j++)
+                pending.push_back(buf->reader(j)->link());
+        }
+    }
+
+    now = std::chrono::steady_clock::now();
+    dt = std::chrono::duration<double>(now - d_stats_time).count();
+    tps = (double)gr::high_res_timer_tps();
+
+    for (auto &it : blocks)
+    {
+        gr::block_sptr       blk = it.second;
+        gr::block_detail_sptr detail = blk->detail();
+        block_stats_t        st;
+        block_sample         smp;
+
+        smp.work_time = blk->pc_work_time_total();
+        smp.nitems = detail->noutputs() > 0 ? blk->nitems_written(0) :
+                                              blk->nitems_read(0);
+        if (smp.work_time > 0.0)
+            have_pc = true;
+
+        st.name = blk->alias();
+        st.load = 0.0;
+        st.rate = 0.0;
+        st.buffer_full = 0.0f;
+
+        auto prev = d_stats_prev.find(it.first);
+        /* counters start over when the flow graph is restarted */
+        if (prev != d_stats_prev.end() && dt > 0.0 &&
+            smp.nitems >= prev->second.nitems &&
+            smp.work_time >= prev->second.work_time)
+        {
+            st.load = (smp.work_time - prev->second.work_time) / tps / dt;
+            st.rate = (smp.nitems - prev->second.nitems) / dt;
+        }
+
+        for (int i = 0; i < detail->ninputs(); i++)
+        {
+            gr::buffer_reader_sptr reader = detail->input(i);
+            float full = (float)reader->items_available() /
+                         (float)reader->buffer()->bufsize();
+            st.buffer_full = std::max(st.buffer_full, full);
+        }
+
+        samples[it.first] = smp;
+        stats.push_back(st);
+    }
+
+    if (!have_pc)
+        for (auto &st : stats)
+            st.load = -1.0;
+
+    /* without load figures the block with the fullest input buffers is
+     * the one that does not keep up
+     */
+    std::sort(stats.begin(), stats.end(),
+              [](const block_stats_t &a, const block_stats_t &b) {
+                  if (a.load != b.load)
+                      return a.load > b.load;
+                  return a.buffer_full > b.buffer_full;
+              });
+
+    d_stats_prev.swap(samples);
+    d_stats_time = now;
+}
+
+/**
+ * @brief Get the statistics of the samples received from the input device.
+ * @param samples The number of samples received.
+ * @param lost The number of samples lost by the device or the driver.
+ * @param gaps The number of gaps in the input stream.
+ * @param last_gap The time of the last gap in seconds since the epoch or 0.
+ *
+ * The statistics are kept since the receiver was created.
+ */
+void receiver::get_input_stats(uint64_t &samples, uint64_t &lost,
+                               unsigned long &gaps, double &last_gap)
+{
+    src_time->get_stats(samples, lost, gaps, last_gap);
+}
+
+/**
+ * @brief Get flow graph restart statistics.
+ * @param count The number of times the flow graph was stopped and restarted
+ *              for a reconfiguration, e.g. a demodulator change.
+ * @param last_ms The duration of the last restart in milliseconds.
+ */
+void receiver::get_reconf_stats(unsigned long &count, double &last_ms)
+{
+    count = d_reconf_count;
+    last_ms = d_reconf_ms;
+}
+
 
 /**
  * @brief Start WAV file recorder.
@@ -973,14 +1442,14 @@ receiver::status receiver::set_af_gain(float gain_db)
  */
 receiver::status receiver::start_audio_recording(const std::string filename)
 {
-    if (d_recording_wav)
+    if (d_recording_wav || d_recording_sql)
     {
         /* error - we are already recording */
         std::cout << "ERROR: Can not start audio recorder (already recording)" << std::endl;
 
         return STATUS_ERROR;
     }
-    if (!d_running)
+    if (!d_running && !d_offline)
     {
         /* receiver is not running */
         std::cout << "Can not start audio recorder (receiver not running)" << std::endl;
@@ -999,10 +1468,10 @@ receiver::status receiver::start_audio_recording(const std::string filename)
         return STATUS_ERROR;
     }
 
-    tb->lock();
+    graph_lock();
     tb->connect(rx, 0, wav_sink, 0);
     tb->connect(rx, 1, wav_sink, 1);
-    tb->unlock();
+    graph_unlock();
     d_recording_wav = true;
 
     std::cout << "Recording audio to " << filename << std::endl;
@@ -1010,16 +1479,72 @@ receiver::status receiver::start_audio_recording(const std::string filename)
     return STATUS_OK;
 }
 
-/** Stop WAV file recorder. */
+/**
+ * @brief Start squelch triggered audio recorder.
+ * @param dir The directory where the recordings are stored.
+ * @param preroll_ms Length of audio recorded before the squelch opens.
+ * @param hang_ms Time after the squelch closes before a file is closed.
+ *
+ * A new WAV file is created for each transmission, i.e. each time the
+ * squelch opens. The file names contain the label set using
+ * set_audio_rec_label(). Use stop_audio_recording() to stop.
+ */
+receiver::status receiver::start_sql_recording(const std::string dir,
+                                               int preroll_ms, int hang_ms)
+{
+    if (d_recording_wav || d_recording_sql)
+    {
+        /* error - we are already recording */
+        std::cout << "ERROR: Can not start audio recorder (already recording)" << std::endl;
+
+        return STATUS_ERROR;
+    }
+    if (!d_running && !d_offline)
+    {
+        /* receiver is not running */
+        std::cout << "Can not start audio recorder (receiver not running)" << std::endl;
+
+        return STATUS_ERROR;
+    }
+
+    sql_rec = make_sql_recorder_ff(dir, (int) d_audio_rate, preroll_ms, hang_ms);
+    sql_rec->set_label(d_audio_rec_label);
+    sql_rec->set_sql_open(rx->is_sql_open());
+
+    graph_lock();
+    tb->connect(rx, 0, sql_rec, 0);
+    tb->connect(rx, 1, sql_rec, 1);
+    graph_unlock();
+    d_recording_sql = true;
+
+    std::cout << "Recording transmissions to " << dir << std::endl;
+
+    return STATUS_OK;
+}
+
+/** Set label used in the file names of squelch triggered recordings. */
+void receiver::set_audio_rec_label(const std::string label)
+{
+    d_audio_rec_label = label;
+    if (sql_rec)
+        sql_rec->set_label(label);
+}
+
+/**
+ * @brief Stop WAV file recorder.
+ *
+ * In offline mode the recorder may also be stopped after the flow graph,
+ * which ensures that all audio up to the end of the input file is written.
+ */
 receiver::status receiver::stop_audio_recording()
 {
-    if (!d_recording_wav) {
+    if (!d_recording_wav && !d_recording_sql) {
         /* error: we are not recording */
         std::cout << "ERROR: Can not stop audio recorder (not recording)" << std::endl;
 
         return STATUS_ERROR;
     }
-    if (!d_running)
+    if (!d_running && !d_offline)
     {
         /* receiver is not running */
         std::cout << "Can not stop audio recorder (receiver not running)" << std::endl;
@@ -1027,12 +1552,27 @@ receiver::status receiver::stop_audio_recording()
         return STATUS_ERROR;
     }
 
+    if (d_recording_sql)
+    {
+        graph_lock();
+        sql_rec->close();
+        tb->disconnect(rx, 0, sql_rec, 0);
+        tb->disconnect(rx, 1, sql_rec, 1);
+        graph_unlock();
+        sql_rec.reset();
+        d_recording_sql = false;
+
+        std::cout << "Audio recorder stopped" << std::endl;
+
+        return STATUS_OK;
+    }
+
     // not strictly necessary to lock but I think it is safer
-    tb->lock();
+    graph_lock();
     wav_sink->close();
     tb->disconnect(rx, 0, wav_sink, 0);
     tb->disconnect(rx, 1, wav_sink, 1);
-    tb->unlock();
+    graph_unlock();
     wav_sink.reset();
     d_recording_wav = false;
 
@@ -1080,7 +1620,7 @@ receiver::status receiver::start_audio_playback(const std::string filename)
         return STATUS_ERROR;
     }
 
-    stop();
+    graph_stop();
     /* route demodulator output to null sink */
     tb->disconnect(rx, 0, audio_gain0, 0);
     tb->disconnect(rx, 1, audio_gain1, 0);
@@ -1094,7 +1634,7 @@ receiver::status receiver::start_audio_playback(const std::string filename)
     tb->connect(wav_src, 0, audio_fft, 0);
     tb->connect(wav_src, 0, audio_udp_sink, 0);
     tb->connect(wav_src, 1, audio_udp_sink, 1);
-    start();
+    graph_start();
 
     std::cout << "Playing audio from " << filename << std::endl;
 
@@ -1105,7 +1645,7 @@ receiver::status receiver::start_audio_playback(const std::string filename)
 receiver::status receiver::stop_audio_playback()
 {
     /* disconnect wav source and reconnect receiver */
-    stop();
+    graph_stop();
     tb->disconnect(wav_src, 0, audio_gain0, 0);
     tb->disconnect(wav_src, 1, audio_gain1, 0);
     tb->disconnect(wav_src, 0, audio_fft, 0);
@@ -1118,7 +1658,7 @@ receiver::status receiver::stop_audio_playback()
     tb->connect(rx, 0, audio_fft, 0);  /** FIXME: other channel? */
     tb->connect(rx, 0, audio_udp_sink, 0);
     tb->connect(rx, 1, audio_udp_sink, 1);
-    start();
+    graph_start();
 
     /* delete wav_src since we can not change file name */
     wav_src.reset();
@@ -1127,9 +1667,12 @@ receiver::status receiver::stop_audio_playback()
 }
 
 /** Start UDP streaming of audio. */
-receiver::status receiver::start_udp_streaming(const std::string host, int port, bool stereo)
+receiver::status receiver::start_udp_streaming(const std::string host, int port, bool stereo,
+                                               int format)
 {
-    audio_udp_sink->start_streaming(host, port, stereo);
+    if (!audio_udp_sink->start_streaming(host, port, stereo, format))
+        return STATUS_ERROR;
+
     return STATUS_OK;
 }
 
@@ -1140,6 +1683,12 @@ receiver::status receiver::stop_udp_streaming()
     return STATUS_OK;
 }
 
+/** Set the frequency sent with framed UDP audio. */
+void receiver::set_udp_stream_freq(int64_t freq_hz)
+{
+    audio_udp_sink->set_frequency(freq_hz);
+}
+
 /**
  * @brief Start I/Q data recorder.
  * @param filename The filename where to record.
@@ -1163,13 +1712,22 @@ receiver::status receiver::start_iq_recording(const std::string filename)
         return STATUS_ERROR;
     }
 
-    tb->lock();
+    /* gap markers are written next to the recording */
+    iq_gap_log = make_gap_logger_c(filename + ".gaps", d_quad_rate);
+
+    graph_lock();
     if (d_decim >= 2)
+    {
         tb->connect(input_decim, 0, iq_sink, 0);
+        tb->connect(input_decim, 0, iq_gap_log, 0);
+    }
     else
-        tb->connect(src, 0, iq_sink, 0);
+    {
+        tb->connect(src_time, 0, iq_sink, 0);
+        tb->connect(src_time, 0, iq_gap_log, 0);
+    }
     d_recording_iq = true;
-    tb->unlock();
+    graph_unlock();
 
     return status;
 }
@@ -1182,16 +1740,24 @@ receiver::status receiver::stop_iq_recording()
         return STATUS_ERROR;
     }
 
-    tb->lock();
+    graph_lock();
     iq_sink->close();
+    iq_gap_log->close();
 
     if (d_decim >= 2)
+    {
         tb->disconnect(input_decim, 0, iq_sink, 0);
+        tb->disconnect(input_decim, 0, iq_gap_log, 0);
+    }
     else
-        tb->disconnect(src, 0, iq_sink, 0);
+    {
+        tb->disconnect(src_time, 0, iq_sink, 0);
+        tb->disconnect(src_time, 0, iq_gap_log, 0);
+    }
 
-    tb->unlock();
+    graph_unlock();
     iq_sink.reset();
+    iq_gap_log.reset();
     d_recording_iq = false;
 
     return STATUS_OK;
@@ -1205,7 +1771,7 @@ receiver::status receiver::seek_iq_file(long pos)
 {
     receiver::status status = STATUS_OK;
 
-    tb->lock();
+    graph_lock();
 
     if (src->seek(pos, SEEK_SET))
     {
@@ -1216,7 +1782,7 @@ receiver::status receiver::seek_iq_file(long pos)
         status = STATUS_ERROR;
     }
 
-    tb->unlock();
+    graph_unlock();
 
     return status;
 }
@@ -1234,11 +1800,12 @@ receiver::status receiver::start_sniffer(unsigned int samprate, int buffsize)
     }
 
     sniffer->set_buffer_size(buffsize);
+    sniffer->set_sample_rate(samprate);
     sniffer_rr = make_resampler_ff((float)samprate/(float)d_audio_rate);
-    tb->lock();
+    graph_lock();
     tb->connect(rx, 0, sniffer_rr, 0);
     tb->connect(sniffer_rr, 0, sniffer, 0);
-    tb->unlock();
+    graph_unlock();
     d_sniffer_active = true;
 
     return STATUS_OK;
@@ -1254,10 +1821,10 @@ receiver::status receiver::stop_sniffer()
         return STATUS_ERROR;
     }
 
-    tb->lock();
+    graph_lock();
     tb->disconnect(rx, 0, sniffer_rr, 0);
     tb->disconnect(sniffer_rr, 0, sniffer, 0);
-    tb->unlock();
+    graph_unlock();
     d_sniffer_active = false;
 
     /* delete resampler */
@@ -1272,13 +1839,112 @@ void receiver::get_sniffer_data(float * outbuff, unsigned int &num)
     sniffer->get_samples(outbuff, num);
 }
 
+/**
+ * @brief Get sniffer data and the time of the first sample.
+ * @param time The time in seconds since the epoch or 0 if not known.
+ *
+ * The time is derived from the rx_time tags of the input samples.
+ */
+void receiver::get_sniffer_data(float * outbuff, unsigned int &num,
+                                double &time)
+{
+    sniffer->get_samples(outbuff, num, time);
+}
+
+/**
+ * @brief Add a packet radio channel.
+ * @param offset_hz The channel offset from the center of the I/Q band.
+ * @return The ID of the new channel.
+ *
+ * A packet radio channel is an FM demodulator tapping the pre-processed I/Q
+ * stream in parallel with the main receiver. The demodulated audio is
+ * resampled to 22050 Hz and can be fetched with get_packet_channel_data()
+ * in the same way as get_sniffer_data().
+ */
+int receiver::add_packet_channel(double offset_hz)
+{
+    packet_chan_c_sptr chan;
+
+    chan = make_packet_chan_c(d_quad_rate, offset_hz, 22050.0, 48000);
+    packet_chans[++d_packet_chan_id] = chan;
+
+    graph_lock();
+    tb->connect(iq_tap(), 0, chan, 0);
+    graph_unlock();
+
+    return d_packet_chan_id;
+}
+
+/**
+ * @brief Remove a packet radio channel.
+ * @param id The channel ID returned by add_packet_channel().
+ * @return STATUS_ERROR if the channel does not exist.
+ */
+receiver::status receiver::remove_packet_channel(int id)
+{
+    std::map<int, packet_chan_c_sptr>::iterator it = packet_chans.find(id);
+
+    if (it == packet_chans.end())
+        return STATUS_ERROR;
+
+    graph_lock();
+    tb->disconnect(iq_tap(), 0, it->second, 0);
+    graph_unlock();
+    packet_chans.erase(it);
+
+    return STATUS_OK;
+}
+
+/**
+ * @brief Set new offset of a packet radio channel.
+ * @param id The channel ID returned by add_packet_channel().
+ * @param offset_hz The channel offset from the center of the I/Q band.
+ * @return STATUS_ERROR if the channel does not exist.
+ */
+receiver::status receiver::set_packet_channel_offset(int id, double offset_hz)
+{
+    std::map<int, packet_chan_c_sptr>::iterator it = packet_chans.find(id);
+
+    if (it == packet_chans.end())
+        return STATUS_ERROR;
+
+    it->second->set_offset(offset_hz);
+
+    return STATUS_OK;
+}
+
+/** Get demodulated samples from a packet radio channel. */
+void receiver::get_packet_channel_data(int id, float * outbuff, unsigned int &num)
+{
+    std::map<int, packet_chan_c_sptr>::iterator it = packet_chans.find(id);
+
+    if (it == packet_chans.end())
+        num = 0;
+    else
+        it->second->get_samples(outbuff, num);
+}
+
+/** Get demodulated samples and the time of the first sample. */
+void receiver::get_packet_channel_data(int id, float * outbuff, unsigned int &num,
+                                       double &time)
+{
+    std::map<int, packet_chan_c_sptr>::iterator it = packet_chans.find(id);
+
+    time = 0.0;
+    if (it == packet_chans.end())
+        num = 0;
+    else
+        it->second->get_samples(outbuff, num, time);
+}
+
 /** Convenience function to connect all blocks. */
 void receiver::connect_all(rx_chain type)
 {
     gr::basic_block_sptr b;
 
     // Setup source
-    b = src;
+    tb->connect(src, 0, src_time, 0);
+    b = src_time;
 
     // Pre-processing
     if (d_decim >= 2)
@@ -1291,6 +1957,7 @@ void receiver::connect_all(rx_chain type)
     {
         // We record IQ with minimal pre-processing
         tb->connect(b, 0, iq_sink, 0);
+        tb->connect(b, 0, iq_gap_log, 0);
     }
 
     tb->connect(b, 0, iq_swap, 0);
@@ -1305,6 +1972,10 @@ void receiver::connect_all(rx_chain type)
     // Visualization
     tb->connect(b, 0, iq_fft, 0);
 
+    // Packet radio channels
+    for (auto &chan : packet_chans)
+        tb->connect(b, 0, chan.second, 0);
+
     // RX demod chain
     switch (type)
     {
@@ -1313,6 +1984,7 @@ void receiver::connect_all(rx_chain type)
         {
             rx.reset();
             rx = make_nbrx(d_quad_rate, d_audio_rate);
+            rx->set_level_history(level_hist);
         }
         break;
 
@@ -1321,6 +1993,7 @@ void receiver::connect_all(rx_chain type)
         {
             rx.reset();
             rx = make_wfmrx(d_quad_rate, d_audio_rate);
+            rx->set_level_history(level_hist);
         }
         break;
 
@@ -1336,10 +2009,13 @@ void receiver::connect_all(rx_chain type)
         tb->connect(rx, 0, audio_fft, 0);
         tb->connect(rx, 0, audio_udp_sink, 0);
         tb->connect(rx, 1, audio_udp_sink, 1);
-        tb->connect(rx, 0, audio_gain0, 0);
-        tb->connect(rx, 1, audio_gain1, 0);
-        tb->connect(audio_gain0, 0, audio_snk, 0);
-        tb->connect(audio_gain1, 0, audio_snk, 1);
+        if (!d_offline)
+        {
+            tb->connect(rx, 0, audio_gain0, 0);
+            tb->connect(rx, 1, audio_gain1, 0);
+            tb->connect(audio_gain0, 0, audio_snk, 0);
+            tb->connect(audio_gain1, 0, audio_snk, 1);
+        }
     }
 
     // Recorders and sniffers
@@ -1349,6 +2025,13 @@ void receiver::connect_all(rx_chain type)
         tb->connect(rx, 1, wav_sink, 1);
     }
 
+    if (d_recording_sql)
+    {
+        tb->connect(rx, 0, sql_rec, 0);
+        tb->connect(rx, 1, sql_rec, 1);
+        sql_rec->set_sql_open(rx->is_sql_open());
+    }
+
     if (d_sniffer_active)
     {
         tb->connect(rx, 0, sniffer_rr, 0);
@@ -1356,6 +2039,15 @@ void receiver::connect_all(rx_chain type)
     }
 }
 
+/** The last pre-processing block, i.e. where the demodulators are connected. */
+gr::basic_block_sptr receiver::iq_tap(void) const
+{
+    if (d_dc_cancel)
+        return dc_corr;
+
+    return iq_swap;
+}
+
 /** Convenience function to update all DDC related components. */
 void receiver::update_ddc()
 {
@@ -1369,16 +2061,16 @@ void receiver::get_rds_data(std::string &outbuff, int &num)
 
 void receiver::start_rds_decoder(void)
 {
-    stop();
+    graph_stop();
     rx->start_rds_decoder();
-    start();
+    graph_start();
 }
 
 void receiver::stop_rds_decoder(void)
 {
-    stop();
+    graph_stop();
     rx->stop_rds_decoder();
-    start();
+    graph_start();
 }
 
 bool receiver::is_rds_decoder_active(void) const
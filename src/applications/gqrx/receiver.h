@@ -36,10 +36,17 @@
 #include <gnuradio/blocks/wavfile_source.h>
 #include <gnuradio/top_block.h>
 #include <osmosdr/source.h>
+#include <atomic>
+#include <chrono>
+#include <map>
 #include <string>
+#include <thread>
 
+#include "applications/gqrx/block_stats.h"
 #include "dsp/correct_iq_cc.h"
 #include "dsp/filter/fir_decim.h"
+#include "dsp/gap_logger_c.h"
+#include "dsp/hbf_decim.h"
 #include "dsp/rx_noise_blanker_cc.h"
 #include "dsp/rx_filter.h"
 #include "dsp/rx_meter.h"
@@ -47,7 +54,10 @@
 #include "dsp/rx_demod_fm.h"
 #include "dsp/rx_demod_am.h"
 #include "dsp/rx_fft.h"
+#include "dsp/rx_time_tagger_cc.h"
+#include "dsp/packet_chan.h"
 #include "dsp/sniffer_f.h"
+#include "dsp/sql_recorder_ff.h"
 #include "dsp/resampler_xx.h"
 #include "interfaces/udp_sink_f.h"
 #include "receivers/receiver_base.h"
@@ -102,6 +112,12 @@ public:
         RX_CHAIN_WFMRX = 2    /*!< Wide band FM receiver (for broadcast). */
     };
 
+    /** Input decimation filter implementation. */
+    enum decim_engine {
+        DECIM_ENGINE_FIR = 0,   /*!< Multi-stage FIR filter (fir_decim_cc). */
+        DECIM_ENGINE_HBF = 1    /*!< Polyphase half-band filters (hbf_decim). */
+    };
+
     /** Filter shape (convenience wrappers for "transition width"). */
     enum filter_shape {
         FILTER_SHAPE_SOFT = 0,   /*!< Soft: Transition band is TBD of width. */
@@ -116,6 +132,15 @@ public:
 
     void        start();
     void        stop();
+
+    /* offline processing */
+    void        set_offline(bool offline, double start_time = 0.0);
+    void        start_offline(void);
+    bool        is_finished(void) const { return d_finished; }
+
+    /* batched reconfiguration */
+    void        begin_reconf(void);
+    void        commit_reconf(void);
     void        set_input_device(const std::string device);
     void        set_output_device(const std::string device);
 
@@ -128,6 +153,9 @@ public:
     unsigned int    set_input_decim(unsigned int decim);
     unsigned int    get_input_decim(void) const { return d_decim; }
 
+    void            set_input_decim_engine(decim_engine engine);
+    decim_engine    get_input_decim_engine(void) const { return d_decim_engine; }
+
     double      get_quad_rate(void) const {
         return d_input_rate / (double)d_decim;
     }
@@ -162,10 +190,15 @@ public:
     status      set_filter(double low, double high, filter_shape shape);
     status      set_freq_corr(double ppm);
     float       get_signal_pwr(bool dbfs) const;
+    void        set_level_history_interval(double interval);
+    level_history_sptr get_level_history(void) const { return level_hist; }
     void        set_iq_fft_size(int newsize);
     void        set_iq_fft_window(int window_type);
     void        get_iq_fft_data(std::complex<float>* fftPoints,
                                 unsigned int &fftsize);
+    void        set_iq_fft_zoom(double center, double span);
+    void        get_iq_fft_range(double &center, double &rate);
+    unsigned long get_iq_fft_count(void);
     void        get_audio_fft_data(std::complex<float>* fftPoints,
                                    unsigned int &fftsize);
 
@@ -196,13 +229,27 @@ public:
 
     /* Audio parameters */
     status      set_af_gain(float gain_db);
+    double      get_audio_latency(void);
+    unsigned long get_audio_underruns(void);
+    double      get_audio_drift(void);
+
+    /* Performance counters */
+    void        get_block_stats(block_stats_list_t &stats);
+    void        get_input_stats(uint64_t &samples, uint64_t &lost,
+                                unsigned long &gaps, double &last_gap);
+    void        get_reconf_stats(unsigned long &count, double &last_ms);
     status      start_audio_recording(const std::string filename);
+    status      start_sql_recording(const std::string dir, int preroll_ms,
+                                    int hang_ms);
     status      stop_audio_recording();
+    void        set_audio_rec_label(const std::string label);
     status      start_audio_playback(const std::string filename);
     status      stop_audio_playback();
 
-    status      start_udp_streaming(const std::string host, int port, bool stereo);
+    status      start_udp_streaming(const std::string host, int port, bool stereo,
+                                    int format = udp_sink_f::FORMAT_RAW);
     status      stop_udp_streaming();
+    void        set_udp_stream_freq(int64_t freq_hz);
 
     /* I/Q recording and playback */
     status      start_iq_recording(const std::string filename);
@@ -213,10 +260,19 @@ public:
     status      start_sniffer(unsigned int samplrate, int buffsize);
     status      stop_sniffer();
     void        get_sniffer_data(float * outbuff, unsigned int &num);
+    void        get_sniffer_data(float * outbuff, unsigned int &num, double &time);
 
-    bool        is_recording_audio(void) const { return d_recording_wav; }
+    bool        is_recording_audio(void) const { return d_recording_wav || d_recording_sql; }
     bool        is_snifffer_active(void) const { return d_sniffer_active; }
 
+    /* packet radio channels */
+    int         add_packet_channel(double offset_hz);
+    status      remove_packet_channel(int id);
+    status      set_packet_channel_offset(int id, double offset_hz);
+    void        get_packet_channel_data(int id, float * outbuff, unsigned int &num);
+    void        get_packet_channel_data(int id, float * outbuff, unsigned int &num,
+                                        double &time);
+
     /* rds functions */
     void        get_rds_data(std::string &outbuff, int &num);
     void        start_rds_decoder(void);
@@ -226,7 +282,21 @@ public:
 
 private:
     void        connect_all(rx_chain type);
+    void        graph_stop(void);
+    void        graph_start(void);
+    void        graph_lock(void);
+    void        graph_unlock(void);
+    void        reconf_done(void);
+    void        update_gap_detection(void);
+    void        create_input_decim();
     void        update_ddc();
+    gr::basic_block_sptr iq_tap(void) const;
+
+    /** Previous counter sample of a block, see get_block_stats(). */
+    struct block_sample {
+        double      work_time;   /*!< pc_work_time_total() in timer ticks. */
+        uint64_t    nitems;      /*!< Items produced or consumed. */
+    };
 
 private:
     bool        d_running;          /*!< Whether receiver is running or not. */
@@ -234,11 +304,13 @@ private:
     double      d_quad_rate;        /*!< Quadrature rate (input_rate / decim) */
     double      d_audio_rate;       /*!< Audio output rate. */
     unsigned int    d_decim;        /*!< input decimation. */
+    decim_engine    d_decim_engine; /*!< input decimation filter type. */
     double      d_rf_freq;          /*!< Current RF frequency. */
     double      d_filter_offset;    /*!< Current filter offset */
     double      d_cw_offset;        /*!< CW offset */
     bool        d_recording_iq;     /*!< Whether we are recording I/Q file. */
     bool        d_recording_wav;    /*!< Whether we are recording WAV file. */
+    bool        d_recording_sql;    /*!< Whether we are recording transmissions. */
     bool        d_sniffer_active;   /*!< Only one data decoder allowed. */
     bool        d_iq_rev;           /*!< Whether I/Q is reversed or not. */
     bool        d_dc_cancel;        /*!< Enable automatic DC removal. */
@@ -246,13 +318,22 @@ private:
 
     std::string input_devstr;  /*!< Current input device string. */
     std::string output_devstr; /*!< Current output device string. */
+    std::string d_audio_rec_label; /*!< Label used in squelch triggered recordings. */
 
     rx_demod    d_demod;       /*!< Current demodulator. */
 
+    int         d_reconf_depth;     /*!< Nesting level of begin_reconf(). */
+    bool        d_reconf_stopped;   /*!< Flow graph stopped by a batched reconf. */
+    std::chrono::steady_clock::time_point d_reconf_start; /*!< Time of stop. */
+    double      d_reconf_ms;        /*!< Duration of the last reconfiguration. */
+    unsigned long d_reconf_count;   /*!< Number of flow graph restarts. */
+
     gr::top_block_sptr         tb;        /*!< The GNU Radio top block. */
 
     osmosdr::source::sptr     src;       /*!< Real time I/Q source. */
-    fir_decim_cc_sptr         input_decim;      /*!< Input decimator. */
+    rx_time_tagger_cc_sptr    src_time;  /*!< Sample time stamps. */
+    level_history_sptr        level_hist; /*!< Signal level history. */
+    gr::basic_block_sptr      input_decim;      /*!< Input decimator. */
     receiver_base_cf_sptr     rx;        /*!< receiver. */
 
     dc_corr_cc_sptr           dc_corr;   /*!< DC corrector block. */
@@ -267,8 +348,10 @@ private:
     gr::blocks::multiply_const_ff::sptr audio_gain1; /*!< Audio gain block. */
 
     gr::blocks::file_sink::sptr         iq_sink;     /*!< I/Q file sink. */
+    gap_logger_c_sptr                   iq_gap_log;  /*!< Gaps in the I/Q recording. */
 
     gr::blocks::wavfile_sink::sptr      wav_sink;   /*!< WAV file sink for recording. */
+    sql_recorder_ff_sptr                sql_rec;    /*!< Squelch triggered recorder. */
     gr::blocks::wavfile_source::sptr    wav_src;    /*!< WAV file source for playback. */
     gr::blocks::null_sink::sptr         audio_null_sink0; /*!< Audio null sink used during playback. */
     gr::blocks::null_sink::sptr         audio_null_sink1; /*!< Audio null sink used during playback. */
@@ -277,6 +360,17 @@ private:
     sniffer_f_sptr    sniffer;    /*!< Sample sniffer for data decoders. */
     resampler_ff_sptr sniffer_rr; /*!< Sniffer resampler. */
 
+    std::map<int, packet_chan_c_sptr> packet_chans; /*!< Packet radio channels. */
+    int         d_packet_chan_id;   /*!< Last used packet channel ID. */
+
+    bool        d_offline;          /*!< No sound card, run as fast as possible. */
+    std::thread d_wait_thread;      /*!< Waits for the end of offline input. */
+    std::atomic<bool> d_finished;   /*!< Offline input has ended. */
+    bool        d_file_input;       /*!< The input device is an I/Q file. */
+
+    std::map<long, block_sample> d_stats_prev; /*!< Last counters per block ID. */
+    std::chrono::steady_clock::time_point d_stats_time; /*!< Time of last sample. */
+
 #ifdef WITH_PULSEAUDIO
     pa_sink_sptr              audio_snk;  /*!< Pulse audio sink. */
 #elif WITH_PORTAUDIO
@@ -20,9 +20,11 @@
  * the Free Software Foundation, Inc., 51 Franklin Street,
  * Boston, MA 02110-1301, USA.
  */
+#include <algorithm>
 #include <cmath>
 #include <cstdlib>
 #include <iostream>
+#include <QDateTime>
 #include <QString>
 #include <QStringList>
 #include <QtGlobal>
@@ -45,8 +47,15 @@ RemoteControl::RemoteControl(QObject *parent) :
     signal_level = -200.0;
     squelch_level = -150.0;
     audio_recorder_status = false;
+    scanner_status = false;
     receiver_running = false;
     hamlib_compatible = false;
+    input_samples = 0;
+    input_lost = 0;
+    input_gaps = 0;
+    input_last_gap = 0.0;
+    reconf_count = 0;
+    reconf_last_ms = 0.0;
 
     rc_port = DEFAULT_RC_PORT;
     rc_allowed_hosts.append(DEFAULT_RC_ALLOWED_HOSTS);
@@ -243,6 +252,14 @@ void RemoteControl::startRead()
         answer = cmd_lnb_lo(cmdlist);
     else if (cmd == "\\dump_state")
         answer = cmd_dump_state();
+    else if (cmd == "DSP_LOAD")
+        answer = cmd_dsp_load(cmdlist);
+    else if (cmd == "INPUT_STATS")
+        answer = cmd_input_stats();
+    else if (cmd == "RECONF_STATS")
+        answer = cmd_reconf_stats();
+    else if (cmd == "LEVEL_HISTORY")
+        answer = cmd_level_history(cmdlist);
     else if (cmd == "q" || cmd == "Q")
     {
         // FIXME: for now we assume 'close' command
@@ -361,6 +378,12 @@ void RemoteControl::stopAudioRecorder()
     audio_recorder_status = false;
 }
 
+/*! \brief Set band scanner status (from mainwindow). */
+void RemoteControl::setScannerStatus(bool running)
+{
+    scanner_status = running;
+}
+
 /*! \brief Set receiver status (from mainwindow). */
 void RemoteControl::setReceiverStatus(bool enabled)
 {
@@ -373,6 +396,35 @@ void RemoteControl::setGainStages(gain_list_t &gain_list)
     gains = gain_list;
 }
 
+/*! \brief Set the latest flow graph statistics, see receiver::get_block_stats(). */
+void RemoteControl::setBlockStats(const block_stats_list_t &stats)
+{
+    block_stats = stats;
+}
+
+/*! \brief Set the input statistics, see receiver::get_input_stats(). */
+void RemoteControl::setInputStats(quint64 samples, quint64 lost,
+                                  unsigned long gaps, double last_gap)
+{
+    input_samples = samples;
+    input_lost = lost;
+    input_gaps = gaps;
+    input_last_gap = last_gap;
+}
+
+/*! \brief Set the flow graph restart statistics, see receiver::get_reconf_stats(). */
+void RemoteControl::setReconfStats(unsigned long count, double last_ms)
+{
+    reconf_count = count;
+    reconf_last_ms = last_ms;
+}
+
+/*! \brief Set the signal level history, see receiver::get_level_history(). */
+void RemoteControl::setLevelHistory(level_history_sptr hist)
+{
+    level_hist = hist;
+}
+
 /*! \brief Set value for a specific gain setting (from DockInputCtl). */
 bool RemoteControl::setGain(QString name, double gain)
 {
@@ -683,9 +735,11 @@ QString RemoteControl::cmd_get_func(QStringList cmdlist)
     QString func = cmdlist.value(1, "");
 
     if (func == "?")
-        answer = QString("RECORD\n");
+        answer = QString("RECORD SCAN\n");
     else if (func.compare("RECORD", Qt::CaseInsensitive) == 0)
         answer = QString("%1\n").arg(audio_recorder_status);
+    else if (func.compare("SCAN", Qt::CaseInsensitive) == 0)
+        answer = QString("%1\n").arg(scanner_status);
     else
         answer = QString("RPRT 1\n");
 
@@ -702,7 +756,7 @@ QString RemoteControl::cmd_set_func(QStringList cmdlist)
 
     if (func == "?")
     {
-        answer = QString("RECORD\n");
+        answer = QString("RECORD SCAN\n");
     }
     else if ((func.compare("RECORD", Qt::CaseInsensitive) == 0) && ok)
     {
@@ -720,6 +774,22 @@ QString RemoteControl::cmd_set_func(QStringList cmdlist)
                 emit stopAudioRecorderEvent();
         }
     }
+    else if ((func.compare("SCAN", Qt::CaseInsensitive) == 0) && ok)
+    {
+        if (!receiver_running)
+        {
+            answer = QString("RPRT 1\n");
+        }
+        else
+        {
+            answer = QString("RPRT 0\n");
+            scanner_status = status;
+            if (status)
+                emit startScannerEvent();
+            else
+                emit stopScannerEvent();
+        }
+    }
     else
     {
         answer = QString("RPRT 1\n");
@@ -787,6 +857,131 @@ QString RemoteControl::cmd_LOS()
     return QString("RPRT 0\n");
 }
 
+/*
+ * Gqrx specific command: DSP_LOAD - print the load of the flow graph blocks,
+ * optionally limited to the N heaviest blocks. The first line holds the number
+ * of blocks followed by one line per block:
+ *   <name> <load %> <items/s> <input buffer fill %>
+ * The load is -1 if GNU Radio does not provide performance counters.
+ */
+QString RemoteControl::cmd_dsp_load(QStringList cmdlist) const
+{
+    int num = block_stats.size();
+
+    if (cmdlist.size() == 2)
+    {
+        bool ok;
+        int  max_num = cmdlist[1].toInt(&ok);
+
+        if (!ok || max_num < 0)
+            return QString("RPRT 1\n");
+
+        num = std::min(num, max_num);
+    }
+
+    QString answer = QString("%1\n").arg(num);
+    for (int i = 0; i < num; i++)
+    {
+        const block_stats_t &st = block_stats[i];
+        answer += QString("%1 %2 %3 %4\n")
+                .arg(QString::fromStdString(st.name))
+                .arg(st.load < 0.0 ? -1.0 : 100.0 * st.load, 0, 'f', 1)
+                .arg(st.rate, 0, 'f', 0)
+                .arg(100.0 * st.buffer_full, 0, 'f', 0);
+    }
+
+    return answer;
+}
+
+/*
+ * Gqrx specific command: INPUT_STATS - print the number of samples received
+ * from the input device, the number of samples lost, the number of gaps and
+ * the time of the last gap in seconds since the epoch (0 if none):
+ *   <samples> <lost> <gaps> <last gap>
+ */
+QString RemoteControl::cmd_input_stats() const
+{
+    return QString("%1 %2 %3 %4\n")
+            .arg(input_samples)
+            .arg(input_lost)
+            .arg(input_gaps)
+            .arg(input_last_gap, 0, 'f', 3);
+}
+
+/*
+ * Gqrx specific command: RECONF_STATS - print the number of flow graph
+ * restarts, e.g. for demodulator changes, and the duration of the last one
+ * in milliseconds, i.e. the length of the audio dropout:
+ *   <restarts> <last ms>
+ */
+QString RemoteControl::cmd_reconf_stats() const
+{
+    return QString("%1 %2\n")
+            .arg(reconf_count)
+            .arg(reconf_last_ms, 0, 'f', 1);
+}
+
+/*
+ * Gqrx specific command: LEVEL_HISTORY [level [seconds]]
+ *
+ * Without arguments print the available resolutions; the first line holds
+ * the number of resolutions followed by one line per resolution:
+ *   <level> <bucket length in s> <number of buckets>
+ *
+ * With a level print the buckets of that resolution, optionally limited to
+ * the last N seconds, oldest first. The first line holds the number of
+ * buckets followed by one line per bucket:
+ *   <time> <min dBFS> <max dBFS> <avg dBFS>
+ * where the time is the start of the bucket in seconds since the epoch.
+ */
+QString RemoteControl::cmd_level_history(QStringList cmdlist) const
+{
+    std::vector<level_bucket_t> buckets;
+    unsigned int    level;
+    double          since = 0.0;
+    bool            ok;
+    QString         answer;
+
+    if (!level_hist)
+        return QString("RPRT 1\n");
+
+    if (cmdlist.size() == 1)
+    {
+        answer = QString("%1\n").arg(level_hist->levels());
+        for (level = 0; level < level_hist->levels(); level++)
+            answer += QString("%1 %2 %3\n")
+                    .arg(level)
+                    .arg(level_hist->interval(level))
+                    .arg(level_hist->count(level));
+        return answer;
+    }
+
+    level = cmdlist[1].toUInt(&ok);
+    if (!ok || level >= level_hist->levels())
+        return QString("RPRT 1\n");
+
+    if (cmdlist.size() == 3)
+    {
+        double seconds = cmdlist[2].toDouble(&ok);
+
+        if (!ok || seconds <= 0.0)
+            return QString("RPRT 1\n");
+
+        since = QDateTime::currentMSecsSinceEpoch() * 1.0e-3 - seconds;
+    }
+
+    level_hist->get(level, since, buckets);
+    answer = QString("%1\n").arg(buckets.size());
+    for (size_t i = 0; i < buckets.size(); i++)
+        answer += QString("%1 %2 %3 %4\n")
+                .arg(buckets[i].time, 0, 'f', 3)
+                .arg(buckets[i].min, 0, 'f', 1)
+                .arg(buckets[i].max, 0, 'f', 1)
+                .arg(buckets[i].avg, 0, 'f', 1);
+
+    return answer;
+}
+
 /* Set the LNB LO value */
 QString RemoteControl::cmd_lnb_lo(QStringList cmdlist)
 {
@@ -31,8 +31,9 @@
 #include <QTcpSocket>
 #include <QtNetwork>
 
-/* For gain_t and gain_list_t */
-#include "qtgui/dockinputctl.h"
+#include "applications/gqrx/block_stats.h"
+#include "applications/gqrx/gain_stage.h"
+#include "dsp/level_history.h"
 
 /*! \brief Simple TCP server for remote control.
  *
@@ -82,6 +83,11 @@ public:
     }
     void setReceiverStatus(bool enabled);
     void setGainStages(gain_list_t &gain_list);
+    void setBlockStats(const block_stats_list_t &stats);
+    void setInputStats(quint64 samples, quint64 lost, unsigned long gaps,
+                       double last_gap);
+    void setReconfStats(unsigned long count, double last_ms);
+    void setLevelHistory(level_history_sptr hist);
 
 public slots:
     void setNewFrequency(qint64 freq);
@@ -94,6 +100,7 @@ public slots:
     void setSquelchLevel(double level);
     void startAudioRecorder(QString unused);
     void stopAudioRecorder();
+    void setScannerStatus(bool running);
     bool setGain(QString name, double gain);
 
 signals:
@@ -105,6 +112,8 @@ signals:
     void newSquelchLevel(double level);
     void startAudioRecorderEvent();
     void stopAudioRecorderEvent();
+    void startScannerEvent();
+    void stopScannerEvent();
     void gainChanged(QString name, double value);
 
 private slots:
@@ -129,9 +138,18 @@ private:
     float       signal_level;      /*!< Signal level in dBFS */
     double      squelch_level;     /*!< Squelch level in dBFS */
     bool        audio_recorder_status; /*!< Recording enabled */
+    bool        scanner_status;    /*!< Band scanner running */
     bool        receiver_running;  /*!< Wether the receiver is running or not */
     bool        hamlib_compatible;
     gain_list_t gains;             /*!< Possible and current gain settings */
+    block_stats_list_t block_stats; /*!< Latest flow graph statistics, heaviest first */
+    quint64     input_samples;     /*!< Samples received from the input device */
+    quint64     input_lost;        /*!< Samples lost by the input device */
+    unsigned long input_gaps;      /*!< Number of gaps in the input stream */
+    double      input_last_gap;    /*!< Time of the last gap or 0 */
+    unsigned long reconf_count;    /*!< Number of flow graph restarts */
+    double      reconf_last_ms;    /*!< Duration of the last restart */
+    level_history_sptr level_hist; /*!< Signal level history */
 
     void        setNewRemoteFreq(qint64 freq);
     int         modeStrToInt(QString mode_str);
@@ -155,6 +173,10 @@ private:
     QString     cmd_LOS();
     QString     cmd_lnb_lo(QStringList cmdlist);
     QString     cmd_dump_state() const;
+    QString     cmd_dsp_load(QStringList cmdlist) const;
+    QString     cmd_input_stats() const;
+    QString     cmd_reconf_stats() const;
+    QString     cmd_level_history(QStringList cmdlist) const;
 };
 
 #endif // REMOTE_CONTROL_H
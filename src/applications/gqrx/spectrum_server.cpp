@@ -0,0 +1,411 @@
+/* -*- c++ -*- */
+/*
+ * Gqrx SDR: Software defined radio receiver powered by GNU Radio and Qt
+ *           http://gqrx.dk/
+ *
+ * Copyright 2020 Vadym Ostanin.
+ *
+ * Gqrx is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * Gqrx is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Gqrx; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#include <QDataStream>
+#include <QDebug>
+#include <QList>
+#include <QNetworkProxy>
+#include <QtGlobal>
+#include "spectrum_server.h"
+
+#define DEFAULT_SPECTRUM_PORT   7357
+#define DEFAULT_ALLOWED_HOSTS   "::ffff:127.0.0.1"
+
+#define SPEC_VERSION        1
+#define SPEC_FLAG_DELTA     0x01
+#define SPEC_FLAG_ZLIB      0x02
+
+#define DEFAULT_CLIENT_RATE 25
+#define DEFAULT_MIN_DB      -140.f
+#define DEFAULT_MAX_DB      0.f
+#define MAX_COLUMNS         65535
+
+// send a key frame at least this often so that clients can resynchronise
+#define KEY_INTERVAL_MS     1000
+
+// skip frames for a client with more than this waiting to be sent
+#define MAX_BACKLOG         (256 * 1024)
+
+// longest command line accepted from a client
+#define MAX_CMD_LEN         256
+
+SpectrumServer::SpectrumServer(QObject *parent) :
+    QObject(parent),
+    spec_port(DEFAULT_SPECTRUM_PORT)
+{
+#if QT_VERSION < 0x050900
+    // Workaround for https://bugreports.qt.io/browse/QTBUG-58374
+    spec_server.setProxy(QNetworkProxy::NoProxy);
+#endif
+
+    spec_allowed_hosts.append(DEFAULT_ALLOWED_HOSTS);
+
+    spec_clock.start();
+    connect(&spec_server, SIGNAL(newConnection()), this, SLOT(acceptConnection()));
+}
+
+SpectrumServer::~SpectrumServer()
+{
+    stop_server();
+}
+
+/*! \brief Start the server. */
+void SpectrumServer::start_server()
+{
+    if (!spec_server.isListening())
+        spec_server.listen(QHostAddress::Any, spec_port);
+}
+
+/*! \brief Stop the server and disconnect all clients. */
+void SpectrumServer::stop_server()
+{
+    foreach (QTcpSocket *client, spec_clients.keys())
+    {
+        client->disconnect(this);
+        client->close();
+        client->deleteLater();
+    }
+    spec_clients.clear();
+
+    if (spec_server.isListening())
+        spec_server.close();
+}
+
+/*! \brief Set new network port.
+ *  \param port The new network port.
+ *
+ * If the server is running it will be restarted.
+ */
+void SpectrumServer::setPort(int port)
+{
+    if (port == spec_port)
+        return;
+
+    spec_port = port;
+    if (spec_server.isListening())
+    {
+        spec_server.close();
+        spec_server.listen(QHostAddress::Any, spec_port);
+    }
+}
+
+/*! \brief Set the hosts we accept connections from. */
+void SpectrumServer::setHosts(QStringList hosts)
+{
+    spec_allowed_hosts = hosts;
+}
+
+/*! \brief Read settings and start the server if it was enabled. */
+void SpectrumServer::readSettings(QSettings *settings)
+{
+    bool    conv_ok;
+    int     int_val;
+
+    if (!settings)
+        return;
+
+    settings->beginGroup("spectrum_server");
+
+    int_val = settings->value("port", DEFAULT_SPECTRUM_PORT).toInt(&conv_ok);
+    if (conv_ok)
+        setPort(int_val);
+
+    if (settings->contains("allowed_hosts"))
+        setHosts(settings->value("allowed_hosts").toStringList());
+
+    if (settings->value("enabled", false).toBool())
+        start_server();
+    else
+        stop_server();
+
+    settings->endGroup();
+}
+
+void SpectrumServer::saveSettings(QSettings *settings)
+{
+    if (!settings)
+        return;
+
+    settings->beginGroup("spectrum_server");
+
+    if (spec_server.isListening())
+        settings->setValue("enabled", true);
+    else
+        settings->remove("enabled");
+
+    if (spec_port != DEFAULT_SPECTRUM_PORT)
+        settings->setValue("port", spec_port);
+    else
+        settings->remove("port");
+
+    if (spec_allowed_hosts.count() > 0)
+        settings->setValue("allowed_hosts", spec_allowed_hosts);
+    else
+        settings->remove("allowed_hosts");
+
+    settings->endGroup();
+}
+
+/*! \brief Send an FFT frame to the clients.
+ *  \param fft_db The FFT in dB, lowest frequency first.
+ *  \param fftsize The number of FFT bins.
+ *  \param center The center frequency of the FFT in Hz.
+ *  \param span The frequency span of the FFT in Hz.
+ *
+ * Clients with the same width and dB range share the quantized levels, so
+ * the cost of an additional viewer is mostly the delta encoding.
+ */
+void SpectrumServer::sendFftData(const float *fft_db, int fftsize,
+                                 qint64 center, qint64 span)
+{
+    struct levels_t
+    {
+        int         width;
+        float       min_db;
+        float       max_db;
+        QByteArray  levels;
+    };
+
+    QList<levels_t>     cache;
+    QByteArray          payload;
+    QByteArray          frame;
+    qint64              now;
+    int                 width, i;
+    bool                key;
+    quint8              flags;
+
+    if (spec_clients.isEmpty() || fftsize <= 0)
+        return;
+
+    now = spec_clock.elapsed();
+
+    QHash<QTcpSocket *, client_t>::iterator it;
+    for (it = spec_clients.begin(); it != spec_clients.end(); ++it)
+    {
+        QTcpSocket *socket = it.key();
+        client_t   &client = it.value();
+
+        if (now - client.last_ms < 1000 / client.rate)
+            continue;
+        if (socket->bytesToWrite() > MAX_BACKLOG)
+            continue;
+
+        width = client.width > 0 ? qMin(client.width, fftsize) : fftsize;
+        width = qMin(width, MAX_COLUMNS);
+
+        // levels for this width and range, computed once per frame
+        const QByteArray *levels = 0;
+        for (i = 0; i < cache.size(); i++)
+        {
+            if (cache[i].width == width && cache[i].min_db == client.min_db &&
+                cache[i].max_db == client.max_db)
+            {
+                levels = &cache[i].levels;
+                break;
+            }
+        }
+        if (!levels)
+        {
+            levels_t entry;
+
+            entry.width = width;
+            entry.min_db = client.min_db;
+            entry.max_db = client.max_db;
+            quantize(fft_db, fftsize, width, client.min_db, client.max_db,
+                     entry.levels);
+            cache.append(entry);
+            levels = &cache.last().levels;
+        }
+
+        key = (client.prev.size() != width || client.prev_center != center ||
+               client.prev_span != span ||
+               now - client.key_ms >= KEY_INTERVAL_MS);
+
+        if (key)
+        {
+            payload = *levels;
+            flags = 0;
+            client.key_ms = now;
+        }
+        else
+        {
+            payload.resize(width);
+            for (i = 0; i < width; i++)
+                payload[i] = (char)(quint8)((quint8)levels->at(i) -
+                                            (quint8)client.prev.at(i));
+            flags = SPEC_FLAG_DELTA;
+        }
+
+        // deltas of a steady spectrum are mostly small and compress well
+        QByteArray packed = qCompress(payload, 6);
+        if (packed.size() < payload.size())
+        {
+            payload = packed;
+            flags |= SPEC_FLAG_ZLIB;
+        }
+
+        frame.clear();
+        QDataStream out(&frame, QIODevice::WriteOnly);
+        out.setByteOrder(QDataStream::LittleEndian);
+        out.setFloatingPointPrecision(QDataStream::SinglePrecision);
+        out.writeRawData("GQSF", 4);
+        out << (quint8)SPEC_VERSION << flags << (quint16)width
+            << client.seq << center << span
+            << client.min_db << client.max_db << (quint32)payload.size();
+        out.writeRawData(payload.constData(), payload.size());
+
+        socket->write(frame);
+
+        client.prev = *levels;
+        client.prev_center = center;
+        client.prev_span = span;
+        client.last_ms = now;
+        client.seq++;
+    }
+}
+
+/*! \brief Map FFT bins to levels.
+ *
+ * Each column gets the peak of the bins it covers, so that narrow signals
+ * are not lost when the client is narrower than the FFT.
+ */
+void SpectrumServer::quantize(const float *fft_db, int fftsize, int width,
+                              float min_db, float max_db, QByteArray &levels)
+{
+    float   scale = 255.f / (max_db - min_db);
+    float   peak;
+    int     x, i, first, last;
+
+    levels.resize(width);
+    for (x = 0; x < width; x++)
+    {
+        first = (int)((qint64)x * fftsize / width);
+        last = (int)((qint64)(x + 1) * fftsize / width);
+        peak = fft_db[first];
+        for (i = first + 1; i < last; i++)
+            peak = qMax(peak, fft_db[i]);
+
+        levels[x] = (char)(quint8)qBound(0.f, (peak - min_db) * scale + 0.5f,
+                                         255.f);
+    }
+}
+
+/*! \brief Accept a new client connection. */
+void SpectrumServer::acceptConnection()
+{
+    QTcpSocket *socket;
+
+    while ((socket = spec_server.nextPendingConnection()) != 0)
+    {
+        client_t    client;
+        QString     address = socket->peerAddress().toString();
+
+        if (spec_allowed_hosts.indexOf(address) == -1)
+        {
+            qDebug() << "Spectrum server: connection attempt from" << address
+                     << "(not in allowed list)";
+            socket->close();
+            socket->deleteLater();
+            continue;
+        }
+
+        client.width = 0;
+        client.rate = DEFAULT_CLIENT_RATE;
+        client.min_db = DEFAULT_MIN_DB;
+        client.max_db = DEFAULT_MAX_DB;
+        client.last_ms = 0;
+        client.prev_center = 0;
+        client.prev_span = 0;
+        client.key_ms = 0;
+        client.seq = 0;
+
+        connect(socket, SIGNAL(readyRead()), this, SLOT(startRead()));
+        connect(socket, SIGNAL(disconnected()), this, SLOT(clientDisconnected()));
+        spec_clients.insert(socket, client);
+    }
+}
+
+/*! \brief Read commands from a client. */
+void SpectrumServer::startRead()
+{
+    QTcpSocket *socket = qobject_cast<QTcpSocket *>(sender());
+    int         pos;
+
+    if (!socket || !spec_clients.contains(socket))
+        return;
+
+    client_t   &client = spec_clients[socket];
+
+    client.cmd_buf.append(socket->readAll());
+    while ((pos = client.cmd_buf.indexOf('\n')) >= 0)
+    {
+        parseCommand(client, client.cmd_buf.left(pos).trimmed());
+        client.cmd_buf.remove(0, pos + 1);
+    }
+
+    // not a command, just garbage
+    if (client.cmd_buf.size() > MAX_CMD_LEN)
+        client.cmd_buf.clear();
+}
+
+/*! \brief Apply a command line received from a client. */
+void SpectrumServer::parseCommand(client_t &client, const QByteArray &line)
+{
+    QList<QByteArray>   cmdlist = line.simplified().split(' ');
+    QByteArray          cmd = cmdlist[0].toUpper();
+    bool                ok1 = false, ok2 = false;
+
+    if (cmd == "WIDTH" && cmdlist.size() == 2)
+    {
+        int width = cmdlist[1].toInt(&ok1);
+        if (ok1 && width >= 0)
+            client.width = qMin(width, MAX_COLUMNS);
+    }
+    else if (cmd == "RATE" && cmdlist.size() == 2)
+    {
+        int rate = cmdlist[1].toInt(&ok1);
+        if (ok1 && rate > 0)
+            client.rate = qMin(rate, 1000);
+    }
+    else if (cmd == "RANGE" && cmdlist.size() == 3)
+    {
+        float min_db = cmdlist[1].toFloat(&ok1);
+        float max_db = cmdlist[2].toFloat(&ok2);
+        if (ok1 && ok2 && max_db > min_db)
+        {
+            client.min_db = min_db;
+            client.max_db = max_db;
+        }
+    }
+}
+
+/*! \brief Remove a client that has disconnected. */
+void SpectrumServer::clientDisconnected()
+{
+    QTcpSocket *socket = qobject_cast<QTcpSocket *>(sender());
+
+    if (socket)
+    {
+        spec_clients.remove(socket);
+        socket->deleteLater();
+    }
+}
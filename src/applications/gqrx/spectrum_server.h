@@ -0,0 +1,134 @@
+/* -*- c++ -*- */
+/*
+ * Gqrx SDR: Software defined radio receiver powered by GNU Radio and Qt
+ *           http://gqrx.dk/
+ *
+ * Copyright 2020 Vadym Ostanin.
+ *
+ * Gqrx is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * Gqrx is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Gqrx; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifndef SPECTRUM_SERVER_H
+#define SPECTRUM_SERVER_H
+
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QObject>
+#include <QSettings>
+#include <QStringList>
+#include <QTcpServer>
+#include <QTcpSocket>
+
+/*! \brief TCP server streaming the spectrum to remote displays.
+ *
+ * Each FFT frame shown on the pandapter is sent to every connected client
+ * as a row of 8 bit levels, so a remote display needs a small fraction of
+ * the bandwidth of a screen sharing session. Each client chooses its own
+ * width, frame rate and dB range by sending text lines:
+ *
+ *   WIDTH <columns>        Number of columns, 0 for the full FFT size.
+ *   RATE <frames/s>        Maximum frame rate.
+ *   RANGE <min> <max>      dB range mapped to levels 0...255.
+ *
+ * When the FFT is wider than the client, each column gets the peak of the
+ * FFT bins it covers. Every frame starts with a 40 byte little endian
+ * header:
+ *
+ *   char[4]  "GQSF"
+ *   uint8    version (1)
+ *   uint8    flags: bit 0 delta frame, bit 1 zlib (qCompress) payload
+ *   uint16   columns
+ *   uint32   sequence number
+ *   int64    center frequency in Hz
+ *   int64    span in Hz
+ *   float    min dB
+ *   float    max dB
+ *   uint32   payload bytes
+ *
+ * The payload of a key frame is the levels, that of a delta frame the
+ * difference to the previous frame modulo 256. A key frame is sent at
+ * least once per second and whenever the frequency, span, width or range
+ * change. Frames are skipped for clients that can not keep up.
+ *
+ * Like the remote control, the server only accepts connections from the
+ * hosts in its allowed list, by default only localhost.
+ */
+class SpectrumServer : public QObject
+{
+    Q_OBJECT
+public:
+    explicit SpectrumServer(QObject *parent = 0);
+    ~SpectrumServer();
+
+    void start_server(void);
+    void stop_server(void);
+    bool is_running(void) const
+    {
+        return spec_server.isListening();
+    }
+
+    void setPort(int port);
+    int  getPort(void) const
+    {
+        return spec_port;
+    }
+
+    void setHosts(QStringList hosts);
+    QStringList getHosts(void) const
+    {
+        return spec_allowed_hosts;
+    }
+
+    void readSettings(QSettings *settings);
+    void saveSettings(QSettings *settings);
+
+    void sendFftData(const float *fft_db, int fftsize, qint64 center,
+                     qint64 span);
+
+private slots:
+    void acceptConnection();
+    void startRead();
+    void clientDisconnected();
+
+private:
+    /*! \brief Per client state. */
+    struct client_t
+    {
+        QByteArray  cmd_buf;    /*!< Incomplete command line. */
+        int         width;      /*!< Requested number of columns, 0 for all bins. */
+        int         rate;       /*!< Maximum frames per second. */
+        float       min_db;
+        float       max_db;
+        qint64      last_ms;    /*!< Time of the last frame sent. */
+        QByteArray  prev;       /*!< Last levels sent, reference for delta frames. */
+        qint64      prev_center;
+        qint64      prev_span;
+        qint64      key_ms;     /*!< Time of the last key frame. */
+        quint32     seq;
+    };
+
+    void parseCommand(client_t &client, const QByteArray &line);
+    static void quantize(const float *fft_db, int fftsize, int width,
+                         float min_db, float max_db, QByteArray &levels);
+
+    QTcpServer                      spec_server;    /*!< The active server object. */
+    QHash<QTcpSocket *, client_t>   spec_clients;   /*!< Connected clients. */
+    int                             spec_port;      /*!< The port we are listening on. */
+    QStringList                     spec_allowed_hosts; /*!< Hosts where we accept connections from. */
+    QElapsedTimer                   spec_clock;     /*!< Monotonic time for rate limiting. */
+};
+
+#endif // SPECTRUM_SERVER_H
@@ -12,6 +12,7 @@ using namespace std;
 RtlSdrSource::RtlSdrSource(int dev_index)
     : m_dev(0)
     , m_block_length(default_block_length)
+    , m_samples_lost(0)
 {
     int r;
 
@@ -156,6 +157,7 @@ bool RtlSdrSource::get_samples(IQSampleVector& samples)
     }
 
     if (n_read != 2 * m_block_length) {
+        m_samples_lost += m_block_length - n_read / 2;
         m_error = "short read, samples lost";
         return false;
     }
@@ -62,6 +62,12 @@ public:
      */
     bool get_samples(IQSampleVector& samples);
 
+    /** Return the number of samples lost in short reads. */
+    std::uint64_t get_samples_lost() const
+    {
+        return m_samples_lost;
+    }
+
     /** Return the last error, or return an empty string if there is no error. */
     std::string error()
     {
@@ -84,6 +90,7 @@ private:
     int                 m_block_length;
     std::string         m_devname;
     std::string         m_error;
+    std::uint64_t       m_samples_lost;
 };
 
 #endif
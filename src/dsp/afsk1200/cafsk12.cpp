@@ -20,11 +20,13 @@
  *      along with this program; if not, write to the Free Software
  *      Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
  */
+#include <QDateTime>
 #include <QDebug>
 #include <QTime>
 #include <math.h>
 #include <stdio.h>
 #include <stdarg.h>
+#include <volk/volk.h>
 #include "filter.h"
 #include "cafsk12.h"
 
@@ -32,8 +34,15 @@
 
 
 CAfsk12::CAfsk12(QObject *parent) :
-    QObject(parent)
+    QObject(parent),
+    raw_frames(false),
+    bit_time(0.0)
 {
+    size_t alignment = volk_get_alignment();
+
+    corr_mark = (lv_32fc_t *) volk_malloc(CORRLEN * sizeof(lv_32fc_t), alignment);
+    corr_space = (lv_32fc_t *) volk_malloc(CORRLEN * sizeof(lv_32fc_t), alignment);
+
     state = (demod_state *) malloc(sizeof(demod_state));
     reset();
 }
@@ -41,6 +50,8 @@ CAfsk12::CAfsk12(QObject *parent) :
 CAfsk12::~CAfsk12()
 {
     free(state);
+    volk_free(corr_mark);
+    volk_free(corr_space);
 }
 
 /*! \brief Reset the decoder. */
@@ -52,23 +63,33 @@ void CAfsk12::reset()
     hdlc_init(state);
     memset(&state->l1.afsk12, 0, sizeof(state->l1.afsk12));
     for (f = 0, i = 0; i < CORRLEN; i++) {
-        corr_mark_i[i] = cos(f);
-        corr_mark_q[i] = sin(f);
+        corr_mark[i] = lv_cmake(cosf(f), sinf(f));
         f += 2.0*M_PI*FREQ_MARK/FREQ_SAMP;
     }
     for (f = 0, i = 0; i < CORRLEN; i++) {
-        corr_space_i[i] = cos(f);
-        corr_space_q[i] = sin(f);
+        corr_space[i] = lv_cmake(cosf(f), sinf(f));
         f += 2.0*M_PI*FREQ_SPACE/FREQ_SAMP;
     }
 
 }
 
 
-void CAfsk12::demod(float *buffer, int length)
+/*! \brief Demodulate a block of samples.
+ *
+ * The mark and space energies are computed as |sum(x[n] * e^jwn)|^2 using
+ * one complex-by-real dot product per tone. VOLK selects the fastest
+ * available kernel (SSE, AVX, NEON, ...) at runtime.
+ *
+ * The optional time is the sampling time of buffer[0] in seconds since the
+ * epoch. It is used to timestamp the received frames with the time they were
+ * on the air rather than the time they were processed.
+ */
+void CAfsk12::demod(float *buffer, int length, double time)
 {
     float f;
+    lv_32fc_t mark, space;
     unsigned char curbit;
+    int pos = 0;
 
     if (state->l1.afsk12.subsamp) {
         int numfill = SUBSAMP - state->l1.afsk12.subsamp;
@@ -78,13 +99,14 @@ void CAfsk12::demod(float *buffer, int length)
         }
         buffer += numfill;
         length -= numfill;
+        pos = numfill;
         state->l1.afsk12.subsamp = 0;
     }
-    for (; length >= SUBSAMP; length -= SUBSAMP, buffer += SUBSAMP) {
-        f = fsqr(mac(buffer, corr_mark_i, CORRLEN)) +
-            fsqr(mac(buffer, corr_mark_q, CORRLEN)) -
-            fsqr(mac(buffer, corr_space_i, CORRLEN)) -
-            fsqr(mac(buffer, corr_space_q, CORRLEN));
+    for (; length >= SUBSAMP; length -= SUBSAMP, buffer += SUBSAMP, pos += SUBSAMP) {
+        volk_32fc_32f_dot_prod_32fc(&mark, corr_mark, buffer, CORRLEN);
+        volk_32fc_32f_dot_prod_32fc(&space, corr_space, buffer, CORRLEN);
+        f = fsqr(lv_creal(mark)) + fsqr(lv_cimag(mark)) -
+            fsqr(lv_creal(space)) - fsqr(lv_cimag(space));
         state->l1.afsk12.dcd_shreg <<= 1;
         state->l1.afsk12.dcd_shreg |= (f > 0);
         verbprintf(10, "%c", '0'+(state->l1.afsk12.dcd_shreg & 1));
@@ -105,6 +127,7 @@ void CAfsk12::demod(float *buffer, int length)
             curbit = (state->l1.afsk12.lasts ^
                   (state->l1.afsk12.lasts >> 1) ^ 1) & 1;
             verbprintf(9, " %c ", '0'+curbit);
+            bit_time = time > 0.0 ? time + (double) pos / FREQ_SAMP : 0.0;
             hdlc_rxbit(state, curbit);
         }
     }
@@ -164,7 +187,14 @@ void CAfsk12::hdlc_rxbit(struct demod_state *s, int bit)
     s->l2.hdlc.rxbitstream |= !!bit;
     if ((s->l2.hdlc.rxbitstream & 0xff) == 0x7e) {
         if (s->l2.hdlc.rxstate && (s->l2.hdlc.rxptr - s->l2.hdlc.rxbuf) > 2)
-            ax25_disp_packet(s->l2.hdlc.rxbuf, s->l2.hdlc.rxptr - s->l2.hdlc.rxbuf);
+        {
+            if (raw_frames)
+                emit newFrame(QByteArray((const char *)s->l2.hdlc.rxbuf,
+                                         s->l2.hdlc.rxptr - s->l2.hdlc.rxbuf),
+                              bit_time);
+            else
+                ax25_disp_packet(s->l2.hdlc.rxbuf, s->l2.hdlc.rxptr - s->l2.hdlc.rxbuf);
+        }
         s->l2.hdlc.rxstate = 1;
         s->l2.hdlc.rxptr = s->l2.hdlc.rxbuf;
         s->l2.hdlc.rxbitbuf = 0x80;
@@ -219,11 +249,20 @@ static inline int check_crc_ccitt(const unsigned char *buf, int cnt)
 }
 
 
+/*! \brief Check the FCS of a received HDLC frame.
+ *  \param buf The frame including the two FCS bytes.
+ *  \param len The length of the frame in bytes.
+ *  \return true if the CRC is correct.
+ */
+bool CAfsk12::checkCrc(const unsigned char *buf, int len)
+{
+    return check_crc_ccitt(buf, len);
+}
+
+
 void CAfsk12::ax25_disp_packet(unsigned char *bp, unsigned int len)
 {
     QString message;
-    unsigned char v1=1,cmd=0;
-    unsigned char i,j;
 
     verbprintf(6, "AX.25 PKT; L=%d\n", len);
 
@@ -236,8 +275,42 @@ void CAfsk12::ax25_disp_packet(unsigned char *bp, unsigned int len)
     }
 #endif
 
-    /* get current time that will be prepended to packet display */
-    QTime time = QTime::currentTime();
+    /* get the time that will be prepended to packet display */
+    message = formatPacket(bp, len, packetTime(bit_time));
+    if (message.size() > 0) {
+        emit newMessage(message);
+    }
+}
+
+
+/*! \brief Convert the sampling time of a frame to local time.
+ *  \param time The time in seconds since the epoch or 0 if not known.
+ *  \return The local time of the frame or the current time if not known.
+ */
+QTime CAfsk12::packetTime(double time)
+{
+    if (time <= 0.0)
+        return QTime::currentTime();
+
+    return QDateTime::fromMSecsSinceEpoch((qint64)(time * 1000.0)).time();
+}
+
+
+/*! \brief Format a CRC checked AX.25 frame as text.
+ *  \param bp The frame including the two FCS bytes.
+ *  \param len The length of the frame in bytes.
+ *  \param time The time to prepend to the message.
+ *  \return The formatted message or an empty string if the frame is too short.
+ */
+QString CAfsk12::formatPacket(const unsigned char *bp, unsigned int len,
+                              const QTime &time)
+{
+    QString message;
+    unsigned char v1=1,cmd=0;
+    unsigned char i,j;
+
+    if (!bp || len < 10)
+        return message;
 
     len -= 2;
     if (bp[1] & 1) {
@@ -456,8 +529,6 @@ void CAfsk12::ax25_disp_packet(unsigned char *bp, unsigned int len)
 
     /* I just secured myself a ticket to hell */
     finished:
-    if (message.size() > 0) {
-        emit newMessage(message);
-    }
+    return message;
 }
 
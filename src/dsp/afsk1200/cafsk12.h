@@ -23,7 +23,10 @@
 #ifndef CAFSK12_H
 #define CAFSK12_H
 
+#include <QByteArray>
 #include <QObject>
+#include <QTime>
+#include <complex>
 
 extern const float costabf[0x400];
 #define COS(x) costabf[(((x)>>6)&0x3ffu)]
@@ -152,26 +155,45 @@ public:
     explicit CAfsk12(QObject *parent = 0);
     ~CAfsk12();
 
-    void demod(float *buffer, int length);
+    void demod(float *buffer, int length, double time = 0.0);
     void reset();
 
+    void setRawFrames(bool raw) { raw_frames = raw; }
+
+    static bool    checkCrc(const unsigned char *buf, int len);
+    static QString formatPacket(const unsigned char *bp, unsigned int len,
+                                const QTime &time);
+    static QTime   packetTime(double time);
+
 signals:
     void newMessage(const QString &message);
 
+    /*! \brief New HDLC frame received (only in raw frames mode).
+     *
+     * The frame includes the FCS and has not been CRC checked. This allows
+     * several demodulators to feed a common CRC check and deduplication stage.
+     * The time is the sampling time of the closing flag in seconds since the
+     * epoch, or 0 if the time of the samples is not known.
+     */
+    void newFrame(const QByteArray &frame, double time);
+
 public slots:
 
 private:
-    float corr_mark_i[CORRLEN];
-    float corr_mark_q[CORRLEN];
-    float corr_space_i[CORRLEN];
-    float corr_space_q[CORRLEN];
+    /* Mark and space correlators stored as complex (I + jQ) taps in
+     * VOLK-aligned memory so that each tone takes a single dot product.
+     */
+    std::complex<float> *corr_mark;
+    std::complex<float> *corr_space;
 
     struct demod_state *state;
+    bool raw_frames;     /*! Emit raw HDLC frames instead of decoded messages. */
+    double bit_time;     /*! Sampling time of the current bit or 0 if not known. */
 
     /* HDLC functions */
     void hdlc_init(struct demod_state *s);
     void hdlc_rxbit(struct demod_state *s, int bit);
-    void verbprintf(int verb_level, const char *fmt, ...);
+    static void verbprintf(int verb_level, const char *fmt, ...);
     void ax25_disp_packet(unsigned char *bp, unsigned int len);
 };
 
@@ -0,0 +1,90 @@
+/* -*- c++ -*- */
+/*
+ * Gqrx SDR: Software defined radio receiver powered by GNU Radio and Qt
+ *           http://gqrx.dk/
+ *
+ * Copyright 2020 Vadym Ostanin.
+ *
+ * Gqrx is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * Gqrx is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Gqrx; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#include <algorithm>
+#include <string.h>
+#include <volk/volk.h>
+
+#include "dsp/audio_ring.h"
+
+
+audio_ring::audio_ring(unsigned int frames)
+    : d_buf(2 * frames),
+      d_size(frames),
+      d_head(0),
+      d_tail(0)
+{
+}
+
+/*! \brief Write audio to the buffer.
+ *  \param left Left channel.
+ *  \param right Right channel, may be the same as left for mono.
+ *  \param frames Number of samples in each channel.
+ *  \return The number of frames written, less than frames if the buffer
+ *          is full.
+ */
+unsigned int audio_ring::write(const float *left, const float *right,
+                               unsigned int frames)
+{
+    uint64_t        head = d_head.load(std::memory_order_relaxed);
+    unsigned int    pos = head % d_size;
+    unsigned int    n, chunk;
+
+    n = std::min(frames, space());
+    chunk = std::min(n, d_size - pos);
+
+    // interleaving two float channels is the same as building complex
+    // samples from I and Q
+    volk_32f_x2_interleave_32fc((lv_32fc_t *)&d_buf[2 * pos], left, right,
+                                chunk);
+    if (n > chunk)
+        volk_32f_x2_interleave_32fc((lv_32fc_t *)&d_buf[0], left + chunk,
+                                    right + chunk, n - chunk);
+
+    d_head.store(head + n, std::memory_order_release);
+
+    return n;
+}
+
+/*! \brief Read interleaved audio from the buffer.
+ *  \param out Output buffer with room for 2 * frames samples.
+ *  \param frames The number of frames wanted.
+ *  \return The number of frames read, less than frames if the buffer ran
+ *          empty. The rest of out is left untouched.
+ */
+unsigned int audio_ring::read(float *out, unsigned int frames)
+{
+    uint64_t        tail = d_tail.load(std::memory_order_relaxed);
+    unsigned int    pos = tail % d_size;
+    unsigned int    n, chunk;
+
+    n = std::min(frames, fill());
+    chunk = std::min(n, d_size - pos);
+
+    memcpy(out, &d_buf[2 * pos], 2 * chunk * sizeof(float));
+    if (n > chunk)
+        memcpy(out + 2 * chunk, &d_buf[0], 2 * (n - chunk) * sizeof(float));
+
+    d_tail.store(tail + n, std::memory_order_release);
+
+    return n;
+}
@@ -0,0 +1,74 @@
+/* -*- c++ -*- */
+/*
+ * Gqrx SDR: Software defined radio receiver powered by GNU Radio and Qt
+ *           http://gqrx.dk/
+ *
+ * Copyright 2020 Vadym Ostanin.
+ *
+ * Gqrx is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * Gqrx is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Gqrx; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifndef AUDIO_RING_H
+#define AUDIO_RING_H
+
+#include <atomic>
+#include <stdint.h>
+#include <vector>
+
+
+/*! \brief Lock-free stereo audio buffer between the flow graph and the
+ *         audio device.
+ *
+ * Single producer, single consumer ring buffer. The producer (the work()
+ * function of an audio sink) writes separate left and right channels which
+ * are interleaved on the way in. The consumer (the audio device callback)
+ * reads interleaved frames. Neither side ever blocks or takes a lock.
+ */
+class audio_ring
+{
+public:
+    explicit audio_ring(unsigned int frames);
+
+    unsigned int write(const float *left, const float *right,
+                       unsigned int frames);
+    unsigned int read(float *out, unsigned int frames);
+
+    /*! \brief Number of frames available for reading. */
+    unsigned int fill(void) const
+    {
+        return (unsigned int)(d_head.load(std::memory_order_acquire) -
+                              d_tail.load(std::memory_order_acquire));
+    }
+
+    /*! \brief Number of frames that can be written. */
+    unsigned int space(void) const
+    {
+        return d_size - fill();
+    }
+
+    /*! \brief Capacity in frames. */
+    unsigned int size(void) const
+    {
+        return d_size;
+    }
+
+private:
+    std::vector<float>      d_buf;  /*! Interleaved samples. */
+    unsigned int            d_size; /*! Capacity in frames. */
+    std::atomic<uint64_t>   d_head; /*! Frames written, producer only. */
+    std::atomic<uint64_t>   d_tail; /*! Frames read, consumer only. */
+};
+
+#endif // AUDIO_RING_H
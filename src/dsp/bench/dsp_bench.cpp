@@ -0,0 +1,626 @@
+/* -*- c++ -*- */
+/*
+ * Gqrx SDR: Software defined radio receiver powered by GNU Radio and Qt
+ *           http://gqrx.dk/
+ *
+ * Copyright 2020 Vadym Ostanin.
+ *
+ * Gqrx is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * Gqrx is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Gqrx; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#include <gnuradio/blocks/head.h>
+#include <gnuradio/blocks/null_sink.h>
+#if GNURADIO_VERSION < 0x030800
+#include <gnuradio/blocks/vector_sink_f.h>
+#include <gnuradio/blocks/vector_source_c.h>
+#include <gnuradio/blocks/vector_source_f.h>
+#else
+#include <gnuradio/blocks/vector_sink.h>
+#include <gnuradio/blocks/vector_source.h>
+#endif
+#include <gnuradio/blocks/wavfile.h>
+#include <gnuradio/filter/firdes.h>
+#include <gnuradio/top_block.h>
+#include <boost/program_options.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "dsp/afsk1200/cafsk12.h"
+#include "dsp/fft_plan.h"
+#include "dsp/filter/decimator.h"
+#include "dsp/filter/filtercoef_hbf_70.h"
+#include "dsp/filter/filtercoef_hbf_100.h"
+#include "dsp/filter/filtercoef_hbf_140.h"
+#include "dsp/filter/fir_decim.h"
+#include "dsp/hbf_decim.h"
+#include "dsp/resampler_xx.h"
+#include "dsp/rx_agc_xx.h"
+#include "dsp/rx_demod_am.h"
+#include "dsp/rx_demod_fm.h"
+#include "dsp/rx_fft.h"
+#include "dsp/rx_filter.h"
+#include "dsp/rx_noise_blanker_cc.h"
+#include "dsp/rx_rds.h"
+#include "dsp/stereo_demod.h"
+
+namespace po = boost::program_options;
+
+/*
+ * Benchmark of the gqrx DSP blocks.
+ *
+ * Each block runs standalone in its own flow graph on a synthetic signal at
+ * the sample rate it is used with in the receiver:
+ *
+ *   vector_source -> head -> block -> null_sink(s)
+ *
+ * Objects that are not GNU Radio blocks are fed the signal directly: the
+ * AFSK1200 demodulator and the FFT of the pandapter, which rx_fft_c only
+ * computes when the GUI fetches the spectrum. The rx_fft_c entry therefore
+ * measures the buffering in work() and fft_8192 the FFT itself.
+ *
+ * The signals are generated with a fixed seed, so runs are reproducible and
+ * the JSON output can be compared across commits. Every block is run a
+ * number of times and the fastest run is reported.
+ *
+ * With --afsk-wav a recorded AFSK1200 signal is decoded instead, reporting
+ * the number of frames with a valid CRC and the CPU time. This checks the
+ * decoder on real signals, e.g. the WA8LMF APRS test tracks.
+ */
+
+/* Heap allocations, counted by the replacement operator new below. */
+static std::atomic<unsigned long> alloc_count(0);
+
+void *operator new(size_t size)
+{
+    void *p = malloc(size ? size : 1);
+
+    if (!p)
+        throw std::bad_alloc();
+    alloc_count++;
+
+    return p;
+}
+
+void operator delete(void *p) noexcept
+{
+    free(p);
+}
+
+
+struct bench_result {
+    std::string     name;
+    double          rate;       /* sample rate the block is used at */
+    unsigned long   samples;    /* input samples processed */
+    double          seconds;    /* wall time of the fastest run */
+    unsigned long   allocs;     /* heap allocations during that run */
+};
+
+enum sig_type {
+    SIG_COMPLEX,    /* FM modulated carrier in noise */
+    SIG_MPX,        /* FM stereo multiplex with RDS subcarrier */
+    SIG_AFSK        /* AFSK1200 at 22050 Hz */
+};
+
+struct bench_block {
+    bench_block(const char *name, double rate, sig_type type,
+                std::function<gr::basic_block_sptr(void)> make,
+                std::function<Decimator::CDec2 *(void)> stage = nullptr)
+        : name(name), rate(rate), type(type), make(make), stage(stage)
+    {
+    }
+
+    const char     *name;
+    double          rate;
+    sig_type        type;
+    std::function<gr::basic_block_sptr(void)>   make;
+    std::function<Decimator::CDec2 *(void)>     stage;  /* half-band stage */
+};
+
+/* One decimate by 2 stage of hbf_decim with the coefficients HBF_att_len */
+#define HBF_STAGE(att, len) \
+    { "hbf_" #att "_" #len, 20e6, SIG_COMPLEX, nullptr, []() { \
+        return new Decimator::CHalfBandDecimateBy2<HBF_##att##_##len##_LENGTH>( \
+            HBF_##att##_##len); } }
+
+
+/* One second of NFM: 1 kHz tone, 5 kHz deviation, 10 kHz offset, in noise. */
+static std::vector<gr_complex> make_complex_signal(double rate)
+{
+    std::vector<gr_complex>     sig((size_t) rate);
+    std::mt19937                gen(1);
+    std::normal_distribution<float> noise(0.0f, 0.05f);
+    double                      phase = 0.0;
+
+    for (size_t i = 0; i < sig.size(); i++)
+    {
+        double t = i / rate;
+
+        phase += 2.0 * M_PI * (10.e3 + 5.e3 * sin(2.0 * M_PI * 1.e3 * t)) / rate;
+        sig[i] = gr_complex(0.5 * cos(phase) + noise(gen),
+                            0.5 * sin(phase) + noise(gen));
+    }
+
+    return sig;
+}
+
+/* One second of FM multiplex: L+R, L-R, 19 kHz pilot and 57 kHz RDS. */
+static std::vector<float> make_mpx_signal(double rate)
+{
+    std::vector<float>  sig((size_t) rate);
+    std::mt19937        gen(1);
+    std::uniform_int_distribution<int> bit(0, 1);
+    int                 rds = 1;
+
+    for (size_t i = 0; i < sig.size(); i++)
+    {
+        double t = i / rate;
+
+        if (i % (size_t)(rate / 1187.5) == 0)
+            rds = bit(gen) ? 1 : -1;
+
+        sig[i] = 0.4 * sin(2.0 * M_PI * 1.e3 * t) +
+                 0.2 * sin(2.0 * M_PI * 3.e3 * t) * sin(2.0 * M_PI * 38.e3 * t) +
+                 0.1 * sin(2.0 * M_PI * 19.e3 * t) +
+                 0.05 * rds * sin(2.0 * M_PI * 57.e3 * t);
+    }
+
+    return sig;
+}
+
+/* One second of AFSK1200 with random data. */
+static std::vector<float> make_afsk_signal(double rate)
+{
+    std::vector<float>  sig((size_t) rate);
+    std::mt19937        gen(1);
+    std::uniform_int_distribution<int> bit(0, 1);
+    double              phase = 0.0;
+    double              freq = FREQ_MARK;
+
+    for (size_t i = 0; i < sig.size(); i++)
+    {
+        if (i % (size_t)(rate / BAUD) == 0)
+            freq = bit(gen) ? FREQ_MARK : FREQ_SPACE;
+
+        phase += 2.0 * M_PI * freq / rate;
+        sig[i] = 0.5 * sin(phase);
+    }
+
+    return sig;
+}
+
+/* Run a GNU Radio block once and return the wall time in seconds. */
+static double run_block(const bench_block &b, unsigned long samples,
+                        const std::vector<gr_complex> &sig_c,
+                        const std::vector<float> &sig_f,
+                        unsigned long &allocs)
+{
+    gr::top_block_sptr      tb = gr::make_top_block("gqrx_dsp_bench");
+    gr::basic_block_sptr    blk = b.make();
+    gr::basic_block_sptr    src;
+    gr::basic_block_sptr    head;
+    int                     i;
+
+    if (b.type == SIG_COMPLEX)
+    {
+        src = gr::blocks::vector_source_c::make(sig_c, true);
+        head = gr::blocks::head::make(sizeof(gr_complex), samples);
+    }
+    else
+    {
+        src = gr::blocks::vector_source_f::make(sig_f, true);
+        head = gr::blocks::head::make(sizeof(float), samples);
+    }
+
+    tb->connect(src, 0, head, 0);
+    tb->connect(head, 0, blk, 0);
+    for (i = 0; i < blk->output_signature()->min_streams(); i++)
+        tb->connect(blk, i, gr::blocks::null_sink::make(
+                        blk->output_signature()->sizeof_stream_item(i)), 0);
+
+    auto start = std::chrono::steady_clock::now();
+    unsigned long start_allocs = alloc_count;
+    tb->run();
+    allocs = alloc_count - start_allocs;
+
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+/* CAfsk12 is not a GNU Radio block; feed it in chunks like PacketDecoder. */
+static double run_afsk(unsigned long samples, std::vector<float> &sig,
+                       unsigned long &allocs)
+{
+    CAfsk12         afsk;
+    unsigned long   done = 0;
+    unsigned long   n;
+
+    auto start = std::chrono::steady_clock::now();
+    unsigned long start_allocs = alloc_count;
+    while (done < samples)
+    {
+        n = std::min(4096UL, samples - done);
+        afsk.demod(&sig[done % (sig.size() - 4096)], (int) n);
+        done += n;
+    }
+    allocs = alloc_count - start_allocs;
+
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+/*
+ * Read the first channel of a 16 bit WAV file and resample it to the AFSK1200
+ * sample rate. CORRLEN samples of silence are appended, since the demodulator
+ * looks that far ahead of the samples it is given.
+ */
+static bool read_afsk_wav(const std::string &filename, std::vector<float> &sig)
+{
+    FILE           *fp;
+    unsigned int    rate;
+    unsigned int    num;
+    int             chans;
+    int             bytes;
+    int             first;
+    unsigned int    i;
+    int             ch;
+
+    fp = fopen(filename.c_str(), "rb");
+    if (!fp)
+    {
+        std::cerr << "Can not open " << filename << std::endl;
+        return false;
+    }
+
+    if (!gr::blocks::wavheader_parse(fp, rate, chans, bytes, first, num) ||
+        bytes != 2)
+    {
+        std::cerr << filename << " is not a 16 bit WAV file" << std::endl;
+        fclose(fp);
+        return false;
+    }
+
+    sig.resize(num);
+    for (i = 0; i < num; i++)
+    {
+        sig[i] = gr::blocks::wav_read_sample(fp, bytes) / 32768.0f;
+        for (ch = 1; ch < chans; ch++)
+            gr::blocks::wav_read_sample(fp, bytes);
+    }
+    fclose(fp);
+
+    if (rate != FREQ_SAMP)
+    {
+        gr::top_block_sptr              tb = gr::make_top_block("afsk_wav");
+        resampler_ff_sptr               rr = make_resampler_ff((float) FREQ_SAMP / rate);
+        gr::blocks::vector_sink_f::sptr sink = gr::blocks::vector_sink_f::make();
+
+        tb->connect(gr::blocks::vector_source_f::make(sig), 0, rr, 0);
+        tb->connect(rr, 0, sink, 0);
+        tb->run();
+        sig = sink->data();
+    }
+
+    sig.resize(sig.size() + CORRLEN, 0.0f);
+
+    return true;
+}
+
+/* Decode a signal read by read_afsk_wav() and count the valid frames. */
+static double run_afsk_wav(std::vector<float> &sig, unsigned long &frames)
+{
+    CAfsk12         afsk;
+    unsigned long   len = sig.size() - CORRLEN;
+    unsigned long   done = 0;
+    unsigned long   n;
+
+    frames = 0;
+    afsk.setRawFrames(true);
+    QObject::connect(&afsk, &CAfsk12::newFrame,
+                     [&frames](const QByteArray &frame, double) {
+        if (frame.size() >= 10 &&
+            CAfsk12::checkCrc((const unsigned char *) frame.constData(),
+                              frame.size()))
+            frames++;
+    });
+
+    std::clock_t start = std::clock();
+    while (done < len)
+    {
+        n = std::min(4096UL, len - done);
+        afsk.demod(&sig[done], (int) n);
+        done += n;
+    }
+
+    return (double)(std::clock() - start) / CLOCKS_PER_SEC;
+}
+
+/*
+ * A single half-band decimate by 2 stage as used by hbf_decim, called with
+ * the same block size as a GNU Radio work() call.
+ */
+static double run_hbf_stage(const bench_block &b, unsigned long samples,
+                            const std::vector<gr_complex> &sig,
+                            unsigned long &allocs)
+{
+    const int                       size = 8192;
+    std::unique_ptr<Decimator::CDec2> stage(b.stage());
+    std::vector<gr_complex>         out(size / 2);
+    unsigned long                   done = 0;
+    size_t                          pos = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    unsigned long start_allocs = alloc_count;
+    while (done + size <= samples)
+    {
+        if (pos + size > sig.size())
+            pos = 0;
+        stage->DecBy2(size, &sig[pos], &out[0]);
+        pos += size;
+        done += size;
+    }
+    allocs = alloc_count - start_allocs;
+
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+/*
+ * Windowed FFTs back to back over the signal, like rx_fft_c::get_fft_data().
+ * The pandapter computes far fewer FFTs per second, so the real time factor
+ * is how much headroom there is for the FFT rate and size.
+ */
+static double run_fft(unsigned long samples,
+                      const std::vector<gr_complex> &sig,
+                      unsigned long &allocs)
+{
+    const unsigned int  size = 8192;
+    fft_plan_c          fft(size);
+    std::vector<float>  window = gr::filter::firdes::window(
+                                    gr::filter::firdes::WIN_HANN, size, 6.76);
+    gr_complex         *in = fft.get_inbuf();
+    unsigned long       done = 0;
+    size_t              pos = 0;
+    unsigned int        i;
+
+    auto start = std::chrono::steady_clock::now();
+    unsigned long start_allocs = alloc_count;
+    while (done + size <= samples)
+    {
+        if (pos + size > sig.size())
+            pos = 0;
+        for (i = 0; i < size; i++)
+            in[i] = sig[pos + i] * window[i];
+        fft.execute();
+        pos += size;
+        done += size;
+    }
+    allocs = alloc_count - start_allocs;
+
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+/* Decode a WAV file runs times and print the fastest CPU time. */
+static int bench_afsk_wav(const std::string &filename, int runs, bool json)
+{
+    std::vector<float>  sig;
+    unsigned long       frames = 0;
+    double              cpu = 0.0;
+    double              seconds;
+    double              audio;
+
+    if (!read_afsk_wav(filename, sig))
+        return 1;
+
+    for (int i = 0; i < runs; i++)
+    {
+        seconds = run_afsk_wav(sig, frames);
+        if (i == 0 || seconds < cpu)
+            cpu = seconds;
+    }
+
+    audio = (double)(sig.size() - CORRLEN) / FREQ_SAMP;
+    if (json)
+        printf("{\n  \"version\": \"%s\",\n  \"file\": \"%s\",\n"
+               "  \"frames\": %lu,\n  \"audio_seconds\": %.3f,\n"
+               "  \"cpu_seconds\": %.3f\n}\n",
+               VERSION, filename.c_str(), frames, audio, cpu);
+    else
+        printf("%s: %lu frames, %.1f s audio, %.3f s CPU, %.1fx realtime\n",
+               filename.c_str(), frames, audio, cpu,
+               cpu > 0.0 ? audio / cpu : 0.0);
+
+    return 0;
+}
+
+static void print_text(const std::vector<bench_result> &results)
+{
+    printf("%-14s %10s %12s %10s %10s %10s %10s\n", "block", "rate", "samples",
+           "Msps", "ns/sample", "realtime", "allocs");
+
+    for (const bench_result &r : results)
+        printf("%-14s %10.0f %12lu %10.2f %10.2f %9.1fx %10lu\n",
+               r.name.c_str(), r.rate, r.samples,
+               1.e-6 * r.samples / r.seconds,
+               1.e9 * r.seconds / r.samples,
+               r.samples / r.rate / r.seconds,
+               r.allocs);
+}
+
+static void print_json(const std::vector<bench_result> &results)
+{
+    printf("{\n  \"version\": \"%s\",\n  \"results\": [\n", VERSION);
+
+    for (size_t i = 0; i < results.size(); i++)
+    {
+        const bench_result &r = results[i];
+
+        printf("    {\"block\": \"%s\", \"rate\": %.0f, \"samples\": %lu, "
+               "\"msps\": %.3f, \"ns_per_sample\": %.3f, \"allocs\": %lu}%s\n",
+               r.name.c_str(), r.rate, r.samples,
+               1.e-6 * r.samples / r.seconds,
+               1.e9 * r.seconds / r.samples,
+               r.allocs,
+               i + 1 < results.size() ? "," : "");
+    }
+
+    printf("  ]\n}\n");
+}
+
+int main(int argc, char *argv[])
+{
+    double          duration = 10.0;
+    int             runs = 3;
+    std::string     only;
+    std::string     afsk_wav;
+    bool            clierr = false;
+
+    po::options_description desc("Command line options");
+    desc.add_options()
+            ("help,h", "This help message")
+            ("json,j", "Print the results as JSON")
+            ("seconds,s", po::value<double>(&duration), "Seconds of signal per block (default 10)")
+            ("runs,n", po::value<int>(&runs), "Runs per block, the fastest is reported (default 3)")
+            ("block,b", po::value<std::string>(&only), "Only run blocks with this name")
+            ("afsk-wav,w", po::value<std::string>(&afsk_wav), "Decode an AFSK1200 WAV file and report the frames and CPU time")
+    ;
+
+    po::variables_map vm;
+    try
+    {
+        po::store(po::parse_command_line(argc, argv, desc), vm);
+        po::notify(vm);
+    }
+    catch(const boost::program_options::error& ex)
+    {
+        std::cerr << ex.what() << std::endl;
+        clierr = true;
+    }
+
+    if (vm.count("help") || clierr || duration <= 0.0 || runs < 1)
+    {
+        std::cout << "Gqrx DSP benchmark " << VERSION << std::endl;
+        std::cout << desc << std::endl;
+        return 1;
+    }
+
+    if (!afsk_wav.empty())
+        return bench_afsk_wav(afsk_wav, runs, vm.count("json") > 0);
+
+    const std::vector<bench_block> blocks = {
+        { "rx_agc_cc", 96e3, SIG_COMPLEX, []() {
+            return make_rx_agc_cc(96e3, true, -100, 0, 0, 500, false); } },
+        { "rx_nb_cc", 96e3, SIG_COMPLEX, []() {
+            rx_nb_cc_sptr nb = make_rx_nb_cc(96e3, 3.3, 2.5);
+            nb->set_nb1_on(true);
+            nb->set_nb2_on(true);
+            return nb; } },
+        { "rx_filter", 96e3, SIG_COMPLEX, []() {
+            return make_rx_filter(96e3, -5000.0, 5000.0, 1000.0); } },
+        { "rx_demod_fm", 96e3, SIG_COMPLEX, []() {
+            return make_rx_demod_fm(96e3, 5000.0, 75.0e-6); } },
+        { "rx_demod_am", 96e3, SIG_COMPLEX, []() {
+            return make_rx_demod_am(96e3, true); } },
+        { "stereo_demod", 120e3, SIG_MPX, []() {
+            return make_stereo_demod(120e3, 48e3, true); } },
+        { "rx_rds", 240e3, SIG_MPX, []() {
+            return make_rx_rds(240e3); } },
+        { "hbf_decim", 2.4e6, SIG_COMPLEX, []() {
+            return make_hbf_decim(8); } },
+        { "fir_decim_cc", 2.4e6, SIG_COMPLEX, []() {
+            return make_fir_decim_cc(8); } },
+        { "hbf_decim_20M", 20e6, SIG_COMPLEX, []() {
+            return make_hbf_decim(64); } },
+        { "fir_decim_20M", 20e6, SIG_COMPLEX, []() {
+            return make_fir_decim_cc(64); } },
+        HBF_STAGE(70, 11),
+        HBF_STAGE(70, 39),
+        HBF_STAGE(100, 11),
+        HBF_STAGE(100, 19),
+        HBF_STAGE(100, 59),
+        HBF_STAGE(140, 11),
+        HBF_STAGE(140, 15),
+        HBF_STAGE(140, 27),
+        HBF_STAGE(140, 87),
+        { "resampler_cc", 300e3, SIG_COMPLEX, []() {
+            return make_resampler_cc(96e3 / 300e3); } },
+        { "rx_fft_c", 2.4e6, SIG_COMPLEX, []() {
+            return make_rx_fft_c(8192, 2.4e6, gr::filter::firdes::WIN_HANN); } },
+        { "fft_8192", 2.4e6, SIG_COMPLEX, nullptr },
+        { "CAfsk12", FREQ_SAMP, SIG_AFSK, nullptr },
+    };
+
+    std::vector<bench_result> results;
+
+    for (const bench_block &b : blocks)
+    {
+        if (!only.empty() && only != b.name)
+            continue;
+
+        std::vector<gr_complex>     sig_c;
+        std::vector<float>          sig_f;
+        bench_result                res;
+        unsigned long               allocs;
+        double                      seconds;
+
+        if (b.type == SIG_COMPLEX)
+            sig_c = make_complex_signal(b.rate);
+        else if (b.type == SIG_MPX)
+            sig_f = make_mpx_signal(b.rate);
+        else
+            sig_f = make_afsk_signal(b.rate);
+
+        res.name = b.name;
+        res.rate = b.rate;
+        res.samples = (unsigned long)(duration * b.rate);
+        res.seconds = 0.0;
+        res.allocs = 0;
+
+        for (int i = 0; i < runs; i++)
+        {
+            if (b.type == SIG_AFSK)
+                seconds = run_afsk(res.samples, sig_f, allocs);
+            else if (b.stage)
+                seconds = run_hbf_stage(b, res.samples, sig_c, allocs);
+            else if (!b.make)
+                seconds = run_fft(res.samples, sig_c, allocs);
+            else
+                seconds = run_block(b, res.samples, sig_c, sig_f, allocs);
+
+            if (i == 0 || seconds < res.seconds)
+            {
+                res.seconds = seconds;
+                res.allocs = allocs;
+            }
+        }
+
+        results.push_back(res);
+    }
+
+    if (vm.count("json"))
+        print_json(results);
+    else
+        print_text(results);
+
+    return 0;
+}
@@ -0,0 +1,130 @@
+/* -*- c++ -*- */
+/*
+ * Gqrx SDR: Software defined radio receiver powered by GNU Radio and Qt
+ *           http://gqrx.dk/
+ *
+ * Copyright 2020 Vadym Ostanin.
+ *
+ * Gqrx is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * Gqrx is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Gqrx; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#include <algorithm>
+#include <cmath>
+
+#include "dsp/drift_resampler.h"
+
+#define FILL_TAU        5.0     /* time constant of the fill average in s */
+#define KP              0.1     /* rate correction per second of error */
+#define KI              0.001   /* integral gain */
+#define MAX_CORRECTION  1.e-3   /* 1000 ppm */
+
+
+drift_resampler::drift_resampler(int sample_rate, double target_latency)
+    : d_sample_rate(sample_rate),
+      d_target(target_latency),
+      d_integ(0.0)
+{
+    reset();
+}
+
+/*! \brief Reset the resampler state.
+ *
+ * Clears the sample history and the fill average but keeps the drift
+ * estimate, which remains valid when the flow graph is restarted.
+ */
+void drift_resampler::reset(void)
+{
+    for (int ch = 0; ch < 2; ch++)
+        d_in[ch].assign(d_interp.ntaps() - 1, 0.0f);
+
+    d_fill = d_target;
+    d_step = 1.0 + d_integ;
+    d_mu = 0.0;
+}
+
+/*! \brief Resample a block of audio.
+ *  \param left Left channel input.
+ *  \param right Right channel input, may be the same as left.
+ *  \param frames Number of input samples in each channel.
+ *  \param fill Number of frames currently waiting in the output buffer.
+ *  \return The number of output frames, available from left() and right().
+ */
+unsigned int drift_resampler::process(const float *left, const float *right,
+                                      unsigned int frames, unsigned int fill)
+{
+    const float    *input[2] = { left, right };
+    unsigned int    ntaps = d_interp.ntaps();
+    unsigned int    n = 0;
+    unsigned int    pos;
+    double          mu;
+    int             ch;
+
+    update_rate(frames, fill);
+
+    for (ch = 0; ch < 2; ch++)
+    {
+        d_in[ch].insert(d_in[ch].end(), input[ch], input[ch] + frames);
+        d_out[ch].resize(frames + frames / 100 + 2);
+    }
+
+    pos = 0;
+    mu = d_mu;
+    while (pos + ntaps <= d_in[0].size() && n < d_out[0].size())
+    {
+        d_out[0][n] = d_interp.interpolate(&d_in[0][pos], (float) mu);
+        if (right == left)
+            d_out[1][n] = d_out[0][n];
+        else
+            d_out[1][n] = d_interp.interpolate(&d_in[1][pos], (float) mu);
+        n++;
+
+        mu += d_step;
+        pos += (unsigned int) mu;
+        mu -= std::floor(mu);
+    }
+    d_mu = mu;
+
+    // keep the samples needed for the next block
+    pos = std::min(pos, (unsigned int) d_in[0].size());
+    for (ch = 0; ch < 2; ch++)
+        d_in[ch].erase(d_in[ch].begin(), d_in[ch].begin() + pos);
+
+    return n;
+}
+
+/*! \brief Steer the resampling rate towards the target latency.
+ *
+ * A slow PI controller working on the smoothed buffer fill. The integral
+ * term converges to the relative clock error.
+ */
+void drift_resampler::update_rate(unsigned int frames, unsigned int fill)
+{
+    double  dt = (double) frames / d_sample_rate;
+    double  alpha = std::min(1.0, dt / FILL_TAU);
+    double  error;
+    double  correction;
+
+    d_fill += alpha * ((double) fill / d_sample_rate - d_fill);
+    error = d_fill - d_target;
+
+    d_integ += KI * error * dt;
+    d_integ = std::max(-MAX_CORRECTION, std::min(MAX_CORRECTION, d_integ));
+
+    correction = KP * error + d_integ;
+    correction = std::max(-MAX_CORRECTION, std::min(MAX_CORRECTION, correction));
+
+    // too much audio buffered: consume input faster
+    d_step = 1.0 + correction;
+}
@@ -0,0 +1,78 @@
+/* -*- c++ -*- */
+/*
+ * Gqrx SDR: Software defined radio receiver powered by GNU Radio and Qt
+ *           http://gqrx.dk/
+ *
+ * Copyright 2020 Vadym Ostanin.
+ *
+ * Gqrx is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * Gqrx is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Gqrx; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifndef DRIFT_RESAMPLER_H
+#define DRIFT_RESAMPLER_H
+
+#include <gnuradio/filter/mmse_fir_interpolator_ff.h>
+#include <vector>
+
+
+/*! \brief Stereo resampler compensating the drift between the SDR and the
+ *         sound card sample clocks.
+ *  \ingroup DSP
+ *
+ * The SDR and the sound card run on independent clocks, so over time the
+ * audio buffer in front of the sound card either runs empty or overflows.
+ * The caller passes the current buffer fill with every block of audio and
+ * the resampler slowly steers its rate to hold the fill at the target
+ * latency. The rate is changed by at most 1000 ppm, which is inaudible.
+ *
+ * The estimated clock drift is available from get_drift_ppm().
+ */
+class drift_resampler
+{
+public:
+    drift_resampler(int sample_rate, double target_latency);
+
+    unsigned int process(const float *left, const float *right,
+                         unsigned int frames, unsigned int fill);
+
+    /*! \brief Left channel output of the last process() call. */
+    const float *left(void) const { return &d_out[0][0]; }
+
+    /*! \brief Right channel output of the last process() call. */
+    const float *right(void) const { return &d_out[1][0]; }
+
+    /*! \brief Estimated clock drift, positive if the SDR delivers audio
+     *         faster than the sound card plays it. */
+    double get_drift_ppm(void) const { return d_integ * 1.e6; }
+
+    void reset(void);
+
+private:
+    void update_rate(unsigned int frames, unsigned int fill);
+
+    gr::filter::mmse_fir_interpolator_ff    d_interp;
+
+    std::vector<float>  d_in[2];    /*! History and new input. */
+    std::vector<float>  d_out[2];   /*! Resampled output. */
+
+    int         d_sample_rate;
+    double      d_target;   /*! Target latency in seconds. */
+    double      d_fill;     /*! Smoothed buffer fill in seconds. */
+    double      d_integ;    /*! Integral term, the long term rate error. */
+    double      d_step;     /*! Input samples per output sample. */
+    double      d_mu;       /*! Fractional input position. */
+};
+
+#endif // DRIFT_RESAMPLER_H
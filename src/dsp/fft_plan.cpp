@@ -0,0 +1,90 @@
+/* -*- c++ -*- */
+/*
+ * Gqrx SDR: Software defined radio receiver powered by GNU Radio and Qt
+ *           http://gqrx.dk/
+ *
+ * Copyright 2020 Vadym Ostanin.
+ *
+ * Gqrx is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * Gqrx is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Gqrx; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+#include <gnuradio/fft/fft.h>
+#include "dsp/fft_plan.h"
+
+std::string fft_plan_c::d_wisdom_file;
+
+/*! \brief Create a new FFT plan.
+ *  \param size The FFT size.
+ *
+ * The plan is measured unless the wisdom already contains a plan for this
+ * size, which may take a few seconds for large sizes. New wisdom is saved
+ * to the wisdom file right away.
+ */
+fft_plan_c::fft_plan_c(unsigned int size)
+    : d_size(size)
+{
+    gr::fft::planner::scoped_lock lock(gr::fft::planner::mutex());
+
+    d_inbuf = (gr_complex *) fftwf_malloc(sizeof(gr_complex) * d_size);
+    d_outbuf = (gr_complex *) fftwf_malloc(sizeof(gr_complex) * d_size);
+    if (!d_inbuf || !d_outbuf)
+        throw std::runtime_error("fft_plan_c: can not allocate FFT buffers");
+
+    d_plan = fftwf_plan_dft_1d(d_size,
+                               reinterpret_cast<fftwf_complex *>(d_inbuf),
+                               reinterpret_cast<fftwf_complex *>(d_outbuf),
+                               FFTW_FORWARD, FFTW_MEASURE);
+    if (!d_plan)
+        throw std::runtime_error("fft_plan_c: can not create FFTW plan");
+
+    if (!d_wisdom_file.empty())
+        fftwf_export_wisdom_to_filename(d_wisdom_file.c_str());
+
+    /* planning with FFTW_MEASURE overwrites the buffers */
+    std::fill(d_inbuf, d_inbuf + d_size, gr_complex(0.0f, 0.0f));
+}
+
+fft_plan_c::~fft_plan_c()
+{
+    gr::fft::planner::scoped_lock lock(gr::fft::planner::mutex());
+
+    fftwf_destroy_plan(d_plan);
+    fftwf_free(d_inbuf);
+    fftwf_free(d_outbuf);
+}
+
+/*! \brief Compute the FFT of the input buffer into the output buffer. */
+void fft_plan_c::execute()
+{
+    fftwf_execute(d_plan);
+}
+
+/*! \brief Set the file where FFTW wisdom is stored and load it.
+ *  \param filename The wisdom file, usually in the configuration directory.
+ *
+ * This should be called before the first plan is created, i.e. before the
+ * receiver is created.
+ */
+void fft_plan_c::set_wisdom_file(const std::string &filename)
+{
+    gr::fft::planner::scoped_lock lock(gr::fft::planner::mutex());
+
+    d_wisdom_file = filename;
+    if (fftwf_import_wisdom_from_filename(d_wisdom_file.c_str()))
+        std::cout << "Loaded FFTW wisdom from " << d_wisdom_file << std::endl;
+}
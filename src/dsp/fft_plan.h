@@ -0,0 +1,64 @@
+/* -*- c++ -*- */
+/*
+ * Gqrx SDR: Software defined radio receiver powered by GNU Radio and Qt
+ *           http://gqrx.dk/
+ *
+ * Copyright 2020 Vadym Ostanin.
+ *
+ * Gqrx is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * Gqrx is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Gqrx; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifndef FFT_PLAN_H
+#define FFT_PLAN_H
+
+#include <string>
+#include <fftw3.h>
+#include <gnuradio/gr_complex.h>
+
+/*! \brief Forward complex FFT with its own FFTW plan.
+ *  \ingroup DSP
+ *
+ * Similar to gr::fft::fft_complex but the FFTW wisdom is stored in a file
+ * chosen by the application and creating a plan can be done in any thread,
+ * so large plans can be prepared without blocking the DSP thread.
+ *
+ * Planning is serialized with the GNU Radio FFT blocks through the GNU Radio
+ * planner mutex since the FFTW planner is not thread safe. execute() may be
+ * called without locking.
+ */
+class fft_plan_c
+{
+public:
+    explicit fft_plan_c(unsigned int size);
+    ~fft_plan_c();
+
+    gr_complex *get_inbuf() const { return d_inbuf; }
+    gr_complex *get_outbuf() const { return d_outbuf; }
+    unsigned int size() const { return d_size; }
+
+    void execute();
+
+    static void set_wisdom_file(const std::string &filename);
+
+private:
+    unsigned int    d_size;     /*! FFT size. */
+    gr_complex     *d_inbuf;    /*! Input buffer allocated by FFTW. */
+    gr_complex     *d_outbuf;   /*! Output buffer allocated by FFTW. */
+    fftwf_plan      d_plan;     /*! The FFTW plan. */
+
+    static std::string  d_wisdom_file;  /*! Where the wisdom is stored. */
+};
+
+#endif // FFT_PLAN_H
@@ -12,13 +12,14 @@
  */
 #include <gnuradio/gr_complex.h>
 #include <stdio.h>
+#include <string.h>
+#include <volk/volk.h>
 
 #include "decimator.h"
 #include "filtercoef_hbf_70.h"
 #include "filtercoef_hbf_100.h"
 #include "filtercoef_hbf_140.h"
 
-#define MAX_HALF_BAND_BUFSIZE 32768
 #define DECIM_IS_POWER_OF_2(x)        ((x != 0) && ((x & (~x + 1)) == x))
 
 Decimator::Decimator()
@@ -27,6 +28,7 @@ Decimator::Decimator()
 
     decim = 0;
     atten = 0;
+    num_stages = 0;
 
     for (i = 0; i < MAX_STAGES; i++)
         filter_table[i] = 0;
@@ -65,16 +67,29 @@ unsigned int Decimator::init(unsigned int _decim, unsigned int _att)
     return decim;
 }
 
-int Decimator::process(int samples, gr_complex * pin, gr_complex * pout)
+/*
+ * Decimate a block of samples.
+ * The number of input samples must be a multiple of the decimation. The input
+ * buffer is not modified and may be a GNU Radio input buffer.
+ */
+int Decimator::process(int samples, const gr_complex * pin, gr_complex * pout)
 {
-    int         i = 0;
-    int         n = samples;
+    const gr_complex   *in = pin;
+    gr_complex         *out;
+    int                 i;
+    int                 n = samples;
 
-    while (filter_table[i])
-        n = filter_table[i++]->DecBy2(n, pin, pin);
+    if (num_stages > 1 && (int)buffer.size() < samples / 2)
+        buffer.resize(samples / 2);
 
-    for(i = 0; i < n; i++)
-        pout[i] = pin[i];
+    // first stage reads the input, intermediate stages work in place and the
+    // last stage writes to the output buffer
+    for (i = 0; i < num_stages; i++)
+    {
+        out = (i == num_stages - 1) ? pout : &buffer[0];
+        n = filter_table[i]->DecBy2(n, in, out);
+        in = out;
+    }
 
     return n;
 }
@@ -91,6 +106,7 @@ void Decimator::delete_filters()
             filter_table[i] = 0;
         }
     }
+    num_stages = 0;
 }
 
 int Decimator::init_filters_70(unsigned int decimation)
@@ -101,17 +117,18 @@ int Decimator::init_filters_70(unsigned int decimation)
     {
         if (decimation >= 4)
         {
-            filter_table[n++] = new CHalfBand11TapDecimateBy2(HBF_70_11);
-            fprintf(stderr, "  DEC %d: HBF_70_11 (unrolled)\n", n);
+            filter_table[n++] = new CHalfBandDecimateBy2<HBF_70_11_LENGTH>(HBF_70_11);
+            fprintf(stderr, "  DEC %d: HBF_70_11\n", n);
         }
         else if (decimation == 2)
         {
-            filter_table[n++] = new CHalfBandDecimateBy2(HBF_70_39_LENGTH, HBF_70_39);
+            filter_table[n++] = new CHalfBandDecimateBy2<HBF_70_39_LENGTH>(HBF_70_39);
             fprintf(stderr, "  DEC %d: HBF_70_39\n", n);
         }
 
         decimation /= 2;
     }
+    num_stages = n;
 
     return (1 << n);
 }
@@ -124,22 +141,23 @@ int Decimator::init_filters_100(unsigned int decimation)
     {
         if (decimation >= 8)
         {
-            filter_table[n++] = new CHalfBand11TapDecimateBy2(HBF_100_11);
-            fprintf(stderr, "  DEC %d: HBF_100_11 (unrolled)\n", n);
+            filter_table[n++] = new CHalfBandDecimateBy2<HBF_100_11_LENGTH>(HBF_100_11);
+            fprintf(stderr, "  DEC %d: HBF_100_11\n", n);
         }
         else if (decimation == 4)
         {
-            filter_table[n++] = new CHalfBandDecimateBy2(HBF_100_19_LENGTH, HBF_100_19);
+            filter_table[n++] = new CHalfBandDecimateBy2<HBF_100_19_LENGTH>(HBF_100_19);
             fprintf(stderr, "  DEC %d: HBF_100_19\n", n);
         }
         else if (decimation == 2)
         {
-            filter_table[n++] = new CHalfBandDecimateBy2(HBF_100_59_LENGTH, HBF_100_59);
+            filter_table[n++] = new CHalfBandDecimateBy2<HBF_100_59_LENGTH>(HBF_100_59);
             fprintf(stderr, "  DEC %d: HBF_100_59\n", n);
         }
 
         decimation /= 2;
     }
+    num_stages = n;
 
     return (1 << n);
 }
@@ -152,189 +170,115 @@ int Decimator::init_filters_140(unsigned int decimation)
     {
         if (decimation >= 16)
         {
-            filter_table[n++] = new CHalfBand11TapDecimateBy2(HBF_140_11);
-            fprintf(stderr, "  DEC %d: HBF_140_11 (unrolled)\n", n);
+            filter_table[n++] = new CHalfBandDecimateBy2<HBF_140_11_LENGTH>(HBF_140_11);
+            fprintf(stderr, "  DEC %d: HBF_140_11\n", n);
         }
         else if (decimation == 8)
         {
-            filter_table[n++] = new CHalfBandDecimateBy2(HBF_140_15_LENGTH, HBF_140_15);
+            filter_table[n++] = new CHalfBandDecimateBy2<HBF_140_15_LENGTH>(HBF_140_15);
             fprintf(stderr, "  DEC %d: HBF_140_15\n", n);
         }
         else if (decimation == 4)
         {
-            filter_table[n++] = new CHalfBandDecimateBy2(HBF_140_27_LENGTH, HBF_140_27);
+            filter_table[n++] = new CHalfBandDecimateBy2<HBF_140_27_LENGTH>(HBF_140_27);
             fprintf(stderr, "  DEC %d: HBF_140_27\n", n);
         }
         else if (decimation == 2)
         {
-            filter_table[n++] = new CHalfBandDecimateBy2(HBF_140_87_LENGTH, HBF_140_87);
+            filter_table[n++] = new CHalfBandDecimateBy2<HBF_140_87_LENGTH>(HBF_140_87);
             fprintf(stderr, "  DEC %d: HBF_140_87\n", n);
         }
 
         decimation /= 2;
     }
+    num_stages = n;
 
     return (1 << n);
 }
 
-Decimator::CHalfBandDecimateBy2::CHalfBandDecimateBy2(int len, const float * pCoef)
-    : m_FirLength(len), m_pCoef(pCoef)
+template <int N>
+Decimator::CHalfBandDecimateBy2<N>::CHalfBandDecimateBy2(const float * pCoef)
+    : m_Even(NUM_TAPS - 1 + BLOCK_SIZE, gr_complex(0.0, 0.0)),
+      m_Odd(ODD_DELAY + BLOCK_SIZE, gr_complex(0.0, 0.0)),
+      m_Pair(2 * BLOCK_SIZE, 0.0f)
 {
-    gr_complex  CPXZERO(0.0,0.0);
+    int     i;
 
-    // create buffer for FIR implementation
-    m_pHBFirBuf = new gr_complex[MAX_HALF_BAND_BUFSIZE];
-    for (int i = 0; i < MAX_HALF_BAND_BUFSIZE; i++)
-        m_pHBFirBuf[i] = CPXZERO;
+    // the taps are symmetric, so tap i of the even branch is also tap
+    // NUM_TAPS - 1 - i and the order of the delay lines does not matter
+    for (i = 0; i < NUM_PAIRS; i++)
+        m_Taps[i] = pCoef[2 * i];
+
+    m_Center = pCoef[(N - 1) / 2];
 }
 
 /*
  * Half band filter and decimate by 2 function.
- * Two restrictions on this routine:
- * InLength must be larger or equal to the Number of Halfband Taps
- * InLength must be an even number
+ * InLength must be an even number. Input and output may be the same buffer.
  */
-int Decimator::CHalfBandDecimateBy2::DecBy2(int InLength, gr_complex * pInData,
-                                            gr_complex * pOutData)
+template <int N>
+int Decimator::CHalfBandDecimateBy2<N>::DecBy2(int InLength,
+                                               const gr_complex * pInData,
+                                               gr_complex * pOutData)
 {
-    gr_complex     acc;
-    int     i;
-    int     j;
-    int     numoutsamples = 0;
-
-    // copy input samples into buffer starting at position m_FirLength-1
-    for (i = 0, j = m_FirLength - 1; i < InLength; i++)
-        m_pHBFirBuf[j++] = pInData[i];
-
-    // perform decimation FIR filter on even samples
-    for (i = 0; i < InLength; i += 2)
+    gr_complex     *even;
+    gr_complex     *odd;
+    const float    *x;
+    float          *acc;
+    float          *pair = &m_Pair[0];
+    int             numoutsamples = InLength / 2;
+    int             done;
+    int             n;
+    int             i;
+    int             k;
+
+    for (done = 0; done < numoutsamples; done += n)
     {
-        acc = m_pHBFirBuf[i] * m_pCoef[0];
-        for (j = 0; j < m_FirLength; j += 2)
-            acc += m_pHBFirBuf[i+j] * m_pCoef[j];
+        n = numoutsamples - done;
+        if (n > BLOCK_SIZE)
+            n = BLOCK_SIZE;
+
+        // split input into the two polyphase branches after the history;
+        // this consumes the input before any output of this block is written
+        even = &m_Even[NUM_TAPS - 1];
+        odd = &m_Odd[ODD_DELAY];
+        for (i = 0; i < n; i++)
+        {
+            even[i] = pInData[2 * (done + i)];
+            odd[i] = pInData[2 * (done + i) + 1];
+        }
 
-        // center coefficient
-        acc += m_pHBFirBuf[i+(m_FirLength-1)/2] * m_pCoef[(m_FirLength-1)/2];
-        pOutData[numoutsamples++] = acc;
-    }
+        // Filter the whole block one tap pair at a time. Output i uses the
+        // even branch samples i .. i + NUM_TAPS - 1, so for pair k the sums
+        // of sample i + k and i + NUM_TAPS - 1 - k of all outputs are two
+        // contiguous vectors. The I and Q components are treated as
+        // separate real samples.
+        x = reinterpret_cast<const float *>(&m_Even[0]);
+        acc = reinterpret_cast<float *>(&pOutData[done]);
+        volk_32f_s32f_multiply_32f(acc, reinterpret_cast<const float *>(&m_Odd[0]),
+                                   m_Center, 2 * n);
+        for (k = 0; k < NUM_PAIRS; k++)
+        {
+            volk_32f_x2_add_32f(pair, &x[2 * k], &x[2 * (NUM_TAPS - 1 - k)],
+                                2 * n);
+            volk_32f_s32f_multiply_32f(pair, pair, m_Taps[k], 2 * n);
+            volk_32f_x2_add_32f(acc, acc, pair, 2 * n);
+        }
 
-    // need to copy last m_FirLength - 1 input samples in buffer to beginning of buffer
-    // for FIR wrap around management
-    for (i = 0, j = InLength - m_FirLength + 1; i < m_FirLength - 1; i++)
-        m_pHBFirBuf[i] = pInData[j++];
+        // keep the last samples as history for the next block
+        memmove(&m_Even[0], &m_Even[n], (NUM_TAPS - 1) * sizeof(gr_complex));
+        memmove(&m_Odd[0], &m_Odd[n], ODD_DELAY * sizeof(gr_complex));
+    }
 
     return numoutsamples;
 }
 
-/*
- * Decimate by 2 Fixed 11 Tap Halfband filter class implementation
- */
-Decimator::CHalfBand11TapDecimateBy2::CHalfBand11TapDecimateBy2(const float * coef)
-{
-    gr_complex     CPXZERO(0.0, 0.0);
-
-    // preload only the taps that are used since evey other one is zero
-    // except center tap 5
-    H0 = coef[0];
-    H2 = coef[2];
-    H4 = coef[4];
-    H5 = coef[5];
-    H6 = coef[6];
-    H8 = coef[8];
-    H10 = coef[10];
-
-    d0 = CPXZERO;
-    d1 = CPXZERO;
-    d2 = CPXZERO;
-    d3 = CPXZERO;
-    d4 = CPXZERO;
-    d5 = CPXZERO;
-    d6 = CPXZERO;
-    d7 = CPXZERO;
-    d8 = CPXZERO;
-    d9 = CPXZERO;
-}
-
-/*
- * Decimate by 2 Fixed 11 Tap Halfband filter class implementation
- * Two restrictions on this routine:
- * InLength must be larger or equal to the Number of Halfband Taps(11)
- * InLength must be an even number
- * Loop unrolled for speed
- */
-int Decimator::CHalfBand11TapDecimateBy2::DecBy2(int InLength,
-                                                 gr_complex * pInData,
-                                                 gr_complex * pOutData)
-{
-    // calculate first 10 samples using previous samples in delay buffer
-    gr_complex     tmpout[9];
-
-    tmpout[0] = H0 * d0 + H2 * d2 + H4 * d4 + H5 * d5 + H6 * d6 + H8 * d8
-            + H10 * pInData[0];
-
-    tmpout[1] = H0 * d2 + H2 * d4 + H4 * d6 + H5 * d7 + H6 * d8
-            + H8 * pInData[0] + H10 * pInData[2];
-
-    tmpout[2] = H0 * d4 + H2 * d6 + H4 * d8 + H5 * d9 + H6 * pInData[0]
-            + H8 * pInData[2] + H10 * pInData[4];
-
-    tmpout[3] = H0 * d6 + H2 * d8 + H4 * pInData[0] + H5 * pInData[1]
-            + H6 * pInData[2] + H8 * pInData[4] + H10 * pInData[6];
-
-    tmpout[4] = H0 * d8 + H2 * pInData[0] + H4 * pInData[2] + H5 * pInData[3]
-            + H6 * pInData[4] + H8 * pInData[6] + H10 * pInData[8];
-
-    tmpout[5] = H0 * pInData[0] + H2 * pInData[2] + H4 * pInData[4]
-            + H5 * pInData[5] + H6 * pInData[6] + H8 * pInData[8]
-            + H10 * pInData[10];
-
-    tmpout[6] = H0 * pInData[2] + H2 * pInData[4] + H4 * pInData[6]
-            + H5 * pInData[7] + H6 * pInData[8] + H8 * pInData[10]
-            + H10 * pInData[12];
-
-    tmpout[7] = H0 * pInData[4] + H2 * pInData[6] + H4 * pInData[8]
-            + H5 * pInData[9] + H6 * pInData[10] + H8 * pInData[12]
-            + H10 * pInData[14];
-
-    tmpout[8] = H0 * pInData[6] + H2 * pInData[8] + H4 * pInData[10]
-            + H5 * pInData[11] + H6 * pInData[12] + H8 * pInData[14]
-            + H10 * pInData[16];
-
-    // now loop through remaining input samples
-    gr_complex     *pIn = &pInData[8];
-    gr_complex     *pOut = &pOutData[9];
-    int         i;
-
-    for(i = 0; i < (InLength - 11 - 6) / 2; i++)
-    {
-      *pOut++ = (H0 * pIn[0]) + (H2 * pIn[2]) + (H4 * pIn[4]) +
-        (H5 * pIn[5]) + (H6 * pIn[6]) + (H8 * pIn[8]) + (H10 * pIn[10]);
-      pIn += 2;
-    }
-
-    // copy first outputs back into output array so outbuf can be same as inbuf
-    pOutData[0] = tmpout[0];
-    pOutData[1] = tmpout[1];
-    pOutData[2] = tmpout[2];
-    pOutData[3] = tmpout[3];
-    pOutData[4] = tmpout[4];
-    pOutData[5] = tmpout[5];
-    pOutData[6] = tmpout[6];
-    pOutData[7] = tmpout[7];
-    pOutData[8] = tmpout[8];
-
-    // copy last 10 input samples into delay buffer for next time
-    pIn = &pInData[InLength-1];
-    d9 = *pIn--;
-    d8 = *pIn--;
-    d7 = *pIn--;
-    d6 = *pIn--;
-    d5 = *pIn--;
-    d4 = *pIn--;
-    d3 = *pIn--;
-    d2 = *pIn--;
-    d1 = *pIn--;
-    d0 = *pIn;
-
-    return InLength / 2;
-}
+// filter lengths used by the init_filters_xxx() functions; the 11 tap stages
+// of all three attenuations share one instantiation
+template class Decimator::CHalfBandDecimateBy2<HBF_70_11_LENGTH>;
+template class Decimator::CHalfBandDecimateBy2<HBF_70_39_LENGTH>;
+template class Decimator::CHalfBandDecimateBy2<HBF_100_19_LENGTH>;
+template class Decimator::CHalfBandDecimateBy2<HBF_100_59_LENGTH>;
+template class Decimator::CHalfBandDecimateBy2<HBF_140_15_LENGTH>;
+template class Decimator::CHalfBandDecimateBy2<HBF_140_27_LENGTH>;
+template class Decimator::CHalfBandDecimateBy2<HBF_140_87_LENGTH>;
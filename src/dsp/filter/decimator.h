@@ -14,6 +14,7 @@
 #define DECIMATOR_H 1
 
 #include <gnuradio/gr_complex.h>
+#include <vector>
 
 #define MAX_DECIMATION          512
 #define MAX_STAGES              9
@@ -25,10 +26,15 @@ public:
     virtual    ~Decimator();
 
     unsigned int    init(unsigned int _decim, unsigned int _att);
-    int             process(int samples, gr_complex * pin,
+    int             process(int samples, const gr_complex * pin,
                             gr_complex * pout);
 
-private:
+    /*
+     * The decimate by 2 stages are public so that gqrx_dsp_bench can measure
+     * each coefficient set on its own. All the filter lengths used by the
+     * coefficient sets in filtercoef_hbf_*.h are instantiated in
+     * decimator.cpp.
+     */
 
     /**
      * Abstract base class for all the different types of decimate by 2 stages
@@ -38,44 +44,50 @@ private:
     public:
         CDec2() {}
         virtual    ~CDec2(){}
-        virtual int DecBy2(int InLength, gr_complex * pInData,
+        virtual int DecBy2(int InLength, const gr_complex * pInData,
                            gr_complex * pOutData) = 0;
     };
 
     /**
-     * Generic dcimate-by-2 class
+     * Polyphase half-band decimate-by-2 stage.
+     *
+     * The filter length N is a template parameter so that the number of taps
+     * and the delay lines are fixed at compile time. Every other tap of a
+     * half-band filter is zero except the center one, so the input is split
+     * into an even branch filtered by the (N+1)/2 non-zero taps and an odd
+     * branch that is only delayed and scaled by the center tap.
+     *
+     * The filter is linear phase, so the taps of the even branch are
+     * symmetric and each one is applied to the sum of the two samples that
+     * share it. The input is processed in blocks and each tap pair is
+     * applied to the whole block with VOLK kernels, so the work is done by
+     * the SIMD implementation VOLK selects for the CPU at runtime and the
+     * call overhead is spread over BLOCK_SIZE output samples.
      */
+    template <int N>
     class CHalfBandDecimateBy2 : public CDec2
     {
-    public:
-        CHalfBandDecimateBy2(int len, const float * pCoef);
-        ~CHalfBandDecimateBy2() {
-            if(m_pHBFirBuf) delete [] m_pHBFirBuf;
-        }
-        int     DecBy2(int InLength, gr_complex * pInData,
-                       gr_complex * pOutData);
-
-        gr_complex     *m_pHBFirBuf;
-        int             m_FirLength;
-        const float    *m_pCoef;
-    };
+        static_assert(N % 4 == 3, "Half-band filter length must be 4k+3");
 
-    /**
-     * 11-tap half-band filter with unrolled loop.
-     */
-    class CHalfBand11TapDecimateBy2 : public CDec2
-    {
     public:
-        CHalfBand11TapDecimateBy2(const float * coef);
-        ~CHalfBand11TapDecimateBy2() {}
-        int     DecBy2(int InLength, gr_complex * pInData,
+        explicit CHalfBandDecimateBy2(const float * pCoef);
+        ~CHalfBandDecimateBy2() {}
+        int     DecBy2(int InLength, const gr_complex * pInData,
                        gr_complex * pOutData);
 
-        // coefficients
-        float               H0, H2, H4, H5, H6, H8, H10;
+    private:
+        enum {
+            NUM_TAPS = (N + 1) / 2,     /* taps in the even branch */
+            NUM_PAIRS = (N + 1) / 4,    /* pairs of symmetric taps */
+            ODD_DELAY = (N + 1) / 4,    /* delay of the odd branch */
+            BLOCK_SIZE = 1024           /* output samples per block */
+        };
 
-        // delay buffer
-        std::complex<float> d0, d1, d2, d3, d4, d5, d6, d7, d8, d9;
+        float                    m_Taps[NUM_PAIRS]; /* first half of the even taps */
+        float                    m_Center;  /* center tap */
+        std::vector<gr_complex>  m_Even;    /* even branch delay line */
+        std::vector<gr_complex>  m_Odd;     /* odd branch delay line */
+        std::vector<float>       m_Pair;    /* sums of one tap pair */
     };
 
 private:
@@ -84,6 +96,9 @@ private:
     int         init_filters_140(unsigned int decimation);
     void        delete_filters();
     CDec2      *filter_table[MAX_STAGES];
+    int         num_stages;
+
+    std::vector<gr_complex> buffer;     /* intermediate stage output */
 
     unsigned int        atten;
     unsigned int        decim;
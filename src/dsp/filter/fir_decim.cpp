@@ -21,7 +21,8 @@
  * the Free Software Foundation, Inc., 51 Franklin Street,
  * Boston, MA 02110-1301, USA.
  */
-#include <cstdio>
+#include <iostream>
+#include <stdexcept>
 #include <vector>
 
 #if GNURADIO_VERSION < 0x030800
@@ -34,13 +35,12 @@
 #include "fir_decim.h"
 #include "fir_decim_coef.h"
 
-#ifdef USE_NEW_FIR_DECIM
 struct decimation_stage
 {
-    int         decimation;
-    int         ratio;
-    int         length;
-    const float *kernel;
+    unsigned int    decimation;
+    unsigned int    ratio;
+    int             length;
+    const float    *kernel;
 };
 
 static const int decimation_stage_count = 8;
@@ -95,7 +95,6 @@ static const decimation_stage decimation_stages[] =
         d_256_r_64_kernel
     }
 };
-#endif
 
 fir_decim_cc_sptr make_fir_decim_cc(unsigned int decim)
 {
@@ -108,11 +107,18 @@ fir_decim_cc::fir_decim_cc(unsigned int decim)
           gr::io_signature::make(1, 1, sizeof(gr_complex)))
 {
     std::vector<float>  taps;
-
-#ifdef USE_NEW_FIR_DECIM
-    int this_stage = 0;
-    int index = decimation_stage_count - 1;
-
+    unsigned int        i;
+    int                 index = decimation_stage_count - 1;
+
+    if (decim < 2 || (decim & (decim - 1)) != 0)
+        throw std::range_error("Decimation must be a power of 2");
+
+    /* Plan the stages starting with the largest kernel that divides the
+     * remaining decimation. A kernel designed for a larger total decimation
+     * than what is left has a wider passband than necessary, so it is also
+     * safe to use for the first stages of larger decimations, e.g.
+     * 512 = d_256_r_64 + d_8_r_8.
+     */
     std::cout << "Decimation: " << decim << std::endl;
     while (decim > 1 && index >= 0)
     {
@@ -120,20 +126,12 @@ fir_decim_cc::fir_decim_cc(unsigned int decim)
 
         if (decim % stage->decimation == 0)
         {
-            this_stage++;
             taps.assign(stage->kernel, stage->kernel + stage->length);
-            if (this_stage == 1)
-                fir1 = gr::filter::fir_filter_ccf::make(stage->ratio, taps);
-            else if (this_stage == 2)
-                fir2 = gr::filter::fir_filter_ccf::make(stage->ratio, taps);
-            else if (this_stage == 3)  // NB: currently max 2 stages
-                fir3 = gr::filter::fir_filter_ccf::make(stage->ratio, taps);
-            else
-                std::cout << "  Too many decimation stages: " << this_stage
-                          << std::endl;
+            stages.push_back(gr::filter::fir_filter_ccf::make(stage->ratio, taps));
 
-            std::cout << "  stage: " << this_stage << "  ratio: " << stage->ratio
-                      << std::endl;
+            std::cout << "  stage: " << stages.size()
+                      << "  ratio: " << stage->ratio
+                      << "  taps: " << stage->length << std::endl;
             decim /= stage->ratio;
         }
         else
@@ -142,136 +140,10 @@ fir_decim_cc::fir_decim_cc(unsigned int decim)
         }
     }
 
-    if (this_stage == 1)
-    {
-        connect(self(), 0, fir1, 0);
-        connect(fir1, 0, self(), 0);
-    }
-    else if (this_stage == 2)
-    {
-        connect(self(), 0, fir1, 0);
-        connect(fir1, 0, fir2, 0);
-        connect(fir2, 0, self(), 0);
-    }
-    else
-    {
-        connect(self(), 0, fir1, 0);
-        connect(fir1, 0, fir2, 0);
-        connect(fir2, 0, fir3, 0);
-        connect(fir3, 0, self(), 0);
-    }
-
-#else
-    switch (decim)
-    {
-    default:
-        std::cout << "Invalid decimation: " << decim
-                  << " (falling back to 2)." << std::endl;
-        // fallthrough
-    case 2:
-        // Stage   Passband        Stopband        Decimation
-        // FIR1    0.4500000000    0.5500000000    2
-        taps.assign(FIR_2_1_TAPS, FIR_2_1_TAPS + FIR_2_1_LEN);
-        fir1 = gr::filter::fir_filter_ccf::make(2, taps);
-        connect(self(), 0, fir1, 0);
-        connect(fir1, 0, self(), 0);
-        break;
-
-    case 4:
-        // Stage   Passband        Stopband        Decimation
-        // FIR1    0.2250000000    0.7750000000    2
-        // FIR2    0.4500000000    0.5500000000    2
-        taps.assign(FIR_4_1_TAPS, FIR_4_1_TAPS + FIR_4_1_LEN);
-        fir1 = gr::filter::fir_filter_ccf::make(2, taps);
-        taps.assign(FIR_4_2_TAPS, FIR_4_2_TAPS + FIR_4_2_LEN);
-        fir2 = gr::filter::fir_filter_ccf::make(2, taps);
-        connect(self(), 0, fir1, 0);
-        connect(fir1, 0, fir2, 0);
-        connect(fir2, 0, self(), 0);
-        break;
-
-    case 8:
-        // Stage   Passband        Stopband        Decimation
-        // FIR1    0.1125000000    0.3875000000    4
-        // FIR2    0.4500000000    0.5500000000    2
-        taps.assign(FIR_8_1_TAPS, FIR_8_1_TAPS + FIR_8_1_LEN);
-        fir1 = gr::filter::fir_filter_ccf::make(4, taps);
-        taps.assign(FIR_8_2_TAPS, FIR_8_2_TAPS + FIR_8_2_LEN);
-        fir2 = gr::filter::fir_filter_ccf::make(2, taps);
-        connect(self(), 0, fir1, 0);
-        connect(fir1, 0, fir2, 0);
-        connect(fir2, 0, self(), 0);
-        break;
-
-    case 16:
-        // Stage   Passband        Stopband        Decimation
-        // FIR1    0.0562500000    0.4437500000    4
-        // FIR2    0.2250000000    0.7750000000    2
-        // FIR3    0.4500000000    0.5500000000    2
-        taps.assign(FIR_16_1_TAPS, FIR_16_1_TAPS + FIR_16_1_LEN);
-        fir1 = gr::filter::fir_filter_ccf::make(4, taps);
-        taps.assign(FIR_16_2_TAPS, FIR_16_2_TAPS + FIR_16_2_LEN);
-        fir2 = gr::filter::fir_filter_ccf::make(2, taps);
-        taps.assign(FIR_16_3_TAPS, FIR_16_3_TAPS + FIR_16_3_LEN);
-        fir3 = gr::filter::fir_filter_ccf::make(2, taps);
-        connect(self(), 0, fir1, 0);
-        connect(fir1, 0, fir2, 0);
-        connect(fir2, 0, fir3, 0);
-        connect(fir3, 0, self(), 0);
-        break;
-
-    case 32:
-        // Stage   Passband        Stopband        Decimation
-        // FIR1    0.0281250000    0.2218750000    8
-        // FIR2    0.2250000000    0.7750000000    2
-        // FIR3    0.4500000000    0.5500000000    2
-        taps.assign(FIR_32_1_TAPS, FIR_32_1_TAPS + FIR_32_1_LEN);
-        fir1 = gr::filter::fir_filter_ccf::make(8, taps);
-        taps.assign(FIR_32_2_TAPS, FIR_32_2_TAPS + FIR_32_2_LEN);
-        fir2 = gr::filter::fir_filter_ccf::make(2, taps);
-        taps.assign(FIR_32_3_TAPS, FIR_32_3_TAPS + FIR_32_3_LEN);
-        fir3 = gr::filter::fir_filter_ccf::make(2, taps);
-        connect(self(), 0, fir1, 0);
-        connect(fir1, 0, fir2, 0);
-        connect(fir2, 0, fir3, 0);
-        connect(fir3, 0, self(), 0);
-        break;
-
-    case 64:
-        // Stage   Passband        Stopband        Decimation
-        // FIR1    0.0140625000    0.2359375000    8
-        // FIR2    0.1125000000    0.3875000000    4
-        // FIR3    0.4500000000    0.5500000000    2
-        taps.assign(FIR_64_1_TAPS, FIR_64_1_TAPS + FIR_64_1_LEN);
-        fir1 = gr::filter::fir_filter_ccf::make(8, taps);
-        taps.assign(FIR_64_2_TAPS, FIR_64_2_TAPS + FIR_64_2_LEN);
-        fir2 = gr::filter::fir_filter_ccf::make(4, taps);
-        taps.assign(FIR_64_3_TAPS, FIR_64_3_TAPS + FIR_64_3_LEN);
-        fir3 = gr::filter::fir_filter_ccf::make(2, taps);
-        connect(self(), 0, fir1, 0);
-        connect(fir1, 0, fir2, 0);
-        connect(fir2, 0, fir3, 0);
-        connect(fir3, 0, self(), 0);
-        break;
-
-    case 128:
-        // Stage   Passband        Stopband        Decimation
-        // FIR1    0.0070312500    0.1179688000    16
-        // FIR2    0.1125000000    0.3875000000    4
-        // FIR3    0.4500000000    0.5500000000    2
-        taps.assign(FIR_128_1_TAPS, FIR_128_1_TAPS + FIR_128_1_LEN);
-        fir1 = gr::filter::fir_filter_ccf::make(16, taps);
-        taps.assign(FIR_128_2_TAPS, FIR_128_2_TAPS + FIR_128_2_LEN);
-        fir2 = gr::filter::fir_filter_ccf::make(4, taps);
-        taps.assign(FIR_128_3_TAPS, FIR_128_3_TAPS + FIR_128_3_LEN);
-        fir3 = gr::filter::fir_filter_ccf::make(2, taps);
-        connect(self(), 0, fir1, 0);
-        connect(fir1, 0, fir2, 0);
-        connect(fir2, 0, fir3, 0);
-        connect(fir3, 0, self(), 0);
-        break;
-    }
-#endif
+    connect(self(), 0, stages[0], 0);
+    for (i = 1; i < stages.size(); i++)
+        connect(stages[i - 1], 0, stages[i], 0);
+    connect(stages.back(), 0, self(), 0);
 }
 
 fir_decim_cc::~fir_decim_cc()
@@ -29,25 +29,31 @@
 #endif
 
 #include <gnuradio/hier_block2.h>
+#include <vector>
 
 class fir_decim_cc;
 
 typedef boost::shared_ptr<fir_decim_cc> fir_decim_cc_sptr;
 fir_decim_cc_sptr make_fir_decim_cc(unsigned int decim);
 
+/*! \brief Multi-stage FIR decimator.
+ *  \ingroup DSP
+ *
+ * The decimation is split into stages using the optimized kernels in
+ * fir_decim_coef.h. The stages are planned automatically for any power of 2
+ * decimation: the largest kernel that divides the remaining decimation is
+ * selected for each stage. Other decimations throw std::range_error.
+ */
 class fir_decim_cc : public gr::hier_block2
 {
     friend fir_decim_cc_sptr make_fir_decim_cc(unsigned int decim);
 
-//protected:
-public:
+protected:
     fir_decim_cc(unsigned int decim);
 
 public:
     ~fir_decim_cc();
 
 private:
-    gr::filter::fir_filter_ccf::sptr        fir1;
-    gr::filter::fir_filter_ccf::sptr        fir2;
-    gr::filter::fir_filter_ccf::sptr        fir3;
+    std::vector<gr::filter::fir_filter_ccf::sptr>   stages;
 };
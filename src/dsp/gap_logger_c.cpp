@@ -0,0 +1,147 @@
+/* -*- c++ -*- */
+/*
+ * Gqrx SDR: Software defined radio receiver powered by GNU Radio and Qt
+ *           http://gqrx.dk/
+ *
+ * Copyright 2020 Vadym Ostanin.
+ *
+ * Gqrx is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * Gqrx is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Gqrx; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#include <algorithm>
+#include <cmath>
+#include <ctime>
+#include <iostream>
+#include <gnuradio/io_signature.h>
+#include <dsp/gap_logger_c.h>
+
+
+gap_logger_c_sptr make_gap_logger_c(const std::string &filename,
+                                    double sample_rate)
+{
+    return gnuradio::get_initial_sptr(new gap_logger_c(filename, sample_rate));
+}
+
+gap_logger_c::gap_logger_c(const std::string &filename, double sample_rate)
+    : gr::sync_block ("gap_logger_c",
+          gr::io_signature::make(1, 1, sizeof(gr_complex)),
+          gr::io_signature::make(0, 0, 0)),
+      d_started(false),
+      d_first(0),
+      d_gaps(0)
+{
+    d_clock.set_sample_rate(sample_rate);
+
+    d_fp = fopen(filename.c_str(), "w");
+    if (!d_fp)
+    {
+        std::cout << "Error opening " << filename << std::endl;
+        return;
+    }
+
+    fprintf(d_fp, "# Gaps in %s\n", filename.c_str());
+    fprintf(d_fp, "# Sample rate %.0f\n", sample_rate);
+    fprintf(d_fp, "# sample time duration\n");
+    fflush(d_fp);
+}
+
+gap_logger_c::~gap_logger_c()
+{
+    close();
+}
+
+int gap_logger_c::work(int noutput_items,
+                       gr_vector_const_void_star &input_items,
+                       gr_vector_void_star &output_items)
+{
+    std::vector<gr::tag_t> tags;
+    uint64_t start = nitems_read(0);
+    double time, duration;
+
+    (void) input_items;
+    (void) output_items;
+
+    boost::mutex::scoped_lock lock(d_mutex);
+
+    if (!d_started)
+    {
+        d_first = start;
+        d_started = true;
+    }
+
+    /* the gaps are placed using the time before the gap, so they are
+     * handled before the rx_time tags on the same items */
+    get_tags_in_range(tags, 0, start, start + noutput_items, rx_gap_key());
+    for (size_t i = 0; i < tags.size(); i++)
+    {
+        if (!parse_rx_gap(tags[i].value, time, duration))
+            continue;
+
+        if (d_clock.valid())
+            write_gap(std::min(d_clock.item_of(time), tags[i].offset),
+                      time, duration);
+        else
+            write_gap(tags[i].offset, time, duration);
+    }
+
+    get_tags_in_range(tags, 0, start, start + noutput_items, rx_time_key());
+    d_clock.update(tags);
+
+    return noutput_items;
+}
+
+/*! \brief Close the log file. */
+void gap_logger_c::close()
+{
+    boost::mutex::scoped_lock lock(d_mutex);
+
+    if (!d_fp)
+        return;
+
+    fprintf(d_fp, "# %lu gaps\n", d_gaps);
+    fclose(d_fp);
+    d_fp = 0;
+}
+
+/*! \brief Get the number of gaps logged. */
+unsigned long gap_logger_c::gaps(void)
+{
+    boost::mutex::scoped_lock lock(d_mutex);
+
+    return d_gaps;
+}
+
+void gap_logger_c::write_gap(uint64_t item, double time, double duration)
+{
+    char        timestamp[32];
+    time_t      secs = (time_t) std::floor(time);
+    struct tm   utc;
+
+    d_gaps++;
+    if (!d_fp)
+        return;
+
+#ifdef _WIN32
+    gmtime_s(&utc, &secs);
+#else
+    gmtime_r(&secs, &utc);
+#endif
+    strftime(timestamp, sizeof(timestamp), "%Y-%m-%dT%H:%M:%S", &utc);
+
+    fprintf(d_fp, "%llu %s.%06dZ %.6f\n",
+            (unsigned long long)(item < d_first ? 0 : item - d_first),
+            timestamp, (int)((time - std::floor(time)) * 1.0e6), duration);
+    fflush(d_fp);
+}
@@ -0,0 +1,89 @@
+/* -*- c++ -*- */
+/*
+ * Gqrx SDR: Software defined radio receiver powered by GNU Radio and Qt
+ *           http://gqrx.dk/
+ *
+ * Copyright 2020 Vadym Ostanin.
+ *
+ * Gqrx is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * Gqrx is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Gqrx; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifndef GAP_LOGGER_C_H
+#define GAP_LOGGER_C_H
+
+#include <gnuradio/gr_complex.h>
+#include <gnuradio/sync_block.h>
+#include <boost/thread/mutex.hpp>
+#include <cstdio>
+#include <string>
+#include <dsp/rx_time.h>
+
+
+class gap_logger_c;
+
+typedef boost::shared_ptr<gap_logger_c> gap_logger_c_sptr;
+
+
+/*! \brief Return a shared_ptr to a new instance of gap_logger_c.
+ *  \param filename The name of the log file.
+ *  \param sample_rate The sample rate of the input stream.
+ */
+gap_logger_c_sptr make_gap_logger_c(const std::string &filename,
+                                    double sample_rate);
+
+
+/*! \brief Log the gaps of a stream to a text file.
+ *  \ingroup DSP
+ *
+ * The block is connected next to a recorder and writes one line for every
+ * rx_gap tag, see rx_time_tagger_cc. Each line holds the position of the gap
+ * in the recording in samples, its UTC time and its length in seconds:
+ *
+ *   12345678 2020-05-17T12:34:56.789012Z 0.052000
+ *
+ * Lines starting with # are comments. The file is created even if there
+ * are no gaps, so that it can be used to verify the recording.
+ */
+class gap_logger_c : public gr::sync_block
+{
+    friend gap_logger_c_sptr make_gap_logger_c(const std::string &filename,
+                                               double sample_rate);
+
+protected:
+    gap_logger_c(const std::string &filename, double sample_rate);
+
+public:
+    ~gap_logger_c();
+
+    int work(int noutput_items,
+             gr_vector_const_void_star &input_items,
+             gr_vector_void_star &output_items);
+
+    void close();
+
+    unsigned long gaps(void);
+
+private:
+    void write_gap(uint64_t item, double time, double duration);
+
+    boost::mutex    d_mutex;        /*! Protects the file. */
+    FILE           *d_fp;           /*! Log file or NULL. */
+    sample_clock    d_clock;        /*! Time of the samples. */
+    bool            d_started;      /*! The first sample has been received. */
+    uint64_t        d_first;        /*! Item number of the first sample. */
+    unsigned long   d_gaps;         /*! Number of gaps logged. */
+};
+
+#endif /* GAP_LOGGER_C_H */
@@ -26,17 +26,20 @@
 
 class hbf_decim;
 typedef boost::shared_ptr<hbf_decim> hbf_decim_sptr;
-hbf_decim_sptr make_hbf_decim(unsigned int decim);
+hbf_decim_sptr make_hbf_decim(unsigned int decim, unsigned int atten=100);
 
 /**
  * Decimator block using half-band filters.
+ *
+ * The decimation must be a power of 2 between 2 and MAX_DECIMATION and the
+ * stop band attenuation is 70, 100 or 140 dB.
  */
 class hbf_decim : virtual public gr::sync_decimator
 {
-    friend hbf_decim_sptr make_hbf_decim(unsigned int decim);
+    friend hbf_decim_sptr make_hbf_decim(unsigned int decim, unsigned int atten);
 
 protected:
-    hbf_decim(unsigned int decim);
+    hbf_decim(unsigned int decim, unsigned int atten);
 
 public:
     ~hbf_decim();
@@ -0,0 +1,221 @@
+/* -*- c++ -*- */
+/*
+ * Gqrx SDR: Software defined radio receiver powered by GNU Radio and Qt
+ *           http://gqrx.dk/
+ *
+ * Copyright 2020 Vadym Ostanin.
+ *
+ * Gqrx is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * Gqrx is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Gqrx; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <ctime>
+#include <dsp/level_history.h>
+
+/* Base intervals in a bucket of each level */
+static const unsigned int level_ratio[LEVEL_HISTORY_LEVELS] = { 1, 10, 100, 600 };
+
+
+static float to_dbfs(float pwr)
+{
+    return 10.0f * log10f(std::max(pwr, 1.0e-20f));
+}
+
+
+/*! \brief Create a new level history.
+ *  \param interval The base interval in seconds.
+ *  \param capacity The number of buckets kept for each resolution.
+ */
+level_history::level_history(double interval, unsigned int capacity)
+    : d_interval(interval),
+      d_capacity(std::max(capacity, 1u))
+{
+    for (unsigned int l = 0; l < LEVEL_HISTORY_LEVELS; l++)
+        d_ring[l].resize(d_capacity);
+
+    clear();
+}
+
+/*! \brief Set the base interval and clear the history.
+ *  \param interval The interval in seconds.
+ */
+void level_history::set_interval(double interval)
+{
+    {
+        boost::mutex::scoped_lock lock(d_mutex);
+
+        if (interval <= 0.0 || interval == d_interval)
+            return;
+        d_interval = interval;
+    }
+    clear();
+}
+
+/*! \brief Get the length of the buckets of a level in seconds. */
+double level_history::interval(unsigned int level)
+{
+    boost::mutex::scoped_lock lock(d_mutex);
+
+    if (level >= LEVEL_HISTORY_LEVELS)
+        return 0.0;
+
+    return d_interval * level_ratio[level];
+}
+
+/*! \brief Get the number of buckets available at a level. */
+unsigned int level_history::count(unsigned int level)
+{
+    boost::mutex::scoped_lock lock(d_mutex);
+
+    return level < LEVEL_HISTORY_LEVELS ? d_count[level] : 0;
+}
+
+/*! \brief Remove all buckets. */
+void level_history::clear(void)
+{
+    boost::mutex::scoped_lock lock(d_mutex);
+
+    for (unsigned int l = 0; l < LEVEL_HISTORY_LEVELS; l++)
+    {
+        d_head[l] = 0;
+        d_count[l] = 0;
+        d_pending[l].num = 0;
+    }
+}
+
+/*! \brief Add a bucket of the base interval.
+ *  \param time The start of the interval in seconds since the epoch.
+ *  \param min_pwr The lowest short term power.
+ *  \param max_pwr The highest short term power.
+ *  \param avg_pwr The average power over the interval.
+ *
+ * The power is linear with full scale = 1.0.
+ */
+void level_history::add(double time, float min_pwr, float max_pwr,
+                        float avg_pwr)
+{
+    boost::mutex::scoped_lock lock(d_mutex);
+
+    add_bucket(0, time, min_pwr, max_pwr, avg_pwr);
+}
+
+/*! \brief Get the most recent buckets of a level.
+ *  \param level The resolution, 0 is the finest.
+ *  \param since Only return buckets starting at or after this time.
+ *  \param buckets The buckets, oldest first.
+ *  \return The number of buckets returned.
+ */
+unsigned int level_history::get(unsigned int level, double since,
+                                std::vector<level_bucket_t> &buckets)
+{
+    boost::mutex::scoped_lock lock(d_mutex);
+    unsigned int i, idx;
+
+    buckets.clear();
+    if (level >= LEVEL_HISTORY_LEVELS)
+        return 0;
+
+    buckets.reserve(d_count[level]);
+    for (i = 0; i < d_count[level]; i++)
+    {
+        idx = (d_head[level] + d_capacity - d_count[level] + i) % d_capacity;
+        if (d_ring[level][idx].time >= since)
+            buckets.push_back(d_ring[level][idx]);
+    }
+
+    return buckets.size();
+}
+
+/*! \brief Write the buckets of a level to a CSV file.
+ *  \param filename The name of the file.
+ *  \param level The resolution, 0 is the finest.
+ *  \return true if the file has been written.
+ *
+ * The file has a header line followed by one line per bucket with the UTC
+ * time of the start of the bucket and the minimum, maximum and average level
+ * in dBFS.
+ */
+bool level_history::write_csv(const std::string &filename, unsigned int level)
+{
+    std::vector<level_bucket_t> buckets;
+    char        timestamp[32];
+    time_t      secs;
+    struct tm   utc;
+    FILE       *fp;
+
+    get(level, 0.0, buckets);
+
+    fp = fopen(filename.c_str(), "w");
+    if (!fp)
+        return false;
+
+    fprintf(fp, "time,min_dbfs,max_dbfs,avg_dbfs\n");
+    for (size_t i = 0; i < buckets.size(); i++)
+    {
+        secs = (time_t) std::floor(buckets[i].time);
+#ifdef _WIN32
+        gmtime_s(&utc, &secs);
+#else
+        gmtime_r(&secs, &utc);
+#endif
+        strftime(timestamp, sizeof(timestamp), "%Y-%m-%dT%H:%M:%S", &utc);
+        fprintf(fp, "%s.%03dZ,%.1f,%.1f,%.1f\n", timestamp,
+                (int)((buckets[i].time - std::floor(buckets[i].time)) * 1.0e3),
+                buckets[i].min, buckets[i].max, buckets[i].avg);
+    }
+
+    return fclose(fp) == 0;
+}
+
+void level_history::add_bucket(unsigned int level, double time, float min_pwr,
+                               float max_pwr, float avg_pwr)
+{
+    level_bucket_t &bucket = d_ring[level][d_head[level]];
+
+    bucket.time = time;
+    bucket.min = to_dbfs(min_pwr);
+    bucket.max = to_dbfs(max_pwr);
+    bucket.avg = to_dbfs(avg_pwr);
+
+    d_head[level] = (d_head[level] + 1) % d_capacity;
+    if (d_count[level] < d_capacity)
+        d_count[level]++;
+
+    if (level + 1 >= LEVEL_HISTORY_LEVELS)
+        return;
+
+    /* combine into the next resolution */
+    pending_t &next = d_pending[level + 1];
+    if (next.num == 0)
+    {
+        next.time = time;
+        next.min_pwr = min_pwr;
+        next.max_pwr = max_pwr;
+        next.sum_pwr = 0.0;
+    }
+    next.min_pwr = std::min(next.min_pwr, min_pwr);
+    next.max_pwr = std::max(next.max_pwr, max_pwr);
+    next.sum_pwr += avg_pwr;
+    next.num++;
+
+    if (next.num == level_ratio[level + 1] / level_ratio[level])
+    {
+        add_bucket(level + 1, next.time, next.min_pwr, next.max_pwr,
+                   (float)(next.sum_pwr / next.num));
+        next.num = 0;
+    }
+}
@@ -0,0 +1,111 @@
+/* -*- c++ -*- */
+/*
+ * Gqrx SDR: Software defined radio receiver powered by GNU Radio and Qt
+ *           http://gqrx.dk/
+ *
+ * Copyright 2020 Vadym Ostanin.
+ *
+ * Gqrx is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * Gqrx is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Gqrx; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifndef LEVEL_HISTORY_H
+#define LEVEL_HISTORY_H
+
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+#include <string>
+#include <vector>
+
+/* Number of resolutions kept by the history */
+#define LEVEL_HISTORY_LEVELS    4
+
+
+/*! \brief A bucket of the signal level history. */
+typedef struct
+{
+    double  time;   /*!< Start of the bucket in seconds since the epoch. */
+    float   min;    /*!< Lowest level in dBFS. */
+    float   max;    /*!< Highest level in dBFS. */
+    float   avg;    /*!< Average power in dBFS. */
+} level_bucket_t;
+
+
+class level_history;
+
+typedef boost::shared_ptr<level_history> level_history_sptr;
+
+
+/*! \brief Signal level history with several resolutions.
+ *
+ * The history is fed with one bucket per base interval by rx_meter_c and
+ * keeps the most recent buckets in a ring for each resolution. Each
+ * resolution combines a fixed number of buckets of the previous one, 1, 10,
+ * 100 and 600 base intervals, so that with the default interval of 100 ms
+ * and 3600 buckets per ring the history covers 6 minutes at 0.1 s, one hour
+ * at 1 s, 10 hours at 10 s and 2.5 days at 1 minute resolution.
+ *
+ * The minimum and maximum are the extremes of the short term average power
+ * measured over a tenth of the base interval, the average is the mean power
+ * over the bucket. All levels are in dBFS.
+ *
+ * The history is written by the flow graph and read by the user interface
+ * and the remote control, all methods are thread safe.
+ */
+class level_history
+{
+public:
+    explicit level_history(double interval = 0.1, unsigned int capacity = 3600);
+
+    void set_interval(double interval);
+    double interval(unsigned int level = 0);
+
+    unsigned int levels(void) const { return LEVEL_HISTORY_LEVELS; }
+    unsigned int capacity(void) const { return d_capacity; }
+    unsigned int count(unsigned int level);
+
+    void clear(void);
+
+    void add(double time, float min_pwr, float max_pwr, float avg_pwr);
+
+    unsigned int get(unsigned int level, double since,
+                     std::vector<level_bucket_t> &buckets);
+
+    bool write_csv(const std::string &filename, unsigned int level);
+
+private:
+    /*! \brief Bucket being collected from the buckets of the level below. */
+    typedef struct
+    {
+        double          time;
+        float           min_pwr;
+        float           max_pwr;
+        double          sum_pwr;
+        unsigned int    num;
+    } pending_t;
+
+    void add_bucket(unsigned int level, double time, float min_pwr,
+                    float max_pwr, float avg_pwr);
+
+    boost::mutex    d_mutex;        /*! Protects the rings. */
+    double          d_interval;     /*! Base interval in seconds. */
+    unsigned int    d_capacity;     /*! Buckets in each ring. */
+
+    std::vector<level_bucket_t> d_ring[LEVEL_HISTORY_LEVELS];
+    unsigned int    d_head[LEVEL_HISTORY_LEVELS];   /*! Next bucket to write. */
+    unsigned int    d_count[LEVEL_HISTORY_LEVELS];  /*! Buckets in the ring. */
+    pending_t       d_pending[LEVEL_HISTORY_LEVELS];
+};
+
+#endif /* LEVEL_HISTORY_H */
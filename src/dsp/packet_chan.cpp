@@ -0,0 +1,155 @@
+/* -*- c++ -*- */
+/*
+ * Gqrx SDR: Software defined radio receiver powered by GNU Radio and Qt
+ *           http://gqrx.dk/
+ *
+ * Copyright 2020 Vadym Ostanin.
+ *
+ * Gqrx is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * Gqrx is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Gqrx; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#include <algorithm>
+#include <cmath>
+#include <gnuradio/io_signature.h>
+#include <gnuradio/filter/firdes.h>
+#include "dsp/packet_chan.h"
+
+/* Sample rate we aim for after the channel filter */
+#define CHAN_RATE       48000.0
+
+/* Channel filter cutoff; wide enough for 1200 baud AFSK with 5 kHz deviation */
+#define CHAN_CUTOFF     8000.0
+
+/* FM demodulator max deviation */
+#define CHAN_MAXDEV     5000.0
+
+
+packet_chan_c_sptr make_packet_chan_c(double quad_rate, double offset,
+                                      double audio_rate, int buffsize)
+{
+    return gnuradio::get_initial_sptr(new packet_chan_c(quad_rate, offset,
+                                                        audio_rate, buffsize));
+}
+
+
+packet_chan_c::packet_chan_c(double quad_rate, double offset,
+                             double audio_rate, int buffsize)
+    : gr::hier_block2 ("packet_chan_c",
+          gr::io_signature::make (1, 1, sizeof(gr_complex)),
+          gr::io_signature::make (0, 0, 0)),
+      d_quad_rate(quad_rate),
+      d_audio_rate(audio_rate),
+      d_offset(offset)
+{
+    make_filter();
+
+    demod = gr::analog::quadrature_demod_cf::make(d_chan_rate / (2.0 * M_PI * CHAN_MAXDEV));
+    audio_rr = make_resampler_ff(d_audio_rate / d_chan_rate);
+    sniffer = make_sniffer_f(buffsize);
+    sniffer->set_sample_rate(d_audio_rate);
+
+    connect(self(), 0, chan_filter, 0);
+    connect(chan_filter, 0, demod, 0);
+    connect(demod, 0, audio_rr, 0);
+    connect(audio_rr, 0, sniffer, 0);
+}
+
+packet_chan_c::~packet_chan_c()
+{
+
+}
+
+/*! \brief Create the channel filter for the current quadrature rate.
+ *
+ * At quadrature rates of 20 ksps and below the cutoff is reduced to leave
+ * a transition band, so the filter can always be designed, albeit with
+ * some loss of the signal.
+ */
+void packet_chan_c::make_filter()
+{
+    double cutoff;
+    double trans_width;
+
+    d_decim = (int) std::floor(d_quad_rate / CHAN_RATE);
+    if (d_decim < 1)
+        d_decim = 1;
+    d_chan_rate = d_quad_rate / (double) d_decim;
+
+    /* use all the room we have below the output Nyquist frequency */
+    cutoff = std::min(CHAN_CUTOFF, 0.4 * d_chan_rate);
+    trans_width = 0.5 * d_chan_rate - cutoff;
+    d_taps = gr::filter::firdes::low_pass(1.0, d_quad_rate, cutoff,
+                                          trans_width);
+    chan_filter = gr::filter::freq_xlating_fir_filter_ccf::make(d_decim, d_taps,
+                                                                d_offset,
+                                                                d_quad_rate);
+}
+
+/*! \brief Set new input sample rate.
+ *  \param quad_rate The new input sample rate.
+ *
+ * This will recreate the channel filter and the audio resampler.
+ */
+void packet_chan_c::set_quad_rate(double quad_rate)
+{
+    if (std::abs(d_quad_rate - quad_rate) < 0.5)
+        return;
+
+    lock();
+    disconnect_all();
+
+    d_quad_rate = quad_rate;
+    make_filter();
+    demod->set_gain(d_chan_rate / (2.0 * M_PI * CHAN_MAXDEV));
+    audio_rr->set_rate(d_audio_rate / d_chan_rate);
+
+    connect(self(), 0, chan_filter, 0);
+    connect(chan_filter, 0, demod, 0);
+    connect(demod, 0, audio_rr, 0);
+    connect(audio_rr, 0, sniffer, 0);
+    unlock();
+}
+
+/*! \brief Set new channel offset.
+ *  \param offset The channel offset from the center of the input band in Hz.
+ */
+void packet_chan_c::set_offset(double offset)
+{
+    d_offset = offset;
+    chan_filter->set_center_freq(d_offset);
+}
+
+/*! \brief Fetch demodulated samples.
+ *  \param buffer Pointer to allocated memory where the samples will be copied.
+ *  \param num The number of samples returned.
+ *
+ * \sa sniffer_f::get_samples()
+ */
+void packet_chan_c::get_samples(float * buffer, unsigned int &num)
+{
+    sniffer->get_samples(buffer, num);
+}
+
+/*! \brief Fetch demodulated samples and their time.
+ *  \param buffer Pointer to allocated memory where the samples will be copied.
+ *  \param num The number of samples returned.
+ *  \param time The time of the first sample or 0 if not known.
+ *
+ * \sa sniffer_f::get_samples()
+ */
+void packet_chan_c::get_samples(float * buffer, unsigned int &num, double &time)
+{
+    sniffer->get_samples(buffer, num, time);
+}
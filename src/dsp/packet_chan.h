@@ -0,0 +1,98 @@
+/* -*- c++ -*- */
+/*
+ * Gqrx SDR: Software defined radio receiver powered by GNU Radio and Qt
+ *           http://gqrx.dk/
+ *
+ * Copyright 2020 Vadym Ostanin.
+ *
+ * Gqrx is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * Gqrx is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Gqrx; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifndef PACKET_CHAN_H
+#define PACKET_CHAN_H
+
+#include <gnuradio/hier_block2.h>
+#include <gnuradio/analog/quadrature_demod_cf.h>
+#include <gnuradio/filter/freq_xlating_fir_filter_ccf.h>
+#include <vector>
+#include "dsp/resampler_xx.h"
+#include "dsp/sniffer_f.h"
+
+
+class packet_chan_c;
+
+typedef boost::shared_ptr<packet_chan_c> packet_chan_c_sptr;
+
+
+/*! \brief Return a shared_ptr to a new instance of packet_chan_c.
+ *  \param quad_rate The input sample rate.
+ *  \param offset The channel offset from the center of the input band in Hz.
+ *  \param audio_rate The output sample rate delivered to the data decoder.
+ *  \param buffsize The size of the sample buffer.
+ */
+packet_chan_c_sptr make_packet_chan_c(double quad_rate, double offset,
+                                      double audio_rate=22050.0,
+                                      int buffsize=48000);
+
+
+/*! \brief Narrow band FM channel feeding a data decoder.
+ *  \ingroup DSP
+ *
+ * This block extracts a narrow band FM channel from the baseband I/Q stream,
+ * demodulates it and makes the audio available to a data decoder in the same
+ * way as sniffer_f. Several instances can be connected to the same I/Q stream
+ * to decode packet radio on several frequencies simultaneously.
+ *
+ * The channel selection is done by a frequency translating FIR filter that
+ * also decimates to 48-96 ksps, so the cost is dominated by one polyphase
+ * filter branch per output sample.
+ */
+class packet_chan_c : public gr::hier_block2
+{
+    friend packet_chan_c_sptr make_packet_chan_c(double quad_rate, double offset,
+                                                 double audio_rate,
+                                                 int buffsize);
+
+protected:
+    packet_chan_c(double quad_rate, double offset, double audio_rate,
+                  int buffsize);
+
+public:
+    ~packet_chan_c();
+
+    void    set_quad_rate(double quad_rate);
+    void    set_offset(double offset);
+    double  get_offset(void) const { return d_offset; }
+
+    void    get_samples(float * buffer, unsigned int &num);
+    void    get_samples(float * buffer, unsigned int &num, double &time);
+
+private:
+    void    make_filter();
+
+    gr::filter::freq_xlating_fir_filter_ccf::sptr   chan_filter;
+    gr::analog::quadrature_demod_cf::sptr           demod;
+    resampler_ff_sptr   audio_rr;
+    sniffer_f_sptr      sniffer;
+
+    std::vector<float>  d_taps;
+    double      d_quad_rate;    /*! Input sample rate. */
+    double      d_chan_rate;    /*! Sample rate after channel filter. */
+    double      d_audio_rate;   /*! Output sample rate. */
+    double      d_offset;       /*! Channel offset. */
+    int         d_decim;        /*! Channel filter decimation. */
+};
+
+#endif // PACKET_CHAN_H
@@ -21,6 +21,7 @@
  * Boston, MA 02110-1301, USA.
  */
 #include <math.h>
+#include <iostream>
 #include <gnuradio/io_signature.h>
 #include <gnuradio/filter/firdes.h>
 #include <gnuradio/gr_complex.h>
@@ -45,11 +46,21 @@ rx_fft_c::rx_fft_c(unsigned int fftsize, double quad_rate, int wintype)
           gr::io_signature::make(0, 0, 0)),
       d_fftsize(fftsize),
       d_quadrate(quad_rate),
-      d_wintype(-1)
+      d_wintype(-1),
+      d_plan_size(fftsize),
+      d_plan_pending(false),
+      d_plan_stop(false),
+      d_zoom_center(0.0),
+      d_zoom_span(0.0),
+      d_zoom_decim(1),
+      d_have_fft(false),
+      d_fft_center(0.0),
+      d_fft_rate(quad_rate),
+      d_fft_count(0)
 {
 
     /* create FFT object */
-    d_fft = new gr::fft::fft_complex(d_fftsize, true);
+    d_fft = new fft_plan_c(d_fftsize);
 
     /* allocate circular buffer */
     d_cbuf.set_capacity(d_fftsize + d_quadrate);
@@ -58,10 +69,19 @@ rx_fft_c::rx_fft_c(unsigned int fftsize, double quad_rate, int wintype)
     set_window_type(wintype);
 
     d_lasttime = std::chrono::steady_clock::now();
+
+    d_planner = boost::thread(&rx_fft_c::planner_thread, this);
 }
 
 rx_fft_c::~rx_fft_c()
 {
+    {
+        boost::mutex::scoped_lock lock(d_plan_mutex);
+        d_plan_stop = true;
+        d_plan_cond.notify_one();
+    }
+    d_planner.join();
+
     delete d_fft;
 }
 
@@ -82,8 +102,36 @@ int rx_fft_c::work(int noutput_items,
     const gr_complex *in = (const gr_complex*)input_items[0];
     (void) output_items;
 
-    /* just throw new samples into the buffer */
     boost::mutex::scoped_lock lock(d_mutex);
+
+    if (d_zoom_decim > 1)
+    {
+        /* shift and decimate, the decimator needs a multiple of the
+         * decimation so the rest is kept for the next call
+         */
+        size_t  nold = d_zoom_in.size();
+        int     nin, nout;
+
+        d_zoom_in.resize(nold + noutput_items);
+        d_zoom_rot.rotateN(&d_zoom_in[nold], in, noutput_items);
+
+        nin = d_zoom_in.size() - d_zoom_in.size() % d_zoom_decim;
+        if (nin > 0)
+        {
+            if (d_zoom_out.size() < (size_t)nin / d_zoom_decim)
+                d_zoom_out.resize(nin / d_zoom_decim);
+
+            nout = d_zoom_dec.process(nin, &d_zoom_in[0], &d_zoom_out[0]);
+            d_zoom_in.erase(d_zoom_in.begin(), d_zoom_in.begin() + nin);
+
+            for (i = 0; i < nout; i++)
+                d_cbuf.push_back(d_zoom_out[i]);
+        }
+
+        return noutput_items;
+    }
+
+    /* just throw new samples into the buffer */
     for (i = 0; i < noutput_items; i++)
     {
         d_cbuf.push_back(in[i]);
@@ -103,8 +151,17 @@ void rx_fft_c::get_fft_data(std::complex<float>* fftPoints, unsigned int &fftSiz
 
     if (d_cbuf.size() < d_fftsize)
     {
-        // not enough samples in the buffer
-        fftSize = 0;
+        // not enough samples in the buffer, e.g. after the zoom has changed,
+        // repeat the last spectrum
+        if (d_have_fft)
+        {
+            memcpy(fftPoints, d_fft->get_outbuf(), sizeof(gr_complex)*d_fftsize);
+            fftSize = d_fftsize;
+        }
+        else
+        {
+            fftSize = 0;
+        }
 
         return;
     }
@@ -114,9 +171,13 @@ void rx_fft_c::get_fft_data(std::complex<float>* fftPoints, unsigned int &fftSiz
     d_lasttime = now;
 
     /* perform FFT */
-    d_cbuf.erase_begin(std::min((unsigned int)(diff.count() * d_quadrate * 1.001), (unsigned int)d_cbuf.size() - d_fftsize));
+    d_cbuf.erase_begin(std::min((unsigned int)(diff.count() * fft_rate() * 1.001), (unsigned int)d_cbuf.size() - d_fftsize));
     do_fft(d_fftsize);
     //d_cbuf.clear();
+    d_have_fft = true;
+    d_fft_center = d_zoom_decim > 1 ? d_zoom_center : 0.0;
+    d_fft_rate = fft_rate();
+    d_fft_count++;
 
     /* get FFT data */
     memcpy(fftPoints, d_fft->get_outbuf(), sizeof(gr_complex)*d_fftsize);
@@ -148,45 +209,194 @@ void rx_fft_c::do_fft(unsigned int size)
     d_fft->execute();
 }
 
-/*! \brief Update circular buffer and FFT object. */
-void rx_fft_c::set_params()
+/*! \brief Create FFT plans for new FFT sizes.
+ *
+ * Creating an FFTW plan for a large size can take seconds, so it is done
+ * here instead of in set_fft_size(). The new plan, window and buffer are
+ * swapped in under the mutex, so work() and get_fft_data() never wait for
+ * the planner.
+ */
+void rx_fft_c::planner_thread()
 {
-    boost::mutex::scoped_lock lock(d_mutex);
+    boost::unique_lock<boost::mutex> lock(d_plan_mutex);
 
-    /* clear and resize circular buffer */
-    d_cbuf.clear();
-    d_cbuf.set_capacity(d_fftsize + d_quadrate);
-
-    /* reset window */
-    int wintype = d_wintype; // FIXME: would be nicer with a window_reset()
-    d_wintype = -1;
-    set_window_type(wintype);
-
-    /* reset FFT object (also reset FFTW plan) */
-    delete d_fft;
-    d_fft = new gr::fft::fft_complex (d_fftsize, true);
+    while (true)
+    {
+        while (!d_plan_pending && !d_plan_stop)
+            d_plan_cond.wait(lock);
+
+        if (d_plan_stop)
+            break;
+
+        unsigned int size = d_plan_size;
+        d_plan_pending = false;
+        lock.unlock();
+
+        try
+        {
+            fft_plan_c *fft = new fft_plan_c(size);
+            int wintype;
+
+            {
+                boost::mutex::scoped_lock data_lock(d_mutex);
+                wintype = d_wintype;
+            }
+            std::vector<float> window = gr::filter::firdes::window(
+                        (gr::filter::firdes::win_type)wintype, size, 6.76);
+
+            {
+                boost::mutex::scoped_lock data_lock(d_mutex);
+
+                std::swap(d_fft, fft);
+                d_fftsize = size;
+                d_have_fft = false;
+                if (wintype == d_wintype)
+                    d_window.swap(window);
+                else
+                    d_window = gr::filter::firdes::window(
+                                (gr::filter::firdes::win_type)d_wintype, size, 6.76);
+
+                /* clear and resize circular buffer */
+                d_cbuf.clear();
+                d_cbuf.set_capacity(d_fftsize + fft_rate());
+            }
+
+            /* the old plan */
+            delete fft;
+        }
+        catch (std::exception &x)
+        {
+            std::cerr << "rx_fft_c: " << x.what() << std::endl;
+        }
+
+        lock.lock();
+    }
 }
 
-/*! \brief Set new FFT size. */
+/*! \brief Set new FFT size.
+ *
+ * The new size takes effect when the planner thread has created the plan.
+ */
 void rx_fft_c::set_fft_size(unsigned int fftsize)
 {
-    if (fftsize != d_fftsize)
+    boost::mutex::scoped_lock lock(d_plan_mutex);
+
+    if (fftsize != d_plan_size)
     {
-        d_fftsize = fftsize;
-        set_params();
+        d_plan_size = fftsize;
+        d_plan_pending = true;
+        d_plan_cond.notify_one();
     }
-
 }
 
 /*! \brief Set new quadrature rate. */
 void rx_fft_c::set_quad_rate(double quad_rate)
 {
-    if (quad_rate != d_quadrate) {
+    if (quad_rate != d_quadrate)
+    {
+        boost::mutex::scoped_lock lock(d_mutex);
+
         d_quadrate = quad_rate;
-        set_params();
+        update_zoom(true);
+    }
+}
+
+/*! \brief Compute the FFT only over a part of the spectrum.
+ *  \param center The center of the span relative to the input center in Hz.
+ *  \param span The span in Hz, 0 to compute the FFT over the full bandwidth.
+ *
+ * The FFT covers at least the requested span; the zoom is off if the span
+ * is more than 40% of the quadrature rate. Use get_zoom() to find which
+ * part of the spectrum the FFT data covers.
+ */
+void rx_fft_c::set_zoom(double center, double span)
+{
+    boost::mutex::scoped_lock lock(d_mutex);
+
+    if (center != d_zoom_center || span != d_zoom_span)
+    {
+        d_zoom_center = center;
+        d_zoom_span = span;
+        update_zoom(false);
+    }
+}
+
+/*! \brief Get the part of the spectrum covered by the FFT data.
+ *  \param center The center relative to the input center in Hz (output).
+ *  \param rate The bandwidth in Hz (output).
+ */
+void rx_fft_c::get_zoom(double &center, double &rate)
+{
+    boost::mutex::scoped_lock lock(d_mutex);
+
+    if (d_have_fft)
+    {
+        center = d_fft_center;
+        rate = d_fft_rate;
+    }
+    else
+    {
+        center = d_zoom_decim > 1 ? d_zoom_center : 0.0;
+        rate = fft_rate();
     }
 }
 
+/*! \brief Get the number of spectra computed so far.
+ *
+ * The count does not change when get_fft_data() repeats the last spectrum,
+ * which allows callers to tell new spectra from repeated ones.
+ */
+unsigned long rx_fft_c::get_fft_count()
+{
+    boost::mutex::scoped_lock lock(d_mutex);
+
+    return d_fft_count;
+}
+
+/*! \brief Configure rotator and decimator for the zoom settings.
+ *  \param rate_changed The quadrature rate has changed.
+ *
+ * The decimation is the largest power of two that keeps the requested
+ * span within 80% of the decimated bandwidth, where the half-band filters
+ * are flat. Must be called with the mutex locked.
+ *
+ * When only the center moves, e.g. while the pandapter is dragged, the
+ * buffered samples are kept and the following ones replace them within one
+ * FFT, so the display does not go blank.
+ */
+void rx_fft_c::update_zoom(bool rate_changed)
+{
+    unsigned int decim = 1;
+
+    if (d_zoom_span > 0.0 && d_quadrate > 0.0)
+        while (2 * decim <= MAX_DECIMATION &&
+               0.8 * d_quadrate / (2 * decim) >= d_zoom_span)
+            decim *= 2;
+
+    if (decim > 1 && d_zoom_dec.init(decim, 100) != decim)
+        decim = 1;
+
+    if (d_quadrate > 0.0)
+        d_zoom_rot.set_phase_incr(std::exp(gr_complex(0.0f, (float)(-2.0 * M_PI * d_zoom_center / d_quadrate))));
+
+    if (decim == d_zoom_decim && !rate_changed)
+        return;
+
+    d_zoom_decim = decim;
+    d_zoom_rot.set_phase(gr_complex(1.0f, 0.0f));
+    d_zoom_in.clear();
+
+    /* clear and resize circular buffer */
+    d_cbuf.clear();
+    d_cbuf.set_capacity(d_fftsize + fft_rate());
+}
+
+/*! \brief The sample rate of the samples in the circular buffer. */
+double rx_fft_c::fft_rate() const
+{
+    return d_quadrate / d_zoom_decim;
+}
+
 /*! \brief Get currently used FFT size. */
 unsigned int rx_fft_c::get_fft_size() const
 {
@@ -196,6 +406,8 @@ unsigned int rx_fft_c::get_fft_size() const
 /*! \brief Set new window type. */
 void rx_fft_c::set_window_type(int wintype)
 {
+    boost::mutex::scoped_lock lock(d_mutex);
+
     if (wintype == d_wintype)
     {
         /* nothing to do */
@@ -24,13 +24,19 @@
 #define RX_FFT_H
 
 #include <gnuradio/sync_block.h>
+#include <gnuradio/blocks/rotator.h>
 #include <gnuradio/fft/fft.h>
 #include <gnuradio/filter/firdes.h>       /* contains enum win_type */
 #include <gnuradio/gr_complex.h>
+#include <boost/thread/condition_variable.hpp>
 #include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
 #include <boost/circular_buffer.hpp>
 #include <chrono>
 
+#include "dsp/fft_plan.h"
+#include "dsp/filter/decimator.h"
+
 
 #define MAX_FFT_SIZE 1048576
 
@@ -62,6 +68,18 @@ rx_fft_c_sptr make_rx_fft_c(unsigned int fftsize=4096, double quad_rate=0, int w
  * will be performed on the data stored in the circular buffer - assuming
  * of course that the buffer contains at least fftsize samples.
  *
+ * When the FFT size is changed the new FFTW plan is created in a planner
+ * thread and swapped in when it is ready. Until then get_fft_data() keeps
+ * returning data with the old size.
+ *
+ * In zoom mode, see set_zoom(), the samples are shifted to the center of
+ * the displayed span and decimated by a power of two before they are stored
+ * in the circular buffer. The FFT then covers only the displayed span with
+ * a resolution that would otherwise need a much larger FFT. Moving the
+ * span keeps the buffered samples; when the decimation changes the buffer
+ * has to be refilled and get_fft_data() repeats the last spectrum until
+ * then, with get_zoom() describing that spectrum.
+ *
  * \note Uses code from qtgui_sink_c
  */
 class rx_fft_c : public gr::sync_block
@@ -87,6 +105,10 @@ public:
     void set_quad_rate(double quad_rate);
     unsigned int get_fft_size() const;
 
+    void set_zoom(double center, double span);
+    void get_zoom(double &center, double &rate);
+    unsigned long get_fft_count();
+
 private:
     unsigned int d_fftsize;   /*! Current FFT size. */
     double       d_quadrate;
@@ -94,14 +116,36 @@ private:
 
     boost::mutex d_mutex;  /*! Used to lock FFT output buffer. */
 
-    gr::fft::fft_complex    *d_fft;    /*! FFT object. */
+    fft_plan_c         *d_fft;    /*! FFT object. */
     std::vector<float>  d_window; /*! FFT window taps. */
 
     boost::circular_buffer<gr_complex> d_cbuf; /*! buffer to accumulate samples. */
     std::chrono::time_point<std::chrono::steady_clock> d_lasttime;
 
+    boost::thread       d_planner;      /*! Creates FFT plans for new sizes. */
+    boost::mutex        d_plan_mutex;   /*! Protects the planner request. */
+    boost::condition_variable d_plan_cond;
+    unsigned int        d_plan_size;    /*! Requested FFT size. */
+    bool                d_plan_pending; /*! A new FFT size has been requested. */
+    bool                d_plan_stop;    /*! Stop the planner thread. */
+
+    double              d_zoom_center;  /*! Center of the zoomed span in Hz. */
+    double              d_zoom_span;    /*! Zoomed span in Hz, 0 if zoom is off. */
+    unsigned int        d_zoom_decim;   /*! Zoom decimation, 1 if zoom is off. */
+    gr::blocks::rotator d_zoom_rot;     /*! Shifts the zoom center to 0 Hz. */
+    Decimator           d_zoom_dec;     /*! Half-band decimator cascade. */
+    std::vector<gr_complex> d_zoom_in;  /*! Shifted samples waiting for decimation. */
+    std::vector<gr_complex> d_zoom_out; /*! Decimator output. */
+
+    bool                d_have_fft;     /*! d_fft holds the last spectrum. */
+    double              d_fft_center;   /*! Center of the last spectrum. */
+    double              d_fft_rate;     /*! Bandwidth of the last spectrum. */
+    unsigned long       d_fft_count;    /*! Number of spectra computed. */
+
     void do_fft(unsigned int size);
-    void set_params();
+    void planner_thread();
+    void update_zoom(bool rate_changed);
+    double fft_rate() const;
 
 };
 
@@ -20,6 +20,7 @@
  * the Free Software Foundation, Inc., 51 Franklin Street,
  * Boston, MA 02110-1301, USA.
  */
+#include <algorithm>
 #include <math.h>
 #include <gnuradio/io_signature.h>
 #include <dsp/rx_meter.h>
@@ -40,7 +41,15 @@ rx_meter_c::rx_meter_c(int detector)
       d_level_db(0.0),
       d_sum(0.0),
       d_sumsq(0.0),
-      d_num(0)
+      d_num(0),
+      d_sub_len(0),
+      d_sub_num(0),
+      d_sub_sum(0.0),
+      d_subs(0),
+      d_hist_min(0.0),
+      d_hist_max(0.0),
+      d_hist_sum(0.0),
+      d_bucket_item(0)
 {
 
 }
@@ -52,6 +61,9 @@ rx_meter_c::~rx_meter_c()
 
 #define ALPHA 0.4
 
+/* Short term averages in a bucket of the level history */
+#define HIST_SUBS   10
+
 int rx_meter_c::work (int noutput_items,
                       gr_vector_const_void_star &input_items,
                       gr_vector_void_star &output_items)
@@ -62,6 +74,20 @@ int rx_meter_c::work (int noutput_items,
     float pwr = 0.0;
     int   i = 0;
 
+    {
+        boost::mutex::scoped_lock lock(d_hist_mutex);
+
+        if (d_hist)
+        {
+            std::vector<gr::tag_t> tags;
+
+            get_tags_in_range(tags, 0, nitems_read(0),
+                              nitems_read(0) + noutput_items, rx_time_key());
+            d_clock.update(tags);
+            update_history(in, noutput_items, nitems_read(0));
+        }
+    }
+
     if (d_num == 0)
     {
         // first sample after a reset
@@ -173,3 +199,63 @@ void rx_meter_c::reset_stats()
     d_sumsq = 0.0;
     d_num = 0;
 }
+
+/*! \brief Set the level history fed by this meter.
+ *  \param hist The level history or an empty pointer to stop feeding it.
+ *  \param sample_rate The sample rate of the input.
+ */
+void rx_meter_c::set_history(level_history_sptr hist, double sample_rate)
+{
+    boost::mutex::scoped_lock lock(d_hist_mutex);
+
+    d_hist = hist;
+    d_clock.set_sample_rate(sample_rate);
+    d_sub_sum = 0.0;
+    d_sub_num = 0;
+    d_subs = 0;
+}
+
+/*! \brief Collect the history buckets.
+ *  \param in The input samples.
+ *  \param num The number of input samples.
+ *  \param item The item number of in[0].
+ */
+void rx_meter_c::update_history(const gr_complex *in, int num, uint64_t item)
+{
+    double  interval;
+    float   avg;
+
+    for (int i = 0; i < num; i++)
+    {
+        if (d_sub_num == 0 && d_subs == 0)
+        {
+            /* the interval may change at any time */
+            interval = d_hist->interval(0);
+            d_sub_len = std::max(1, (int)(interval * d_clock.sample_rate() / HIST_SUBS));
+            d_hist_sum = 0.0;
+            d_bucket_item = item + i;
+        }
+
+        d_sub_sum += in[i].real()*in[i].real() + in[i].imag()*in[i].imag();
+        if (++d_sub_num < d_sub_len)
+            continue;
+
+        avg = (float)(d_sub_sum / d_sub_len);
+        if (d_subs == 0 || avg < d_hist_min)
+            d_hist_min = avg;
+        if (d_subs == 0 || avg > d_hist_max)
+            d_hist_max = avg;
+        d_hist_sum += avg;
+        d_sub_sum = 0.0;
+        d_sub_num = 0;
+
+        if (++d_subs < HIST_SUBS)
+            continue;
+
+        interval = (double)(d_sub_len * HIST_SUBS) / d_clock.sample_rate();
+        d_hist->add(d_clock.valid() ? d_clock.time_of(d_bucket_item) :
+                                      rx_time_now() - interval,
+                    d_hist_min, d_hist_max, (float)(d_hist_sum / HIST_SUBS));
+        d_subs = 0;
+    }
+}
@@ -24,6 +24,9 @@
 #define RX_METER_H
 
 #include <gnuradio/sync_block.h>
+#include <boost/thread/mutex.hpp>
+#include <dsp/level_history.h>
+#include <dsp/rx_time.h>
 
 enum detector_type_e {
     DETECTOR_TYPE_NONE   = 0,
@@ -57,6 +60,10 @@ rx_meter_c_sptr make_rx_meter_c(int detector=DETECTOR_TYPE_RMS);
  * For each group of samples received this block stores the maximum power level,
  * which then can be retrieved using the get_level() and get_level_db()
  * methods.
+ *
+ * Independently of the detector, the block can feed a level_history with
+ * the minimum, maximum and average power of every interval of the history,
+ * timestamped using the rx_time tags of the stream.
  */
 class rx_meter_c : public gr::sync_block
 {
@@ -88,6 +95,8 @@ public:
      */
     int get_detector_type() {return d_detector;}
 
+    void set_history(level_history_sptr hist, double sample_rate);
+
 private:
     int    d_detector;  /*! Detector type. */
     float  d_level;     /*! The current level in the range 0.0 to 1.0 */
@@ -96,7 +105,20 @@ private:
     float  d_sumsq;     /*! Sum of samples squared. */
     int    d_num;       /*! Number of samples in d_sum and d_sumsq. */
 
+    boost::mutex        d_hist_mutex;   /*! Protects d_hist. */
+    level_history_sptr  d_hist;         /*! Level history or NULL. */
+    sample_clock        d_clock;        /*! Time of the samples. */
+    int       d_sub_len;    /*! Samples in a short term average. */
+    int       d_sub_num;    /*! Samples in d_sub_sum. */
+    double    d_sub_sum;    /*! Sum of power for the short term average. */
+    int       d_subs;       /*! Short term averages in the current bucket. */
+    float     d_hist_min;   /*! Lowest short term average in the bucket. */
+    float     d_hist_max;   /*! Highest short term average in the bucket. */
+    double    d_hist_sum;   /*! Sum of short term averages in the bucket. */
+    uint64_t  d_bucket_item;  /*! Item number of the start of the bucket. */
+
     void reset_stats();
+    void update_history(const gr_complex *in, int num, uint64_t item);
 };
 
 
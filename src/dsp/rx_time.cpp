@@ -0,0 +1,170 @@
+/* -*- c++ -*- */
+/*
+ * Gqrx SDR: Software defined radio receiver powered by GNU Radio and Qt
+ *           http://gqrx.dk/
+ *
+ * Copyright 2020 Vadym Ostanin.
+ *
+ * Gqrx is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * Gqrx is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Gqrx; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#include <chrono>
+#include <cmath>
+#include <dsp/rx_time.h>
+
+
+const pmt::pmt_t &rx_time_key(void)
+{
+    static const pmt::pmt_t key = pmt::string_to_symbol("rx_time");
+
+    return key;
+}
+
+pmt::pmt_t make_rx_time(double time)
+{
+    double secs = std::floor(time);
+
+    return pmt::make_tuple(pmt::from_uint64((uint64_t) secs),
+                           pmt::from_double(time - secs));
+}
+
+bool parse_rx_time(const pmt::pmt_t &value, double &time)
+{
+    if (!pmt::is_tuple(value) || pmt::length(value) != 2)
+        return false;
+
+    pmt::pmt_t secs = pmt::tuple_ref(value, 0);
+    pmt::pmt_t frac = pmt::tuple_ref(value, 1);
+
+    if (!pmt::is_uint64(secs) || !pmt::is_real(frac))
+        return false;
+
+    time = (double) pmt::to_uint64(secs) + pmt::to_double(frac);
+
+    return true;
+}
+
+double rx_time_now(void)
+{
+    using namespace std::chrono;
+
+    return duration_cast<microseconds>(
+                system_clock::now().time_since_epoch()).count() * 1.0e-6;
+}
+
+const pmt::pmt_t &rx_gap_key(void)
+{
+    static const pmt::pmt_t key = pmt::string_to_symbol("rx_gap");
+
+    return key;
+}
+
+pmt::pmt_t make_rx_gap(double time, double duration)
+{
+    return pmt::make_tuple(make_rx_time(time), pmt::from_double(duration));
+}
+
+bool parse_rx_gap(const pmt::pmt_t &value, double &time, double &duration)
+{
+    if (!pmt::is_tuple(value) || pmt::length(value) != 2)
+        return false;
+
+    pmt::pmt_t dur = pmt::tuple_ref(value, 1);
+
+    if (!parse_rx_time(pmt::tuple_ref(value, 0), time) || !pmt::is_real(dur))
+        return false;
+
+    duration = pmt::to_double(dur);
+
+    return true;
+}
+
+
+sample_clock::sample_clock()
+    : d_valid(false),
+      d_item(0),
+      d_time(0.0),
+      d_rate(0.0)
+{
+}
+
+/*! \brief Forget the anchor, e.g. when the flow graph is restarted. */
+void sample_clock::reset(void)
+{
+    d_valid = false;
+}
+
+/*! \brief Set the time of an item.
+ *  \param item The absolute item number.
+ *  \param time The time of the item in seconds since the epoch.
+ */
+void sample_clock::set_anchor(uint64_t item, double time)
+{
+    d_item = item;
+    d_time = time;
+    d_valid = true;
+}
+
+/*! \brief Update the anchor from a set of tags.
+ *  \param tags Tags as returned by get_tags_in_range().
+ *  \return true if the anchor has been updated.
+ *
+ * The last valid rx_time tag is used. Tags with other keys are ignored.
+ */
+bool sample_clock::update(const std::vector<gr::tag_t> &tags)
+{
+    bool    updated = false;
+    double  time;
+
+    std::vector<gr::tag_t>::const_iterator it;
+    for (it = tags.begin(); it != tags.end(); ++it)
+    {
+        if (!pmt::eq(it->key, rx_time_key()))
+            continue;
+
+        if (parse_rx_time(it->value, time))
+        {
+            set_anchor(it->offset, time);
+            updated = true;
+        }
+    }
+
+    return updated;
+}
+
+/*! \brief Get the time of an item.
+ *  \param item The absolute item number.
+ *  \return The time in seconds since the epoch or 0 if the clock is not
+ *          valid.
+ */
+double sample_clock::time_of(uint64_t item) const
+{
+    if (!valid())
+        return 0.0;
+
+    return d_time + (double) (int64_t) (item - d_item) / d_rate;
+}
+
+/*! \brief Get the item sampled at a given time.
+ *  \param time The time in seconds since the epoch.
+ *  \return The absolute item number or 0 if the clock is not valid.
+ */
+uint64_t sample_clock::item_of(double time) const
+{
+    if (!valid())
+        return 0;
+
+    return d_item + (int64_t) std::floor((time - d_time) * d_rate + 0.5);
+}
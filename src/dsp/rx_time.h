@@ -0,0 +1,106 @@
+/* -*- c++ -*- */
+/*
+ * Gqrx SDR: Software defined radio receiver powered by GNU Radio and Qt
+ *           http://gqrx.dk/
+ *
+ * Copyright 2020 Vadym Ostanin.
+ *
+ * Gqrx is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * Gqrx is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Gqrx; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifndef RX_TIME_H
+#define RX_TIME_H
+
+#include <gnuradio/tags.h>
+#include <pmt/pmt.h>
+#include <stdint.h>
+#include <vector>
+
+
+/*! \brief Key of the stream tags carrying the sampling time. */
+const pmt::pmt_t &rx_time_key(void);
+
+/*! \brief Create the value of an rx_time tag.
+ *  \param time The time in seconds since the epoch.
+ *
+ * The value is a tuple of integer seconds (uint64) and fractional seconds
+ * (double), the same format as used by UHD and the GNU Radio file meta data.
+ */
+pmt::pmt_t make_rx_time(double time);
+
+/*! \brief Read the value of an rx_time tag.
+ *  \param value The tag value.
+ *  \param time The time in seconds since the epoch.
+ *  \return true if the value is a valid time, false otherwise.
+ */
+bool parse_rx_time(const pmt::pmt_t &value, double &time);
+
+/*! \brief Return the current time in seconds since the epoch. */
+double rx_time_now(void);
+
+/*! \brief Key of the stream tags marking lost samples. */
+const pmt::pmt_t &rx_gap_key(void);
+
+/*! \brief Create the value of an rx_gap tag.
+ *  \param time The sampling time of the first lost sample.
+ *  \param duration The length of the gap in seconds.
+ *
+ * The tag is added to the first sample after the gap has been detected,
+ * which can be some time after the gap itself. The value therefore holds
+ * the time of the gap rather than relying on the tag offset. The rx_time
+ * tag added to the same sample accounts for the lost samples.
+ */
+pmt::pmt_t make_rx_gap(double time, double duration);
+
+/*! \brief Read the value of an rx_gap tag.
+ *  \return true if the value is a valid gap, false otherwise.
+ */
+bool parse_rx_gap(const pmt::pmt_t &value, double &time, double &duration);
+
+
+/*! \brief Sample clock following the rx_time tags of a stream.
+ *
+ * The clock keeps the absolute item number and time of the last rx_time tag
+ * seen by a block and computes the time of any other item from the sample
+ * rate of the stream at that block. GNU Radio adjusts the tag offsets by the
+ * relative rate of the decimators and resamplers, so the tags remain sample
+ * accurate when they arrive at a sink running at a different rate than the
+ * source.
+ */
+class sample_clock
+{
+public:
+    sample_clock();
+
+    void reset(void);
+
+    void set_sample_rate(double rate) { d_rate = rate; }
+    double sample_rate(void) const { return d_rate; }
+
+    void set_anchor(uint64_t item, double time);
+    bool update(const std::vector<gr::tag_t> &tags);
+
+    bool valid(void) const { return d_valid && d_rate > 0.0; }
+    double time_of(uint64_t item) const;
+    uint64_t item_of(double time) const;
+
+private:
+    bool        d_valid;    /*! An anchor has been set. */
+    uint64_t    d_item;     /*! Absolute item number of the anchor. */
+    double      d_time;     /*! Time of the anchor item in seconds. */
+    double      d_rate;     /*! Sample rate of the stream. */
+};
+
+#endif /* RX_TIME_H */
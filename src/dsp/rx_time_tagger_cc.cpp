@@ -0,0 +1,325 @@
+/* -*- c++ -*- */
+/*
+ * Gqrx SDR: Software defined radio receiver powered by GNU Radio and Qt
+ *           http://gqrx.dk/
+ *
+ * Copyright 2020 Vadym Ostanin.
+ *
+ * Gqrx is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * Gqrx is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Gqrx; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <gnuradio/io_signature.h>
+#include <dsp/rx_time_tagger_cc.h>
+
+/* Shortest gap that is reported */
+#define GAP_MIN_SEC         0.005
+
+/* Time the latency must stay above the baseline to be counted as a gap */
+#define GAP_CONFIRM_SEC     1.0
+
+/* Period of the latency baseline update, follows the clock drift between
+ * the device and the computer */
+#define BASELINE_SEC        1.0
+
+
+static double mono_now(void)
+{
+    using namespace std::chrono;
+
+    return duration_cast<microseconds>(
+                steady_clock::now().time_since_epoch()).count() * 1.0e-6;
+}
+
+
+rx_time_tagger_cc_sptr make_rx_time_tagger_cc(double sample_rate)
+{
+    return gnuradio::get_initial_sptr(new rx_time_tagger_cc(sample_rate));
+}
+
+rx_time_tagger_cc::rx_time_tagger_cc(double sample_rate)
+    : gr::sync_block ("rx_time_tagger_cc",
+          gr::io_signature::make(1, 1, sizeof(gr_complex)),
+          gr::io_signature::make(1, 1, sizeof(gr_complex))),
+      d_items(0),
+      d_next_tag(0),
+      d_upstream(false),
+      d_start_time(-1.0),
+      d_detect_gaps(true),
+      d_detect_reset(true),
+      d_mono_start(0.0),
+      d_mono_items(0),
+      d_baseline(0.0),
+      d_period_min(0.0),
+      d_period_start(0.0),
+      d_delayed(false),
+      d_delay_item(0),
+      d_delay_start(0.0),
+      d_delay_min(0.0),
+      d_samples(0),
+      d_lost(0),
+      d_gaps(0),
+      d_last_gap(0.0)
+{
+    d_clock.set_sample_rate(sample_rate);
+}
+
+rx_time_tagger_cc::~rx_time_tagger_cc()
+{
+}
+
+/*! \brief Forget the time anchor when the flow graph is (re)started.
+ *
+ * The item counters start from zero and the device may have been idle, so
+ * the first buffer is anchored to the system clock again.
+ */
+bool rx_time_tagger_cc::start()
+{
+    boost::mutex::scoped_lock lock(d_mutex);
+
+    d_clock.reset();
+    d_items = 0;
+    d_next_tag = 0;
+    d_upstream = false;
+    d_detect_reset = true;
+
+    return true;
+}
+
+int rx_time_tagger_cc::work(int noutput_items,
+                            gr_vector_const_void_star &input_items,
+                            gr_vector_void_star &output_items)
+{
+    const gr_complex *in = (const gr_complex *) input_items[0];
+    gr_complex *out = (gr_complex *) output_items[0];
+    std::vector<gr::tag_t> tags;
+    uint64_t first = nitems_written(0);
+    uint64_t end = first + noutput_items;
+    double period;
+    double time;
+
+    boost::mutex::scoped_lock lock(d_mutex);
+
+    /* device time takes precedence; the tags are propagated as they are */
+    get_tags_in_range(tags, 0, nitems_read(0), nitems_read(0) + noutput_items,
+                      rx_time_key());
+    for (size_t i = 0; i < tags.size(); i++)
+    {
+        if (!parse_rx_time(tags[i].value, time))
+            continue;
+
+        if (d_upstream && d_clock.valid() &&
+            time - d_clock.time_of(tags[i].offset) > GAP_MIN_SEC)
+        {
+            add_gap(tags[i].offset, d_clock.time_of(tags[i].offset),
+                    time - d_clock.time_of(tags[i].offset));
+        }
+        d_clock.set_anchor(tags[i].offset, time);
+        d_upstream = true;
+    }
+
+    if (!d_clock.valid() && d_clock.sample_rate() > 0.0)
+    {
+        if (d_start_time >= 0.0)
+            d_clock.set_anchor(first, d_start_time);
+        else
+            /* the last sample of the buffer has just been received */
+            d_clock.set_anchor(first, rx_time_now() -
+                               noutput_items / d_clock.sample_rate());
+        d_next_tag = first;
+    }
+
+    if (!d_upstream && d_clock.valid())
+    {
+        if (d_detect_gaps)
+            detect_gap(first, noutput_items);
+
+        period = std::max(1.0, d_clock.sample_rate());
+        while (d_next_tag < end)
+        {
+            add_time_tag(d_next_tag);
+            d_next_tag += (uint64_t) period;
+        }
+    }
+
+    memcpy(out, in, noutput_items * sizeof(gr_complex));
+    d_items = end;
+    d_samples += noutput_items;
+
+    return noutput_items;
+}
+
+/*! \brief Set the sample rate of the input stream.
+ *
+ * The clock is re-anchored at the next item using the old rate, so the time
+ * remains continuous across the change, and a new tag is added there.
+ */
+void rx_time_tagger_cc::set_sample_rate(double rate)
+{
+    boost::mutex::scoped_lock lock(d_mutex);
+
+    if (d_clock.valid())
+        d_clock.set_anchor(d_items, d_clock.time_of(d_items));
+    d_clock.set_sample_rate(rate);
+    d_next_tag = d_items;
+    d_detect_reset = true;
+}
+
+/*! \brief Set a fixed time for the first item after start().
+ *  \param time The time in seconds since the epoch, or a negative value to
+ *              use the system clock.
+ *
+ * Used when the input is a recording processed faster or slower than real
+ * time, where the system clock says nothing about the sampling time. Takes
+ * effect the next time the flow graph is started.
+ */
+void rx_time_tagger_cc::set_start_time(double time)
+{
+    boost::mutex::scoped_lock lock(d_mutex);
+
+    d_start_time = time;
+}
+
+/*! \brief Enable or disable the detection of lost samples.
+ *
+ * Should be disabled when the input does not run in real time, e.g. a
+ * file. Jumps in device provided rx_time tags are reported regardless.
+ */
+void rx_time_tagger_cc::set_gap_detection(bool enable)
+{
+    boost::mutex::scoped_lock lock(d_mutex);
+
+    d_detect_gaps = enable;
+    d_detect_reset = true;
+}
+
+/*! \brief Get the time of an item of the output stream.
+ *  \return The time in seconds since the epoch or 0 if not known yet.
+ */
+double rx_time_tagger_cc::time_of(uint64_t item)
+{
+    boost::mutex::scoped_lock lock(d_mutex);
+
+    return d_clock.time_of(item);
+}
+
+/*! \brief Get the input statistics.
+ *  \param samples The number of samples received.
+ *  \param lost The number of samples lost.
+ *  \param gaps The number of gaps.
+ *  \param last_gap The time of the last gap in seconds since the epoch or 0.
+ */
+void rx_time_tagger_cc::get_stats(uint64_t &samples, uint64_t &lost,
+                                  unsigned long &gaps, double &last_gap)
+{
+    boost::mutex::scoped_lock lock(d_mutex);
+
+    samples = d_samples;
+    lost = d_lost;
+    gaps = d_gaps;
+    last_gap = d_last_gap;
+}
+
+void rx_time_tagger_cc::add_time_tag(uint64_t item)
+{
+    add_item_tag(0, item, rx_time_key(), make_rx_time(d_clock.time_of(item)),
+                 alias_pmt());
+}
+
+void rx_time_tagger_cc::add_gap(uint64_t item, double time, double duration)
+{
+    uint64_t lost = (uint64_t) std::floor(duration * d_clock.sample_rate() + 0.5);
+
+    add_item_tag(0, item, rx_gap_key(), make_rx_gap(time, duration),
+                 alias_pmt());
+
+    d_lost += lost;
+    d_gaps++;
+    d_last_gap = time;
+}
+
+/*! \brief Compare the samples delivered with the elapsed time.
+ *  \param first The item number of the first sample in this call.
+ *  \param num The number of samples in this call.
+ */
+void rx_time_tagger_cc::detect_gap(uint64_t first, int num)
+{
+    double  rate = d_clock.sample_rate();
+    double  now = mono_now();
+    double  threshold = GAP_MIN_SEC * rate;
+    double  latency;
+    double  duration;
+
+    if (d_detect_reset)
+    {
+        d_mono_start = now - num / rate;
+        d_mono_items = 0;
+        d_baseline = 0.0;
+        d_period_min = 0.0;
+        d_period_start = now;
+        d_delayed = false;
+        d_detect_reset = false;
+    }
+
+    /* samples that should have arrived but have not */
+    d_mono_items += num;
+    latency = (now - d_mono_start) * rate - (double) d_mono_items;
+
+    if (!d_delayed)
+    {
+        if (latency > d_baseline + threshold)
+        {
+            d_delayed = true;
+            d_delay_item = first;
+            d_delay_start = now;
+            d_delay_min = latency;
+            return;
+        }
+
+        d_baseline = std::min(d_baseline, latency);
+        d_period_min = std::min(d_period_min, latency);
+        if (now - d_period_start >= BASELINE_SEC)
+        {
+            d_baseline = d_period_min;
+            d_period_min = latency;
+            d_period_start = now;
+        }
+        return;
+    }
+
+    d_delay_min = std::min(d_delay_min, latency);
+    if (d_delay_min <= d_baseline + threshold)
+    {
+        /* the backlog has drained, nothing was lost */
+        d_delayed = false;
+    }
+    else if (now - d_delay_start >= GAP_CONFIRM_SEC)
+    {
+        duration = (d_delay_min - d_baseline) / rate;
+        add_gap(first, d_clock.time_of(d_delay_item), duration);
+
+        /* move the time of the following samples */
+        d_clock.set_anchor(first, d_clock.time_of(first) + duration);
+        d_next_tag = first;
+
+        d_baseline = d_delay_min;
+        d_period_min = d_delay_min;
+        d_period_start = now;
+        d_delayed = false;
+    }
+}
@@ -0,0 +1,139 @@
+/* -*- c++ -*- */
+/*
+ * Gqrx SDR: Software defined radio receiver powered by GNU Radio and Qt
+ *           http://gqrx.dk/
+ *
+ * Copyright 2020 Vadym Ostanin.
+ *
+ * Gqrx is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * Gqrx is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Gqrx; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifndef RX_TIME_TAGGER_CC_H
+#define RX_TIME_TAGGER_CC_H
+
+#include <gnuradio/gr_complex.h>
+#include <gnuradio/sync_block.h>
+#include <boost/thread/mutex.hpp>
+#include <dsp/rx_time.h>
+
+
+class rx_time_tagger_cc;
+
+typedef boost::shared_ptr<rx_time_tagger_cc> rx_time_tagger_cc_sptr;
+
+
+/*! \brief Return a shared_ptr to a new instance of rx_time_tagger_cc.
+ *  \param sample_rate The sample rate of the input stream.
+ */
+rx_time_tagger_cc_sptr make_rx_time_tagger_cc(double sample_rate);
+
+
+/*! \brief Add rx_time tags to the samples coming from the input device and
+ *         detect lost samples.
+ *  \ingroup DSP
+ *
+ * The block passes the samples through and tags them with their sampling
+ * time. The first item after start() is anchored to the system clock,
+ * corrected by the length of the first buffer; after that the time is
+ * derived by counting samples so that it is free from the scheduling jitter
+ * of the flow graph. The time is repeated once per second of samples, which
+ * allows blocks connected while the flow graph is running to pick it up.
+ *
+ * If the device already provides rx_time tags, e.g. from a GPS disciplined
+ * clock, these are passed through unchanged and no tags are added. When
+ * processing a recording the first item is anchored to the capture time of
+ * the recording instead, see set_start_time().
+ *
+ * The tags travel through the decimators and resamplers of the receiver
+ * and are used by the sinks and data decoders to timestamp their output.
+ *
+ * Samples dropped by the device or the driver when the flow graph does not
+ * keep up are detected by comparing the number of samples delivered with
+ * the number expected from the elapsed time on a monotonic clock. The
+ * difference contains the buffering latency, so the block tracks its
+ * minimum as the baseline; a gap is reported when the difference stays
+ * above the baseline for a second, which allows a backlog in the driver to
+ * drain without being counted. Jumps in the device provided rx_time tags
+ * are reported directly. Each gap is marked with an rx_gap tag and the time
+ * is advanced by the length of the gap. Gaps are only reported through the
+ * tags and get_stats() since the block runs in the DSP thread.
+ *
+ * The comparison with the clock is meaningless when the input is a file,
+ * which may be read faster or slower than real time, so it can be disabled
+ * using set_gap_detection().
+ *
+ * The samples are copied from the input to the output buffer because the
+ * tags can only be added to the output of a block. This costs one memcpy()
+ * of the input stream, e.g. 160 MB/s at 20 Msps, which is small compared to
+ * the filtering in the input decimator that follows.
+ */
+class rx_time_tagger_cc : public gr::sync_block
+{
+    friend rx_time_tagger_cc_sptr make_rx_time_tagger_cc(double sample_rate);
+
+protected:
+    rx_time_tagger_cc(double sample_rate);
+
+public:
+    ~rx_time_tagger_cc();
+
+    bool start();
+
+    int work(int noutput_items,
+             gr_vector_const_void_star &input_items,
+             gr_vector_void_star &output_items);
+
+    void set_sample_rate(double rate);
+    void set_start_time(double time);
+    void set_gap_detection(bool enable);
+
+    double time_of(uint64_t item);
+
+    void get_stats(uint64_t &samples, uint64_t &lost, unsigned long &gaps,
+                   double &last_gap);
+
+private:
+    void add_time_tag(uint64_t item);
+    void add_gap(uint64_t item, double time, double duration);
+    void detect_gap(uint64_t first, int num);
+
+    boost::mutex    d_mutex;        /*! Protects the clock and statistics. */
+    sample_clock    d_clock;        /*! Time of the output items. */
+    uint64_t        d_items;        /*! Number of items produced. */
+    uint64_t        d_next_tag;     /*! Item number of the next tag. */
+    bool            d_upstream;     /*! The input has rx_time tags. */
+    double          d_start_time;   /*! Fixed time of the first item or -1. */
+
+    /* gap detector, all latencies in samples */
+    bool            d_detect_gaps;  /*! Gap detection is enabled. */
+    bool            d_detect_reset; /*! Restart on the next call to work(). */
+    double          d_mono_start;   /*! Monotonic time of the first sample. */
+    uint64_t        d_mono_items;   /*! Samples received since d_mono_start. */
+    double          d_baseline;     /*! Normal latency. */
+    double          d_period_min;   /*! Minimum latency in the current period. */
+    double          d_period_start; /*! Start of the baseline period. */
+    bool            d_delayed;      /*! Latency is above the baseline. */
+    uint64_t        d_delay_item;   /*! First item after the latency rose. */
+    double          d_delay_start;  /*! Time when the latency rose. */
+    double          d_delay_min;    /*! Minimum latency since then. */
+
+    /* statistics since the block was created */
+    uint64_t        d_samples;      /*! Samples received. */
+    uint64_t        d_lost;         /*! Samples lost. */
+    unsigned long   d_gaps;         /*! Number of gaps. */
+    double          d_last_gap;     /*! Time of the last gap or 0. */
+};
+
+#endif /* RX_TIME_TAGGER_CC_H */
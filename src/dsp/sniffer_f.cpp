@@ -43,7 +43,8 @@ sniffer_f::sniffer_f(int buffsize)
     : gr::sync_block ("rx_fft_c",
           gr::io_signature::make(1, 1, sizeof(float)),
           gr::io_signature::make(0, 0, 0)),
-      d_minsamp(1000)
+      d_minsamp(1000),
+      d_items(0)
 {
 
     /* allocate circular buffer */
@@ -71,11 +72,17 @@ int sniffer_f::work(int noutput_items,
 {
     int i;
     const float *in = (const float *)input_items[0];
+    std::vector<gr::tag_t> tags;
 
     (void) output_items;
 
     boost::mutex::scoped_lock lock(d_mutex);
 
+    get_tags_in_range(tags, 0, nitems_read(0), nitems_read(0) + noutput_items,
+                      rx_time_key());
+    d_clock.update(tags);
+    d_items = nitems_read(0) + noutput_items;
+
     /* dump new samples into the buffer */
     for (i = 0; i < noutput_items; i++) {
         d_buffer.push_back(in[i]);
@@ -104,9 +111,24 @@ int  sniffer_f::samples_available()
  *  \param num The number of sampels returned.
  */
 void sniffer_f::get_samples(float * out, unsigned int &num)
+{
+    double time;
+
+    get_samples(out, num, time);
+}
+
+/*! \brief Fetch avaialble samples and their time.
+ *  \param out Pointer to allocated memory where the samples will be copied.
+ *  \param num The number of sampels returned.
+ *  \param time The time of the first sample in seconds since the epoch or 0
+ *              if the time is not known.
+ */
+void sniffer_f::get_samples(float * out, unsigned int &num, double &time)
 {
     boost::mutex::scoped_lock lock(d_mutex);
 
+    time = 0.0;
+
     if (d_buffer.size() < d_minsamp) {
         /* not enough samples in buffer */
         num = 0;
@@ -114,6 +136,7 @@ void sniffer_f::get_samples(float * out, unsigned int &num)
     }
 
     num = d_buffer.size();
+    time = d_clock.time_of(d_items - num);
     float *buff = d_buffer.linearize();
 
     memcpy(out, buff, sizeof(float)*num);
@@ -122,6 +145,19 @@ void sniffer_f::get_samples(float * out, unsigned int &num)
 }
 
 
+/*! \brief Set the sample rate of the input stream.
+ *
+ * The sample rate is needed to compute the time of the samples between the
+ * rx_time tags.
+ */
+void sniffer_f::set_sample_rate(double rate)
+{
+    boost::mutex::scoped_lock lock(d_mutex);
+
+    d_clock.set_sample_rate(rate);
+}
+
+
 /*! \brief Resize internal buffer.
  *  \param newsize The new size of the buffer (number of samples, not bytes)
  */
@@ -26,6 +26,7 @@
 #include <gnuradio/sync_block.h>
 #include <boost/thread/mutex.hpp>
 #include <boost/circular_buffer.hpp>
+#include <dsp/rx_time.h>
 
 
 class sniffer_f;
@@ -54,6 +55,9 @@ sniffer_f_sptr make_sniffer_f(int buffsize=48000);
  * The class uses a circular buffer for internal storage and if the received samples
  * exceed the buffer size, old samples will be overwritten. The collected samples
  * can be accessed via the get_samples() method.
+ *
+ * The block follows the rx_time tags of the stream so that the time of the
+ * returned samples is known, provided that the sample rate has been set.
  */
 class sniffer_f : public gr::sync_block
 {
@@ -71,6 +75,9 @@ public:
 
     int  samples_available();
     void get_samples(float * buffer, unsigned int &num);
+    void get_samples(float * buffer, unsigned int &num, double &time);
+
+    void set_sample_rate(double rate);
 
     void set_buffer_size(int newsize);
     int  buffer_size();
@@ -83,6 +90,8 @@ private:
     boost::mutex d_mutex;                   /*! Used to prevent concurrent access to buffer. */
     boost::circular_buffer<float> d_buffer; /*! buffer to accumulate samples. */
     unsigned int d_minsamp;                 /*! smallest number of samples we want to return. */
+    sample_clock d_clock;                   /*! Time of the samples. */
+    uint64_t     d_items;                   /*! Item number following the last sample in the buffer. */
 
 };
 
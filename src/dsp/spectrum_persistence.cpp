@@ -0,0 +1,150 @@
+/* -*- c++ -*- */
+/*
+ * Gqrx SDR: Software defined radio receiver powered by GNU Radio and Qt
+ *           http://gqrx.dk/
+ *
+ * Copyright 2020 Vadym Ostanin.
+ *
+ * Gqrx is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * Gqrx is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Gqrx; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#include <algorithm>
+#include <volk/volk.h>
+
+#include "dsp/spectrum_persistence.h"
+
+// rescale the cells when the weight of a hit reaches this value, low
+// enough that small contributions are not lost in the float precision
+#define MAX_WEIGHT  1.0e4f
+
+// cells decayed below this density are cleared during rescaling
+#define MIN_DENSITY 1.0e-4f
+
+
+spectrum_persistence::spectrum_persistence()
+    : d_columns(0),
+      d_rows(0),
+      d_decay(0.95f),
+      d_weight(1.f)
+{
+}
+
+/*! \brief Set the size of the histogram and clear it. */
+void spectrum_persistence::resize(int columns, int rows)
+{
+    if (columns == d_columns && rows == d_rows)
+        return;
+
+    d_columns = std::max(columns, 0);
+    d_rows = std::max(rows, 0);
+    d_cells.resize((size_t)d_columns * d_rows);
+    d_top.resize(d_columns);
+    d_bottom.resize(d_columns);
+    clear();
+}
+
+/*! \brief Clear all hits. */
+void spectrum_persistence::clear()
+{
+    std::fill(d_cells.begin(), d_cells.end(), 0.f);
+    std::fill(d_top.begin(), d_top.end(), d_rows);
+    std::fill(d_bottom.begin(), d_bottom.end(), -1);
+    d_weight = 1.f;
+}
+
+/*! \brief Set the decay per frame.
+ *  \param decay The factor applied to old hits in each frame, 0...1.
+ *               The time constant is 1/(1-decay) frames.
+ */
+void spectrum_persistence::set_decay(float decay)
+{
+    d_decay = std::min(std::max(decay, 0.01f), 0.9999f);
+}
+
+/*! \brief Add a spectrum frame.
+ *  \param top The highest row of the trace in each column.
+ *  \param bottom The lowest row of the trace in each column, may be the
+ *                same as top.
+ *  \param xmin The first column with data.
+ *  \param xmax One past the last column with data.
+ */
+void spectrum_persistence::add_frame(const int *top, const int *bottom,
+                                     int xmin, int xmax)
+{
+    int     x, y, y0, y1;
+    float   weight = d_weight;
+
+    xmin = std::max(xmin, 0);
+    xmax = std::min(xmax, d_columns);
+    if (d_rows == 0)
+        return;
+
+    for (x = xmin; x < xmax; x++)
+    {
+        y0 = std::min(std::max(top[x], 0), d_rows - 1);
+        y1 = std::min(std::max(bottom[x], y0), d_rows - 1);
+
+        float  *cells = &d_cells[(size_t)x * d_rows];
+        for (y = y0; y <= y1; y++)
+            cells[y] += weight;
+
+        d_top[x] = std::min(d_top[x], y0);
+        d_bottom[x] = std::max(d_bottom[x], y1);
+    }
+
+    // the next frame weighs 1/decay times this one, which is the same as
+    // decaying everything already in the histogram
+    d_weight /= d_decay;
+    if (d_weight > MAX_WEIGHT)
+        renormalize();
+}
+
+/*! \brief Scale the cells back to a weight of 1.
+ *
+ * Also clears the cells which have decayed away and shrinks the touched
+ * range of each column accordingly.
+ */
+void spectrum_persistence::renormalize()
+{
+    float   min_val = MIN_DENSITY / (1.f - d_decay);
+    int     x, y;
+
+    if (!d_cells.empty())
+        volk_32f_s32f_multiply_32f(&d_cells[0], &d_cells[0], 1.f / d_weight,
+                                   d_cells.size());
+    d_weight = 1.f;
+
+    for (x = 0; x < d_columns; x++)
+    {
+        float  *cells = &d_cells[(size_t)x * d_rows];
+        int     top = d_rows;
+        int     bottom = -1;
+
+        for (y = d_top[x]; y <= d_bottom[x]; y++)
+        {
+            if (cells[y] < min_val)
+            {
+                cells[y] = 0.f;
+            }
+            else
+            {
+                top = std::min(top, y);
+                bottom = y;
+            }
+        }
+        d_top[x] = top;
+        d_bottom[x] = bottom;
+    }
+}
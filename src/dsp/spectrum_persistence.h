@@ -0,0 +1,94 @@
+/* -*- c++ -*- */
+/*
+ * Gqrx SDR: Software defined radio receiver powered by GNU Radio and Qt
+ *           http://gqrx.dk/
+ *
+ * Copyright 2020 Vadym Ostanin.
+ *
+ * Gqrx is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * Gqrx is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Gqrx; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifndef SPECTRUM_PERSISTENCE_H
+#define SPECTRUM_PERSISTENCE_H
+
+#include <vector>
+
+
+/*! \brief Persistence (density) histogram of the spectrum.
+ *
+ * Counts how often the spectrum trace passes through each cell of a
+ * columns x rows grid, with exponential decay so that old hits fade out.
+ * The rows are the vertical screen coordinates of the trace, as computed
+ * by the plotter for each column.
+ *
+ * Adding a frame only touches the cells hit by that frame. Instead of
+ * decaying all cells, the weight of new hits grows by 1/decay per frame
+ * and the cells are read scaled down by the current weight. The whole
+ * histogram is rescaled only when the weight gets large, which happens
+ * once every few hundred frames.
+ *
+ * The cells of a column are contiguous so that the hits of a column are a
+ * single vectorizable add over a range of rows.
+ */
+class spectrum_persistence
+{
+public:
+    spectrum_persistence();
+
+    void resize(int columns, int rows);
+    void clear();
+    void set_decay(float decay);
+
+    void add_frame(const int *top, const int *bottom, int xmin, int xmax);
+
+    /*! \brief The cells of one column, see density_scale(). */
+    const float *column(int x) const
+    {
+        return &d_cells[(size_t)x * d_rows];
+    }
+
+    /*! \brief Scale factor from cell value to density.
+     *
+     * The density of a cell is the decayed fraction of frames hitting the
+     * cell, 1.0 for a cell hit by every frame.
+     */
+    float density_scale() const
+    {
+        return (1.f - d_decay) / d_weight;
+    }
+
+    /*! \brief The range of rows which may have a non-zero density. */
+    void get_extent(int x, int &top, int &bottom) const
+    {
+        top = d_top[x];
+        bottom = d_bottom[x];
+    }
+
+    int columns() const { return d_columns; }
+    int rows() const { return d_rows; }
+
+private:
+    void renormalize();
+
+    std::vector<float>  d_cells;    /*! Column major histogram. */
+    std::vector<int>    d_top;      /*! First touched row of each column. */
+    std::vector<int>    d_bottom;   /*! Last touched row of each column. */
+    int                 d_columns;
+    int                 d_rows;
+    float               d_decay;    /*! Decay per frame, 0...1. */
+    float               d_weight;   /*! Weight of a hit in the current frame. */
+};
+
+#endif // SPECTRUM_PERSISTENCE_H
@@ -0,0 +1,292 @@
+/* -*- c++ -*- */
+/*
+ * Gqrx SDR: Software defined radio receiver powered by GNU Radio and Qt
+ *           http://gqrx.dk/
+ *
+ * Copyright 2020 Vadym Ostanin.
+ *
+ * Gqrx is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * Gqrx is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Gqrx; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#include <algorithm>
+#include <ctime>
+#include <iostream>
+#include <gnuradio/blocks/wavfile.h>
+#include <gnuradio/io_signature.h>
+#include <dsp/sql_recorder_ff.h>
+
+#define BYTES_PER_SAMPLE  2
+
+/* Tags added by gr::analog::squelch_base_cc when the squelch opens / closes */
+static const pmt::pmt_t SOB_KEY = pmt::intern("squelch_sob");
+static const pmt::pmt_t EOB_KEY = pmt::intern("squelch_eob");
+
+
+sql_recorder_ff_sptr make_sql_recorder_ff(const std::string &dir,
+                                          int sample_rate,
+                                          int preroll_ms,
+                                          int hang_ms)
+{
+    return gnuradio::get_initial_sptr(new sql_recorder_ff(dir, sample_rate,
+                                                          preroll_ms, hang_ms));
+}
+
+sql_recorder_ff::sql_recorder_ff(const std::string &dir, int sample_rate,
+                                 int preroll_ms, int hang_ms)
+    : gr::sync_block ("sql_recorder_ff",
+          gr::io_signature::make(2, 2, sizeof(float)),
+          gr::io_signature::make(0, 0, 0)),
+      d_sql_open(true),
+      d_dir(dir),
+      d_sample_rate(sample_rate),
+      d_hang_left(0),
+      d_fp(0),
+      d_byte_count(0)
+{
+    d_hang_samples = (int)((long long)hang_ms * sample_rate / 1000);
+    d_preroll.set_capacity(2 * (size_t)preroll_ms * sample_rate / 1000);
+    d_clock.set_sample_rate(sample_rate);
+}
+
+sql_recorder_ff::~sql_recorder_ff()
+{
+    close_file();
+}
+
+int sql_recorder_ff::work(int noutput_items,
+                          gr_vector_const_void_star &input_items,
+                          gr_vector_void_star &output_items)
+{
+    (void) output_items;
+
+    const float *left = (const float *) input_items[0];
+    const float *right = (const float *) input_items[1];
+    std::vector<gr::tag_t> tags;
+    std::vector<gr::tag_t> sql_tags;
+    std::vector<gr::tag_t> eob_tags;
+    uint64_t first = nitems_read(0);
+    int pos = 0;
+    int end;
+
+    boost::mutex::scoped_lock lock(d_mutex);
+
+    get_tags_in_range(tags, 0, first, first + noutput_items, rx_time_key());
+    d_clock.update(tags);
+
+    get_tags_in_range(sql_tags, 0, first, first + noutput_items, SOB_KEY);
+    get_tags_in_range(eob_tags, 0, first, first + noutput_items, EOB_KEY);
+    sql_tags.insert(sql_tags.end(), eob_tags.begin(), eob_tags.end());
+    std::sort(sql_tags.begin(), sql_tags.end(), gr::tag_t::offset_compare);
+
+    /* process the samples between squelch transitions */
+    for (const gr::tag_t &tag : sql_tags)
+    {
+        end = (int)(tag.offset - first);
+        process(left + pos, right + pos, end - pos, first + pos);
+        pos = end;
+        d_sql_open = pmt::eq(tag.key, SOB_KEY);
+    }
+    process(left + pos, right + pos, noutput_items - pos, first + pos);
+
+    return noutput_items;
+}
+
+/*! \brief Process samples with constant squelch state.
+ *  \param first_item The item number of left[0].
+ */
+void sql_recorder_ff::process(const float *left, const float *right, int num,
+                              uint64_t first_item)
+{
+    int n;
+
+    if (num <= 0)
+        return;
+
+    if (d_sql_open)
+        d_hang_left = d_hang_samples;
+
+    if (!d_fp)
+    {
+        /* the pre-roll holds the samples before this block */
+        if (!d_sql_open || !open_file(first_item - d_preroll.size() / 2))
+        {
+            store_preroll(left, right, num);
+            return;
+        }
+    }
+
+    if (d_sql_open)
+    {
+        write_samples(left, right, num);
+        return;
+    }
+
+    /* squelch closed: record until the hang time has passed */
+    n = std::min(num, d_hang_left);
+    write_samples(left, right, n);
+    d_hang_left -= n;
+    if (d_hang_left <= 0)
+    {
+        close_file();
+        store_preroll(left + n, right + n, num - n);
+    }
+}
+
+/*! \brief Set the squelch state.
+ *
+ * The state is used until the next squelch_sob or squelch_eob tag, e.g.
+ * when the recorder is connected to a receiver whose squelch is already
+ * open. Receivers without a squelch do not tag the stream and are recorded
+ * continuously if the state is open, which is the default.
+ */
+void sql_recorder_ff::set_sql_open(bool open)
+{
+    boost::mutex::scoped_lock lock(d_mutex);
+    d_sql_open = open;
+}
+
+/*! \brief Set the label used for the names of new files. */
+void sql_recorder_ff::set_label(const std::string &label)
+{
+    boost::mutex::scoped_lock lock(d_mutex);
+    d_label = label;
+}
+
+/*! \brief Close the current file, if any. */
+void sql_recorder_ff::close()
+{
+    boost::mutex::scoped_lock lock(d_mutex);
+    close_file();
+    d_preroll.clear();
+}
+
+bool sql_recorder_ff::is_recording(void)
+{
+    boost::mutex::scoped_lock lock(d_mutex);
+    return d_fp != 0;
+}
+
+std::string sql_recorder_ff::last_file(void)
+{
+    boost::mutex::scoped_lock lock(d_mutex);
+    return d_last_file;
+}
+
+/*! \brief Open a new file and write the pre-roll audio to it.
+ *  \param first_item The item number of the first sample in the file.
+ */
+bool sql_recorder_ff::open_file(uint64_t first_item)
+{
+    char        timestamp[32];
+    time_t      now = time(0);
+    struct tm   utc;
+    std::string basename;
+    std::string filename;
+    FILE       *fp;
+    int         seq = 1;
+
+    if (d_clock.valid())
+        now = (time_t) d_clock.time_of(first_item);
+
+#ifdef _WIN32
+    gmtime_s(&utc, &now);
+#else
+    gmtime_r(&now, &utc);
+#endif
+    strftime(timestamp, sizeof(timestamp), "gqrx_%Y%m%d_%H%M%S", &utc);
+
+    basename = d_dir + "/" + timestamp;
+    if (!d_label.empty())
+        basename += "_" + d_label;
+    filename = basename + ".wav";
+
+    /* do not overwrite a transmission recorded within the same second */
+    while ((fp = fopen(filename.c_str(), "rb")) != 0)
+    {
+        fclose(fp);
+        filename = basename + "_" + std::to_string(++seq) + ".wav";
+    }
+
+    d_fp = fopen(filename.c_str(), "wb");
+    if (!d_fp)
+    {
+        std::cout << "Error opening " << filename << std::endl;
+        return false;
+    }
+
+    if (!gr::blocks::wavheader_write(d_fp, d_sample_rate, 2, BYTES_PER_SAMPLE))
+    {
+        std::cout << "Error writing WAV header to " << filename << std::endl;
+        fclose(d_fp);
+        d_fp = 0;
+        return false;
+    }
+
+    d_byte_count = 0;
+    d_last_file = filename;
+    std::cout << "Recording audio to " << filename << std::endl;
+
+    boost::circular_buffer<float>::const_iterator it;
+    for (it = d_preroll.begin(); it != d_preroll.end(); ++it)
+    {
+        float sample = std::max(-1.0f, std::min(1.0f, *it));
+        gr::blocks::wav_write_sample(d_fp, (short int)(sample * 32767.0f),
+                                     BYTES_PER_SAMPLE);
+    }
+    d_byte_count += d_preroll.size() * BYTES_PER_SAMPLE;
+    d_preroll.clear();
+
+    return true;
+}
+
+void sql_recorder_ff::close_file(void)
+{
+    if (!d_fp)
+        return;
+
+    gr::blocks::wavheader_complete(d_fp, d_byte_count);
+    fclose(d_fp);
+    d_fp = 0;
+}
+
+void sql_recorder_ff::write_samples(const float *left, const float *right,
+                                    int num)
+{
+    int i;
+    float sample;
+
+    for (i = 0; i < num; i++)
+    {
+        sample = std::max(-1.0f, std::min(1.0f, left[i]));
+        gr::blocks::wav_write_sample(d_fp, (short int)(sample * 32767.0f),
+                                     BYTES_PER_SAMPLE);
+        sample = std::max(-1.0f, std::min(1.0f, right[i]));
+        gr::blocks::wav_write_sample(d_fp, (short int)(sample * 32767.0f),
+                                     BYTES_PER_SAMPLE);
+    }
+    d_byte_count += 2 * num * BYTES_PER_SAMPLE;
+}
+
+void sql_recorder_ff::store_preroll(const float *left, const float *right,
+                                    int num)
+{
+    int i;
+
+    for (i = 0; i < num; i++)
+    {
+        d_preroll.push_back(left[i]);
+        d_preroll.push_back(right[i]);
+    }
+}
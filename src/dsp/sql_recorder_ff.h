@@ -0,0 +1,123 @@
+/* -*- c++ -*- */
+/*
+ * Gqrx SDR: Software defined radio receiver powered by GNU Radio and Qt
+ *           http://gqrx.dk/
+ *
+ * Copyright 2020 Vadym Ostanin.
+ *
+ * Gqrx is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * Gqrx is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Gqrx; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifndef SQL_RECORDER_FF_H
+#define SQL_RECORDER_FF_H
+
+#include <gnuradio/sync_block.h>
+#include <boost/circular_buffer.hpp>
+#include <boost/thread/mutex.hpp>
+#include <dsp/rx_time.h>
+#include <cstdio>
+#include <string>
+
+
+class sql_recorder_ff;
+
+typedef boost::shared_ptr<sql_recorder_ff> sql_recorder_ff_sptr;
+
+
+/*! \brief Return a shared_ptr to a new instance of sql_recorder_ff.
+ *  \param dir The directory where the recordings are stored.
+ *  \param sample_rate The audio sample rate.
+ *  \param preroll_ms Length of audio recorded before the squelch opens.
+ *  \param hang_ms Time after the squelch closes before the file is closed.
+ */
+sql_recorder_ff_sptr make_sql_recorder_ff(const std::string &dir,
+                                          int sample_rate,
+                                          int preroll_ms = 500,
+                                          int hang_ms = 2000);
+
+
+/*! \brief Squelch triggered stereo WAV recorder.
+ *  \ingroup DSP
+ *
+ * The recorder writes one WAV file per transmission. While the squelch is
+ * closed the most recent audio is kept in a pre-roll buffer. When the
+ * squelch opens a new file is created, the pre-roll audio is written to it
+ * and recording continues until the squelch has been closed for the hang
+ * time.
+ *
+ * The squelch state is carried in the stream by the squelch_sob and
+ * squelch_eob tags of the GNU Radio squelch blocks, which mark the first
+ * sample after the squelch opened and closed. Files are opened and closed at
+ * these samples, so the recordings do not depend on thread timing and are
+ * the same when an I/Q file is processed faster than real time. The state
+ * before the first tag is set using set_sql_open().
+ *
+ * Files are named gqrx_yyyyMMdd_hhmmss_<label>.wav using UTC time, where the
+ * label is set by the application, e.g. to the frequency and mode. The time
+ * is the sampling time of the first sample in the file according to the
+ * rx_time tags of the stream, or the current time if the stream is not
+ * tagged. If a file with that name exists, e.g. because the squelch opened
+ * twice within a second, a sequence number is appended to the name.
+ */
+class sql_recorder_ff : public gr::sync_block
+{
+    friend sql_recorder_ff_sptr make_sql_recorder_ff(const std::string &dir,
+                                                     int sample_rate,
+                                                     int preroll_ms,
+                                                     int hang_ms);
+
+protected:
+    sql_recorder_ff(const std::string &dir, int sample_rate, int preroll_ms,
+                    int hang_ms);
+
+public:
+    ~sql_recorder_ff();
+
+    int work(int noutput_items,
+             gr_vector_const_void_star &input_items,
+             gr_vector_void_star &output_items);
+
+    void set_sql_open(bool open);
+    void set_label(const std::string &label);
+    void close();
+
+    bool is_recording(void);
+    std::string last_file(void);
+
+private:
+    bool open_file(uint64_t first_item);
+    void close_file(void);
+    void process(const float *left, const float *right, int num,
+                 uint64_t first_item);
+    void write_samples(const float *left, const float *right, int num);
+    void store_preroll(const float *left, const float *right, int num);
+
+    boost::mutex    d_mutex;        /*! Protects the file, squelch state and label. */
+    bool            d_sql_open;     /*! Squelch state at the current sample. */
+    std::string     d_dir;          /*! Directory for the recordings. */
+    std::string     d_label;        /*! Suffix of the file name. */
+    std::string     d_last_file;    /*! Name of the current or last file. */
+    int             d_sample_rate;
+    int             d_hang_samples; /*! Hang time in samples. */
+    int             d_hang_left;    /*! Samples left before the file is closed. */
+
+    boost::circular_buffer<float> d_preroll; /*! Interleaved pre-roll audio. */
+
+    FILE           *d_fp;           /*! Current file or NULL. */
+    unsigned int    d_byte_count;   /*! Bytes of audio written to d_fp. */
+    sample_clock    d_clock;        /*! Time of the samples. */
+};
+
+#endif /* SQL_RECORDER_FF_H */
@@ -0,0 +1,321 @@
+/* -*- c++ -*- */
+/*
+ * Gqrx SDR: Software defined radio receiver powered by GNU Radio and Qt
+ *           http://gqrx.dk/
+ *
+ * Copyright 2020 Vadym Ostanin.
+ *
+ * Gqrx is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * Gqrx is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Gqrx; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#include <algorithm>
+#include <iostream>
+#include <gnuradio/io_signature.h>
+
+#include "udp_framer_f.h"
+
+#define HEADER_SIZE     32
+#define MAX_PAYLOAD     1440    /* keep PCM packets within a typical MTU */
+#define MAX_QUEUE       50      /* frames */
+#define OPUS_BITRATE    24000   /* bits/s per channel */
+
+
+udp_framer_f_sptr make_udp_framer_f(int sample_rate)
+{
+    return gnuradio::get_initial_sptr(new udp_framer_f(sample_rate));
+}
+
+udp_framer_f::udp_framer_f(int sample_rate)
+    : gr::sync_block("udp_framer_f",
+          gr::io_signature::make(2, 2, sizeof(float)),
+          gr::io_signature::make(0, 0, 0)),
+      d_quit(false),
+      d_open(false),
+      d_sample_rate(sample_rate),
+      d_codec(CODEC_PCM),
+      d_channels(1),
+      d_frame_len(MAX_PAYLOAD / 2),
+      d_seq(0),
+      d_sample_count(0),
+      d_frequency(0),
+      d_socket(d_io_service)
+{
+#ifdef WITH_OPUS
+    d_opus = 0;
+#endif
+    d_thread = boost::thread(&udp_framer_f::worker, this);
+}
+
+udp_framer_f::~udp_framer_f()
+{
+    {
+        boost::mutex::scoped_lock lock(d_mutex);
+        d_quit = true;
+    }
+    d_cond.notify_one();
+    d_thread.join();
+
+    close();
+}
+
+/*! \brief Check whether a codec is available in this build. */
+bool udp_framer_f::have_codec(int codec)
+{
+#ifdef WITH_OPUS
+    return codec == CODEC_PCM || codec == CODEC_OPUS;
+#else
+    return codec == CODEC_PCM;
+#endif
+}
+
+/*! \brief Start sending audio.
+ *  \param host The hostname or IP address of the client.
+ *  \param port The UDP port of the client.
+ *  \param codec The codec, see codec_type.
+ *  \param stereo Send both audio channels.
+ *  \return True if the stream could be set up.
+ */
+bool udp_framer_f::open(const std::string &host, int port, int codec,
+                        bool stereo)
+{
+    close();
+
+    boost::mutex::scoped_lock send_lock(d_send_mutex);
+    boost::system::error_code error;
+
+    boost::asio::ip::udp::resolver resolver(d_io_service);
+    boost::asio::ip::udp::resolver::query query(host, std::to_string(port),
+        boost::asio::ip::resolver_query_base::passive);
+    boost::asio::ip::udp::resolver::iterator it = resolver.resolve(query, error);
+    if (error)
+    {
+        std::cout << "udp_framer_f: Can not resolve " << host << ": "
+                  << error.message() << std::endl;
+        return false;
+    }
+
+    d_endpoint = *it;
+    d_socket.open(d_endpoint.protocol(), error);
+    if (error)
+    {
+        std::cout << "udp_framer_f: " << error.message() << std::endl;
+        return false;
+    }
+
+    d_channels = stereo ? 2 : 1;
+    d_codec = have_codec(codec) ? codec : CODEC_PCM;
+    d_frame_len = MAX_PAYLOAD / (2 * d_channels);
+
+#ifdef WITH_OPUS
+    if (d_codec == CODEC_OPUS)
+    {
+        int err;
+
+        d_opus = opus_encoder_create(d_sample_rate, d_channels,
+                                     OPUS_APPLICATION_AUDIO, &err);
+        if (err == OPUS_OK)
+        {
+            opus_encoder_ctl(d_opus, OPUS_SET_BITRATE(OPUS_BITRATE * d_channels));
+            d_frame_len = d_sample_rate / 50; // 20 ms
+        }
+        else
+        {
+            std::cout << "udp_framer_f: Opus does not support "
+                      << d_sample_rate << " Hz, sending PCM" << std::endl;
+            d_opus = 0;
+            d_codec = CODEC_PCM;
+        }
+    }
+#endif
+
+    d_packet.resize(HEADER_SIZE + 2 * d_channels * d_frame_len);
+
+    boost::mutex::scoped_lock lock(d_mutex);
+    d_queue.clear();
+    d_frame.samples.clear();
+    d_frame.samples.reserve(d_channels * d_frame_len);
+    d_sample_count = 0;
+    d_seq = 0;
+    d_open = true;
+
+    return true;
+}
+
+/*! \brief Stop sending audio. */
+void udp_framer_f::close(void)
+{
+    {
+        boost::mutex::scoped_lock lock(d_mutex);
+        d_open = false;
+        d_queue.clear();
+    }
+
+    boost::mutex::scoped_lock send_lock(d_send_mutex);
+    boost::system::error_code error;
+
+    if (d_socket.is_open())
+        d_socket.close(error);
+
+#ifdef WITH_OPUS
+    if (d_opus)
+    {
+        opus_encoder_destroy(d_opus);
+        d_opus = 0;
+    }
+#endif
+}
+
+/*! \brief Set the receive frequency sent in the packet headers. */
+void udp_framer_f::set_frequency(int64_t freq_hz)
+{
+    boost::mutex::scoped_lock lock(d_mutex);
+    d_frequency = freq_hz;
+}
+
+int udp_framer_f::work(int noutput_items,
+                       gr_vector_const_void_star &input_items,
+                       gr_vector_void_star &output_items)
+{
+    (void) output_items;
+
+    const float *left = (const float *) input_items[0];
+    const float *right = (const float *) input_items[1];
+    int i;
+
+    boost::mutex::scoped_lock lock(d_mutex);
+
+    if (!d_open)
+        return noutput_items;
+
+    for (i = 0; i < noutput_items; i++)
+    {
+        if (d_frame.samples.empty())
+        {
+            d_frame.seq = d_seq++;
+            d_frame.timestamp = d_sample_count;
+        }
+
+        d_frame.samples.push_back(left[i]);
+        if (d_channels == 2)
+            d_frame.samples.push_back(right[i]);
+        d_sample_count++;
+
+        if (d_frame.samples.size() == d_channels * d_frame_len)
+        {
+            // drop the oldest frame rather than blocking the flow graph
+            if (d_queue.size() >= MAX_QUEUE)
+                d_queue.pop_front();
+            d_queue.push_back(d_frame);
+            d_frame.samples.clear();
+            d_cond.notify_one();
+        }
+    }
+
+    return noutput_items;
+}
+
+void udp_framer_f::worker(void)
+{
+    frame f;
+
+    while (true)
+    {
+        {
+            boost::mutex::scoped_lock lock(d_mutex);
+
+            while (d_queue.empty() && !d_quit)
+                d_cond.wait(lock);
+
+            if (d_quit)
+                return;
+
+            f.seq = d_queue.front().seq;
+            f.timestamp = d_queue.front().timestamp;
+            f.samples.swap(d_queue.front().samples);
+            d_queue.pop_front();
+        }
+
+        send_frame(f);
+    }
+}
+
+static inline void put_u32(unsigned char *p, uint32_t val)
+{
+    p[0] = val >> 24;
+    p[1] = val >> 16;
+    p[2] = val >> 8;
+    p[3] = val;
+}
+
+static inline void put_u64(unsigned char *p, uint64_t val)
+{
+    put_u32(p, val >> 32);
+    put_u32(p + 4, val);
+}
+
+void udp_framer_f::send_frame(const frame &f)
+{
+    boost::mutex::scoped_lock send_lock(d_send_mutex);
+    unsigned char  *p = &d_packet[0];
+    size_t          payload = 0;
+    size_t          i;
+    int64_t         freq;
+
+    if (!d_socket.is_open())
+        return;
+
+    {
+        boost::mutex::scoped_lock lock(d_mutex);
+        freq = d_frequency;
+    }
+
+    put_u32(p, 0x47515241);     // "GQRA"
+    p[4] = 1;
+    p[5] = d_codec;
+    p[6] = d_channels;
+    p[7] = 0;
+    put_u32(p + 8, f.seq);
+    put_u32(p + 12, d_sample_rate);
+    put_u64(p + 16, f.timestamp);
+    put_u64(p + 24, (uint64_t) freq);
+
+#ifdef WITH_OPUS
+    if (d_opus)
+    {
+        opus_int32 len = opus_encode_float(d_opus, &f.samples[0], d_frame_len,
+                                           p + HEADER_SIZE,
+                                           d_packet.size() - HEADER_SIZE);
+        if (len < 0)
+            return;
+        payload = len;
+    }
+    else
+#endif
+    {
+        for (i = 0; i < f.samples.size(); i++)
+        {
+            float sample = std::max(-1.0f, std::min(1.0f, f.samples[i]));
+            int16_t val = (int16_t)(sample * 32767.0f);
+
+            p[HEADER_SIZE + 2 * i] = (uint16_t)val >> 8;
+            p[HEADER_SIZE + 2 * i + 1] = (uint16_t)val & 0xff;
+        }
+        payload = 2 * f.samples.size();
+    }
+
+    boost::system::error_code error;
+    d_socket.send_to(boost::asio::buffer(p, HEADER_SIZE + payload),
+                     d_endpoint, 0, error);
+}
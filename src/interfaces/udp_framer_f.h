@@ -0,0 +1,135 @@
+/* -*- c++ -*- */
+/*
+ * Gqrx SDR: Software defined radio receiver powered by GNU Radio and Qt
+ *           http://gqrx.dk/
+ *
+ * Copyright 2020 Vadym Ostanin.
+ *
+ * Gqrx is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * Gqrx is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Gqrx; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifndef UDP_FRAMER_F_H
+#define UDP_FRAMER_F_H
+
+#include <gnuradio/sync_block.h>
+#include <boost/asio.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+#include <deque>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#ifdef WITH_OPUS
+#include <opus.h>
+#endif
+
+
+class udp_framer_f;
+
+typedef boost::shared_ptr<udp_framer_f> udp_framer_f_sptr;
+
+udp_framer_f_sptr make_udp_framer_f(int sample_rate);
+
+
+/*! \brief Audio sink sending framed, optionally compressed audio over UDP.
+ *  \ingroup IO
+ *
+ * Audio is split into frames which are encoded and sent by a worker thread,
+ * so the flow graph never waits for the encoder or the network. If the
+ * worker falls behind, the oldest frames are dropped.
+ *
+ * Each UDP packet contains one frame preceded by a 32 byte header. All
+ * fields are big endian:
+ *
+ *   offset  size  field
+ *        0     4  magic "GQRA"
+ *        4     1  version (1)
+ *        5     1  codec (0 = 16 bit PCM, big endian; 1 = Opus)
+ *        6     1  number of channels, interleaved
+ *        7     1  reserved
+ *        8     4  sequence number, incremented for every frame
+ *       12     4  sample rate
+ *       16     8  timestamp: index of the first sample of the frame
+ *       24     8  receive frequency in Hz
+ *
+ * Gaps in the sequence number indicate lost or dropped frames, the
+ * timestamp can be used to insert the right amount of silence.
+ */
+class udp_framer_f : public gr::sync_block
+{
+    friend udp_framer_f_sptr make_udp_framer_f(int sample_rate);
+
+protected:
+    udp_framer_f(int sample_rate);
+
+public:
+    enum codec_type {
+        CODEC_PCM  = 0,
+        CODEC_OPUS = 1
+    };
+
+    ~udp_framer_f();
+
+    int work(int noutput_items,
+             gr_vector_const_void_star &input_items,
+             gr_vector_void_star &output_items);
+
+    bool open(const std::string &host, int port, int codec, bool stereo);
+    void close(void);
+    void set_frequency(int64_t freq_hz);
+
+    static bool have_codec(int codec);
+
+private:
+    struct frame {
+        uint32_t            seq;
+        uint64_t            timestamp;
+        std::vector<float>  samples;
+    };
+
+    void worker(void);
+    void send_frame(const frame &f);
+
+    boost::mutex                d_mutex;    /*! Protects the queue and state. */
+    boost::condition_variable   d_cond;     /*! Signals new frames. */
+    boost::mutex                d_send_mutex; /*! Protects socket and encoder. */
+    boost::thread               d_thread;   /*! Encoder and sender thread. */
+    bool                        d_quit;
+
+    std::deque<frame>           d_queue;    /*! Frames waiting to be sent. */
+    frame                       d_frame;    /*! Frame being collected. */
+
+    bool        d_open;
+    int         d_sample_rate;
+    int         d_codec;
+    int         d_channels;
+    unsigned int d_frame_len;   /*! Samples per channel in a frame. */
+    uint32_t    d_seq;
+    uint64_t    d_sample_count;
+    int64_t     d_frequency;
+
+    boost::asio::io_service         d_io_service;
+    boost::asio::ip::udp::socket    d_socket;
+    boost::asio::ip::udp::endpoint  d_endpoint;
+    std::vector<unsigned char>      d_packet;
+
+#ifdef WITH_OPUS
+    OpusEncoder                    *d_opus;
+#endif
+};
+
+#endif // UDP_FRAMER_F_H
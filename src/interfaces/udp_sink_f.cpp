@@ -33,9 +33,9 @@
  * upcasted boost shared_ptr. This is effectively the public
  * constructor.
  */
-udp_sink_f_sptr make_udp_sink_f()
+udp_sink_f_sptr make_udp_sink_f(int sample_rate)
 {
-    return gnuradio::get_initial_sptr(new udp_sink_f());
+    return gnuradio::get_initial_sptr(new udp_sink_f(sample_rate));
 }
 
 static const int MIN_IN = 2;  /*!< Mininum number of input streams. */
@@ -43,7 +43,7 @@ static const int MAX_IN = 2;  /*!< Maximum number of input streams. */
 static const int MIN_OUT = 0; /*!< Minimum number of output streams. */
 static const int MAX_OUT = 0; /*!< Maximum number of output streams. */
 
-udp_sink_f::udp_sink_f()
+udp_sink_f::udp_sink_f(int sample_rate)
     : gr::hier_block2("udp_sink_f",
                       gr::io_signature::make(MIN_IN, MAX_IN, sizeof(float)),
                       gr::io_signature::make(MIN_OUT, MAX_OUT, sizeof(float)))
@@ -62,6 +62,7 @@ udp_sink_f::udp_sink_f()
     d_inter = gr::blocks::interleave::make(sizeof(float));
     d_null0 = gr::blocks::null_sink::make(sizeof(float));
     d_null1 = gr::blocks::null_sink::make(sizeof(float));
+    d_framer = make_udp_framer_f(sample_rate);
 
     connect(self(), 0, d_null0, 0);
     connect(self(), 1, d_null1, 0);
@@ -75,12 +76,38 @@ udp_sink_f::~udp_sink_f()
  *  \param host The hostname or IP address of the client.
  *  \param port The port used for the UDP stream
  *  \param stereo Select mono or stereo streaming
+ *  \param format The stream format, see udp_sink_f::format.
+ *
+ * The raw format sends 16 bit samples without any header and is compatible
+ * with earlier versions. The framed formats add a header with sequence
+ * number, timestamp and frequency to every packet.
+ *
+ * \returns true if streaming was started, false if the framed stream could
+ *          not be opened (e.g. the host could not be resolved). In that
+ *          case the sink is left disconnected as after stop_streaming().
  */
-void udp_sink_f::start_streaming(const std::string host, int port, bool stereo)
+bool udp_sink_f::start_streaming(const std::string host, int port, bool stereo,
+                                 int format)
 {
     lock();
     disconnect_all();
 
+    if (format != FORMAT_RAW)
+    {
+        connect(self(), 0, d_framer, 0);
+        connect(self(), 1, d_framer, 1);
+        unlock();
+
+        if (!d_framer->open(host, port, format == FORMAT_OPUS ?
+                            udp_framer_f::CODEC_OPUS : udp_framer_f::CODEC_PCM,
+                            stereo))
+        {
+            stop_streaming();
+            return false;
+        }
+        return true;
+    }
+
     if (stereo)
     {
         connect(self(), 0, d_inter, 0);
@@ -97,6 +124,7 @@ void udp_sink_f::start_streaming(const std::string host, int port, bool stereo)
     unlock();
 
     d_sink->connect(host, port);
+    return true;
 }
 
 
@@ -109,4 +137,11 @@ void udp_sink_f::stop_streaming(void)
     unlock();
 
     d_sink->disconnect();
+    d_framer->close();
+}
+
+/*! \brief Set the frequency sent in the headers of the framed formats. */
+void udp_sink_f::set_frequency(int64_t freq_hz)
+{
+    d_framer->set_frequency(freq_hz);
 }
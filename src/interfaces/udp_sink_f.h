@@ -28,22 +28,32 @@
 #include <gnuradio/blocks/udp_sink.h>
 #include <gnuradio/blocks/interleave.h>
 #include <gnuradio/blocks/null_sink.h>
+#include "interfaces/udp_framer_f.h"
 
 
 class udp_sink_f;
 
 typedef boost::shared_ptr<udp_sink_f> udp_sink_f_sptr;
 
-udp_sink_f_sptr make_udp_sink_f(void);
+udp_sink_f_sptr make_udp_sink_f(int sample_rate = 48000);
 
 class udp_sink_f : public gr::hier_block2
 {
 public:
-    udp_sink_f(void);
+    /*! \brief Stream formats. */
+    enum format {
+        FORMAT_RAW  = 0,    /*!< Raw 16 bit samples, no header. */
+        FORMAT_PCM  = 1,    /*!< Framed 16 bit samples, see udp_framer_f. */
+        FORMAT_OPUS = 2     /*!< Framed Opus packets, see udp_framer_f. */
+    };
+
+    udp_sink_f(int sample_rate = 48000);
     ~udp_sink_f();
 
-    void start_streaming(const std::string host, int port, bool stereo);
+    bool start_streaming(const std::string host, int port, bool stereo,
+                         int format = FORMAT_RAW);
     void stop_streaming(void);
+    void set_frequency(int64_t freq_hz);
 
 private:
     gr::blocks::udp_sink::sptr        d_sink;   /*!< The gnuradio UDP sink. */
@@ -51,6 +61,7 @@ private:
     gr::blocks::interleave::sptr      d_inter;  /*!< Stereo interleaver. */
     gr::blocks::null_sink::sptr       d_null0;  /*!< Null sink for mono. */
     gr::blocks::null_sink::sptr       d_null1;  /*!< Null sink for mono. */
+    udp_framer_f_sptr                 d_framer; /*!< Framed / compressed sink. */
 
 };
 
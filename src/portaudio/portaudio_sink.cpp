@@ -21,11 +21,16 @@
  * Boston, MA 02110-1301, USA.
  */
 #include <gnuradio/io_signature.h>
+#include <boost/thread/thread.hpp>
 #include <stdio.h>
+#include <string.h>
 
 #include "device_list.h"
 #include "portaudio_sink.h"
 
+#define RING_LATENCY_MS     200     // upper bound for the ring buffer
+#define TARGET_LATENCY_MS   50      // latency held by the drift resampler
+
 /**
  * Create a new portaudio sink object.
  * @param device_name The name of the audio device, or NULL for default.
@@ -49,9 +54,14 @@ portaudio_sink::portaudio_sink(const string device_name, int audio_rate,
   : gr::sync_block ("portaudio_sink",
         gr::io_signature::make (1, 2, sizeof(float)),
         gr::io_signature::make (0, 0, 0)),
+    d_stream(0),
     d_stream_name(stream_name),
     d_app_name(app_name),
-    d_audio_rate(audio_rate)
+    d_audio_rate(audio_rate),
+    d_ring(audio_rate * RING_LATENCY_MS / 1000),
+    d_drift(audio_rate, 1.e-3 * TARGET_LATENCY_MS),
+    d_running(false),
+    d_underruns(0)
 {
 
     // find device index
@@ -75,7 +85,7 @@ portaudio_sink::portaudio_sink(const string device_name, int audio_rate,
     d_out_params.channelCount = 2;
     d_out_params.sampleFormat = paFloat32;
     d_out_params.suggestedLatency =
-            Pa_GetDeviceInfo(d_out_params.device)->defaultHighOutputLatency;
+            Pa_GetDeviceInfo(d_out_params.device)->defaultLowOutputLatency;
     d_out_params.hostApiSpecificStreamInfo = NULL;
 
     if (Pa_IsFormatSupported(NULL, &d_out_params, d_audio_rate) != paFormatIsSupported)
@@ -98,14 +108,15 @@ bool portaudio_sink::start()
                         d_audio_rate,
                         paFramesPerBufferUnspecified,
                         paClipOff,
-                        NULL,           // no callback, use blocking API
-                        NULL);
+                        &portaudio_sink::stream_callback,
+                        this);
 
     if (err != paNoError)
     {
         fprintf(stderr,
                 "portaudio_sink::start(): Failed to open audio stream: %s\n",
                 Pa_GetErrorText(err));
+        d_stream = 0;
         return false;
     }
 
@@ -127,6 +138,12 @@ bool portaudio_sink::stop()
     PaError     err;
     bool        retval = true;
 
+    d_running = false;
+    d_drift.reset();
+
+    if (!d_stream)
+        return true;
+
     err = Pa_StopStream(d_stream);
     if (err != paNoError)
     {
@@ -144,6 +161,7 @@ bool portaudio_sink::stop()
                 "portaudio_sink::stop(): Error closing audio stream: %s\n",
                 Pa_GetErrorText(err));
     }
+    d_stream = 0;
 
     return retval;
 }
@@ -153,63 +171,80 @@ void portaudio_sink::select_device(string device_name)
 
 }
 
-#define BUFFER_SIZE 100000
-int portaudio_sink::work(int noutput_items,
-                         gr_vector_const_void_star &input_items,
-                         gr_vector_void_star &output_items)
+/**
+ * Get the current audio latency.
+ * @return The latency in seconds, including the ring buffer and the audio
+ *         device.
+ */
+double portaudio_sink::get_latency(void)
 {
-    PaError     err;
+    double  latency = (double) d_ring.fill() / d_audio_rate;
 
-    static float    audio_buffer[BUFFER_SIZE];
-    float      *ptr = &audio_buffer[0];
-    int         i;
+    if (d_stream)
+        latency += Pa_GetStreamInfo(d_stream)->outputLatency;
 
-    (void) output_items;
+    return latency;
+}
+
+/**
+ * Stream callback called by portaudio when the device needs more data. Fills
+ * the request from the ring buffer and pads with silence if there is not
+ * enough audio.
+ */
+int portaudio_sink::stream_callback(const void *input, void *output,
+                                    unsigned long frames,
+                                    const PaStreamCallbackTimeInfo *time_info,
+                                    PaStreamCallbackFlags status_flags,
+                                    void *user_data)
+{
+    portaudio_sink *sink = (portaudio_sink *) user_data;
+    unsigned int    n;
 
-    if (noutput_items > BUFFER_SIZE/2)
-        noutput_items = BUFFER_SIZE/2;
+    (void) input;
+    (void) time_info;
+    (void) status_flags;
 
-    // two channels (stereo)
-    const float *data_l = (const float*) input_items[0];
-    const float *data_r = (const float*) input_items[1];
-    for (i = noutput_items; i > 0; i--)
+    n = sink->d_ring.read((float *) output, frames);
+    if (n < frames)
     {
-        *ptr++ = *data_l++;
-        *ptr++ = *data_r++;
+        memset((float *) output + 2 * n, 0, 2 * (frames - n) * sizeof(float));
+        if (sink->d_running)
+            sink->d_underruns++;
     }
 
-    err = Pa_WriteStream(d_stream, audio_buffer, noutput_items);
-    if (err)
-        fprintf(stderr,
-                "portaudio_sink::work(): Error writing to audio device: %s\n",
-                Pa_GetErrorText(err));
+    return paContinue;
+}
 
-    return noutput_items;
+int portaudio_sink::work(int noutput_items,
+                         gr_vector_const_void_star &input_items,
+                         gr_vector_void_star &output_items)
+{
+    const float    *left = (const float *) input_items[0];
+    const float    *right = left; // same data in both channels for mono
+    unsigned int    written = 0;
+    unsigned int    n;
+
+    (void) output_items;
 
-// code below supports 1 or 2 channels
-#if 0
     if (input_items.size() == 2)
+        right = (const float *) input_items[1];
+
+    d_running = true;
+
+    // steer towards the target using the average fill during this block
+    n = d_drift.process(left, right, noutput_items,
+                        d_ring.fill() + noutput_items / 2);
+
+    while (d_stream)
     {
-        // two channels (stereo)
-        const float *data_l = (const float*) input_items[0]; // left channel
-        const float *data_r = (const float*) input_items[1]; // right channel
-        for (i = noutput_items; i > 0; i--)
-        {
-            *ptr++ = *data_l++;
-            *ptr++ = *data_r++;
-        }
-    }
-    else
-    {
-        // assume 1 channel (mono)
-        const float *data = (const float*) input_items[0];
-        for (i = noutput_items; i > 0; i--)
-        {
-            float a = *data++;
-            *ptr++ = a; // same data in left and right channel
-            *ptr++ = a;
-        }
+        written += d_ring.write(d_drift.left() + written,
+                                d_drift.right() + written, n - written);
+        if (written == n)
+            break;
+
+        // ring buffer is full; wait for the audio device to catch up
+        boost::this_thread::sleep(boost::posix_time::milliseconds(5));
     }
-#endif
 
+    return noutput_items;
 }
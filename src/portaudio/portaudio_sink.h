@@ -24,8 +24,12 @@
 
 #include <gnuradio/sync_block.h>
 #include <portaudio.h>
+#include <atomic>
 #include <string>
 
+#include "dsp/audio_ring.h"
+#include "dsp/drift_resampler.h"
+
 using namespace std;
 
 class portaudio_sink;
@@ -36,7 +40,14 @@ portaudio_sink_sptr make_portaudio_sink(const string device_name, int audio_rate
                                         const string app_name,
                                         const string stream_name);
 
-/** Two-channel portaudio sink */
+/**
+ * Two-channel portaudio sink
+ *
+ * The work() function writes into a lock-free ring buffer which is emptied
+ * by the portaudio stream callback. The size of the ring buffer puts an
+ * upper bound on the latency, a drift_resampler holds it at the target in the
+ * presence of clock drift.
+ */
 class portaudio_sink : public gr::sync_block
 {
     friend portaudio_sink_sptr make_portaudio_sink(const string device_name,
@@ -58,10 +69,25 @@ public:
 
     void select_device(string device_name);
 
+    double get_latency(void);
+    unsigned long get_underruns(void) const { return d_underruns; }
+    double get_drift_ppm(void) const { return d_drift.get_drift_ppm(); }
+
 private:
+    static int stream_callback(const void *input, void *output,
+                               unsigned long frames,
+                               const PaStreamCallbackTimeInfo *time_info,
+                               PaStreamCallbackFlags status_flags,
+                               void *user_data);
+
     PaStream           *d_stream;
     PaStreamParameters  d_out_params;
     string      d_stream_name;       // Descriptive name of the stream.
     string      d_app_name;          // Descriptive name of the applcation.
     int         d_audio_rate;
+
+    audio_ring                  d_ring;         // Buffer to the callback
+    drift_resampler             d_drift;        // Clock drift compensation
+    std::atomic<bool>           d_running;      // Flow graph is running
+    std::atomic<unsigned long>  d_underruns;    // Ring buffer underruns
 };
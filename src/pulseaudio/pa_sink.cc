@@ -21,13 +21,17 @@
  * Boston, MA 02110-1301, USA.
  */
 #include <gnuradio/io_signature.h>
-#include <pulse/simple.h>
-#include <pulse/error.h>
-#include <pulse/gccmacro.h>
+#include <boost/thread/thread.hpp>
+#include <pulse/pulseaudio.h>
 #include <stdio.h>
+#include <string.h>
 
 #include "pa_sink.h"
 
+#define RING_LATENCY_MS     200     /* upper bound for the ring buffer */
+#define TARGET_LATENCY_MS   50      /* latency held by the drift resampler */
+#define SERVER_LATENCY_US   40000   /* target latency in the server */
+
 
 /*! \brief Create a new pulseaudio sink object.
  *  \param device_name The name of the audio device, or NULL for default.
@@ -49,47 +53,62 @@ pa_sink::pa_sink(const string device_name, int audio_rate,
   : gr::sync_block ("pa_sink",
         gr::io_signature::make (1, 2, sizeof(float)),
         gr::io_signature::make (0, 0, 0)),
+    d_mainloop(0),
+    d_context(0),
+    d_stream(0),
     d_stream_name(stream_name),
-    d_app_name(app_name)
+    d_app_name(app_name),
+    d_ring(audio_rate * RING_LATENCY_MS / 1000),
+    d_drift(audio_rate, 1.e-3 * TARGET_LATENCY_MS),
+    d_running(false),
+    d_underruns(0)
 {
-    int error;
-
     /* The sample type to use */
     d_ss.format = PA_SAMPLE_FLOAT32LE;
     d_ss.rate = audio_rate;
     d_ss.channels = 2;
-    d_pasink = pa_simple_new(NULL,
-                             d_app_name.c_str(),
-                             PA_STREAM_PLAYBACK,
-                             device_name.empty() ? NULL : device_name.c_str(),
-                             d_stream_name.c_str(),
-                             &d_ss,
-                             NULL,
-                             NULL,
-                             &error);
-
-    if (!d_pasink) {
-        /** FIXME: Throw an exception **/
-        fprintf(stderr, __FILE__": pa_simple_new() failed: %s\n", pa_strerror(error));
-    }
 
+    open(device_name);
 }
 
 
 pa_sink::~pa_sink()
 {
-    if (d_pasink) {
-        pa_simple_free(d_pasink);
-    }
+    close();
 }
 
 bool pa_sink::start()
 {
+    pa_operation *op;
+
+    if (d_stream)
+    {
+        pa_threaded_mainloop_lock(d_mainloop);
+        op = pa_stream_cork(d_stream, 0, NULL, NULL);
+        if (op)
+            pa_operation_unref(op);
+        pa_threaded_mainloop_unlock(d_mainloop);
+    }
+
     return true;
 }
 
 bool pa_sink::stop()
 {
+    pa_operation *op;
+
+    d_running = false;
+    d_drift.reset();
+
+    if (d_stream)
+    {
+        pa_threaded_mainloop_lock(d_mainloop);
+        op = pa_stream_cork(d_stream, 1, NULL, NULL);
+        if (op)
+            pa_operation_unref(op);
+        pa_threaded_mainloop_unlock(d_mainloop);
+    }
+
     return true;
 }
 
@@ -99,67 +118,193 @@ bool pa_sink::stop()
  */
 void pa_sink::select_device(string device_name)
 {
-    int error;
-
-    pa_simple_free(d_pasink);
-
-    d_pasink = pa_simple_new(NULL,
-                             d_app_name.c_str(),
-                             PA_STREAM_PLAYBACK,
-                             device_name.empty() ? NULL : device_name.c_str(),
-                             d_stream_name.c_str(),
-                             &d_ss,
-                             NULL,
-                             NULL,
-                             &error);
-
-    if (!d_pasink) {
-        /** FIXME: Throw an exception **/
-        fprintf(stderr, __FILE__": pa_simple_new() failed: %s\n", pa_strerror(error));
-    }
+    close();
+    open(device_name);
 }
 
+/*! \brief Get the current audio latency.
+ *  \return The latency in seconds, including the ring buffer and the
+ *          pulseaudio server.
+ */
+double pa_sink::get_latency(void)
+{
+    pa_usec_t   usec;
+    int         negative;
+    double      latency = (double) d_ring.fill() / d_ss.rate;
 
-#define BUFFER_SIZE 100000
+    if (d_stream)
+    {
+        pa_threaded_mainloop_lock(d_mainloop);
+        if (pa_stream_get_latency(d_stream, &usec, &negative) == 0 && !negative)
+            latency += 1.e-6 * usec;
+        pa_threaded_mainloop_unlock(d_mainloop);
+    }
 
-int pa_sink::work (int noutput_items,
-                   gr_vector_const_void_star &input_items,
-                   gr_vector_void_star &output_items)
+    return latency;
+}
+
+/*! \brief Connect to the pulseaudio server and create the playback stream.
+ *  \param device_name The name of the audio device, or empty for default.
+ *  \return True if the stream is ready.
+ */
+bool pa_sink::open(const string &device_name)
 {
-    static float audio_buffer[BUFFER_SIZE];
-    float *ptr = &audio_buffer[0];
-    int i, error;
+    pa_context_state_t  cstate;
+    pa_stream_state_t   sstate;
+    pa_buffer_attr      attr;
+    bool                ok = false;
 
-    (void) output_items;
+    d_mainloop = pa_threaded_mainloop_new();
+    d_context = pa_context_new(pa_threaded_mainloop_get_api(d_mainloop),
+                               d_app_name.c_str());
+    pa_context_set_state_callback(d_context, context_state_cb, this);
 
-    if (noutput_items > BUFFER_SIZE/2)
-        noutput_items = BUFFER_SIZE/2;
+    pa_threaded_mainloop_lock(d_mainloop);
 
-    if (input_items.size() == 2)
+    if (pa_threaded_mainloop_start(d_mainloop) == 0 &&
+        pa_context_connect(d_context, NULL, PA_CONTEXT_NOFLAGS, NULL) == 0)
     {
-        // two channels (stereo)
-        const float *data_l = (const float*) input_items[0]; // left channel
-        const float *data_r = (const float*) input_items[1]; // right channel
-        for (i = noutput_items; i > 0; i--)
-        {
-            *ptr++ = *data_l++;
-            *ptr++ = *data_r++;
-        }
+        while ((cstate = pa_context_get_state(d_context)) != PA_CONTEXT_READY &&
+               PA_CONTEXT_IS_GOOD(cstate))
+            pa_threaded_mainloop_wait(d_mainloop);
+
+        if (cstate == PA_CONTEXT_READY)
+            d_stream = pa_stream_new(d_context, d_stream_name.c_str(), &d_ss,
+                                     NULL);
     }
-    else
+
+    if (d_stream)
     {
-        // assume 1 channel (mono)
-        const float *data = (const float*) input_items[0];
-        for (i = noutput_items; i > 0; i--)
+        pa_stream_set_state_callback(d_stream, stream_state_cb, this);
+        pa_stream_set_write_callback(d_stream, stream_write_cb, this);
+
+        attr.maxlength = (uint32_t) -1;
+        attr.tlength = pa_usec_to_bytes(SERVER_LATENCY_US, &d_ss);
+        attr.prebuf = (uint32_t) -1;
+        attr.minreq = (uint32_t) -1;
+        attr.fragsize = (uint32_t) -1;
+
+        if (pa_stream_connect_playback(d_stream,
+                                       device_name.empty() ? NULL : device_name.c_str(),
+                                       &attr,
+                                       (pa_stream_flags_t)(PA_STREAM_START_CORKED |
+                                                           PA_STREAM_ADJUST_LATENCY |
+                                                           PA_STREAM_AUTO_TIMING_UPDATE |
+                                                           PA_STREAM_INTERPOLATE_TIMING),
+                                       NULL, NULL) == 0)
         {
-            float a = *data++;
-            *ptr++ = a; // same data in left and right channel
-            *ptr++ = a;
+            while ((sstate = pa_stream_get_state(d_stream)) != PA_STREAM_READY &&
+                   PA_STREAM_IS_GOOD(sstate))
+                pa_threaded_mainloop_wait(d_mainloop);
+
+            ok = (sstate == PA_STREAM_READY);
         }
     }
 
-    if (pa_simple_write(d_pasink, audio_buffer, 2*noutput_items*sizeof(float), &error) < 0) { //!!!
-        fprintf(stderr, __FILE__": pa_simple_write() failed: %s\n", pa_strerror(error));
+    if (!ok)
+        fprintf(stderr, __FILE__": Failed to open audio stream: %s\n",
+                pa_strerror(pa_context_errno(d_context)));
+
+    pa_threaded_mainloop_unlock(d_mainloop);
+
+    if (!ok)
+        close();
+
+    return ok;
+}
+
+/*! \brief Close the playback stream and the server connection. */
+void pa_sink::close(void)
+{
+    if (!d_mainloop)
+        return;
+
+    pa_threaded_mainloop_stop(d_mainloop);
+
+    if (d_stream)
+    {
+        pa_stream_disconnect(d_stream);
+        pa_stream_unref(d_stream);
+        d_stream = 0;
+    }
+
+    pa_context_disconnect(d_context);
+    pa_context_unref(d_context);
+    d_context = 0;
+
+    pa_threaded_mainloop_free(d_mainloop);
+    d_mainloop = 0;
+}
+
+void pa_sink::context_state_cb(pa_context *c, void *userdata)
+{
+    (void) c;
+    pa_threaded_mainloop_signal(((pa_sink *) userdata)->d_mainloop, 0);
+}
+
+void pa_sink::stream_state_cb(pa_stream *s, void *userdata)
+{
+    (void) s;
+    pa_threaded_mainloop_signal(((pa_sink *) userdata)->d_mainloop, 0);
+}
+
+/*! \brief Stream write callback.
+ *
+ * Called from the pulseaudio thread when the server wants more data. Fills
+ * the request from the ring buffer and pads with silence if there is not
+ * enough audio.
+ */
+void pa_sink::stream_write_cb(pa_stream *s, size_t nbytes, void *userdata)
+{
+    pa_sink        *sink = (pa_sink *) userdata;
+    void           *data = 0;
+    unsigned int    frames, n;
+
+    if (pa_stream_begin_write(s, &data, &nbytes) < 0 || !data)
+        return;
+
+    frames = nbytes / (2 * sizeof(float));
+    n = sink->d_ring.read((float *) data, frames);
+    if (n < frames)
+    {
+        memset((float *) data + 2 * n, 0, 2 * (frames - n) * sizeof(float));
+        if (sink->d_running)
+            sink->d_underruns++;
+    }
+
+    pa_stream_write(s, data, 2 * frames * sizeof(float), NULL, 0, PA_SEEK_RELATIVE);
+}
+
+
+int pa_sink::work (int noutput_items,
+                   gr_vector_const_void_star &input_items,
+                   gr_vector_void_star &output_items)
+{
+    const float    *left = (const float *) input_items[0];
+    const float    *right = left; // same data in both channels for mono
+    unsigned int    written = 0;
+    unsigned int    n;
+
+    (void) output_items;
+
+    if (input_items.size() == 2)
+        right = (const float *) input_items[1];
+
+    d_running = true;
+
+    // steer towards the target using the average fill during this block
+    n = d_drift.process(left, right, noutput_items,
+                        d_ring.fill() + noutput_items / 2);
+
+    while (d_stream)
+    {
+        written += d_ring.write(d_drift.left() + written,
+                                d_drift.right() + written, n - written);
+        if (written == n)
+            break;
+
+        // ring buffer is full; wait for the audio device to catch up
+        boost::this_thread::sleep(boost::posix_time::milliseconds(5));
     }
 
     return noutput_items;
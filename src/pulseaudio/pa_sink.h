@@ -24,9 +24,13 @@
 #define PA_SINK_H
 
 #include <gnuradio/sync_block.h>
-#include <pulse/simple.h>
+#include <pulse/pulseaudio.h>
+#include <atomic>
 #include <string>
 
+#include "dsp/audio_ring.h"
+#include "dsp/drift_resampler.h"
+
 using namespace std;
 
 class pa_sink;
@@ -41,8 +45,11 @@ pa_sink_sptr make_pa_sink(const string device_name, int audio_rate,
 /*! \brief Pulseaudio sink
  *  \ingroup IO
  *
- * This block implements a two-channel pulseaudio sink using the Pulseaudio simple API.
- *
+ * This block implements a two-channel pulseaudio sink using the asynchronous
+ * Pulseaudio API. The work() function writes into a lock-free ring buffer
+ * which is emptied by the stream write callback running in the pulseaudio
+ * thread. The size of the ring buffer puts an upper bound on the latency,
+ * a drift_resampler holds it at the target in the presence of clock drift.
  */
 class pa_sink : public gr::sync_block
 {
@@ -63,11 +70,29 @@ public:
 
     void select_device(string device_name);
 
+    double get_latency(void);
+    unsigned long get_underruns(void) const { return d_underruns; }
+    double get_drift_ppm(void) const { return d_drift.get_drift_ppm(); }
+
 private:
-    pa_simple *d_pasink;    /*! The pulseaudio object. */
+    bool open(const string &device_name);
+    void close(void);
+
+    static void context_state_cb(pa_context *c, void *userdata);
+    static void stream_state_cb(pa_stream *s, void *userdata);
+    static void stream_write_cb(pa_stream *s, size_t nbytes, void *userdata);
+
+    pa_threaded_mainloop *d_mainloop;   /*! Mainloop running the callbacks. */
+    pa_context  *d_context;             /*! Connection to the server. */
+    pa_stream   *d_stream;              /*! The playback stream. */
     string d_stream_name;   /*! Descriptive name of the stream. */
     string d_app_name;      /*! Descriptive name of the applcation. */
     pa_sample_spec d_ss;    /*! pulseaudio sample specification. */
+
+    audio_ring                  d_ring;         /*! Buffer to the callback. */
+    drift_resampler             d_drift;        /*! Clock drift compensation. */
+    std::atomic<bool>           d_running;      /*! Flow graph is running. */
+    std::atomic<unsigned long>  d_underruns;    /*! Ring buffer underruns. */
 };
 
 #endif /* PA_SINK_H */
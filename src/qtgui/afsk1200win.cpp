@@ -62,17 +62,23 @@ Afsk1200Win::~Afsk1200Win()
 }
 
 
-/*! \brief Process new set of samples. */
-void Afsk1200Win::process_samples(float *buffer, int length)
+/*! \brief Process new set of samples.
+ *  \param time The sampling time of buffer[0] or 0 if not known.
+ */
+void Afsk1200Win::process_samples(float *buffer, int length, double time)
 {
     int overlap = 18;
     int i;
 
+    /* the demodulator starts with the overlap from the previous call */
+    if (time > 0.0)
+        time -= (double) tmpbuf.size() / FREQ_SAMP;
+
     for (i = 0; i < length; i++) {
         tmpbuf.append(buffer[i]);
     }
 
-    decoder->demod(tmpbuf.data(), length);
+    decoder->demod(tmpbuf.data(), length, time);
 
     /* clear tmpbuf and store "overlap" */
     tmpbuf.clear();
@@ -83,6 +89,13 @@ void Afsk1200Win::process_samples(float *buffer, int length)
 }
 
 
+/*! \brief Show a packet decoded elsewhere, e.g. by the packet decoder service. */
+void Afsk1200Win::add_message(const QString &message)
+{
+    ui->textView->appendPlainText(message);
+}
+
+
 /*! \brief Catch window close events and emit signal so that main application can destroy us. */
 void Afsk1200Win::closeEvent(QCloseEvent *ev)
 {
@@ -41,7 +41,8 @@ class Afsk1200Win : public QMainWindow
 public:
     explicit Afsk1200Win(QWidget *parent = 0);
     ~Afsk1200Win();
-    void process_samples(float *buffer, int length);
+    void process_samples(float *buffer, int length, double time = 0.0);
+    void add_message(const QString &message);
 
 protected:
     void closeEvent(QCloseEvent *ev);
@@ -37,6 +37,11 @@ CAudioOptions::CAudioOptions(QWidget *parent) :
 
     error_palette = new QPalette();
     error_palette->setColor(QPalette::Text, Qt::red);
+
+#ifndef WITH_OPUS
+    // last item is Opus
+    ui->udpFormat->removeItem(2);
+#endif
 }
 
 CAudioOptions::~CAudioOptions()
@@ -96,6 +101,23 @@ void CAudioOptions::setUdpStereo(bool stereo)
     ui->udpStereo->setChecked(stereo);
 }
 
+/** Set new UDP stream format. */
+void CAudioOptions::setUdpFormat(int format)
+{
+    if (format < ui->udpFormat->count())
+        ui->udpFormat->setCurrentIndex(format);
+}
+
+/** Set squelch triggered recording settings. */
+void CAudioOptions::setRecSql(bool enabled, int preroll_ms, int hang_ms)
+{
+    ui->recSql->setChecked(enabled);
+    ui->recPreroll->setValue(preroll_ms);
+    ui->recHang->setValue(hang_ms);
+    ui->recPreroll->setEnabled(enabled);
+    ui->recHang->setEnabled(enabled);
+}
+
 
 void CAudioOptions::setFftSplit(int pct_2d)
 {
@@ -195,3 +217,29 @@ void CAudioOptions::on_udpStereo_stateChanged(int state)
 {
     emit newUdpStereo(state);
 }
+
+/** UDP stream format has changed. */
+void CAudioOptions::on_udpFormat_currentIndexChanged(int index)
+{
+    emit newUdpFormat(index);
+}
+
+/** Squelch triggered recording has been enabled or disabled. */
+void CAudioOptions::on_recSql_stateChanged(int state)
+{
+    ui->recPreroll->setEnabled(state);
+    ui->recHang->setEnabled(state);
+    emit newRecSql(state, ui->recPreroll->value(), ui->recHang->value());
+}
+
+/** Squelch triggered recording pre-roll has changed. */
+void CAudioOptions::on_recPreroll_valueChanged(int value)
+{
+    emit newRecSql(ui->recSql->isChecked(), value, ui->recHang->value());
+}
+
+/** Squelch triggered recording hang time has changed. */
+void CAudioOptions::on_recHang_valueChanged(int value)
+{
+    emit newRecSql(ui->recSql->isChecked(), ui->recPreroll->value(), value);
+}
@@ -47,6 +47,8 @@ public:
     void setUdpHost(const QString &host);
     void setUdpPort(int port);
     void setUdpStereo(bool stereo);
+    void setUdpFormat(int format);
+    void setRecSql(bool enabled, int preroll_ms, int hang_ms);
 
     void setFftSplit(int pct_2d);
     int  getFftSplit(void) const;
@@ -68,6 +70,8 @@ signals:
     void newUdpHost(const QString text);
     void newUdpPort(int port);
     void newUdpStereo(bool enabled);
+    void newUdpFormat(int format);
+    void newRecSql(bool enabled, int preroll_ms, int hang_ms);
 
 private slots:
     void on_fftSplitSlider_valueChanged(int value);
@@ -78,6 +82,10 @@ private slots:
     void on_udpHost_textChanged(const QString &text);
     void on_udpPort_valueChanged(int port);
     void on_udpStereo_stateChanged(int state);
+    void on_udpFormat_currentIndexChanged(int index);
+    void on_recSql_stateChanged(int state);
+    void on_recPreroll_valueChanged(int value);
+    void on_recHang_valueChanged(int value);
 
 private:
     Ui::CAudioOptions *ui;            /*!< The user interface widget. */
@@ -35,7 +35,8 @@ const QColor TagInfo::DefaultColor(Qt::lightGray);
 const QString TagInfo::strUntagged("Untagged");
 Bookmarks* Bookmarks::m_pThis = 0;
 
-Bookmarks::Bookmarks()
+Bookmarks::Bookmarks() :
+    m_IndexValid(false)
 {
      TagInfo tag(TagInfo::strUntagged);
      m_TagList.append(tag);
@@ -59,8 +60,10 @@ void Bookmarks::setConfigDir(const QString& cfg_dir)
 
 void Bookmarks::add(BookmarkInfo &info)
 {
-    m_BookmarkList.append(info);
-    std::stable_sort(m_BookmarkList.begin(),m_BookmarkList.end());
+    // insert after bookmarks with the same frequency to keep the list sorted
+    QList<BookmarkInfo>::iterator it = std::upper_bound(m_BookmarkList.begin(),
+                                                        m_BookmarkList.end(), info);
+    m_BookmarkList.insert(it, info);
     save();
     emit( BookmarksChanged() );
 }
@@ -139,6 +142,7 @@ bool Bookmarks::load()
         }
         file.close();
         std::stable_sort(m_BookmarkList.begin(),m_BookmarkList.end());
+        m_IndexValid = false;
 
         emit BookmarksChanged();
         return true;
@@ -149,6 +153,9 @@ bool Bookmarks::load()
 //FIXME: Commas in names
 bool Bookmarks::save()
 {
+    // save() is called after every edit of the bookmarks or their tags
+    m_IndexValid = false;
+
     QFile file(m_bookmarksFile);
     if(file.open(QFile::WriteOnly | QFile::Truncate | QIODevice::Text))
     {
@@ -208,28 +215,111 @@ bool Bookmarks::save()
     return false;
 }
 
-QList<BookmarkInfo> Bookmarks::getBookmarksInRange(qint64 low, qint64 high)
+void Bookmarks::updateIndex()
 {
-    BookmarkInfo info;
-    info.frequency=low;
-    QList<BookmarkInfo>::const_iterator lb = qLowerBound(m_BookmarkList, info);
-    info.frequency=high;
-    QList<BookmarkInfo>::const_iterator ub = qUpperBound(m_BookmarkList, info);
+    if (m_IndexValid)
+        return;
 
-    QList<BookmarkInfo> found;
+    int n = m_BookmarkList.size();
 
-    while (lb != ub)
+    QVector<QPair<qint64, int> > order(n);
+    for (int i = 0; i < n; i++)
+        order[i] = qMakePair(m_BookmarkList[i].frequency, i);
+    std::sort(order.begin(), order.end());
+
+    m_IndexFreq.resize(n);
+    m_IndexPos.resize(n);
+    m_TagBits.clear();
+    for (int i = 0; i < n; i++)
     {
-        const BookmarkInfo& info = *lb;
-        //if(info.IsActive())
+        m_IndexFreq[i] = order[i].first;
+        m_IndexPos[i] = order[i].second;
+
+        const BookmarkInfo& info = m_BookmarkList[order[i].second];
+        for (int iTag = 0; iTag < info.tags.size(); ++iTag)
         {
-          found.append(info);
+            QBitArray& bits = m_TagBits[info.tags[iTag]];
+            if (bits.size() != n)
+                bits.resize(n);
+            bits.setBit(i);
         }
-        lb++;
+    }
+
+    m_IndexValid = true;
+    updateActiveBits();
+}
+
+void Bookmarks::updateActiveBits()
+{
+    m_ActiveBits = QBitArray(m_IndexFreq.size());
+
+    QHash<const TagInfo*, QBitArray>::const_iterator it;
+    for (it = m_TagBits.constBegin(); it != m_TagBits.constEnd(); ++it)
+    {
+        if (it.key()->active)
+            m_ActiveBits |= it.value();
+    }
+}
+
+// Returns the bookmarks with at least one active tag.
+QList<BookmarkInfo> Bookmarks::getBookmarksInRange(qint64 low, qint64 high)
+{
+    updateIndex();
+
+    int first = std::lower_bound(m_IndexFreq.begin(), m_IndexFreq.end(), low) - m_IndexFreq.begin();
+    int last = std::upper_bound(m_IndexFreq.begin(), m_IndexFreq.end(), high) - m_IndexFreq.begin();
+
+    QList<BookmarkInfo> found;
+
+    for (int i = first; i < last; i++)
+    {
+        if (m_ActiveBits.testBit(i))
+            found.append(m_BookmarkList[m_IndexPos[i]]);
     }
 
     return found;
+}
+
+// Sorted frequencies of the bookmarks with at least one active tag.
+QVector<qint64> Bookmarks::getActiveFrequencies()
+{
+    updateIndex();
+
+    QVector<qint64> freqs;
+    freqs.reserve(m_ActiveBits.count(true));
+    for (int i = 0; i < m_IndexFreq.size(); i++)
+    {
+        if (m_ActiveBits.testBit(i))
+            freqs.append(m_IndexFreq[i]);
+    }
+
+    return freqs;
+}
+
+// Sorted frequencies of the active bookmarks using the tag tagName.
+QVector<qint64> Bookmarks::getTaggedFrequencies(QString tagName)
+{
+    QVector<qint64> freqs;
+
+    int idx = getTagIndex(tagName);
+    if (idx == -1)
+        return freqs;
+
+    updateIndex();
+
+    QBitArray bits = m_TagBits.value(&m_TagList[idx]);
+    if (bits.isEmpty())
+        return freqs;
+
+    bits &= m_ActiveBits;
+    freqs.reserve(bits.count(true));
+    for (int i = 0; i < m_IndexFreq.size(); i++)
+    {
+        if (bits.testBit(i))
+            freqs.append(m_IndexFreq[i]);
+    }
 
+    return freqs;
 }
 
 TagInfo &Bookmarks::findOrAddTag(QString tagName)
@@ -281,6 +371,7 @@ bool Bookmarks::removeTag(QString tagName)
 
     // Delete Tag.
     m_TagList.removeAt(idx);
+    m_IndexValid = false;
 
     emit BookmarksChanged();
     emit TagListChanged();
@@ -293,6 +384,8 @@ bool Bookmarks::setTagChecked(QString tagName, bool bChecked)
     int idx = getTagIndex(tagName);
     if (idx == -1) return false;
     m_TagList[idx].active = bChecked;
+    if (m_IndexValid)
+        updateActiveBits();
     emit BookmarksChanged();
     emit TagListChanged();
     return true;
@@ -27,7 +27,10 @@
 #include <QObject>
 #include <QString>
 #include <QMap>
+#include <QHash>
 #include <QList>
+#include <QVector>
+#include <QBitArray>
 #include <QStringList>
 #include <QColor>
 
@@ -109,6 +112,8 @@ public:
     int size() { return m_BookmarkList.size(); }
     BookmarkInfo& getBookmark(int i) { return m_BookmarkList[i]; }
     QList<BookmarkInfo> getBookmarksInRange(qint64 low, qint64 high);
+    QVector<qint64> getActiveFrequencies();
+    QVector<qint64> getTaggedFrequencies(QString tagName);
     //int lowerBound(qint64 low);
     //int upperBound(qint64 high);
 
@@ -122,11 +127,23 @@ public:
 
 private:
     Bookmarks(); // Singleton Constructor is private.
+    void updateIndex();
+    void updateActiveBits();
+
     QList<BookmarkInfo> m_BookmarkList;
     QList<TagInfo> m_TagList;
     QString        m_bookmarksFile;
     static Bookmarks* m_pThis;
 
+    // Frequency index, rebuilt on first use after the bookmarks have changed.
+    // Bookmarks are edited in place by the table model, so the index does not
+    // rely on the order of m_BookmarkList.
+    bool            m_IndexValid;
+    QVector<qint64> m_IndexFreq;    // Sorted frequencies.
+    QVector<int>    m_IndexPos;     // Position of each entry in m_BookmarkList.
+    QHash<const TagInfo*, QBitArray> m_TagBits; // Entries using each tag.
+    QBitArray       m_ActiveBits;   // Entries with at least one active tag.
+
 signals:
     void BookmarksChanged(void);
     void TagListChanged(void);
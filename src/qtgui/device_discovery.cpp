@@ -0,0 +1,107 @@
+/* -*- c++ -*- */
+/*
+ * Gqrx SDR: Software defined radio receiver powered by GNU Radio and Qt
+ *           http://gqrx.dk/
+ *
+ * Copyright 2020 Vadym Ostanin.
+ *
+ * Gqrx is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * Gqrx is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Gqrx; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QSettings>
+
+#include "qtgui/device_discovery.h"
+#include "qtgui/ioconfig.h"
+
+CDeviceDiscovery::CDeviceDiscovery(QObject *parent) :
+    QThread(parent)
+{
+}
+
+CDeviceDiscovery::~CDeviceDiscovery()
+{
+    // the probes can not be interrupted
+    wait();
+}
+
+/**
+ * @brief Load the devices found by the previous discovery.
+ * @param filename The cache file.
+ * @param devList The device list where the cached devices are added.
+ * @return True if the cache contained any devices.
+ */
+bool CDeviceDiscovery::loadCache(const QString &filename,
+                                 std::map<QString, QVariant> &devList)
+{
+    QSettings   cache(filename, QSettings::IniFormat);
+    int         num;
+
+    num = cache.beginReadArray("devices");
+    for (int i = 0; i < num; i++)
+    {
+        cache.setArrayIndex(i);
+        devList.insert(std::pair<QString, QVariant>(cache.value("label").toString(),
+                                                    cache.value("devstr")));
+    }
+    cache.endArray();
+
+    qDebug() << __func__ << ": Loaded" << num << "devices from" << filename;
+
+    return num > 0;
+}
+
+/**
+ * @brief Save the devices found by a discovery.
+ * @param filename The cache file.
+ * @param devList The device list to save.
+ */
+void CDeviceDiscovery::saveCache(const QString &filename,
+                                 const std::map<QString, QVariant> &devList)
+{
+    QSettings   cache(filename, QSettings::IniFormat);
+    int         i = 0;
+
+    cache.remove("devices");
+    cache.beginWriteArray("devices", devList.size());
+    for (auto &dev : devList)
+    {
+        cache.setArrayIndex(i++);
+        cache.setValue("label", dev.first);
+        cache.setValue("devstr", dev.second);
+    }
+    cache.endArray();
+}
+
+/*! \brief Probe the devices, called in the discovery thread. */
+void CDeviceDiscovery::run()
+{
+    std::map<QString, QVariant> devList;
+    QElapsedTimer               timer;
+
+    timer.start();
+
+    CIoConfig::getAudioInputDevices(devList);
+    qDebug() << "Device discovery: audio input devices probed after"
+             << timer.elapsed() << "ms";
+    if (!devList.empty())
+        emit devicesFound(QVariantMap(devList), false);
+
+    CIoConfig::getOsmosdrDevices(devList);
+    qDebug() << "Device discovery: gr-osmosdr devices probed after"
+             << timer.elapsed() << "ms";
+    emit devicesFound(QVariantMap(devList), true);
+}
@@ -0,0 +1,63 @@
+/* -*- c++ -*- */
+/*
+ * Gqrx SDR: Software defined radio receiver powered by GNU Radio and Qt
+ *           http://gqrx.dk/
+ *
+ * Copyright 2020 Vadym Ostanin.
+ *
+ * Gqrx is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * Gqrx is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Gqrx; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifndef DEVICE_DISCOVERY_H
+#define DEVICE_DISCOVERY_H
+
+#include <map>
+#include <QString>
+#include <QThread>
+#include <QVariant>
+#include <QVariantMap>
+
+/*! \brief Input device discovery running in a background thread.
+ *
+ * Probing all gr-osmosdr drivers takes several seconds, so it is done in
+ * the background while the configured device is already in use. The
+ * results of the last discovery are cached in a file so that the device
+ * list is available immediately at the next startup.
+ */
+class CDeviceDiscovery : public QThread
+{
+    Q_OBJECT
+
+public:
+    explicit CDeviceDiscovery(QObject *parent = 0);
+    ~CDeviceDiscovery();
+
+    static bool loadCache(const QString &filename,
+                          std::map<QString, QVariant> &devList);
+    static void saveCache(const QString &filename,
+                          const std::map<QString, QVariant> &devList);
+
+signals:
+    /*! \brief Emitted each time a probe has finished.
+     *  \param devices All devices found so far, label -> device string.
+     *  \param finished True when the last probe has finished.
+     */
+    void devicesFound(const QVariantMap &devices, bool finished);
+
+protected:
+    void run();
+};
+
+#endif // DEVICE_DISCOVERY_H
@@ -28,10 +28,15 @@
 #include "ui_dockaudio.h"
 
 #define DEFAULT_FFT_SPLIT 100
+#define DEFAULT_REC_PREROLL 500
+#define DEFAULT_REC_HANG 2000
 
 DockAudio::DockAudio(QWidget *parent) :
     QDockWidget(parent),
     ui(new Ui::DockAudio),
+    rec_sql(false),
+    rec_preroll(DEFAULT_REC_PREROLL),
+    rec_hang(DEFAULT_REC_HANG),
     autoSpan(true),
     rx_freq(144000000)
 {
@@ -63,6 +68,8 @@ DockAudio::DockAudio(QWidget *parent) :
     connect(audioOptions, SIGNAL(newUdpHost(QString)), this, SLOT(setNewUdpHost(QString)));
     connect(audioOptions, SIGNAL(newUdpPort(int)), this, SLOT(setNewUdpPort(int)));
     connect(audioOptions, SIGNAL(newUdpStereo(bool)), this, SLOT(setNewUdpStereo(bool)));
+    connect(audioOptions, SIGNAL(newUdpFormat(int)), this, SLOT(setNewUdpFormat(int)));
+    connect(audioOptions, SIGNAL(newRecSql(bool,int,int)), this, SLOT(setNewRecSql(bool,int,int)));
 
     ui->audioSpectrum->setFreqUnits(1000);
     ui->audioSpectrum->setSampleRate(48000);  // Full bandwidth
@@ -190,7 +197,7 @@ void DockAudio::on_audioGainSlider_valueChanged(int value)
 void DockAudio::on_audioStreamButton_clicked(bool checked)
 {
     if (checked)
-        emit audioStreamingStarted(udp_host, udp_port, udp_stereo);
+        emit audioStreamingStarted(udp_host, udp_port, udp_stereo, udp_format);
     else
         emit audioStreamingStopped();
 }
@@ -203,7 +210,13 @@ void DockAudio::on_audioStreamButton_clicked(bool checked)
  */
 void DockAudio::on_audioRecButton_clicked(bool checked)
 {
-    if (checked) {
+    if (checked && rec_sql) {
+        emit audioSqlRecStarted(rec_dir, rec_preroll, rec_hang);
+
+        ui->audioRecButton->setToolTip(tr("Stop audio recorder"));
+        ui->audioPlayButton->setEnabled(false); /* prevent playback while recording */
+    }
+    else if (checked) {
         // FIXME: option to use local time
         // use toUTC() function compatible with older versions of Qt.
         QString file_name = QDateTime::currentDateTime().toUTC().toString("gqrx_yyyyMMdd_hhmmss");
@@ -311,6 +324,13 @@ void DockAudio::setAudioPlayButtonState(bool checked)
     //ui->audioRecConfButton->setEnabled(!isChecked);
 }
 
+/*! \brief Set status of audio stream button. */
+void DockAudio::setAudioStreamButtonState(bool checked)
+{
+    if (checked != ui->audioStreamButton->isChecked())
+        ui->audioStreamButton->toggle();
+}
+
 void DockAudio::saveSettings(QSettings *settings)
 {
     int     ival, fft_min, fft_max;
@@ -353,6 +373,21 @@ void DockAudio::saveSettings(QSettings *settings)
     else
         settings->remove("rec_dir");
 
+    if (rec_sql)
+        settings->setValue("rec_squelch", true);
+    else
+        settings->remove("rec_squelch");
+
+    if (rec_preroll != DEFAULT_REC_PREROLL)
+        settings->setValue("rec_preroll", rec_preroll);
+    else
+        settings->remove("rec_preroll");
+
+    if (rec_hang != DEFAULT_REC_HANG)
+        settings->setValue("rec_hang", rec_hang);
+    else
+        settings->remove("rec_hang");
+
     if (udp_host.isEmpty())
         settings->remove("udp_host");
     else
@@ -368,6 +403,11 @@ void DockAudio::saveSettings(QSettings *settings)
     else
         settings->remove("udp_stereo");
 
+    if (udp_format != 0)
+        settings->setValue("udp_format", udp_format);
+    else
+        settings->remove("udp_format");
+
     settings->endGroup();
 }
 
@@ -409,16 +449,30 @@ void DockAudio::readSettings(QSettings *settings)
     rec_dir = settings->value("rec_dir", QDir::homePath()).toString();
     audioOptions->setRecDir(rec_dir);
 
+    // Squelch triggered recording
+    rec_sql = settings->value("rec_squelch", false).toBool();
+    rec_preroll = settings->value("rec_preroll", DEFAULT_REC_PREROLL).toInt(&conv_ok);
+    if (!conv_ok || rec_preroll < 0)
+        rec_preroll = DEFAULT_REC_PREROLL;
+    rec_hang = settings->value("rec_hang", DEFAULT_REC_HANG).toInt(&conv_ok);
+    if (!conv_ok || rec_hang < 0)
+        rec_hang = DEFAULT_REC_HANG;
+    audioOptions->setRecSql(rec_sql, rec_preroll, rec_hang);
+
     // Audio streaming host, port and stereo setting
     udp_host = settings->value("udp_host", "localhost").toString();
     udp_port = settings->value("udp_port", 7355).toInt(&conv_ok);
     if (!conv_ok)
         udp_port = 7355;
     udp_stereo = settings->value("udp_stereo", false).toBool();
+    udp_format = settings->value("udp_format", 0).toInt(&conv_ok);
+    if (!conv_ok)
+        udp_format = 0;
 
     audioOptions->setUdpHost(udp_host);
     audioOptions->setUdpPort(udp_port);
     audioOptions->setUdpStereo(udp_stereo);
+    audioOptions->setUdpFormat(udp_format);
 
     settings->endGroup();
 }
@@ -461,3 +515,20 @@ void DockAudio::setNewUdpStereo(bool enabled)
 {
     udp_stereo = enabled;
 }
+
+/*! \brief Slot called when the UDP stream format changes. */
+void DockAudio::setNewUdpFormat(int format)
+{
+    udp_format = format;
+}
+
+/*! \brief Slot called when the squelch triggered recording settings change.
+ *
+ * The new settings are used the next time the recorder is started.
+ */
+void DockAudio::setNewRecSql(bool enabled, int preroll_ms, int hang_ms)
+{
+    rec_sql = enabled;
+    rec_preroll = preroll_ms;
+    rec_hang = hang_ms;
+}
@@ -59,6 +59,7 @@ public:
 
     void setAudioRecButtonState(bool checked);
     void setAudioPlayButtonState(bool checked);
+    void setAudioStreamButtonState(bool checked);
 
     void setFftColor(QColor color);
     void setFftFill(bool enabled);
@@ -77,7 +78,7 @@ signals:
     void audioGainChanged(float gain);
 
     /*! \brief Audio streaming over UDP has started. */
-    void audioStreamingStarted(const QString host, int port, bool stereo);
+    void audioStreamingStarted(const QString host, int port, bool stereo, int format);
 
     /*! \brief Audio streaming stopped. */
     void audioStreamingStopped();
@@ -85,6 +86,9 @@ signals:
     /*! \brief Signal emitted when audio recording is started. */
     void audioRecStarted(const QString filename);
 
+    /*! \brief Signal emitted when squelch triggered recording is started. */
+    void audioSqlRecStarted(const QString dir, int preroll_ms, int hang_ms);
+
     /*! \brief Signal emitted when audio recording is stopped. */
     void audioRecStopped();
 
@@ -110,6 +114,8 @@ private slots:
     void setNewUdpHost(const QString &host);
     void setNewUdpPort(int port);
     void setNewUdpStereo(bool enabled);
+    void setNewUdpFormat(int format);
+    void setNewRecSql(bool enabled, int preroll_ms, int hang_ms);
 
 
 private:
@@ -117,10 +123,14 @@ private:
     CAudioOptions *audioOptions; /*! Audio options dialog. */
     QString        rec_dir;      /*! Location for audio recordings. */
     QString        last_audio;   /*! Last audio recording. */
+    bool           rec_sql;      /*! Squelch triggered recording. */
+    int            rec_preroll;  /*! Squelch triggered recording pre-roll in ms. */
+    int            rec_hang;     /*! Squelch triggered recording hang time in ms. */
 
     QString        udp_host;     /*! UDP client host name. */
     int            udp_port;     /*! UDP client port number. */
     bool           udp_stereo;   /*! Enable stereo streaming for UDP. */
+    int            udp_format;   /*! UDP stream format, see udp_sink_f::format. */
 
     bool           autoSpan;     /*! Whether to allow mode-dependent auto span. */
 
@@ -0,0 +1,153 @@
+/* -*- c++ -*- */
+/*
+ * Gqrx SDR: Software defined radio receiver powered by GNU Radio and Qt
+ *           http://gqrx.dk/
+ *
+ * Copyright 2020 Vadym Ostanin.
+ *
+ * Gqrx is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * Gqrx is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Gqrx; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#include <QDateTime>
+#include <QHeaderView>
+#include <QTableWidgetItem>
+#include "dockdspload.h"
+#include "ui_dockdspload.h"
+
+/* Number of blocks highlighted as top consumers. */
+#define NUM_TOP_BLOCKS  3
+
+/* Input buffer fill level above which a block is considered too slow. */
+#define BUFFER_FULL_LIMIT   0.9f
+
+DockDspLoad::DockDspLoad(QWidget *parent) :
+    QDockWidget(parent),
+    ui(new Ui::DockDspLoad)
+{
+    ui->setupUi(this);
+    ui->blockTable->horizontalHeader()->setSectionResizeMode(0, QHeaderView::Stretch);
+}
+
+DockDspLoad::~DockDspLoad()
+{
+    delete ui;
+}
+
+/*! \brief Show new flow graph statistics.
+ *  \param stats The block statistics sorted with the heaviest block first.
+ */
+void DockDspLoad::setBlockStats(const block_stats_list_t &stats)
+{
+    ui->blockTable->setRowCount(stats.size());
+
+    for (int row = 0; row < (int)stats.size(); row++)
+    {
+        const block_stats_t &st = stats[row];
+        QTableWidgetItem    *items[4];
+
+        items[0] = new QTableWidgetItem(QString::fromStdString(st.name));
+        if (st.load < 0.0)
+            items[1] = new QTableWidgetItem("-");
+        else
+            items[1] = new QTableWidgetItem(QString("%1 %").arg(100.0 * st.load, 0, 'f', 1));
+        if (st.rate >= 1.0e6)
+            items[2] = new QTableWidgetItem(QString("%1 M").arg(st.rate * 1.0e-6, 0, 'f', 2));
+        else if (st.rate >= 1.0e3)
+            items[2] = new QTableWidgetItem(QString("%1 k").arg(st.rate * 1.0e-3, 0, 'f', 1));
+        else
+            items[2] = new QTableWidgetItem(QString("%1").arg(st.rate, 0, 'f', 0));
+        items[3] = new QTableWidgetItem(QString("%1 %").arg(100.0 * st.buffer_full, 0, 'f', 0));
+
+        for (int col = 0; col < 4; col++)
+        {
+            if (col > 0)
+                items[col]->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+
+            if (st.buffer_full > BUFFER_FULL_LIMIT)
+            {
+                items[col]->setForeground(Qt::red);
+            }
+            if (row < NUM_TOP_BLOCKS && st.load > 0.0)
+            {
+                QFont font = items[col]->font();
+                font.setBold(true);
+                items[col]->setFont(font);
+            }
+            ui->blockTable->setItem(row, col, items[col]);
+        }
+    }
+}
+
+/*! \brief Show audio output statistics.
+ *  \param latency The audio output latency in seconds.
+ *  \param underruns The number of audio underruns.
+ *  \param drift The compensated clock drift in ppm.
+ */
+void DockDspLoad::setAudioStats(double latency, unsigned long underruns, double drift)
+{
+    ui->audioLabel->setText(QString("Audio: %1 ms, %2 underruns, drift %3 ppm")
+                            .arg(latency * 1.0e3, 0, 'f', 0)
+                            .arg(underruns)
+                            .arg(drift, 0, 'f', 1));
+}
+
+/*! \brief Show input statistics.
+ *  \param samples The number of samples received from the input device.
+ *  \param lost The number of samples lost.
+ *  \param gaps The number of gaps in the input stream.
+ *  \param last_gap The time of the last gap in seconds since the epoch.
+ */
+void DockDspLoad::setInputStats(quint64 samples, quint64 lost,
+                                unsigned long gaps, double last_gap)
+{
+    if (gaps == 0)
+    {
+        ui->inputLabel->setText(QString("Input: %1 Msamples, no gaps")
+                                .arg(samples * 1.0e-6, 0, 'f', 1));
+        ui->inputLabel->setStyleSheet("");
+        return;
+    }
+
+    ui->inputLabel->setText(QString("Input: %1 samples lost in %2 gaps, last %3")
+                            .arg(lost)
+                            .arg(gaps)
+                            .arg(QDateTime::fromMSecsSinceEpoch((qint64)(last_gap * 1.0e3))
+                                 .toString("HH:mm:ss")));
+    ui->inputLabel->setStyleSheet("QLabel { color: red; }");
+}
+
+/*! \brief Show flow graph restart statistics.
+ *  \param count The number of flow graph restarts.
+ *  \param last_ms The duration of the last restart in milliseconds.
+ */
+void DockDspLoad::setReconfStats(unsigned long count, double last_ms)
+{
+    if (count == 0)
+    {
+        ui->reconfLabel->setText("Restarts: none");
+        return;
+    }
+
+    ui->reconfLabel->setText(QString("Restarts: %1, last %2 ms")
+                             .arg(count)
+                             .arg(last_ms, 0, 'f', 0));
+}
+
+/*! \brief Clear the statistics, e.g. when the receiver is stopped. */
+void DockDspLoad::clearStats()
+{
+    ui->blockTable->setRowCount(0);
+    ui->audioLabel->setText("Audio: -");
+}
@@ -0,0 +1,60 @@
+/* -*- c++ -*- */
+/*
+ * Gqrx SDR: Software defined radio receiver powered by GNU Radio and Qt
+ *           http://gqrx.dk/
+ *
+ * Copyright 2020 Vadym Ostanin.
+ *
+ * Gqrx is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * Gqrx is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Gqrx; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifndef DOCKDSPLOAD_H
+#define DOCKDSPLOAD_H
+
+#include <QDockWidget>
+
+#include "applications/gqrx/block_stats.h"
+
+namespace Ui {
+    class DockDspLoad;
+}
+
+/*! \brief Dock widget showing the CPU load of the flow graph blocks.
+ *
+ * The blocks are shown heaviest first. The top consumers are highlighted
+ * and blocks with full input buffers, i.e. blocks that can not keep up
+ * with the sample rate, are marked in red.
+ */
+class DockDspLoad : public QDockWidget
+{
+    Q_OBJECT
+
+public:
+    explicit DockDspLoad(QWidget *parent = 0);
+    ~DockDspLoad();
+
+public slots:
+    void setBlockStats(const block_stats_list_t &stats);
+    void setAudioStats(double latency, unsigned long underruns, double drift);
+    void setInputStats(quint64 samples, quint64 lost, unsigned long gaps,
+                       double last_gap);
+    void setReconfStats(unsigned long count, double last_ms);
+    void clearStats();
+
+private:
+    Ui::DockDspLoad *ui;        /*! The Qt designer UI file. */
+};
+
+#endif // DOCKDSPLOAD_H
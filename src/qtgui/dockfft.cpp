@@ -59,6 +59,8 @@ DockFft::DockFft(QWidget *parent) :
     // buttons can be smaller than 50x32
     ui->peakDetectionButton->setMinimumSize(48, 24);
     ui->peakHoldButton->setMinimumSize(48, 24);
+    ui->zoomFftButton->setMinimumSize(48, 24);
+    ui->persistButton->setMinimumSize(48, 24);
     ui->lockButton->setMinimumSize(48, 24);
     ui->resetButton->setMinimumSize(48, 24);
     ui->centerButton->setMinimumSize(48, 24);
@@ -243,6 +245,16 @@ void DockFft::saveSettings(QSettings *settings)
     else
         settings->setValue("pandapter_fill", false);
 
+    if (ui->zoomFftButton->isChecked())
+        settings->setValue("zoom_fft", true);
+    else
+        settings->remove("zoom_fft");
+
+    if (ui->persistButton->isChecked())
+        settings->setValue("persistence", true);
+    else
+        settings->remove("persistence");
+
     // dB ranges
     intval = ui->pandRangeSlider->minimumValue();
     if (intval == DEFAULT_FFT_MIN_DB)
@@ -326,6 +338,12 @@ void DockFft::readSettings(QSettings *settings)
     bool_val = settings->value("pandapter_fill", true).toBool();
     ui->fillButton->setChecked(bool_val);
 
+    bool_val = settings->value("zoom_fft", false).toBool();
+    ui->zoomFftButton->setChecked(bool_val);
+
+    bool_val = settings->value("persistence", false).toBool();
+    ui->persistButton->setChecked(bool_val);
+
     // delete old dB settings from config
     if (settings->contains("reference_level"))
         settings->remove("reference_level");
@@ -510,6 +528,18 @@ void DockFft::on_fillButton_toggled(bool checked)
     emit fftFillToggled(checked);
 }
 
+/** Zoom FFT button toggled */
+void DockFft::on_zoomFftButton_toggled(bool checked)
+{
+    emit zoomFftToggled(checked);
+}
+
+/** Persistence button toggled */
+void DockFft::on_persistButton_toggled(bool checked)
+{
+    emit persistenceToggled(checked);
+}
+
 /** peakHold button toggled */
 void DockFft::on_peakHoldButton_toggled(bool checked)
 {
@@ -67,6 +67,8 @@ signals:
     void fftFillToggled(bool fill);                /*! Toggle filling area under FFT plot. */
     void fftPeakHoldToggled(bool enable);          /*! Toggle peak hold in FFT area. */
     void peakDetectionToggled(bool enabled);       /*! Enable peak detection in FFT plot */
+    void zoomFftToggled(bool enabled);             /*! Compute FFT only over the displayed span. */
+    void persistenceToggled(bool enabled);         /*! Toggle persistence display in FFT area. */
     void wfColormapChanged(const QString &cmap);
 
 public slots:
@@ -92,6 +94,8 @@ private slots:
     void on_fillButton_toggled(bool checked);
     void on_peakHoldButton_toggled(bool checked);
     void on_peakDetectionButton_toggled(bool checked);
+    void on_zoomFftButton_toggled(bool checked);
+    void on_persistButton_toggled(bool checked);
     void on_lockButton_toggled(bool checked);
     void on_cmapComboBox_currentIndexChanged(int index);
 
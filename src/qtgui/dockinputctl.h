@@ -36,23 +36,7 @@
 #include <QString>
 #include <QVariant>
 
-
-/*! \brief Structure describing a gain parameter with its range. */
-typedef struct
-{
-    std::string name;   /*!< The name of this gain stage. */
-    double      value;  /*!< Initial value. */
-    double      start;  /*!< The lower limit. */
-    double      stop;   /*!< The uppewr limit. */
-    double      step;   /*!< The resolution/step. */
-} gain_t;
-
-/*! \brief A vector with gain parameters.
- *
- * This data structure is used for transfering
- * information about available gain stages.
- */
-typedef std::vector<gain_t> gain_list_t;
+#include "applications/gqrx/gain_stage.h"
 
 
 namespace Ui {
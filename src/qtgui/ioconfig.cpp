@@ -111,6 +111,7 @@ CIoConfig::CIoConfig(QSettings * settings,
     int idx = decim2idx(settings->value("input/decimation", 0).toInt());
     ui->decimCombo->setCurrentIndex(idx);
     decimationChanged(idx);
+    ui->decimEngineCombo->setCurrentIndex(settings->value("input/decim_engine", 0).toInt());
 
     // Analog bandwidth
     ui->bwSpinBox->setValue(1.0e-6*settings->value("input/bandwidth", 0.0).toDouble());
@@ -188,17 +189,59 @@ CIoConfig::~CIoConfig()
     delete ui;
 }
 
+/**
+ * @brief Update the input device list with new discovery results.
+ * @param devices The devices, label -> device string.
+ *
+ * The device string in the edit box is kept, so this can be called while
+ * the user is editing the configuration.
+ */
+void CIoConfig::updateDeviceList(const QVariantMap &devices)
+{
+    QString devstr = ui->inDevEdit->text();
+    int     idx = -1;
+    int     i = 0;
+
+    ui->inDevCombo->blockSignals(true);
+    ui->inDevCombo->clear();
+    for (auto it = devices.constBegin(); it != devices.constEnd(); ++it, ++i)
+    {
+        ui->inDevCombo->addItem(it.key(), it.value());
+        if (!devstr.isEmpty() && it.value().toString() == devstr)
+            idx = i;
+    }
+    ui->inDevCombo->addItem(tr("Other..."), QVariant(""));
+    ui->inDevCombo->setCurrentIndex(idx < 0 ? i : idx);
+    ui->inDevCombo->blockSignals(false);
+
+    // first time config: select the first detected device
+    if (devstr.isEmpty() && !devices.isEmpty())
+    {
+        ui->inDevCombo->setCurrentIndex(0);
+        inputDeviceSelected(0);
+    }
+}
+
 /**
  * @brief get the list of devices
  */
 void CIoConfig::getDeviceList(std::map<QString, QVariant> &devList)
 {
-    QString         devstr;
-    QString         devlabel;
+    getAudioInputDevices(devList);
+    getOsmosdrDevices(devList);
+}
 
-    // automatic discovery of FCD does not work on Mac
-    // so we do it ourselves
+/**
+ * @brief Get the list of input devices that appear as sound cards.
+ *
+ * Automatic discovery of FCD does not work on Mac so we do it ourselves.
+ * On other platforms this function does nothing.
+ */
+void CIoConfig::getAudioInputDevices(std::map<QString, QVariant> &devList)
+{
 #if defined(GQRX_OS_MACX)
+    QString         devstr;
+
 #ifdef WITH_PORTAUDIO
     portaudio_device_list       devices;
     vector<portaudio_device>    inDevList = devices.get_input_devices();
@@ -232,10 +275,23 @@ void CIoConfig::getDeviceList(std::map<QString, QVariant> &devList)
             devList.insert(std::pair<QString, QVariant>(QString("FUNcube Dongle V2_0"), QVariant(devstr)));
         }
     }
+#else
+    (void) devList;
 #endif
+}
+
+/**
+ * @brief Get the list of input devices discovered by gr-osmosdr.
+ *
+ * The devices are stored in the device list together with the device
+ * descriptor strings. This probes every compiled-in driver and may take
+ * several seconds.
+ */
+void CIoConfig::getOsmosdrDevices(std::map<QString, QVariant> &devList)
+{
+    QString         devstr;
+    QString         devlabel;
 
-    // Get list of input devices discovered by gr-osmosdr and store them in
-    // the device list together with the device descriptor strings
     osmosdr::devices_t devs = osmosdr::device::find();
 
     qDebug() << __FUNCTION__ << ": Available input devices:";
@@ -313,6 +369,12 @@ void CIoConfig::saveConfig()
         m_settings->remove("input/decimation");
     else
         m_settings->setValue("input/decimation", int_val);
+
+    idx = ui->decimEngineCombo->currentIndex();
+    if (idx > 0)
+        m_settings->setValue("input/decim_engine", idx);
+    else
+        m_settings->remove("input/decim_engine");
 }
 
 
@@ -631,12 +693,16 @@ void CIoConfig::updateDecimations(void)
 {
     bool        ok;
     int         rate;
+    int         idx;
 
     // get current sample rate from combo box
     rate= ui->inSrCombo->currentText().toInt(&ok);
     if (!ok || rate < 0)
         return;
 
+    // keep current selection if it is still valid
+    idx = ui->decimCombo->currentIndex();
+
     ui->decimCombo->clear();
     ui->decimCombo->addItem("None", 0);
     if (rate >= 96000)
@@ -653,12 +719,15 @@ void CIoConfig::updateDecimations(void)
         ui->decimCombo->addItem("64", 0);
     if (rate >= 6144000)
         ui->decimCombo->addItem("128", 0);
-//    if (rate >= 12288000)
-//        ui->decimCombo->addItem("256", 0);
-//    if (rate >= 24576000)
-//        ui->decimCombo->addItem("512", 0);
+    if (rate >= 12288000)
+        ui->decimCombo->addItem("256", 0);
+    if (rate >= 24576000)
+        ui->decimCombo->addItem("512", 0);
 
-    decimationChanged(0);
+    if (idx < 0 || idx >= ui->decimCombo->count())
+        idx = 0;
+    ui->decimCombo->setCurrentIndex(idx);
+    decimationChanged(idx);
 }
 
 /**
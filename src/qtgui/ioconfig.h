@@ -26,6 +26,7 @@
 #include <QDialog>
 #include <QSettings>
 #include <QString>
+#include <QVariantMap>
 
 #ifdef WITH_PULSEAUDIO
 #include "pulseaudio/pa_device_list.h"
@@ -49,6 +50,11 @@ public:
     explicit CIoConfig(QSettings *settings, std::map<QString, QVariant> &devList, QWidget *parent = 0);
     virtual ~CIoConfig();
     static void getDeviceList(std::map<QString, QVariant> &devList);
+    static void getAudioInputDevices(std::map<QString, QVariant> &devList);
+    static void getOsmosdrDevices(std::map<QString, QVariant> &devList);
+
+public slots:
+    void updateDeviceList(const QVariantMap &devices);
 
 private slots:
     void saveConfig();
@@ -109,7 +109,8 @@ static inline quint64 time_ms(void)
 #define STATUS_TIP \
     "Click, drag or scroll on spectrum to tune. " \
     "Drag and scroll X and Y axes for pan and zoom. " \
-    "Drag filter edges to adjust filter."
+    "Drag filter edges to adjust filter. " \
+    "Alt+scroll on waterfall for history."
 
 CPlotter::CPlotter(QWidget *parent) : QFrame(parent)
 {
@@ -150,6 +151,8 @@ CPlotter::CPlotter(QWidget *parent) : QFrame(parent)
 
     m_Span = 96000;
     m_SampleFreq = 96000;
+    m_FftDataCenter = 0;
+    m_FftDataRate = 0.f;
 
     m_HorDivs = 12;
     m_VerDivs = 6;
@@ -160,7 +163,12 @@ CPlotter::CPlotter(QWidget *parent) : QFrame(parent)
     m_CursorCaptured = NOCAP;
     m_Running = false;
     m_DrawOverlay = true;
-    m_2DPixmap = QPixmap(0,0);
+    m_OverlayChanged = true;
+    for (int i = 0; i < MAX_SCREENSIZE; i++)
+    {
+        m_DirtyTop[i] = 0;
+        m_DirtyBottom[i] = -1;
+    }
     m_OverlayPixmap = QPixmap(0,0);
     m_WaterfallPixmap = QPixmap(0,0);
     m_Size = QSize(0,0);
@@ -175,6 +183,19 @@ CPlotter::CPlotter(QWidget *parent) : QFrame(parent)
     setPeakDetection(false, 2);
     m_PeakHoldValid = false;
 
+    // sqrt compresses the density so that rare hits remain visible
+    m_Persistence = false;
+    for (int i = 0; i < PERSIST_LUT_SIZE; i++)
+        m_PersistLut[i] = (quint8)(255.f * sqrtf((float)i / (PERSIST_LUT_SIZE - 1)));
+    m_PersistFreq = 0;
+    m_PersistSpan = 0;
+    m_PersistMindB = 0.f;
+    m_PersistMaxdB = 0.f;
+
+    memset(m_HistoryRow, 0, WF_HISTORY_WIDTH);
+    m_HistoryLevel = 0;
+    m_HistoryTime = 0;
+
     setFftPlotColor(QColor(0xFF,0xFF,0xFF,0xFF));
     setFftFill(false);
 
@@ -595,6 +616,51 @@ bool CPlotter::saveWaterfall(const QString & filename) const
     return pixmap.save(filename, 0, -1);
 }
 
+/**
+ * Open the waterfall history.
+ * @param filename The history file.
+ * @param max_bytes The size of the history file, 0 to disable the history.
+ * @returns true if the history is enabled.
+ */
+bool CPlotter::openWaterfallHistory(const QString &filename, qint64 max_bytes)
+{
+    m_HistoryLevel = 0;
+    m_HistoryTime = 0;
+    memset(m_HistoryRow, 0, WF_HISTORY_WIDTH);
+
+    if (max_bytes <= 0)
+    {
+        m_WfHistory.close();
+        return false;
+    }
+
+    return m_WfHistory.open(filename, max_bytes);
+}
+
+/**
+ * Save a time range of the waterfall history to a graphics file.
+ * @param filename The file name, the format is taken from the extension.
+ * @param from_ms Start of the range in ms since the epoch.
+ * @param to_ms End of the range in ms since the epoch.
+ * @returns true if the file has been saved.
+ */
+bool CPlotter::saveWaterfallHistory(const QString &filename, qint64 from_ms,
+                                    qint64 to_ms) const
+{
+    QImage image = m_WfHistory.exportImage(from_ms, to_ms, m_ColorTbl);
+
+    if (image.isNull())
+        return false;
+
+    return image.save(filename);
+}
+
+/** Time of the oldest line in the waterfall history, 0 if there is none. */
+qint64 CPlotter::waterfallHistoryStart() const
+{
+    return m_WfHistory.oldestTime(WF_HISTORY_LEVELS - 1);
+}
+
 /** Get waterfall time resolution in milleconds / line. */
 quint64 CPlotter::getWfTimeRes(void)
 {
@@ -804,6 +870,15 @@ void CPlotter::wheelEvent(QWheelEvent * event)
     {
         zoomStepX(event->delta() < 0 ? 1.1 : 0.9, pt.x());
     }
+    else if ((event->modifiers() & Qt::AltModifier) && m_WfHistory.isOpen() &&
+             pt.y() >= m_OverlayPixmap.height())
+    {
+        // waterfall history, with shift change the time scale
+        if (event->modifiers() & Qt::ShiftModifier)
+            zoomHistory(event->delta() < 0 ? 1 : -1);
+        else
+            scrollHistory(event->delta() < 0 ? 1 : -1);
+    }
     else if (event->modifiers() & Qt::ControlModifier)
     {
         // filter width
@@ -847,8 +922,8 @@ void CPlotter::resizeEvent(QResizeEvent* )
         fft_plot_height = m_Percent2DScreen * m_Size.height() / 100;
         m_OverlayPixmap = QPixmap(m_Size.width(), fft_plot_height);
         m_OverlayPixmap.fill(Qt::black);
-        m_2DPixmap = QPixmap(m_Size.width(), fft_plot_height);
-        m_2DPixmap.fill(Qt::black);
+        m_2DImage = QImage(m_Size.width(), fft_plot_height, QImage::Format_RGB32);
+        m_2DImage.fill(Qt::black);
 
         int height = m_Size.height() - fft_plot_height;
         if (m_WaterfallPixmap.isNull())
@@ -879,9 +954,29 @@ void CPlotter::paintEvent(QPaintEvent *)
 {
     QPainter painter(this);
 
-    painter.drawPixmap(0, 0, m_2DPixmap);
-    painter.drawPixmap(0, m_Percent2DScreen * m_Size.height() / 100,
-                       m_WaterfallPixmap);
+    int     wf_y = m_Percent2DScreen * m_Size.height() / 100;
+
+    painter.drawImage(0, 0, m_2DImage);
+
+    if (m_HistoryTime > 0 && !m_HistoryImage.isNull())
+    {
+        QFontMetrics    metrics(m_Font);
+        QDateTime       tt;
+
+        // scrolled back in the waterfall history
+        painter.drawImage(0, wf_y, m_HistoryImage);
+        tt.setMSecsSinceEpoch(m_HistoryTime);
+        painter.setFont(m_Font);
+        painter.setPen(QColor(PLOTTER_TEXT_COLOR));
+        painter.drawText(5, wf_y + metrics.ascent() + 5,
+                         tr("History %1, time scale 1:%2")
+                         .arg(tt.toString("yyyy.MM.dd hh:mm:ss"))
+                         .arg(1 << m_HistoryLevel));
+    }
+    else
+    {
+        painter.drawPixmap(0, wf_y, m_WaterfallPixmap);
+    }
 }
 
 // Called to update spectrum data for displaying on the screen
@@ -898,8 +993,6 @@ void CPlotter::draw()
         m_DrawOverlay = false;
     }
 
-    QPoint LineBuf[MAX_SCREENSIZE];
-
     if (!m_Running)
         return;
 
@@ -920,6 +1013,21 @@ void CPlotter::draw()
                                 m_wfData, m_fftbuf,
                                 &xmin, &xmax);
 
+        // the history gets its own full resolution line
+        if (m_WfHistory.isOpen())
+        {
+            int     hxmin, hxmax;
+
+            getScreenIntegerFFTData(255, WF_HISTORY_WIDTH, m_WfMaxdB, m_WfMindB,
+                                    m_FftCenter - (qint64)m_Span / 2,
+                                    m_FftCenter + (qint64)m_Span / 2,
+                                    m_wfData, m_HistoryFftBuf,
+                                    &hxmin, &hxmax);
+            for (i = hxmin; i < hxmax; i++)
+                m_HistoryRow[i] = qMax(m_HistoryRow[i],
+                                       (quint8)(255 - m_HistoryFftBuf[i]));
+        }
+
         if (msec_per_wfline > 0)
         {
             // not in "auto" mode, so accumulate waterfall data
@@ -969,50 +1077,62 @@ void CPlotter::draw()
                     painter1.drawPoint(i, 0);
                 }
             }
+
+            if (m_WfHistory.isOpen())
+            {
+                m_WfHistory.addRow(tnow_ms,
+                                   m_CenterFreq + m_FftCenter - m_Span / 2,
+                                   m_CenterFreq + m_FftCenter + m_Span / 2,
+                                   m_HistoryRow);
+                memset(m_HistoryRow, 0, WF_HISTORY_WIDTH);
+            }
         }
     }
 
     // get/draw the 2D spectrum
-    w = m_2DPixmap.width();
-    h = m_2DPixmap.height();
+    w = m_2DImage.width();
+    h = m_2DImage.height();
 
     if (w != 0 && h != 0)
     {
-        // first copy into 2Dbitmap the overlay bitmap.
-        m_2DPixmap = m_OverlayPixmap.copy(0,0,w,h);
-
-        QPainter painter2(&m_2DPixmap);
-
-// workaround for "fixed" line drawing since Qt 5
-// see http://stackoverflow.com/questions/16990326
-#if QT_VERSION >= 0x050000
-        painter2.translate(0.5, 0.5);
-#endif
+        // put back the overlay where the previous frame was drawn
+        restoreOverlay();
 
         // get new scaled fft data
-        getScreenIntegerFFTData(h, qMin(w, MAX_SCREENSIZE),
-                                m_PandMaxdB, m_PandMindB,
+        n = qMin(w, MAX_SCREENSIZE);
+        getScreenIntegerFFTData(h, n, m_PandMaxdB, m_PandMindB,
                                 m_FftCenter - (qint64)m_Span/2,
                                 m_FftCenter + (qint64)m_Span/2,
                                 m_fftData, m_fftbuf,
-                                &xmin, &xmax);
+                                &xmin, &xmax, m_fftMinBuf);
 
-        // draw the pandapter
-        QBrush fillBrush = QBrush(m_FftFillCol);
-        n = xmax - xmin;
-        for (i = 0; i < n; i++)
+        if (m_Persistence)
         {
-            LineBuf[i].setX(i + xmin);
-            LineBuf[i].setY(m_fftbuf[i + xmin]);
-            if (m_FftFill)
-                painter2.fillRect(i + xmin, m_fftbuf[i + xmin], 1, h, fillBrush);
+            // start over when the display no longer matches the histogram
+            qint64 freq = m_CenterFreq + m_FftCenter;
+            if (freq != m_PersistFreq || m_Span != m_PersistSpan ||
+                m_PandMindB != m_PersistMindB || m_PandMaxdB != m_PersistMaxdB)
+            {
+                m_PersistFreq = freq;
+                m_PersistSpan = m_Span;
+                m_PersistMindB = m_PandMindB;
+                m_PersistMaxdB = m_PandMaxdB;
+                m_PersistHist.clear();
+            }
+            m_PersistHist.resize(n, h);
+            m_PersistHist.set_decay(expf(-1.f / (qMax(fft_rate, 1) * PERSIST_TIME_S)));
+            m_PersistHist.add_frame(m_fftbuf, m_fftMinBuf, xmin, xmax);
+            drawPersistence();
         }
 
-        painter2.setPen(m_FftColor);
-        painter2.drawPolyline(LineBuf, n);
+        // draw the pandapter
+        if (m_FftFill)
+            fillBelow(m_fftbuf, xmin, xmax, m_FftFillCol);
+        drawEnvelope(m_fftbuf, m_fftMinBuf, xmin, xmax, m_FftColor);
 
         // Peak detection
-        if (m_PeakDetection > 0)
+        n = xmax - xmin;
+        if (m_PeakDetection > 0 && n > 0)
         {
             m_Peaks.clear();
 
@@ -1040,32 +1160,50 @@ void CPlotter::draw()
                         (i - lastPeak > PEAK_H_TOLERANCE || i == n-1))
                 {
                     m_Peaks.insert(lastPeak + xmin, m_fftbuf[lastPeak + xmin]);
-                    painter2.drawEllipse(lastPeak + xmin - 5,
-                                         m_fftbuf[lastPeak + xmin] - 5, 10, 10);
                     lastPeak = -1;
                 }
             }
+
+            if (!m_Peaks.isEmpty())
+            {
+                QPainter painter2(&m_2DImage);
+
+// workaround for "fixed" line drawing since Qt 5
+// see http://stackoverflow.com/questions/16990326
+#if QT_VERSION >= 0x050000
+                painter2.translate(0.5, 0.5);
+#endif
+                painter2.setPen(m_FftColor);
+
+                QMapIterator<int,int> peak(m_Peaks);
+                while (peak.hasNext())
+                {
+                    peak.next();
+                    painter2.drawEllipse(peak.key() - 5, peak.value() - 5, 10, 10);
+
+                    int x0 = qMax(peak.key() - 5, 0);
+                    int x1 = qMin(peak.key() + 6, qMin(w, MAX_SCREENSIZE) - 1);
+                    for (i = x0; i <= x1; i++)
+                        markDirty(i, qMax(peak.value() - 5, 0),
+                                  qMin(peak.value() + 6, h - 1));
+                }
+                painter2.end();
+            }
         }
 
         // Peak hold
         if (m_PeakHoldActive)
         {
-            for (i = 0; i < n; i++)
+            for (i = xmin; i < xmax; i++)
             {
                 if(!m_PeakHoldValid || m_fftbuf[i] < m_fftPeakHoldBuf[i])
                     m_fftPeakHoldBuf[i] = m_fftbuf[i];
-
-                LineBuf[i].setX(i + xmin);
-                LineBuf[i].setY(m_fftPeakHoldBuf[i + xmin]);
             }
-            painter2.setPen(m_PeakHoldColor);
-            painter2.drawPolyline(LineBuf, n);
+            drawEnvelope(m_fftPeakHoldBuf, m_fftPeakHoldBuf, xmin, xmax,
+                         m_PeakHoldColor);
 
             m_PeakHoldValid = true;
         }
-
-      painter2.end();
-
     }
 
     // trigger a new paintEvent
@@ -1120,7 +1258,8 @@ void CPlotter::getScreenIntegerFFTData(qint32 plotHeight, qint32 plotWidth,
                                        float maxdB, float mindB,
                                        qint64 startFreq, qint64 stopFreq,
                                        float *inBuf, qint32 *outBuf,
-                                       int *xmin, int *xmax)
+                                       int *xmin, int *xmax,
+                                       qint32 *outMinBuf)
 {
     qint32 i;
     qint32 y;
@@ -1132,12 +1271,18 @@ void CPlotter::getScreenIntegerFFTData(qint32 plotHeight, qint32 plotWidth,
     qint32 m_FFTSize = m_fftDataSize;
     float *m_pFFTAveBuf = inBuf;
     float  dBGainFactor = ((float)plotHeight) / fabs(maxdB - mindB);
-    qint32* m_pTranslateTbl = new qint32[qMax(m_FFTSize, plotWidth)];
+    qint32 ymin = -1;
+
+    // reused between frames to avoid an allocation per call
+    if ((int)m_TranslateTbl.size() < qMax(m_FFTSize, plotWidth))
+        m_TranslateTbl.resize(qMax(m_FFTSize, plotWidth));
+    qint32* m_pTranslateTbl = m_TranslateTbl.data();
+    float  dataRate = m_FftDataRate > 0.f ? m_FftDataRate : m_SampleFreq;
 
     /** FIXME: qint64 -> qint32 **/
-    m_BinMin = (qint32)((float)startFreq * (float)m_FFTSize / m_SampleFreq);
+    m_BinMin = (qint32)((float)(startFreq - m_FftDataCenter) * (float)m_FFTSize / dataRate);
     m_BinMin += (m_FFTSize/2);
-    m_BinMax = (qint32)((float)stopFreq * (float)m_FFTSize / m_SampleFreq);
+    m_BinMax = (qint32)((float)(stopFreq - m_FftDataCenter) * (float)m_FFTSize / dataRate);
     m_BinMax += (m_FFTSize/2);
 
     minbin = m_BinMin < 0 ? 0 : m_BinMin;
@@ -1186,13 +1331,21 @@ void CPlotter::getScreenIntegerFFTData(qint32 plotHeight, qint32 plotWidth,
                     outBuf[x] = y;
                     ymax = y;
                 }
-
+                if (y > ymin) // and the min value for the envelope
+                {
+                    ymin = y;
+                    if (outMinBuf)
+                        outMinBuf[x] = y;
+                }
             }
             else
             {
                 outBuf[x] = y;
+                if (outMinBuf)
+                    outMinBuf[x] = y;
                 xprev = x;
                 ymax = y;
+                ymin = y;
             }
         }
     }
@@ -1213,10 +1366,10 @@ void CPlotter::getScreenIntegerFFTData(qint32 plotHeight, qint32 plotWidth,
                 y = 0;
 
             outBuf[x] = y;
+            if (outMinBuf)
+                outMinBuf[x] = y;
         }
     }
-
-    delete [] m_pTranslateTbl;
 }
 
 void CPlotter::setFftRange(float min, float max)
@@ -1439,17 +1592,331 @@ void CPlotter::drawOverlay()
         painter.drawLine(m_DemodFreqX, 0, m_DemodFreqX, h);
     }
 
+    painter.end();
+
+    // keep a raster copy to restore the pandapter from between overlay changes
+    m_OverlayImage = m_OverlayPixmap.toImage().convertToFormat(QImage::Format_RGB32);
+    m_OverlayChanged = true;
+
+    // frequency range may have changed
+    drawHistory();
+
     if (!m_Running)
     {
         // if not running so is no data updates to draw to screen
         // copy into 2Dbitmap the overlay bitmap.
-        m_2DPixmap = m_OverlayPixmap.copy(0,0,w,h);
+        restoreOverlay();
 
         // trigger a new paintEvent
         update();
     }
+}
 
-    painter.end();
+/**
+ * Restore the overlay in the pandapter frame buffer.
+ *
+ * Only the pixels drawn on top of the overlay since the last call are
+ * copied, unless the overlay has changed or most of the frame is dirty
+ * anyway (e.g. FFT fill), in which case the whole overlay is copied.
+ */
+void CPlotter::restoreOverlay()
+{
+    int     w = m_2DImage.width();
+    int     h = m_2DImage.height();
+    int     x, y;
+
+    if (m_OverlayImage.size() != m_2DImage.size())
+        return;
+
+    w = qMin(w, MAX_SCREENSIZE);
+
+    if (!m_OverlayChanged)
+    {
+        qint64  dirty = 0;
+
+        for (x = 0; x < w; x++)
+            if (m_DirtyBottom[x] >= m_DirtyTop[x])
+                dirty += m_DirtyBottom[x] - m_DirtyTop[x] + 1;
+
+        m_OverlayChanged = dirty > (qint64)w * h / 2;
+    }
+
+    if (m_OverlayChanged)
+    {
+        for (y = 0; y < h; y++)
+            memcpy(m_2DImage.scanLine(y), m_OverlayImage.constScanLine(y),
+                   m_2DImage.width() * sizeof(QRgb));
+        m_OverlayChanged = false;
+    }
+    else
+    {
+        QRgb       *dst = (QRgb *)m_2DImage.bits();
+        const QRgb *src = (const QRgb *)m_OverlayImage.constBits();
+        int         dst_stride = m_2DImage.bytesPerLine() / sizeof(QRgb);
+        int         src_stride = m_OverlayImage.bytesPerLine() / sizeof(QRgb);
+
+        for (x = 0; x < w; x++)
+            for (y = qMax(m_DirtyTop[x], 0); y <= qMin(m_DirtyBottom[x], h - 1); y++)
+                dst[y * dst_stride + x] = src[y * src_stride + x];
+    }
+
+    for (x = 0; x < w; x++)
+    {
+        m_DirtyTop[x] = h;
+        m_DirtyBottom[x] = -1;
+    }
+}
+
+/**
+ * Draw the persistence histogram as a heat map using the waterfall colormap.
+ *
+ * Only the rows of each column which have been hit since the histogram
+ * was last rescaled are visited.
+ */
+void CPlotter::drawPersistence()
+{
+    QRgb       *bits = (QRgb *)m_2DImage.bits();
+    int         stride = m_2DImage.bytesPerLine() / sizeof(QRgb);
+    float       scale = m_PersistHist.density_scale() * (PERSIST_LUT_SIZE - 1);
+    QRgb        colors[256];
+    int         x, y, top, bottom, idx;
+
+    for (idx = 0; idx < 256; idx++)
+        colors[idx] = m_ColorTbl[idx].rgb();
+
+    for (x = 0; x < m_PersistHist.columns(); x++)
+    {
+        m_PersistHist.get_extent(x, top, bottom);
+        if (bottom < top)
+            continue;
+
+        const float *cells = m_PersistHist.column(x);
+        for (y = top; y <= bottom; y++)
+        {
+            idx = (int)(cells[y] * scale);
+            if (idx <= 0)
+                continue;
+            if (idx >= PERSIST_LUT_SIZE)
+                idx = PERSIST_LUT_SIZE - 1;
+            if (m_PersistLut[idx] > 0)
+                bits[y * stride + x] = colors[m_PersistLut[idx]];
+        }
+        markDirty(x, top, bottom);
+    }
+}
+
+/**
+ * Render the waterfall from the history when scrolled back.
+ *
+ * The lines are mapped onto the current frequency range of the display,
+ * so the history can be panned and zoomed in frequency too.
+ */
+void CPlotter::drawHistory()
+{
+    int             w = m_WaterfallPixmap.width();
+    int             h = m_WaterfallPixmap.height();
+    int             rw = m_WfHistory.width(m_HistoryLevel);
+    qint64          fstart = m_CenterFreq + m_FftCenter - m_Span / 2;
+    qint64          age, time_ms, start, stop;
+    qint64          last_start = 0, last_stop = 0;
+    const quint8   *data;
+    QRgb            colors[256];
+    int             x, y, c;
+
+    if (m_HistoryTime == 0 || w == 0 || h == 0)
+        return;
+
+    if (m_HistoryImage.size() != m_WaterfallPixmap.size())
+        m_HistoryImage = QImage(w, h, QImage::Format_RGB32);
+
+    for (c = 0; c < 256; c++)
+        colors[c] = m_ColorTbl[c].rgb();
+
+    age = m_WfHistory.findRow(m_HistoryLevel, m_HistoryTime);
+    if (age < 0)
+        age = m_WfHistory.rowCount(m_HistoryLevel) - 1;
+
+    QVector<int>    cols(w);
+    for (y = 0; y < h; y++)
+    {
+        QRgb   *line = (QRgb *)m_HistoryImage.scanLine(y);
+
+        if (!m_WfHistory.getRow(m_HistoryLevel, age + y, time_ms, start, stop,
+                                &data))
+        {
+            for (x = 0; x < w; x++)
+                line[x] = 0xFF000000;
+            continue;
+        }
+
+        // column of each pixel, only changes when the line was retuned
+        if (start != last_start || stop != last_stop)
+        {
+            for (x = 0; x < w; x++)
+            {
+                qint64 f = fstart + m_Span * x / w;
+                c = (stop > start) ? (int)((f - start) * rw / (stop - start)) : -1;
+                cols[x] = (c >= 0 && c < rw) ? c : -1;
+            }
+            last_start = start;
+            last_stop = stop;
+        }
+
+        for (x = 0; x < w; x++)
+            line[x] = cols[x] < 0 ? 0xFF000000 : colors[data[cols[x]]];
+    }
+}
+
+/**
+ * Scroll the waterfall history by a quarter of the waterfall height.
+ * @param dir 1 to go back in time, -1 to go forward.
+ */
+void CPlotter::scrollHistory(int dir)
+{
+    qint64          step = qMax(m_WaterfallPixmap.height() / 4, 1);
+    qint64          rows = m_WfHistory.rowCount(m_HistoryLevel);
+    qint64          age = 0;
+    qint64          time_ms, start, stop;
+    const quint8   *data;
+
+    if (rows == 0)
+        return;
+
+    if (m_HistoryTime > 0)
+    {
+        age = m_WfHistory.findRow(m_HistoryLevel, m_HistoryTime);
+        if (age < 0)
+            age = rows - 1;
+    }
+
+    age += dir * step;
+    if (age <= 0 && dir < 0 && m_HistoryLevel == 0)
+    {
+        // back to the live waterfall
+        m_HistoryTime = 0;
+        update();
+        return;
+    }
+
+    age = qBound((qint64)0, age, rows - 1);
+    if (!m_WfHistory.getRow(m_HistoryLevel, age, time_ms, start, stop, &data))
+        return;
+
+    m_HistoryTime = time_ms;
+    drawHistory();
+    update();
+}
+
+/**
+ * Change the time scale of the waterfall history.
+ * @param dir 1 to show a longer time span, -1 for a shorter one.
+ */
+void CPlotter::zoomHistory(int dir)
+{
+    qint64          time_ms, start, stop;
+    const quint8   *data;
+    int             level = qBound(0, m_HistoryLevel + dir, WF_HISTORY_LEVELS - 1);
+
+    if (m_HistoryTime == 0)
+    {
+        // start from the newest line
+        if (dir < 0 || !m_WfHistory.getRow(0, 0, time_ms, start, stop, &data))
+            return;
+        m_HistoryTime = time_ms;
+    }
+    else if (level == 0 && m_WfHistory.findRow(0, m_HistoryTime) <= 0)
+    {
+        // back to the live waterfall
+        m_HistoryLevel = 0;
+        m_HistoryTime = 0;
+        update();
+        return;
+    }
+
+    m_HistoryLevel = level;
+    drawHistory();
+    update();
+}
+
+/** Blend src over dst, alpha is 0...256. */
+static inline QRgb blendPixel(QRgb dst, QRgb src, quint32 alpha)
+{
+    quint32 rb = ((src & 0xff00ff) * alpha + (dst & 0xff00ff) * (256 - alpha)) >> 8;
+    quint32 g  = ((src & 0x00ff00) * alpha + (dst & 0x00ff00) * (256 - alpha)) >> 8;
+
+    return 0xff000000 | (rb & 0xff00ff) | (g & 0x00ff00);
+}
+
+/**
+ * Draw a trace as one vertical span per column.
+ * @param top The highest point of each column (smallest y).
+ * @param bottom The lowest point of each column (largest y).
+ *
+ * The span of each column is extended towards the previous column so that
+ * the trace is connected like a polyline, while a column covering many FFT
+ * bins shows the full min/max envelope of those bins.
+ */
+void CPlotter::drawEnvelope(const qint32 *top, const qint32 *bottom,
+                            int xmin, int xmax, const QColor &color)
+{
+    QRgb       *bits = (QRgb *)m_2DImage.bits();
+    int         stride = m_2DImage.bytesPerLine() / sizeof(QRgb);
+    int         h = m_2DImage.height();
+    QRgb        rgb = color.rgb();
+    quint32     alpha = color.alpha() + (color.alpha() >> 7);
+    int         x, y, y0, y1;
+
+    for (x = xmin; x < xmax; x++)
+    {
+        y0 = top[x];
+        y1 = bottom[x];
+        if (x > xmin)
+        {
+            y0 = qMin(y0, bottom[x - 1]);
+            y1 = qMax(y1, top[x - 1]);
+        }
+        y0 = qBound(0, y0, h - 1);
+        y1 = qBound(0, y1, h - 1);
+
+        if (alpha >= 256)
+            for (y = y0; y <= y1; y++)
+                bits[y * stride + x] = rgb;
+        else
+            for (y = y0; y <= y1; y++)
+                bits[y * stride + x] = blendPixel(bits[y * stride + x], rgb, alpha);
+
+        markDirty(x, y0, y1);
+    }
+}
+
+/** Fill the area below a trace down to the bottom of the pandapter. */
+void CPlotter::fillBelow(const qint32 *top, int xmin, int xmax, const QColor &color)
+{
+    QRgb       *bits = (QRgb *)m_2DImage.bits();
+    int         stride = m_2DImage.bytesPerLine() / sizeof(QRgb);
+    int         h = m_2DImage.height();
+    QRgb        rgb = color.rgb();
+    quint32     alpha = color.alpha() + (color.alpha() >> 7);
+    int         x, y, y0;
+
+    // row by row to stay within the cache
+    y0 = h;
+    for (x = xmin; x < xmax; x++)
+        y0 = qMin(y0, top[x]);
+    y0 = qMax(y0, 0);
+
+    for (y = y0; y < h; y++)
+    {
+        QRgb   *line = bits + y * stride;
+
+        for (x = xmin; x < xmax; x++)
+            if (y >= top[x])
+                line[x] = blendPixel(line[x], rgb, alpha);
+    }
+
+    for (x = xmin; x < xmax; x++)
+        if (top[x] < h)
+            markDirty(x, qMax(top[x], 0), h - 1);
 }
 
 // Create frequency division strings based on start frequency, span frequency,
@@ -1537,6 +2004,18 @@ quint64 CPlotter::msecFromY(int y)
 
     int dy = y - m_OverlayPixmap.height();
 
+    if (m_HistoryTime > 0)
+    {
+        qint64          age = m_WfHistory.findRow(m_HistoryLevel, m_HistoryTime);
+        qint64          time_ms, start, stop;
+        const quint8   *data;
+
+        if (age >= 0 && m_WfHistory.getRow(m_HistoryLevel, age + dy, time_ms,
+                                           start, stop, &data))
+            return time_ms;
+        return 0;
+    }
+
     if (msec_per_wfline > 0)
         return tlast_wf_ms - dy * msec_per_wfline;
     else
@@ -1645,6 +2124,13 @@ void CPlotter::setFftFill(bool enabled)
     m_FftFill = enabled;
 }
 
+/** Enable or disable the persistence (density) display. */
+void CPlotter::setPersistence(bool enabled)
+{
+    m_Persistence = enabled;
+    m_PersistHist.clear();
+}
+
 /** Set peak hold on or off. */
 void CPlotter::setPeakHold(bool enabled)
 {
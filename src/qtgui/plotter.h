@@ -9,6 +9,9 @@
 #include <vector>
 #include <QMap>
 
+#include "dsp/spectrum_persistence.h"
+#include "qtgui/waterfall_history.h"
+
 #define HORZ_DIVS_MAX 12    //50
 #define VERT_DIVS_MIN 5
 #define MAX_SCREENSIZE 16384
@@ -17,6 +20,9 @@
 #define PEAK_CLICK_MAX_V_DISTANCE 20 //Maximum vertical distance of clicked point from peak
 #define PEAK_H_TOLERANCE 2
 
+#define PERSIST_TIME_S   2.0     // time constant of the persistence display
+#define PERSIST_LUT_SIZE 1024    // density -> colormap index lookup table size
+
 
 class CPlotter : public QFrame
 {
@@ -113,12 +119,26 @@ public:
         m_FftCenter = qBound(-limit, f, limit);
     }
 
+    qint64 getFftCenterFreq(void) const { return m_FftCenter; }
+    qint64 getSpanFreq(void) const { return m_Span; }
+
+    /* Part of the spectrum covered by the FFT data, see setNewFftData(). */
+    void setFftDataRange(qint64 center, float rate)
+    {
+        m_FftDataCenter = center;
+        m_FftDataRate = rate;
+    }
+
     int     getNearestPeak(QPoint pt);
     void    setWaterfallSpan(quint64 span_ms);
     quint64 getWfTimeRes(void);
     void    setFftRate(int rate_hz);
     void    clearWaterfall(void);
     bool    saveWaterfall(const QString & filename) const;
+    bool    openWaterfallHistory(const QString &filename, qint64 max_bytes);
+    bool    saveWaterfallHistory(const QString &filename, qint64 from_ms,
+                                 qint64 to_ms) const;
+    qint64  waterfallHistoryStart() const;
 
 signals:
     void newCenterFreq(qint64 f);
@@ -146,6 +166,7 @@ public slots:
     void setPandapterRange(float min, float max);
     void setWaterfallRange(float min, float max);
     void setPeakDetection(bool enabled, float c);
+    void setPersistence(bool enabled);
     void updateOverlay();
 
     void setPercent2DScreen(int percent)
@@ -191,12 +212,30 @@ private:
                                  float maxdB, float mindB,
                                  qint64 startFreq, qint64 stopFreq,
                                  float *inBuf, qint32 *outBuf,
-                                 qint32 *maxbin, qint32 *minbin);
+                                 qint32 *maxbin, qint32 *minbin,
+                                 qint32 *outMinBuf = NULL);
+    void restoreOverlay();
+    void drawPersistence();
+    void drawHistory();
+    void scrollHistory(int dir);
+    void zoomHistory(int dir);
+    void drawEnvelope(const qint32 *top, const qint32 *bottom,
+                      int xmin, int xmax, const QColor &color);
+    void fillBelow(const qint32 *top, int xmin, int xmax, const QColor &color);
+    void markDirty(int x, int y0, int y1)
+    {
+        if (y0 < m_DirtyTop[x])
+            m_DirtyTop[x] = y0;
+        if (y1 > m_DirtyBottom[x])
+            m_DirtyBottom[x] = y1;
+    }
     void calcDivSize (qint64 low, qint64 high, int divswanted, qint64 &adjlow, qint64 &step, int& divs);
 
     bool        m_PeakHoldActive;
     bool        m_PeakHoldValid;
     qint32      m_fftbuf[MAX_SCREENSIZE];
+    qint32      m_fftMinBuf[MAX_SCREENSIZE]; // lowest point of each column (largest y)
+    std::vector<qint32> m_TranslateTbl;      // FFT bin <-> plot x, see getScreenIntegerFFTData()
     quint8      m_wfbuf[MAX_SCREENSIZE]; // used for accumulating waterfall data at high time spans
     qint32      m_fftPeakHoldBuf[MAX_SCREENSIZE];
     float      *m_fftData;     /*! pointer to incoming FFT data */
@@ -207,8 +246,12 @@ private:
     int         m_YAxisWidth;
 
     eCapturetype    m_CursorCaptured;
-    QPixmap     m_2DPixmap;
+    QImage      m_2DImage;          /*!< Pandapter frame buffer, persistent between frames. */
     QPixmap     m_OverlayPixmap;
+    QImage      m_OverlayImage;     /*!< Raster copy of the overlay used to restore m_2DImage. */
+    bool        m_OverlayChanged;   /*!< m_OverlayImage must be copied in full. */
+    qint32      m_DirtyTop[MAX_SCREENSIZE];     /*!< First row drawn over the overlay in each column. */
+    qint32      m_DirtyBottom[MAX_SCREENSIZE];  /*!< Last row drawn over the overlay in each column. */
     QPixmap     m_WaterfallPixmap;
     QColor      m_ColorTbl[256];
     QSize       m_Size;
@@ -250,6 +293,8 @@ private:
 
     qint64      m_Span;
     float       m_SampleFreq;    /*!< Sample rate. */
+    qint64      m_FftDataCenter; /*!< Center of the FFT data relative to m_CenterFreq. */
+    float       m_FftDataRate;   /*!< Bandwidth of the FFT data, 0 for m_SampleFreq. */
     qint32      m_FreqUnits;
     int         m_ClickResolution;
     int         m_FilterClickResolution;
@@ -268,6 +313,23 @@ private:
     bool        m_FftFill;
 
     float       m_PeakDetection;
+
+    // Persistence display
+    bool                    m_Persistence;
+    spectrum_persistence    m_PersistHist;
+    quint8                  m_PersistLut[PERSIST_LUT_SIZE]; /*!< sqrt(density) as colormap index. */
+    qint64                  m_PersistFreq;      /*!< Display settings the histogram was built for. */
+    qint64                  m_PersistSpan;
+    float                   m_PersistMindB;
+    float                   m_PersistMaxdB;
+
+    // Waterfall history
+    CWaterfallHistory   m_WfHistory;
+    quint8              m_HistoryRow[WF_HISTORY_WIDTH];     /*!< Line being accumulated for the history. */
+    qint32              m_HistoryFftBuf[WF_HISTORY_WIDTH];
+    int                 m_HistoryLevel;     /*!< Resolution level shown when scrolled back. */
+    qint64              m_HistoryTime;      /*!< Time of the top line when scrolled back, 0 for live. */
+    QImage              m_HistoryImage;     /*!< Waterfall rendered from the history. */
     QMap<int,int>   m_Peaks;
 
     QList< QPair<QRect, qint64> >     m_BookmarkTags;
@@ -0,0 +1,371 @@
+/* -*- c++ -*- */
+/*
+ * Gqrx SDR: Software defined radio receiver powered by GNU Radio and Qt
+ *           http://gqrx.dk/
+ *
+ * Copyright 2020 Vadym Ostanin.
+ *
+ * Gqrx is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * Gqrx is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Gqrx; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#include <QDateTime>
+#include <QDebug>
+#include <QVector>
+#include <string.h>
+
+#include "qtgui/waterfall_history.h"
+
+#define WF_HISTORY_MAGIC    "GQRXWFH1"
+
+// exports taller than this use the next level
+#define WF_EXPORT_MAX_ROWS  16384
+
+
+CWaterfallHistory::CWaterfallHistory()
+    : m_Base(0),
+      m_Header(0)
+{
+    for (int i = 0; i < WF_HISTORY_LEVELS; i++)
+    {
+        m_LevelOffset[i] = 0;
+        m_Pending[i] = false;
+    }
+}
+
+CWaterfallHistory::~CWaterfallHistory()
+{
+    close();
+}
+
+/**
+ * Open or create the history file.
+ * @param filename The ring file.
+ * @param max_bytes The size of the file, which sets the number of rows.
+ * @return true if the history is usable.
+ *
+ * An existing file is kept if it has the same layout and size, otherwise
+ * it is cleared.
+ */
+bool CWaterfallHistory::open(const QString &filename, qint64 max_bytes)
+{
+    qint64  row_bytes = 0;
+    qint64  capacity;
+    qint64  size;
+    bool    reuse;
+    int     i;
+
+    close();
+
+    for (i = 0; i < WF_HISTORY_LEVELS; i++)
+        row_bytes += rowSize(i);
+    capacity = (max_bytes - (qint64)sizeof(file_header)) / row_bytes;
+    if (capacity < 16)
+        return false;
+    size = sizeof(file_header) + capacity * row_bytes;
+
+    m_File.setFileName(filename);
+    if (!m_File.open(QIODevice::ReadWrite))
+    {
+        qWarning() << "Can not open waterfall history" << filename << ":"
+                   << m_File.errorString();
+        return false;
+    }
+
+    reuse = (m_File.size() == size);
+    if (!reuse && !m_File.resize(size))
+    {
+        qWarning() << "Can not resize waterfall history" << filename << ":"
+                   << m_File.errorString();
+        m_File.close();
+        return false;
+    }
+
+    m_Base = m_File.map(0, size);
+    if (!m_Base)
+    {
+        qWarning() << "Can not map waterfall history" << filename << ":"
+                   << m_File.errorString();
+        m_File.close();
+        return false;
+    }
+    m_Header = (file_header *)m_Base;
+
+    if (!reuse || memcmp(m_Header->magic, WF_HISTORY_MAGIC, 8) ||
+        m_Header->width != WF_HISTORY_WIDTH ||
+        m_Header->levels != WF_HISTORY_LEVELS ||
+        m_Header->capacity != (quint64)capacity)
+    {
+        memset(m_Header, 0, sizeof(file_header));
+        memcpy(m_Header->magic, WF_HISTORY_MAGIC, 8);
+        m_Header->width = WF_HISTORY_WIDTH;
+        m_Header->levels = WF_HISTORY_LEVELS;
+        m_Header->capacity = capacity;
+    }
+
+    m_LevelOffset[0] = sizeof(file_header);
+    for (i = 1; i < WF_HISTORY_LEVELS; i++)
+        m_LevelOffset[i] = m_LevelOffset[i - 1] + capacity * rowSize(i - 1);
+
+    for (i = 0; i < WF_HISTORY_LEVELS; i++)
+        m_Pending[i] = false;
+
+    return true;
+}
+
+void CWaterfallHistory::close()
+{
+    if (!m_Base)
+        return;
+
+    m_File.unmap(m_Base);
+    m_File.close();
+    m_Base = 0;
+    m_Header = 0;
+}
+
+/**
+ * Add a waterfall line.
+ * @param time_ms The time of the line in ms since the epoch.
+ * @param start_freq The frequency of the first column in Hz.
+ * @param stop_freq The frequency after the last column in Hz.
+ * @param data WF_HISTORY_WIDTH colormap indices.
+ */
+void CWaterfallHistory::addRow(qint64 time_ms, qint64 start_freq,
+                               qint64 stop_freq, const quint8 *data)
+{
+    row_header  hdr;
+
+    if (!isOpen())
+        return;
+
+    hdr.time_ms = time_ms;
+    hdr.start_freq = start_freq;
+    hdr.stop_freq = stop_freq;
+    hdr.reserved = 0;
+    writeRow(0, hdr, data);
+}
+
+/** Number of rows available at a level. */
+qint64 CWaterfallHistory::rowCount(int level) const
+{
+    if (!isOpen())
+        return 0;
+
+    return (qint64)qMin(m_Header->written[level], m_Header->capacity);
+}
+
+/**
+ * Get a row.
+ * @param level The resolution level.
+ * @param age The number of newer rows, 0 for the newest row.
+ * @param data Set to the width(level) colormap indices of the row.
+ * @return false if there is no such row.
+ */
+bool CWaterfallHistory::getRow(int level, qint64 age, qint64 &time_ms,
+                               qint64 &start_freq, qint64 &stop_freq,
+                               const quint8 **data) const
+{
+    if (age < 0 || age >= rowCount(level))
+        return false;
+
+    const uchar        *p = rowPtr(level, m_Header->written[level] - 1 - age);
+    const row_header   *hdr = (const row_header *)p;
+
+    time_ms = hdr->time_ms;
+    start_freq = hdr->start_freq;
+    stop_freq = hdr->stop_freq;
+    *data = p + sizeof(row_header);
+
+    return true;
+}
+
+/**
+ * Find the newest row which is not newer than a given time.
+ * @return The age of the row or -1 if all rows are newer.
+ */
+qint64 CWaterfallHistory::findRow(int level, qint64 time_ms) const
+{
+    qint64  lo = 0;
+    qint64  hi = rowCount(level);
+    qint64  mid;
+
+    // rows get older with increasing age
+    while (lo < hi)
+    {
+        mid = lo + (hi - lo) / 2;
+        const row_header *hdr = (const row_header *)
+                rowPtr(level, m_Header->written[level] - 1 - mid);
+        if (hdr->time_ms <= time_ms)
+            hi = mid;
+        else
+            lo = mid + 1;
+    }
+
+    return lo < rowCount(level) ? lo : -1;
+}
+
+/** Time of the oldest row at a level, 0 if the level is empty. */
+qint64 CWaterfallHistory::oldestTime(int level) const
+{
+    qint64          time_ms, start, stop;
+    const quint8   *data;
+
+    if (!getRow(level, rowCount(level) - 1, time_ms, start, stop, &data))
+        return 0;
+
+    return time_ms;
+}
+
+/**
+ * Export a time range as an image.
+ * @param from_ms Start of the range in ms since the epoch.
+ * @param to_ms End of the range in ms since the epoch.
+ * @param colors The 256 entry colormap.
+ * @return The image, newest row at the top, or a null image if there is
+ *         no history in the range.
+ *
+ * The finest level which still covers the start of the range is used.
+ * Rows with a different frequency range are mapped onto the frequency
+ * range of the newest row. The time and frequency range are stored as
+ * image text.
+ */
+QImage CWaterfallHistory::exportImage(qint64 from_ms, qint64 to_ms,
+                                      const QColor *colors) const
+{
+    QImage          image;
+    QVector<QRgb>   table(256);
+    qint64          newest = -1, oldest = -1;
+    qint64          t0, s0, e0, t, s, e;
+    const quint8   *data;
+    int             level, w, x, c;
+    qint64          y, rows;
+
+    if (!isOpen() || to_ms <= from_ms)
+        return image;
+
+    for (level = 0; level < WF_HISTORY_LEVELS; level++)
+    {
+        newest = findRow(level, to_ms);
+        oldest = findRow(level, from_ms);
+        if (newest < 0)
+            continue;
+        if (oldest < 0)
+            oldest = rowCount(level) - 1;   // range starts before the history
+        else if (oldest > newest &&
+                 getRow(level, oldest, t, s, e, &data) && t < from_ms)
+            oldest--;                       // keep rows inside the range
+        if (oldest - newest < WF_EXPORT_MAX_ROWS &&
+            (oldestTime(level) <= from_ms || level == WF_HISTORY_LEVELS - 1))
+            break;
+    }
+    if (level == WF_HISTORY_LEVELS)
+        level--;
+    if (newest < 0 || oldest < newest)
+        return image;
+
+    rows = qMin(oldest - newest + 1, (qint64)WF_EXPORT_MAX_ROWS);
+    w = width(level);
+
+    image = QImage(w, rows, QImage::Format_Indexed8);
+    for (c = 0; c < 256; c++)
+        table[c] = colors[c].rgb();
+    image.setColorTable(table);
+
+    getRow(level, newest, t0, s0, e0, &data);
+    for (y = 0; y < rows; y++)
+    {
+        uchar *line = image.scanLine(y);
+
+        if (!getRow(level, newest + y, t, s, e, &data))
+        {
+            memset(line, 0, w);
+            continue;
+        }
+        if (s == s0 && e == e0)
+        {
+            memcpy(line, data, w);
+            continue;
+        }
+        for (x = 0; x < w; x++)
+        {
+            qint64 f = s0 + (e0 - s0) * x / w;
+            c = (e > s) ? (int)((f - s) * w / (e - s)) : -1;
+            line[x] = (c >= 0 && c < w) ? data[c] : 0;
+        }
+    }
+
+    image.setText("Start time", QDateTime::fromMSecsSinceEpoch(t).toUTC()
+                  .toString(Qt::ISODate));
+    image.setText("Stop time", QDateTime::fromMSecsSinceEpoch(t0).toUTC()
+                  .toString(Qt::ISODate));
+    image.setText("Start frequency", QString::number(s0));
+    image.setText("Stop frequency", QString::number(e0));
+    image.setText("Resolution", QString("1/%1").arg(1 << level));
+
+    return image;
+}
+
+uchar *CWaterfallHistory::rowPtr(int level, quint64 index) const
+{
+    return m_Base + m_LevelOffset[level] +
+            (index % m_Header->capacity) * rowSize(level);
+}
+
+/** Write a row and combine it into the next level. */
+void CWaterfallHistory::writeRow(int level, const row_header &hdr,
+                                 const quint8 *data)
+{
+    uchar  *p = rowPtr(level, m_Header->written[level]);
+    int     next = level + 1;
+    int     nw, i;
+    quint8  v;
+
+    memcpy(p, &hdr, sizeof(row_header));
+    memcpy(p + sizeof(row_header), data, width(level));
+    m_Header->written[level]++;
+
+    if (next >= WF_HISTORY_LEVELS)
+        return;
+
+    // the frequency range changed; store the half finished row as it is
+    if (m_Pending[next] && (m_PendingHdr[next].start_freq != hdr.start_freq ||
+                            m_PendingHdr[next].stop_freq != hdr.stop_freq))
+    {
+        m_Pending[next] = false;
+        writeRow(next, m_PendingHdr[next], m_PendingData[next]);
+    }
+
+    // peak of two columns and two rows
+    nw = width(next);
+    for (i = 0; i < nw; i++)
+    {
+        v = qMax(data[2 * i], data[2 * i + 1]);
+        if (m_Pending[next])
+            v = qMax(v, m_PendingData[next][i]);
+        m_PendingData[next][i] = v;
+    }
+
+    if (!m_Pending[next])
+    {
+        m_PendingHdr[next] = hdr;
+        m_Pending[next] = true;
+    }
+    else
+    {
+        m_PendingHdr[next].time_ms = hdr.time_ms;
+        m_Pending[next] = false;
+        writeRow(next, m_PendingHdr[next], m_PendingData[next]);
+    }
+}
@@ -0,0 +1,109 @@
+/* -*- c++ -*- */
+/*
+ * Gqrx SDR: Software defined radio receiver powered by GNU Radio and Qt
+ *           http://gqrx.dk/
+ *
+ * Copyright 2020 Vadym Ostanin.
+ *
+ * Gqrx is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * Gqrx is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Gqrx; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifndef WATERFALL_HISTORY_H
+#define WATERFALL_HISTORY_H
+
+#include <QColor>
+#include <QFile>
+#include <QImage>
+#include <QString>
+#include <QtGlobal>
+
+#define WF_HISTORY_WIDTH    4096    // columns of a full resolution row
+#define WF_HISTORY_LEVELS   6       // level n has 2^n lower time and frequency resolution
+
+/*! \brief Waterfall history stored in a memory mapped ring file.
+ *
+ * Each waterfall line is stored as a row of 8 bit colormap indices together
+ * with its time stamp and frequency range. The file holds one ring of rows
+ * per level. Level 0 keeps the rows at full resolution. Every two rows of a
+ * level are combined into one row of the next level, which also has half
+ * the columns. All levels have the same number of rows, so each level
+ * covers twice the time of the previous one for half the memory, and the
+ * coarsest level covers 32 times the time span of level 0.
+ *
+ * The file size is fixed when the history is opened, so memory use is
+ * bounded regardless of how long gqrx runs. An existing file with the same
+ * layout is reused, which keeps the history between sessions.
+ */
+class CWaterfallHistory
+{
+public:
+    CWaterfallHistory();
+    ~CWaterfallHistory();
+
+    bool    open(const QString &filename, qint64 max_bytes);
+    void    close();
+    bool    isOpen() const { return m_Base != 0; }
+
+    void    addRow(qint64 time_ms, qint64 start_freq, qint64 stop_freq,
+                   const quint8 *data);
+
+    int     width(int level) const { return WF_HISTORY_WIDTH >> level; }
+    qint64  rowCount(int level) const;
+    bool    getRow(int level, qint64 age, qint64 &time_ms,
+                   qint64 &start_freq, qint64 &stop_freq,
+                   const quint8 **data) const;
+    qint64  findRow(int level, qint64 time_ms) const;
+    qint64  oldestTime(int level) const;
+
+    QImage  exportImage(qint64 from_ms, qint64 to_ms,
+                        const QColor *colors) const;
+
+private:
+    struct row_header
+    {
+        qint64  time_ms;
+        qint64  start_freq;
+        qint64  stop_freq;
+        qint64  reserved;
+    };
+
+    struct file_header
+    {
+        char    magic[8];
+        quint32 width;
+        quint32 levels;
+        quint64 capacity;                   /*! Rows per level. */
+        quint64 written[WF_HISTORY_LEVELS]; /*! Rows written to each level. */
+    };
+
+    qint64  rowSize(int level) const
+    {
+        return sizeof(row_header) + width(level);
+    }
+    uchar  *rowPtr(int level, quint64 index) const;
+    void    writeRow(int level, const row_header &hdr, const quint8 *data);
+
+    QFile           m_File;
+    uchar          *m_Base;         /*! Start of the mapped file. */
+    file_header    *m_Header;
+    qint64          m_LevelOffset[WF_HISTORY_LEVELS];
+
+    // rows waiting for a second row to be combined into the next level
+    bool            m_Pending[WF_HISTORY_LEVELS];
+    row_header      m_PendingHdr[WF_HISTORY_LEVELS];
+    quint8          m_PendingData[WF_HISTORY_LEVELS][WF_HISTORY_WIDTH / 2];
+};
+
+#endif // WATERFALL_HISTORY_H
@@ -44,7 +44,7 @@ nbrx::nbrx(float quad_rate, float audio_rate)
     nb = make_rx_nb_cc(PREF_QUAD_RATE, 3.3, 2.5);
     filter = make_rx_filter(PREF_QUAD_RATE, -5000.0, 5000.0, 1000.0);
     agc = make_rx_agc_cc(PREF_QUAD_RATE, true, -100, 0, 0, 500, false);
-    sql = gr::analog::simple_squelch_cc::make(-150.0, 0.001);
+    sql = gr::analog::pwr_squelch_cc::make(-150.0, 0.001);
     meter = make_rx_meter_c(DETECTOR_TYPE_RMS);
     demod_raw = gr::blocks::complex_to_float::make(1);
     demod_ssb = gr::blocks::complex_to_real::make(1);
@@ -137,6 +137,12 @@ float nbrx::get_signal_level(bool dbfs)
 
 }
 
+/*! \brief Feed a signal level history from the channel filter output. */
+void nbrx::set_level_history(level_history_sptr hist)
+{
+    meter->set_history(hist, PREF_QUAD_RATE);
+}
+
 void nbrx::set_nb_on(int nbid, bool on)
 {
     if (nbid == 1)
@@ -23,7 +23,7 @@
 #ifndef NBRX_H
 #define NBRX_H
 
-#include <gnuradio/analog/simple_squelch_cc.h>
+#include <gnuradio/analog/pwr_squelch_cc.h>
 #include <gnuradio/basic_block.h>
 #include <gnuradio/blocks/complex_to_float.h>
 #include <gnuradio/blocks/complex_to_real.h>
@@ -75,6 +75,7 @@ public:
     void set_cw_offset(double offset);
 
     float get_signal_level(bool dbfs);
+    void set_level_history(level_history_sptr hist);
 
     /* Noise blanker */
     bool has_nb() { return true; }
@@ -85,6 +86,7 @@ public:
     bool has_sql() { return true; }
     void set_sql_level(double level_db);
     void set_sql_alpha(double alpha);
+    bool is_sql_open() { return sql->unmuted(); }
 
     /* AGC */
     bool has_agc() { return true; }
@@ -119,7 +121,7 @@ private:
     rx_nb_cc_sptr             nb;         /*!< Noise blanker. */
     rx_meter_c_sptr           meter;      /*!< Signal strength. */
     rx_agc_cc_sptr            agc;        /*!< Receiver AGC. */
-    gr::analog::simple_squelch_cc::sptr sql;        /*!< Squelch. */
+    gr::analog::pwr_squelch_cc::sptr sql;           /*!< Squelch, tags open / close. */
     gr::blocks::complex_to_float::sptr  demod_raw;  /*!< Raw I/Q passthrough. */
     gr::blocks::complex_to_real::sptr   demod_ssb;  /*!< SSB demodulator. */
     rx_demod_fm_sptr          demod_fm;   /*!< FM demodulator. */
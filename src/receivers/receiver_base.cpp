@@ -74,6 +74,11 @@ void receiver_base_cf::set_sql_alpha(double alpha)
     (void) alpha;
 }
 
+bool receiver_base_cf::is_sql_open()
+{
+    return true;
+}
+
 bool receiver_base_cf::has_agc()
 {
     return false;
@@ -156,3 +161,8 @@ bool receiver_base_cf::is_rds_decoder_active()
 {
     return false;
 }
+
+void receiver_base_cf::set_level_history(level_history_sptr hist)
+{
+    (void) hist;
+}
@@ -24,6 +24,7 @@
 #define RECEIVER_BASE_H
 
 #include <gnuradio/hier_block2.h>
+#include "dsp/level_history.h"
 
 
 class receiver_base_cf;
@@ -72,6 +73,7 @@ public:
     virtual bool has_sql();
     virtual void set_sql_level(double level_db);
     virtual void set_sql_alpha(double alpha);
+    virtual bool is_sql_open();
 
     /* AGC */
     virtual bool has_agc();
@@ -97,6 +99,9 @@ public:
     virtual void reset_rds_parser();
     virtual bool is_rds_decoder_active();
 
+    /* Signal level history */
+    virtual void set_level_history(level_history_sptr hist);
+
 };
 
 #endif // RECEIVER_BASE_H
@@ -24,7 +24,7 @@
 #ifndef WFMRX_H
 #define WFMRX_H
 
-#include <gnuradio/analog/simple_squelch_cc.h>
+#include <gnuradio/analog/pwr_squelch_cc.h>
 #include "receivers/receiver_base.h"
 #include "dsp/rx_noise_blanker_cc.h"
 #include "dsp/rx_filter.h"
@@ -72,6 +72,7 @@ public:
     void set_cw_offset(double offset) { (void)offset; }
 
     float get_signal_level(bool dbfs);
+    void set_level_history(level_history_sptr hist);
 
     /* Noise blanker */
     bool has_nb() { return false; }
@@ -82,6 +83,7 @@ public:
     bool has_sql() { return true; }
     void set_sql_level(double level_db);
     void set_sql_alpha(double alpha);
+    bool is_sql_open() { return sql->unmuted(); }
 
     /* AGC */
     bool has_agc() { return false; }
@@ -116,7 +118,7 @@ private:
     rx_filter_sptr            filter;    /*!< Non-translating bandpass filter.*/
 
     rx_meter_c_sptr           meter;     /*!< Signal strength. */
-    gr::analog::simple_squelch_cc::sptr sql;       /*!< Squelch. */
+    gr::analog::pwr_squelch_cc::sptr sql;          /*!< Squelch, tags open / close. */
     rx_demod_fm_sptr          demod_fm;  /*!< FM demodulator. */
     resampler_ff_sptr         midle_rr;  /*!< Resampler. */
     stereo_demod_sptr         stereo;    /*!< FM stereo demodulator. */